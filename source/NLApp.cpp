@@ -14,6 +14,9 @@
 
 using namespace cugl;
 
+/** The recorded session in the save directory to replay at startup (empty for none) */
+#define REPLAY_SESSION ""
+
 
 #pragma mark -
 #pragma mark Application State
@@ -139,6 +142,9 @@ void NetApp::preUpdate(float timestep){
         _joingame.init(_assets,_network);
         //_gameplay.init(_assets);
         _status = MENU;
+        if (*REPLAY_SESSION) {
+            runReplay();
+        }
     }
     else if (_status == MENU) {
         updateMenuScene(timestep);
@@ -172,6 +178,9 @@ void NetApp::fixedUpdate() {
     if(_network){
         _network->updateNet();
     }
+    if (_status == GAME) {
+        _gameplay.markNetworkFlush();
+    }
 }
 #else
 /**
@@ -190,6 +199,22 @@ void NetApp::update(float timestep) {
 }
 #endif
 
+/**
+ * Replays the session REPLAY_SESSION, and then quits.
+ *
+ * The replay runs as fast as possible without drawing, so that a recorded
+ * session can be profiled and compared run over run.
+ */
+void NetApp::runReplay() {
+    std::string path = Application::get()->getSaveDirectory() + REPLAY_SESSION;
+    CULog("Replaying %s", path.c_str());
+    if (_gameplay.initReplay(_assets, _network, path)) {
+        _gameplay.replay();
+        _gameplay.dispose();
+    }
+    quit();
+}
+
 /**
  * Inidividualized update method for the menu scene.
  *
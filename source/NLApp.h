@@ -160,6 +160,14 @@ public:
     virtual void update(float timestep) override;
 #endif
     
+    /**
+     * Replays the session REPLAY_SESSION, and then quits.
+     *
+     * The replay runs as fast as possible without drawing, so that a recorded
+     * session can be profiled and compared run over run.
+     */
+    void runReplay();
+
     /**
      * Inidividualized update method for the menu scene.
      *
@@ -0,0 +1,337 @@
+//
+//  NLAuthority.cpp
+//  Networked Physics Demo
+//
+//  This class decides which obstacles this peer should own.
+//  An obstacle pushed around by bodies of this peer looks much better when
+//  this peer simulates it, instead of waiting for corrections from its
+//  remote owner.  So when bodies owned by this peer keep touching a dynamic
+//  obstacle owned elsewhere, the policy asks to acquire it for a while.
+//  Hysteresis, a cooldown and a budget keep the peers from fighting over
+//  obstacles or taking over the whole world.  Two peers may still ask for
+//  the same obstacle at once, so requests go to the host, whose arbiter
+//  grants every obstacle to at most one peer.
+//
+//  Author: Networked Physics Lab contributors
+//  Version: 10/18/26
+//
+#include "NLAuthority.h"
+#include "NLStats.h"
+#include <box2d/b2_world.h>
+#include <box2d/b2_body.h>
+#include <box2d/b2_contact.h>
+#include <box2d/b2_fixture.h>
+#include <unordered_set>
+#include <algorithm>
+
+using namespace cugl;
+
+/** The smallest jump (in physics units) counted as a correction */
+#define CORRECTION_EPSILON  0.0001f
+
+/**
+ * Returns the obstacle attached to a Box2D body (or nullptr).
+ *
+ * @param body  The Box2D body
+ *
+ * @return the obstacle attached to a Box2D body
+ */
+static physics2::Obstacle* getObstacle(b2Body* body) {
+    return reinterpret_cast<physics2::Obstacle*>(body->GetUserData().pointer);
+}
+
+#pragma mark Constructors
+/**
+ * Initializes the policy.
+ *
+ * @param budget        The maximum number of obstacles leased at once
+ * @param hysteresis    The number of consecutive ticks of contact before acquiring
+ * @param lease         The number of ticks of every lease
+ * @param cooldown      The number of ticks before a lost obstacle may be acquired again
+ */
+void AuthorityPolicy::init(size_t budget, Uint32 hysteresis, Uint32 lease, Uint32 cooldown) {
+    _budget = budget;
+    _hysteresis = std::max(hysteresis, (Uint32)1);
+    _lease = std::max(lease, _hysteresis+1);
+    _cooldown = cooldown;
+    clear();
+}
+
+/**
+ * Forgets all candidates and leases.
+ */
+void AuthorityPolicy::clear() {
+    _candidates.clear();
+    _lastPos.clear();
+    _leased = 0;
+}
+
+#pragma mark Policy
+/**
+ * Returns the obstacles to request (or renew) this tick.
+ *
+ * This should be called once per tick, after the physics step. The
+ * caller should request every obstacle returned from the host, and
+ * acquire it for the lease length once granted.
+ *
+ * @param world The obstacle world
+ * @param tick  The current tick
+ *
+ * @return the obstacles to request (or renew) this tick
+ */
+std::vector<std::shared_ptr<physics2::Obstacle>> AuthorityPolicy::update(const std::shared_ptr<physics2::ObstacleWorld>& world,
+                                                                         Uint64 tick) {
+    std::vector<std::shared_ptr<physics2::Obstacle>> result;
+    if (_budget == 0) {
+        return result;
+    }
+    
+    std::unordered_set<physics2::Obstacle*> mine;
+    for(auto it = world->getOwned().begin(); it != world->getOwned().end(); ++it) {
+        mine.insert(it->first.get());
+    }
+    
+    // Find the dynamic obstacles touched by our bodies (leases count, so piles propagate)
+    std::unordered_set<physics2::Obstacle*> touched;
+    for(b2Contact* contact = world->getWorld()->GetContactList(); contact != nullptr; contact = contact->GetNext()) {
+        if (!contact->IsTouching()) {
+            continue;
+        }
+        b2Body* body1 = contact->GetFixtureA()->GetBody();
+        b2Body* body2 = contact->GetFixtureB()->GetBody();
+        physics2::Obstacle* obs1 = getObstacle(body1);
+        physics2::Obstacle* obs2 = getObstacle(body2);
+        if (obs1 == nullptr || obs2 == nullptr) {
+            continue;
+        }
+        bool mine1 = mine.count(obs1) > 0;
+        bool mine2 = mine.count(obs2) > 0;
+        if (mine1 && body2->GetType() == b2_dynamicBody && (!mine2 || _candidates.count(obs2))) {
+            touched.insert(obs2);
+        }
+        if (mine2 && body1->GetType() == b2_dynamicBody && (!mine1 || _candidates.count(obs1))) {
+            touched.insert(obs1);
+        }
+    }
+    
+    // New candidates need their shared pointers
+    bool missing = false;
+    for(physics2::Obstacle* obs : touched) {
+        if (_candidates.find(obs) == _candidates.end()) {
+            missing = true;
+            break;
+        }
+    }
+    if (missing) {
+        for(auto& obj : world->getObstacles()) {
+            if (touched.count(obj.get()) && _candidates.find(obj.get()) == _candidates.end()) {
+                Candidate candidate;
+                candidate.obstacle = obj;
+                candidate.touching = 0;
+                candidate.leaseEnd = 0;
+                candidate.cooldownEnd = 0;
+                _candidates[obj.get()] = candidate;
+            }
+        }
+    }
+    
+    for(auto it = _candidates.begin(); it != _candidates.end(); ) {
+        Candidate& candidate = it->second;
+        bool leased = candidate.leaseEnd > 0;
+        if (candidate.obstacle->isRemoved() || !candidate.obstacle->isEnabled()) {
+            if (leased) {
+                _leased--;
+            }
+            it = _candidates.erase(it);
+            continue;
+        }
+        
+        candidate.touching = touched.count(it->first) ? candidate.touching+1 : 0;
+        if (leased && tick >= candidate.leaseEnd) {
+            // The lease ran out without contact to renew it
+            candidate.leaseEnd = 0;
+            candidate.cooldownEnd = tick+_cooldown;
+            leased = false;
+            _leased--;
+            if (_stats) {
+                _stats->count("authority.expired");
+            }
+        }
+        
+        if (leased) {
+            // Renew shortly before the lease ends, as long as we still push it and
+            // the link can afford it (otherwise the lease runs out and sheds its state)
+            if (candidate.touching > 0 && tick+_hysteresis >= candidate.leaseEnd &&
+                _leased <= std::min(_budget, _limit)) {
+                candidate.leaseEnd = tick+_lease;
+                result.push_back(candidate.obstacle);
+                if (_stats) {
+                    _stats->count("authority.renewed");
+                }
+            }
+        } else if (candidate.touching >= _hysteresis && tick >= candidate.cooldownEnd &&
+                   !mine.count(it->first) && _leased < std::min(_budget, _limit)) {
+            candidate.leaseEnd = tick+_lease;
+            _leased++;
+            result.push_back(candidate.obstacle);
+            if (_stats) {
+                _stats->count("authority.requested");
+            }
+        } else if (candidate.touching == 0 && tick >= candidate.cooldownEnd) {
+            it = _candidates.erase(it);
+            continue;
+        }
+        ++it;
+    }
+    return result;
+}
+
+/**
+ * Ends the lease of an obstacle the host did not grant.
+ *
+ * The obstacle may not be requested again until the cooldown is over.
+ *
+ * @param obj   The obstacle
+ * @param tick  The current tick
+ */
+void AuthorityPolicy::deny(const std::shared_ptr<physics2::Obstacle>& obj, Uint64 tick) {
+    auto it = _candidates.find(obj.get());
+    if (it == _candidates.end() || it->second.leaseEnd == 0) {
+        return;
+    }
+    it->second.leaseEnd = 0;
+    it->second.cooldownEnd = tick+_cooldown;
+    _leased--;
+    if (_stats) {
+        _stats->count("authority.denied");
+    }
+}
+
+#pragma mark Measurement
+/**
+ * Samples the corrections of remote obstacles since the last step.
+ *
+ * This should be called once per tick, after the network has applied
+ * its updates and before the physics step.
+ *
+ * @param world The obstacle world
+ */
+void AuthorityPolicy::measure(const std::shared_ptr<physics2::ObstacleWorld>& world) {
+    if (_stats == nullptr) {
+        return;
+    }
+    for(auto& obj : world->getObstacles()) {
+        auto last = _lastPos.find(obj.get());
+        if (last == _lastPos.end()) {
+            continue;
+        }
+        float jump = obj->getPosition().distance(last->second);
+        if (jump > CORRECTION_EPSILON) {
+            _stats->count("authority.corrected");
+            _stats->sample("authority.correction", jump);
+        }
+    }
+}
+
+/**
+ * Records the positions of remote obstacles after the physics step.
+ *
+ * @param world The obstacle world
+ */
+void AuthorityPolicy::record(const std::shared_ptr<physics2::ObstacleWorld>& world) {
+    _lastPos.clear();
+    auto& owned = world->getOwned();
+    for(auto& obj : world->getObstacles()) {
+        b2Body* body = obj->getBody();
+        if (body == nullptr || body->GetType() != b2_dynamicBody || !body->IsAwake() || !body->IsEnabled()) {
+            continue;
+        }
+        if (owned.find(obj) == owned.end()) {
+            _lastPos[obj.get()] = obj->getPosition();
+        }
+    }
+}
+
+#pragma mark -
+#pragma mark Arbiter
+/**
+ * Initializes the arbiter.
+ *
+ * @param lease The number of ticks of every lease
+ */
+void AuthorityArbiter::init(Uint32 lease) {
+    _lease = std::max(lease, (Uint32)1);
+    clear();
+}
+
+/**
+ * Forgets all leases and requests.
+ */
+void AuthorityArbiter::clear() {
+    _leases.clear();
+    _requests.clear();
+}
+
+/**
+ * Queues the requests of a peer until the next resolution.
+ *
+ * @param peer  The short UID of the peer
+ * @param ids   The ids of the requested obstacles
+ */
+void AuthorityArbiter::request(Uint32 peer, const std::vector<Uint64>& ids) {
+    for(Uint64 id : ids) {
+        _requests.push_back(std::make_pair(peer, id));
+    }
+}
+
+/**
+ * Grants or denies every queued request.
+ *
+ * The verdicts are ordered by peer. Leases that ran out by the given
+ * tick are released first.
+ *
+ * @param tick  The current tick
+ *
+ * @return the verdict for every peer with queued requests
+ */
+std::vector<AuthorityArbiter::Verdict> AuthorityArbiter::resolve(Uint64 tick) {
+    std::vector<Verdict> result;
+    for(auto it = _leases.begin(); it != _leases.end(); ) {
+        if (tick >= it->second.end) {
+            it = _leases.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    if (_requests.empty()) {
+        return result;
+    }
+    
+    // The lowest peer goes first, so it wins every tie
+    std::sort(_requests.begin(), _requests.end());
+    _requests.erase(std::unique(_requests.begin(), _requests.end()), _requests.end());
+    for(auto& request : _requests) {
+        if (result.empty() || result.back().peer != request.first) {
+            Verdict verdict;
+            verdict.peer = request.first;
+            result.push_back(verdict);
+        }
+        auto lease = _leases.find(request.second);
+        if (lease == _leases.end() || lease->second.peer == request.first) {
+            Lease& granted = _leases[request.second];
+            granted.peer = request.first;
+            granted.end = tick+_lease;
+            result.back().granted.push_back(request.second);
+            if (_stats) {
+                _stats->count("authority.granted");
+            }
+        } else {
+            result.back().denied.push_back(request.second);
+            if (_stats) {
+                _stats->count("authority.conflicts");
+            }
+        }
+    }
+    _requests.clear();
+    return result;
+}
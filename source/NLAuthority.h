@@ -0,0 +1,257 @@
+//
+//  NLAuthority.h
+//  Networked Physics Demo
+//
+//  This class decides which obstacles this peer should own.
+//  An obstacle pushed around by bodies of this peer looks much better when
+//  this peer simulates it, instead of waiting for corrections from its
+//  remote owner.  So when bodies owned by this peer keep touching a dynamic
+//  obstacle owned elsewhere, the policy asks to acquire it for a while.
+//  Hysteresis, a cooldown and a budget keep the peers from fighting over
+//  obstacles or taking over the whole world.  Two peers may still ask for
+//  the same obstacle at once, so requests go to the host, whose arbiter
+//  grants every obstacle to at most one peer.
+//
+//  Author: Networked Physics Lab contributors
+//  Version: 10/18/26
+//
+#ifndef __NL_AUTHORITY_H__
+#define __NL_AUTHORITY_H__
+#include <cugl/cugl.h>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class NetLabStats;
+
+/**
+ * This class chooses the obstacles this peer should acquire.
+ *
+ * Ownership is leased: every acquisition lasts a fixed number of ticks, and
+ * is renewed only while this peer's bodies still touch the obstacle. The
+ * policy only chooses what to request. An obstacle is acquired once the
+ * host grants it, and a denied request ends the lease at once. The
+ * policy also measures how much remote obstacles are corrected by the
+ * network between ticks, which is what ownership transfers should reduce.
+ */
+class AuthorityPolicy {
+protected:
+    /** The state of an obstacle this peer is interested in */
+    struct Candidate {
+        /** The obstacle */
+        std::shared_ptr<cugl::physics2::Obstacle> obstacle;
+        /** The number of consecutive ticks touched by our bodies */
+        Uint32 touching;
+        /** The tick our lease ends (0 if not leased) */
+        Uint64 leaseEnd;
+        /** The tick before which the obstacle may not be acquired again */
+        Uint64 cooldownEnd;
+    };
+
+    /** The obstacles touched by our bodies or leased by us */
+    std::unordered_map<cugl::physics2::Obstacle*, Candidate> _candidates;
+    /** The positions of remote obstacles after the last physics step */
+    std::unordered_map<cugl::physics2::Obstacle*, cugl::Vec2> _lastPos;
+    /** The number of obstacles currently leased */
+    size_t _leased;
+    /** The maximum number of obstacles leased at once */
+    size_t _budget;
+    /** The current cap on new leases (below the budget when the uplink is congested) */
+    size_t _limit;
+    /** The number of consecutive ticks of contact before acquiring */
+    Uint32 _hysteresis;
+    /** The number of ticks of every lease */
+    Uint32 _lease;
+    /** The number of ticks before a lost obstacle may be acquired again */
+    Uint32 _cooldown;
+    /** The statistics log for transfers and corrections (may be null) */
+    NetLabStats* _stats;
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates a policy that never acquires anything.
+     */
+    AuthorityPolicy() : _leased(0), _budget(0), _limit(SIZE_MAX), _hysteresis(1), _lease(1), _cooldown(0), _stats(nullptr) {}
+
+    /**
+     * Initializes the policy.
+     *
+     * @param budget        The maximum number of obstacles leased at once
+     * @param hysteresis    The number of consecutive ticks of contact before acquiring
+     * @param lease         The number of ticks of every lease
+     * @param cooldown      The number of ticks before a lost obstacle may be acquired again
+     */
+    void init(size_t budget, Uint32 hysteresis, Uint32 lease, Uint32 cooldown);
+
+    /**
+     * Forgets all candidates and leases.
+     */
+    void clear();
+
+    /**
+     * Sets the statistics log for transfers and corrections.
+     *
+     * @param stats The statistics log (or nullptr)
+     */
+    void setStats(NetLabStats* stats) { _stats = stats; }
+
+    /**
+     * Returns the number of obstacles currently leased.
+     *
+     * @return the number of obstacles currently leased.
+     */
+    size_t getLeased() const { return _leased; }
+
+    /**
+     * Sets the cap on new leases.
+     *
+     * No obstacle is acquired while as many are leased as the cap (or the
+     * budget, if smaller). While more are leased than the cap, no lease is
+     * renewed, so that they run out and their state is no longer sent.
+     *
+     * @param limit The cap on new leases
+     */
+    void setLimit(size_t limit) { _limit = limit; }
+
+#pragma mark Policy
+    /**
+     * Returns the obstacles to request (or renew) this tick.
+     *
+     * This should be called once per tick, after the physics step. The
+     * caller should request every obstacle returned from the host, and
+     * acquire it for the lease length once granted.
+     *
+     * @param world The obstacle world
+     * @param tick  The current tick
+     *
+     * @return the obstacles to request (or renew) this tick
+     */
+    std::vector<std::shared_ptr<cugl::physics2::Obstacle>> update(const std::shared_ptr<cugl::physics2::ObstacleWorld>& world,
+                                                                  Uint64 tick);
+
+    /**
+     * Ends the lease of an obstacle the host did not grant.
+     *
+     * The obstacle may not be requested again until the cooldown is over.
+     *
+     * @param obj   The obstacle
+     * @param tick  The current tick
+     */
+    void deny(const std::shared_ptr<cugl::physics2::Obstacle>& obj, Uint64 tick);
+
+#pragma mark Measurement
+    /**
+     * Samples the corrections of remote obstacles since the last step.
+     *
+     * This should be called once per tick, after the network has applied
+     * its updates and before the physics step.
+     *
+     * @param world The obstacle world
+     */
+    void measure(const std::shared_ptr<cugl::physics2::ObstacleWorld>& world);
+
+    /**
+     * Records the positions of remote obstacles after the physics step.
+     *
+     * @param world The obstacle world
+     */
+    void record(const std::shared_ptr<cugl::physics2::ObstacleWorld>& world);
+};
+
+/**
+ * This class grants obstacle leases on the host.
+ *
+ * Every peer sends the obstacles its policy chose to the host, which queues
+ * them with {@link #request}. Once per tick, {@link #resolve} grants every
+ * obstacle to at most one peer. An obstacle leased to a peer is denied to
+ * every other peer until the lease runs out, while the holder may renew it.
+ * When several peers ask for a free obstacle in the same tick, the peer
+ * with the lowest short UID wins.
+ */
+class AuthorityArbiter {
+public:
+    /** The answer to the requests of one peer */
+    struct Verdict {
+        /** The short UID of the peer */
+        Uint32 peer;
+        /** The ids of the obstacles granted to the peer */
+        std::vector<Uint64> granted;
+        /** The ids of the obstacles denied to the peer */
+        std::vector<Uint64> denied;
+    };
+
+protected:
+    /** A lease granted by this arbiter */
+    struct Lease {
+        /** The short UID of the peer holding the lease */
+        Uint32 peer;
+        /** The tick the lease ends */
+        Uint64 end;
+    };
+
+    /** The current leases, by obstacle id */
+    std::unordered_map<Uint64, Lease> _leases;
+    /** The requests since the last resolution, as (peer, obstacle id) */
+    std::vector<std::pair<Uint32, Uint64>> _requests;
+    /** The number of ticks of every lease */
+    Uint32 _lease;
+    /** The statistics log for grants and denials (may be null) */
+    NetLabStats* _stats;
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates an arbiter with one tick leases.
+     */
+    AuthorityArbiter() : _lease(1), _stats(nullptr) {}
+
+    /**
+     * Initializes the arbiter.
+     *
+     * @param lease The number of ticks of every lease
+     */
+    void init(Uint32 lease);
+
+    /**
+     * Forgets all leases and requests.
+     */
+    void clear();
+
+    /**
+     * Sets the statistics log for grants and denials.
+     *
+     * @param stats The statistics log (or nullptr)
+     */
+    void setStats(NetLabStats* stats) { _stats = stats; }
+
+    /**
+     * Returns the number of obstacles currently leased.
+     *
+     * @return the number of obstacles currently leased.
+     */
+    size_t size() const { return _leases.size(); }
+
+#pragma mark Arbitration
+    /**
+     * Queues the requests of a peer until the next resolution.
+     *
+     * @param peer  The short UID of the peer
+     * @param ids   The ids of the requested obstacles
+     */
+    void request(Uint32 peer, const std::vector<Uint64>& ids);
+
+    /**
+     * Grants or denies every queued request.
+     *
+     * The verdicts are ordered by peer. Leases that ran out by the given
+     * tick are released first.
+     *
+     * @param tick  The current tick
+     *
+     * @return the verdict for every peer with queued requests
+     */
+    std::vector<Verdict> resolve(Uint64 tick);
+};
+
+#endif /* __NL_AUTHORITY_H__ */
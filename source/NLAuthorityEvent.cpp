@@ -0,0 +1,87 @@
+//
+//  NLAuthorityEvent.cpp
+//  Networked Physics Lab
+//
+//  This class carries obstacle lease requests to the host, and the host's
+//  answer back to the peers.  Only the peer a grant is addressed to acquires
+//  the granted obstacles, so two peers never take over the same obstacle.
+//
+//  Created by the Networked Physics Lab contributors on 10/18/26.
+//
+
+#include "NLAuthorityEvent.h"
+
+/**
+ * This method is used by the NetEventController to create a new event of using a
+ * reference of the same type.
+ *
+ * Not that this method is not static, it differs from the static alloc() method
+ * and all methods must implement this method.
+ */
+std::shared_ptr<NetEvent> AuthorityEvent::newEvent(){
+    return std::make_shared<AuthorityEvent>();
+}
+
+std::shared_ptr<NetEvent> AuthorityEvent::allocRequestEvent(Uint32 peer, const std::vector<Uint64>& ids){
+    auto event = std::make_shared<AuthorityEvent>();
+    event->_peer = peer;
+    event->_grant = false;
+    event->_ids = ids;
+    return event;
+}
+
+std::shared_ptr<NetEvent> AuthorityEvent::allocGrantEvent(Uint32 peer, const std::vector<Uint64>& granted,
+                                                          const std::vector<Uint64>& denied){
+    auto event = std::make_shared<AuthorityEvent>();
+    event->_peer = peer;
+    event->_grant = true;
+    event->_ids = granted;
+    event->_denied = denied;
+    return event;
+}
+
+/**
+ * Serialize any paramater that the event contains to a vector of bytes.
+ */
+std::vector<std::byte> AuthorityEvent::serialize(){
+    _serializer.reset();
+    _serializer.writeUint32(_peer);
+    _serializer.writeBool(_grant);
+    _serializer.writeUint32((Uint32)_ids.size());
+    for(Uint64 id : _ids){
+        _serializer.writeUint64(id);
+    }
+    _serializer.writeUint32((Uint32)_denied.size());
+    for(Uint64 id : _denied){
+        _serializer.writeUint64(id);
+    }
+    return _serializer.serialize();
+}
+
+/**
+ * Deserialize a vector of bytes and set the corresponding parameters.
+ *
+ * @param data  a byte vector packed by serialize()
+ *
+ * This function should be the "reverse" of the serialize() function: it
+ * should be able to recreate a serialized event entirely, setting all the
+ * useful parameters of this class.
+ */
+void AuthorityEvent::deserialize(const std::vector<std::byte>& data){
+    _deserializer.reset();
+    _deserializer.receive(data);
+    _peer = _deserializer.readUint32();
+    _grant = _deserializer.readBool();
+    Uint32 count = _deserializer.readUint32();
+    _ids.clear();
+    _ids.reserve(count);
+    for(Uint32 ii = 0; ii < count; ii++){
+        _ids.push_back(_deserializer.readUint64());
+    }
+    count = _deserializer.readUint32();
+    _denied.clear();
+    _denied.reserve(count);
+    for(Uint32 ii = 0; ii < count; ii++){
+        _denied.push_back(_deserializer.readUint64());
+    }
+}
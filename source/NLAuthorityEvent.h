@@ -0,0 +1,79 @@
+//
+//  NLAuthorityEvent.h
+//  Networked Physics Lab
+//
+//  This class carries obstacle lease requests to the host, and the host's
+//  answer back to the peers.  Only the peer a grant is addressed to acquires
+//  the granted obstacles, so two peers never take over the same obstacle.
+//
+//  Created by the Networked Physics Lab contributors on 10/18/26.
+//
+
+#ifndef NLAuthorityEvent_h
+#define NLAuthorityEvent_h
+
+#include <cugl/cugl.h>
+#include <vector>
+using namespace cugl::netphysics;
+using namespace cugl;
+
+class AuthorityEvent : public NetEvent {
+    
+protected:
+    LWSerializer _serializer;
+    LWDeserializer _deserializer;
+    
+    /** The short UID of the requesting peer (or the peer a grant is for) */
+    Uint32 _peer;
+    /** Whether this is the host's answer (instead of a request) */
+    bool _grant;
+    /** The ids of the requested (or granted) obstacles */
+    std::vector<Uint64> _ids;
+    /** The ids of the denied obstacles (grants only) */
+    std::vector<Uint64> _denied;
+    
+public:
+    /**
+     * This method is used by the NetEventController to create a new event of using a
+     * reference of the same type.
+     *
+     * Not that this method is not static, it differs from the static alloc() method
+     * and all methods must implement this method.
+     */
+    std::shared_ptr<NetEvent> newEvent() override;
+    
+    static std::shared_ptr<NetEvent> allocRequestEvent(Uint32 peer, const std::vector<Uint64>& ids);
+    
+    static std::shared_ptr<NetEvent> allocGrantEvent(Uint32 peer, const std::vector<Uint64>& granted,
+                                                     const std::vector<Uint64>& denied);
+    
+    /**
+     * Serialize any paramater that the event contains to a vector of bytes.
+     */
+    std::vector<std::byte> serialize() override;
+    /**
+     * Deserialize a vector of bytes and set the corresponding parameters.
+     *
+     * @param data  a byte vector packed by serialize()
+     *
+     * This function should be the "reverse" of the serialize() function: it
+     * should be able to recreate a serialized event entirely, setting all the
+     * useful parameters of this class.
+     */
+    void deserialize(const std::vector<std::byte>& data) override;
+    
+    /** Gets the short UID of the requesting peer (or the peer a grant is for). */
+    Uint32 getPeer() const { return _peer; }
+    
+    /** Gets whether this is the host's answer (instead of a request). */
+    bool isGrant() const { return _grant; }
+    
+    /** Gets the ids of the requested (or granted) obstacles. */
+    const std::vector<Uint64>& getIds() const { return _ids; }
+    
+    /** Gets the ids of the denied obstacles (grants only). */
+    const std::vector<Uint64>& getDenied() const { return _denied; }
+};
+
+
+#endif /* NLAuthorityEvent_h */
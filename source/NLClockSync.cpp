@@ -0,0 +1,183 @@
+//
+//  NLClockSync.cpp
+//  Networked Physics Demo
+//
+//  This class estimates the clock of the host from timestamped probes, so
+//  that every peer agrees on the current simulation tick.  Each probe gives
+//  the offset between the clocks (NTP-style, assuming symmetric delays),
+//  and probes with a long round trip are filtered out, as their delays are
+//  most likely asymmetric.  The drift between the clocks is the slope of
+//  the offsets over time.  The host also reports its tick, which maps its
+//  clock to the shared tick number.  Clients then dilate their fixed step
+//  by a few percent to stay aligned with the host.
+//
+//  Author: Networked Physics Lab contributors
+//  Version: 10/18/26
+//
+#include "NLClockSync.h"
+#include <algorithm>
+#include <vector>
+
+using namespace cugl;
+
+/** The number of samples needed for an estimate */
+#define MIN_SAMPLES     4
+/** The number of filtered samples needed to estimate drift */
+#define DRIFT_SAMPLES   8
+/** The round trip slack (beyond the best one) of a usable sample */
+#define RTT_SLACK       2000
+/** The largest drift believed, in remote seconds per local second */
+#define MAX_DRIFT       0.001
+
+#pragma mark Constructors
+/**
+ * Initializes an unsynchronized clock.
+ *
+ * @param capacity      The number of recent samples to keep
+ * @param step          The length of a tick
+ * @param maxDilation   The largest change to the tick rate, as a fraction
+ * @param gain          The dilation per tick of error
+ */
+void ClockSync::init(size_t capacity, Uint64 step, double maxDilation, double gain) {
+    _capacity = std::max(capacity, (size_t)MIN_SAMPLES);
+    _step = (double)step;
+    _maxDilation = maxDilation;
+    _gain = gain;
+    clear();
+}
+
+/**
+ * Forgets all samples.
+ */
+void ClockSync::clear() {
+    _samples.clear();
+    _reference = 0;
+    _offset = 0;
+    _drift = 0;
+    _epoch = 0;
+    _rtt = 0;
+    _synced = false;
+}
+
+#pragma mark Sampling
+/**
+ * Adds a probe answered by the remote peer.
+ *
+ * The remote peer must answer as soon as it receives the probe.
+ *
+ * @param sent      The local time the probe was sent
+ * @param remote    The remote time the probe was answered
+ * @param tick      The remote tick the probe was answered
+ * @param received  The local time the answer was received
+ */
+void ClockSync::sample(Uint64 sent, Uint64 remote, Uint64 tick, Uint64 received) {
+    if (received < sent) {
+        return;
+    }
+    Sample sample;
+    sample.local = sent+(received-sent)/2;
+    sample.offset = (double)remote-(double)sample.local;
+    sample.rtt = received-sent;
+    sample.epoch = (double)remote-tick*_step;
+    _samples.push_back(sample);
+    if (_samples.size() > _capacity) {
+        _samples.pop_front();
+    }
+    estimate();
+}
+
+/**
+ * Recomputes the estimate from the filtered samples.
+ */
+void ClockSync::estimate() {
+    if (_samples.size() < MIN_SAMPLES) {
+        return;
+    }
+    
+    // Only trust the samples with a round trip close to the best one
+    Uint64 best = UINT64_MAX;
+    for(auto& sample : _samples) {
+        best = std::min(best, sample.rtt);
+    }
+    Uint64 limit = best+std::max(best/2, (Uint64)RTT_SLACK);
+    std::vector<const Sample*> good;
+    for(auto& sample : _samples) {
+        if (sample.rtt <= limit) {
+            good.push_back(&sample);
+        }
+    }
+    
+    // Least squares fit of the offset over local time
+    double meanT = 0, meanO = 0;
+    for(auto sample : good) {
+        meanT += sample->local;
+        meanO += sample->offset;
+    }
+    meanT /= good.size();
+    meanO /= good.size();
+    double drift = 0;
+    if (good.size() >= DRIFT_SAMPLES) {
+        double num = 0, den = 0;
+        for(auto sample : good) {
+            double dt = sample->local-meanT;
+            num += dt*(sample->offset-meanO);
+            den += dt*dt;
+        }
+        drift = den > 0 ? std::clamp(num/den, -MAX_DRIFT, MAX_DRIFT) : 0;
+    }
+    _reference = meanT;
+    _offset = meanO;
+    _drift = drift;
+    _rtt = best;
+    
+    // The remote loop jitters by up to a tick, so take the median epoch
+    std::vector<double> epochs;
+    for(auto sample : good) {
+        epochs.push_back(sample->epoch);
+    }
+    std::nth_element(epochs.begin(), epochs.begin()+epochs.size()/2, epochs.end());
+    _epoch = epochs[epochs.size()/2];
+    _synced = true;
+}
+
+#pragma mark Estimates
+/**
+ * Returns the remote time at the given local time.
+ *
+ * @param local The local time
+ *
+ * @return the remote time at the given local time.
+ */
+double ClockSync::toRemote(Uint64 local) const {
+    return local+_offset+_drift*(local-_reference);
+}
+
+/**
+ * Returns the (fractional) remote tick at the given local time.
+ *
+ * @param local The local time
+ *
+ * @return the (fractional) remote tick at the given local time.
+ */
+double ClockSync::getTick(Uint64 local) const {
+    return (toRemote(local)-_epoch)/_step;
+}
+
+/**
+ * Returns the factor to apply to the local tick rate.
+ *
+ * The factor is above 1 if the local tick is behind the remote one,
+ * and below 1 if it is ahead, up to the maximum dilation.
+ *
+ * @param local The local time
+ * @param tick  The local tick
+ *
+ * @return the factor to apply to the local tick rate.
+ */
+double ClockSync::getDilation(Uint64 local, Uint64 tick) const {
+    if (!_synced) {
+        return 1;
+    }
+    double error = getTick(local)-(double)tick;
+    return 1+std::clamp(error*_gain, -_maxDilation, _maxDilation);
+}
@@ -0,0 +1,169 @@
+//
+//  NLClockSync.h
+//  Networked Physics Demo
+//
+//  This class estimates the clock of the host from timestamped probes, so
+//  that every peer agrees on the current simulation tick.  Each probe gives
+//  the offset between the clocks (NTP-style, assuming symmetric delays),
+//  and probes with a long round trip are filtered out, as their delays are
+//  most likely asymmetric.  The drift between the clocks is the slope of
+//  the offsets over time.  The host also reports its tick, which maps its
+//  clock to the shared tick number.  Clients then dilate their fixed step
+//  by a few percent to stay aligned with the host.
+//
+//  Author: Networked Physics Lab contributors
+//  Version: 10/18/26
+//
+#ifndef __NL_CLOCK_SYNC_H__
+#define __NL_CLOCK_SYNC_H__
+#include <cugl/cugl.h>
+#include <deque>
+
+/**
+ * This class estimates the clock and tick of a remote peer (the host).
+ *
+ * All times are in microseconds. Local times are measured on this peer's
+ * clock, and remote times on the host's clock.
+ */
+class ClockSync {
+protected:
+    /** A single timestamped probe */
+    struct Sample {
+        /** The local time halfway through the round trip */
+        Uint64 local;
+        /** The remote minus the local clock */
+        double offset;
+        /** The round trip time */
+        Uint64 rtt;
+        /** The remote time of tick 0 */
+        double epoch;
+    };
+
+    /** The most recent samples */
+    std::deque<Sample> _samples;
+    /** The maximum number of samples kept */
+    size_t _capacity;
+    /** The length of a tick */
+    double _step;
+    /** The largest change to the tick rate, as a fraction */
+    double _maxDilation;
+    /** The dilation per tick of error */
+    double _gain;
+    /** The local time the estimate is centered on */
+    double _reference;
+    /** The offset at the reference time */
+    double _offset;
+    /** The drift of the remote clock relative to ours (remote seconds per local second, minus 1) */
+    double _drift;
+    /** The remote time of tick 0 */
+    double _epoch;
+    /** The round trip time of the best sample */
+    Uint64 _rtt;
+    /** Whether there are enough samples for an estimate */
+    bool _synced;
+
+    /**
+     * Recomputes the estimate from the filtered samples.
+     */
+    void estimate();
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates an unsynchronized clock.
+     */
+    ClockSync() : _capacity(0), _step(1), _maxDilation(0), _gain(0), _reference(0),
+    _offset(0), _drift(0), _epoch(0), _rtt(0), _synced(false) {}
+
+    /**
+     * Initializes an unsynchronized clock.
+     *
+     * @param capacity      The number of recent samples to keep
+     * @param step          The length of a tick
+     * @param maxDilation   The largest change to the tick rate, as a fraction
+     * @param gain          The dilation per tick of error
+     */
+    void init(size_t capacity, Uint64 step, double maxDilation, double gain);
+
+    /**
+     * Forgets all samples.
+     */
+    void clear();
+
+#pragma mark Sampling
+    /**
+     * Adds a probe answered by the remote peer.
+     *
+     * The remote peer must answer as soon as it receives the probe.
+     *
+     * @param sent      The local time the probe was sent
+     * @param remote    The remote time the probe was answered
+     * @param tick      The remote tick the probe was answered
+     * @param received  The local time the answer was received
+     */
+    void sample(Uint64 sent, Uint64 remote, Uint64 tick, Uint64 received);
+
+#pragma mark Estimates
+    /**
+     * Returns true if there are enough samples for an estimate.
+     *
+     * @return true if there are enough samples for an estimate.
+     */
+    bool isSynced() const { return _synced; }
+
+    /**
+     * Returns the remote time at the given local time.
+     *
+     * @param local The local time
+     *
+     * @return the remote time at the given local time.
+     */
+    double toRemote(Uint64 local) const;
+
+    /**
+     * Returns the (fractional) remote tick at the given local time.
+     *
+     * @param local The local time
+     *
+     * @return the (fractional) remote tick at the given local time.
+     */
+    double getTick(Uint64 local) const;
+
+    /**
+     * Returns the factor to apply to the local tick rate.
+     *
+     * The factor is above 1 if the local tick is behind the remote one,
+     * and below 1 if it is ahead, up to the maximum dilation.
+     *
+     * @param local The local time
+     * @param tick  The local tick
+     *
+     * @return the factor to apply to the local tick rate.
+     */
+    double getDilation(Uint64 local, Uint64 tick) const;
+
+    /**
+     * Returns the remote minus the local clock, now.
+     *
+     * @param local The local time
+     *
+     * @return the remote minus the local clock, now.
+     */
+    double getOffset(Uint64 local) const { return toRemote(local)-local; }
+
+    /**
+     * Returns the drift of the remote clock, in parts per million.
+     *
+     * @return the drift of the remote clock, in parts per million.
+     */
+    double getDrift() const { return _drift*1000000; }
+
+    /**
+     * Returns the round trip time of the best recent sample.
+     *
+     * @return the round trip time of the best recent sample.
+     */
+    Uint64 getRoundTrip() const { return _rtt; }
+};
+
+#endif /* __NL_CLOCK_SYNC_H__ */
@@ -0,0 +1,150 @@
+//
+//  NLCongestion.cpp
+//  Networked Physics Demo
+//
+//  This class adapts the state update budget of a link to its conditions.
+//  Sending state at the fixed tick rate regardless of the link overruns
+//  slow (e.g. cellular) uplinks, and the queues that build up push the
+//  latency into seconds.  This controller is AIMD: it grows the budget
+//  slowly while the probes come back quickly, and cuts it sharply when
+//  they are lost or when the round trip grows above its minimum (which
+//  means a queue is forming).  The budget caps the obstacles a peer owns
+//  and the optional events it sends; events the game needs always go.
+//
+//  Author: Networked Physics Lab contributors
+//  Version: 10/18/26
+//
+#include "NLCongestion.h"
+#include <algorithm>
+
+using namespace cugl;
+
+/** The loss rate above which the link is congested */
+#define LOSS_THRESHOLD  0.1f
+/** The number of periods in a minimum round trip window */
+#define MIN_RTT_WINDOW  10
+/** The weight of a new round trip sample in the smoothed value */
+#define RTT_GAIN        0.25f
+/** The shortest time before an unanswered probe is lost */
+#define PROBE_TIMEOUT   1000000
+
+#pragma mark Constructors
+/**
+ * Initializes the controller.
+ *
+ * @param budget    The initial budget, in bytes per second
+ * @param minBudget The smallest budget
+ * @param maxBudget The largest budget
+ * @param increase  The budget added each period without congestion
+ * @param decrease  The factor the budget is multiplied by on congestion
+ * @param target    The queue delay above which the link is congested
+ */
+void CongestionController::init(float budget, float minBudget, float maxBudget,
+                                float increase, float decrease, Uint64 target) {
+    _minBudget = minBudget;
+    _maxBudget = std::max(minBudget, maxBudget);
+    _budget = std::clamp(budget, _minBudget, _maxBudget);
+    _increase = increase;
+    _decrease = decrease;
+    _target = target;
+    clear();
+}
+
+/**
+ * Forgets all probes and round trip times, keeping the budget.
+ */
+void CongestionController::clear() {
+    _srtt = 0;
+    _lastMin = 0;
+    _windowMin = 0;
+    _periods = 0;
+    _lastUpdate = 0;
+    _probes.clear();
+    _acked = 0;
+    _lost = 0;
+    _loss = 0;
+}
+
+#pragma mark Measurement
+/**
+ * Records that a probe was answered.
+ *
+ * Answers to unknown (or already lost) probes are ignored.
+ *
+ * @param seq   The sequence number of the probe
+ * @param now   The current time
+ */
+void CongestionController::acknowledge(Uint32 seq, Uint64 now) {
+    auto it = _probes.find(seq);
+    if (it == _probes.end()) {
+        return;
+    }
+    Uint64 rtt = now-it->second;
+    _probes.erase(it);
+    _acked++;
+    _srtt = _srtt == 0 ? rtt : (1-RTT_GAIN)*_srtt+RTT_GAIN*rtt;
+    _windowMin = _windowMin == 0 ? rtt : std::min(_windowMin, rtt);
+}
+
+/**
+ * Adapts the budget to the measurements since the last update.
+ *
+ * Probes unanswered for a second (or four round trips) are lost. The
+ * budget only grows if the sender used at least half of it, so that an
+ * idle link does not build up a budget it never tested.
+ *
+ * @param now   The current time
+ * @param used  The bytes sent since the last update
+ */
+void CongestionController::update(Uint64 now, Uint64 used) {
+    if (_lastUpdate == 0 || now <= _lastUpdate) {
+        _lastUpdate = now;
+        return;
+    }
+    
+    Uint64 timeout = std::max((Uint64)PROBE_TIMEOUT, (Uint64)(4*_srtt));
+    for(auto it = _probes.begin(); it != _probes.end(); ) {
+        if (now-it->second > timeout) {
+            _lost++;
+            it = _probes.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    Uint32 total = _acked+_lost;
+    _loss = total > 0 ? (float)_lost/total : 0;
+    
+    float seconds = (now-_lastUpdate)/1000000.0f;
+    if (_loss > LOSS_THRESHOLD || getQueueDelay() > _target) {
+        _budget = std::max(_minBudget, _budget*_decrease);
+    } else if (used >= 0.5f*_budget*seconds) {
+        _budget = std::min(_maxBudget, _budget+_increase*seconds);
+    }
+    
+    // The minimum is kept over two windows, so that a route change is noticed
+    if (++_periods >= MIN_RTT_WINDOW) {
+        _lastMin = _windowMin;
+        _windowMin = 0;
+        _periods = 0;
+    }
+    _acked = 0;
+    _lost = 0;
+    _lastUpdate = now;
+}
+
+#pragma mark Attributes
+/**
+ * Returns the current queue delay estimate.
+ *
+ * @return the current queue delay estimate.
+ */
+Uint64 CongestionController::getQueueDelay() const {
+    Uint64 base = _lastMin;
+    if (base == 0 || (_windowMin != 0 && _windowMin < base)) {
+        base = _windowMin;
+    }
+    if (base == 0 || _srtt <= base) {
+        return 0;
+    }
+    return (Uint64)_srtt-base;
+}
@@ -0,0 +1,150 @@
+//
+//  NLCongestion.h
+//  Networked Physics Demo
+//
+//  This class adapts the state update budget of a link to its conditions.
+//  Sending state at the fixed tick rate regardless of the link overruns
+//  slow (e.g. cellular) uplinks, and the queues that build up push the
+//  latency into seconds.  This controller is AIMD: it grows the budget
+//  slowly while the probes come back quickly, and cuts it sharply when
+//  they are lost or when the round trip grows above its minimum (which
+//  means a queue is forming).  The budget caps the obstacles a peer owns
+//  and the optional events it sends; events the game needs always go.
+//
+//  Author: Networked Physics Lab contributors
+//  Version: 10/18/26
+//
+#ifndef __NL_CONGESTION_H__
+#define __NL_CONGESTION_H__
+#include <cugl/cugl.h>
+#include <map>
+
+/**
+ * This class is an AIMD congestion controller for a single link.
+ *
+ * The caller reports every probe sent and acknowledged, and calls
+ * {@link #update} once per period with the bytes sent in it. The
+ * queue delay is the smoothed round trip time minus the minimum over the
+ * last two windows. All times are in microseconds.
+ */
+class CongestionController {
+protected:
+    /** The current budget, in bytes per second */
+    float _budget;
+    /** The smallest budget */
+    float _minBudget;
+    /** The largest budget */
+    float _maxBudget;
+    /** The budget added each period without congestion */
+    float _increase;
+    /** The factor the budget is multiplied by on congestion */
+    float _decrease;
+    /** The queue delay above which the link is congested */
+    Uint64 _target;
+    /** The smoothed round trip time */
+    float _srtt;
+    /** The minimum round trip time of the previous window */
+    Uint64 _lastMin;
+    /** The minimum round trip time of the current window */
+    Uint64 _windowMin;
+    /** The number of periods in the current window */
+    Uint32 _periods;
+    /** The time of the last update */
+    Uint64 _lastUpdate;
+    /** The probes waiting for an answer, by sequence number */
+    std::map<Uint32, Uint64> _probes;
+    /** The probes answered since the last update */
+    Uint32 _acked;
+    /** The probes lost since the last update */
+    Uint32 _lost;
+    /** The loss rate of the last period */
+    float _loss;
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates a controller with no budget.
+     */
+    CongestionController() : _budget(0), _minBudget(0), _maxBudget(0), _increase(0),
+    _decrease(1), _target(0), _srtt(0), _lastMin(0), _windowMin(0), _periods(0),
+    _lastUpdate(0), _acked(0), _lost(0), _loss(0) {}
+
+    /**
+     * Initializes the controller.
+     *
+     * @param budget    The initial budget, in bytes per second
+     * @param minBudget The smallest budget
+     * @param maxBudget The largest budget
+     * @param increase  The budget added each period without congestion
+     * @param decrease  The factor the budget is multiplied by on congestion
+     * @param target    The queue delay above which the link is congested
+     */
+    void init(float budget, float minBudget, float maxBudget, float increase, float decrease, Uint64 target);
+
+    /**
+     * Forgets all probes and round trip times, keeping the budget.
+     */
+    void clear();
+
+#pragma mark Measurement
+    /**
+     * Records that a probe was sent.
+     *
+     * @param seq   The sequence number of the probe
+     * @param now   The current time
+     */
+    void probe(Uint32 seq, Uint64 now) { _probes[seq] = now; }
+
+    /**
+     * Records that a probe was answered.
+     *
+     * Answers to unknown (or already lost) probes are ignored.
+     *
+     * @param seq   The sequence number of the probe
+     * @param now   The current time
+     */
+    void acknowledge(Uint32 seq, Uint64 now);
+
+    /**
+     * Adapts the budget to the measurements since the last update.
+     *
+     * Probes unanswered for a second (or four round trips) are lost. The
+     * budget only grows if the sender used at least half of it, so that an
+     * idle link does not build up a budget it never tested.
+     *
+     * @param now   The current time
+     * @param used  The bytes sent since the last update
+     */
+    void update(Uint64 now, Uint64 used);
+
+#pragma mark Attributes
+    /**
+     * Returns the current budget, in bytes per second.
+     *
+     * @return the current budget, in bytes per second.
+     */
+    float getBudget() const { return _budget; }
+
+    /**
+     * Returns the smoothed round trip time.
+     *
+     * @return the smoothed round trip time.
+     */
+    Uint64 getRoundTrip() const { return (Uint64)_srtt; }
+
+    /**
+     * Returns the current queue delay estimate.
+     *
+     * @return the current queue delay estimate.
+     */
+    Uint64 getQueueDelay() const;
+
+    /**
+     * Returns the loss rate of the last period.
+     *
+     * @return the loss rate of the last period.
+     */
+    float getLoss() const { return _loss; }
+};
+
+#endif /* __NL_CONGESTION_H__ */
@@ -0,0 +1,145 @@
+//
+//  NLCrateBatchNode.cpp
+//  Networked Physics Demo
+//
+//  This class is a scene graph node that draws many crates sharing the same
+//  texture.  Rather than having one PolygonNode per crate, the crates are
+//  stored as a packed array of transforms read directly from the physics
+//  state.  As the SpriteBatch only flushes when the texture changes, all of
+//  the crates in this node are drawn with a single draw call.
+//
+//  Author: Networked Physics Lab contributors
+//  Version: 10/18/26
+//
+#include "NLCrateBatchNode.h"
+
+using namespace cugl;
+
+#pragma mark Constructors
+/**
+ * Disposes all of the resources used by this node.
+ */
+void CrateBatchNode::dispose() {
+    clear();
+    _texture = nullptr;
+    SceneNode::dispose();
+}
+
+/**
+ * Initializes a batch node for the given texture.
+ *
+ * @param texture   The texture shared by all crates
+ * @param scale     The scale of the texture relative to each crate
+ *
+ * @return true if initialization was successful.
+ */
+bool CrateBatchNode::initWithTexture(const std::shared_ptr<Texture>& texture, float scale) {
+    if (texture == nullptr || !SceneNode::init()) {
+        return false;
+    }
+    _texture = texture;
+    _origin  = Vec2(texture->getSize())/2.0f;
+    _spriteScale = scale;
+    setAnchor(Vec2::ANCHOR_BOTTOM_LEFT);
+    return true;
+}
+
+#pragma mark Crates
+/**
+ * Adds a crate obstacle to this node.
+ *
+ * @param obj   The crate obstacle
+ */
+void CrateBatchNode::add(const std::shared_ptr<physics2::Obstacle>& obj) {
+    _obstacles.push_back(obj);
+    _transforms.push_back(Affine2::IDENTITY);
+}
+
+/**
+ * Removes a crate obstacle from this node, if it is drawn by it.
+ *
+ * Crates marked as removed are dropped on their own. This is for crates
+ * that leave play but stay in the world.
+ *
+ * @param obj   The crate obstacle
+ */
+void CrateBatchNode::remove(const std::shared_ptr<physics2::Obstacle>& obj) {
+    for(size_t ii = 0; ii < _obstacles.size(); ii++) {
+        if (_obstacles[ii] == obj) {
+            // Swap remove to keep the arrays packed
+            _obstacles[ii] = std::move(_obstacles.back());
+            _transforms[ii] = _transforms.back();
+            _obstacles.pop_back();
+            _transforms.pop_back();
+            return;
+        }
+    }
+}
+
+/**
+ * Removes all crates from this node.
+ */
+void CrateBatchNode::clear() {
+    _obstacles.clear();
+    _transforms.clear();
+}
+
+#pragma mark Rendering
+/**
+ * Packs the transforms of all crates from their physics state.
+ *
+ * This method should be called once per frame, after the physics step.
+ *
+ * @param leftover  The time (in seconds) since the last physics step
+ * @param scale     The drawing scale of the physics world
+ */
+void CrateBatchNode::update(float leftover, float scale) {
+    size_t ii = 0;
+    while (ii < _obstacles.size()) {
+        physics2::Obstacle* obs = _obstacles[ii].get();
+        if (obs->isRemoved()) {
+            // Swap remove to keep the arrays packed
+            _obstacles[ii] = std::move(_obstacles.back());
+            _transforms[ii] = _transforms.back();
+            _obstacles.pop_back();
+            _transforms.pop_back();
+            continue;
+        }
+
+        Vec2 pos;
+        float angle;
+        if (_snapshots == nullptr || !_snapshots->sample(obs, pos, angle)) {
+            pos = obs->getPosition() + leftover * obs->getLinearVelocity();
+            angle = obs->getAngle() + leftover * obs->getAngularVelocity();
+        }
+        float c = cosf(angle) * _spriteScale;
+        float s = sinf(angle) * _spriteScale;
+
+        Affine2& xform = _transforms[ii];
+        xform.m[0] = c;  xform.m[1] = s;
+        xform.m[2] = -s; xform.m[3] = c;
+        xform.offset = pos * scale;
+        ii++;
+    }
+}
+
+/**
+ * Draws all of the crates in this node.
+ *
+ * @param batch     The SpriteBatch to draw with.
+ * @param transform The global transformation matrix.
+ * @param tint      The tint to blend with the crate colors.
+ */
+void CrateBatchNode::draw(const std::shared_ptr<SpriteBatch>& batch,
+                          const Affine2& transform, Color4 tint) {
+    if (_obstacles.empty()) {
+        return;
+    }
+
+    // The batch only flushes on a texture change, so this is one draw call
+    Affine2 world;
+    for(auto it = _transforms.begin(); it != _transforms.end(); ++it) {
+        Affine2::multiply(*it, transform, &world);
+        batch->draw(_texture, tint, _origin, world);
+    }
+}
@@ -0,0 +1,206 @@
+//
+//  NLCrateBatchNode.h
+//  Networked Physics Demo
+//
+//  This class is a scene graph node that draws many crates sharing the same
+//  texture.  Rather than having one PolygonNode per crate, the crates are
+//  stored as a packed array of transforms read directly from the physics
+//  state.  As the SpriteBatch only flushes when the texture changes, all of
+//  the crates in this node are drawn with a single draw call.
+//
+//  Author: Networked Physics Lab contributors
+//  Version: 10/18/26
+//
+#ifndef __NL_CRATE_BATCH_NODE_H__
+#define __NL_CRATE_BATCH_NODE_H__
+#include <cugl/cugl.h>
+#include <vector>
+#include "NLSnapshotBuffer.h"
+
+/**
+ * This class draws all crates of a single texture in one batch.
+ *
+ * Crates are bound to this node by their obstacle.  Each frame, the method
+ * {@link #update} reads the physics state of every bound obstacle and packs
+ * it into an array of affine transforms.  The method {@link #draw} then
+ * submits one textured quad per transform.  There are no child nodes, so the
+ * scene graph traversal cost is constant regardless of the number of crates.
+ *
+ * Obstacles that have been marked as removed are dropped from this node
+ * during the next update.
+ */
+class CrateBatchNode : public cugl::scene2::SceneNode {
+protected:
+    /** The texture shared by all crates in this node */
+    std::shared_ptr<cugl::Texture> _texture;
+    /** The texture origin (so that crates are anchored at their center) */
+    cugl::Vec2 _origin;
+    /** The scale of the texture relative to the crate obstacle */
+    float _spriteScale;
+    /** The bound obstacles */
+    std::vector<std::shared_ptr<cugl::physics2::Obstacle>> _obstacles;
+    /** The packed transforms, parallel to _obstacles */
+    std::vector<cugl::Affine2> _transforms;
+    /** The interpolated poses of remote obstacles (nullptr to use the physics pose) */
+    const SnapshotBuffer* _snapshots;
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates an uninitialized node.
+     *
+     * You must initialize this node before use.
+     */
+    CrateBatchNode() : cugl::scene2::SceneNode(), _spriteScale(1.0f), _snapshots(nullptr) {}
+
+    /**
+     * Disposes all of the resources used by this node.
+     */
+    ~CrateBatchNode() { dispose(); }
+
+    /**
+     * Disposes all of the resources used by this node.
+     */
+    void dispose() override;
+
+    /**
+     * Initializes a batch node for the given texture.
+     *
+     * @param texture   The texture shared by all crates
+     * @param scale     The scale of the texture relative to each crate
+     *
+     * @return true if initialization was successful.
+     */
+    bool initWithTexture(const std::shared_ptr<cugl::Texture>& texture, float scale);
+
+    /**
+     * Returns a newly allocated batch node for the given texture.
+     *
+     * @param texture   The texture shared by all crates
+     * @param scale     The scale of the texture relative to each crate
+     *
+     * @return a newly allocated batch node for the given texture.
+     */
+    static std::shared_ptr<CrateBatchNode> allocWithTexture(const std::shared_ptr<cugl::Texture>& texture,
+                                                            float scale) {
+        std::shared_ptr<CrateBatchNode> node = std::make_shared<CrateBatchNode>();
+        return (node->initWithTexture(texture,scale) ? node : nullptr);
+    }
+
+#pragma mark Crates
+    /**
+     * Adds a crate obstacle to this node.
+     *
+     * @param obj   The crate obstacle
+     */
+    void add(const std::shared_ptr<cugl::physics2::Obstacle>& obj);
+
+    /**
+     * Removes a crate obstacle from this node, if it is drawn by it.
+     *
+     * Crates marked as removed are dropped on their own. This is for crates
+     * that leave play but stay in the world.
+     *
+     * @param obj   The crate obstacle
+     */
+    void remove(const std::shared_ptr<cugl::physics2::Obstacle>& obj);
+
+    /**
+     * Removes all crates from this node.
+     */
+    void clear();
+
+    /**
+     * Returns the number of crates drawn by this node.
+     *
+     * @return the number of crates drawn by this node.
+     */
+    size_t size() const { return _obstacles.size(); }
+
+    /**
+     * Returns the texture shared by all crates in this node.
+     *
+     * @return the texture shared by all crates in this node.
+     */
+    const std::shared_ptr<cugl::Texture>& getTexture() const { return _texture; }
+
+    /**
+     * Sets the snapshot buffer used to draw remote crates.
+     *
+     * Crates with buffered states are drawn at their interpolated pose
+     * instead of the extrapolated physics pose. Passing nullptr restores the
+     * default behavior.
+     *
+     * @param snapshots The snapshot buffer (or nullptr)
+     */
+    void setSnapshots(const SnapshotBuffer* snapshots) { _snapshots = snapshots; }
+
+#pragma mark Rendering
+    /**
+     * Packs the transforms of all crates from their physics state.
+     *
+     * This method should be called once per frame, after the physics step.
+     *
+     * @param leftover  The time (in seconds) since the last physics step
+     * @param scale     The drawing scale of the physics world
+     */
+    void update(float leftover, float scale);
+
+    /**
+     * Draws all of the crates in this node.
+     *
+     * @param batch     The SpriteBatch to draw with.
+     * @param transform The global transformation matrix.
+     * @param tint      The tint to blend with the crate colors.
+     */
+    void draw(const std::shared_ptr<cugl::SpriteBatch>& batch,
+              const cugl::Affine2& transform, cugl::Color4 tint) override;
+};
+
+/**
+ * This class is the scene graph node of a crate drawn by a batch node.
+ *
+ * The proxy draws nothing.  It records the crate type, which is the index
+ * of the batch node that draws the crate, so that the crate factory can
+ * hand the crate to its batch without relying on node names.
+ */
+class CrateProxyNode : public cugl::scene2::SceneNode {
+protected:
+    /** The crate type (1 for the first batch node) */
+    int _type;
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates an uninitialized proxy.
+     *
+     * You must initialize this node before use.
+     */
+    CrateProxyNode() : cugl::scene2::SceneNode(), _type(0) {}
+
+    /**
+     * Returns a newly allocated proxy for a crate of the given type.
+     *
+     * @param type  The crate type (1 for the first batch node)
+     *
+     * @return a newly allocated proxy for a crate of the given type.
+     */
+    static std::shared_ptr<CrateProxyNode> alloc(int type) {
+        std::shared_ptr<CrateProxyNode> node = std::make_shared<CrateProxyNode>();
+        if (!node->init()) {
+            return nullptr;
+        }
+        node->_type = type;
+        return node;
+    }
+
+#pragma mark Attributes
+    /**
+     * Returns the crate type (1 for the first batch node).
+     *
+     * @return the crate type (1 for the first batch node).
+     */
+    int getType() const { return _type; }
+};
+
+#endif /* __NL_CRATE_BATCH_NODE_H__ */
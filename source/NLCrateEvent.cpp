@@ -25,10 +25,27 @@ std::shared_ptr<NetEvent> CrateEvent::allocCrateEvent(Vec2 pos){
 #pragma mark BEGIN SOLUTION
     auto event = std::make_shared<CrateEvent>();
     event->_pos = pos;
+    event->_key = 0;
     return event;
 #pragma mark END SOLUTION
 }
 
+/**
+ * Returns a new crate event for the crate with the given spawn key.
+ *
+ * The key determines the obstacle id of the crate, so that every peer
+ * assigns the same id no matter the order the events arrive in.
+ *
+ * @param pos   The crate position
+ * @param key   The spawn key of the crate
+ */
+std::shared_ptr<NetEvent> CrateEvent::allocCrateEvent(Vec2 pos, Uint32 key){
+    auto event = std::make_shared<CrateEvent>();
+    event->_pos = pos;
+    event->_key = key;
+    return event;
+}
+
 /**
  * Serialize any paramater that the event contains to a vector of bytes.
  */
@@ -36,8 +53,10 @@ std::vector<std::byte> CrateEvent::serialize(){
     //TODO: serialize _pos
 #pragma mark BEGIN SOLUTION
     _serializer.reset();
+    writeStamp(_serializer);
     _serializer.writeFloat(_pos.x);
     _serializer.writeFloat(_pos.y);
+    _serializer.writeUint32(_key);
     return _serializer.serialize();
 #pragma mark END SOLUTION
 }
@@ -57,8 +76,10 @@ void CrateEvent::deserialize(const std::vector<std::byte>& data){
 #pragma mark BEGIN SOLUTION
     _deserializer.reset();
     _deserializer.receive(data);
+    readStamp(_deserializer);
     float x = _deserializer.readFloat();
     float y = _deserializer.readFloat();
     _pos = Vec2(x,y);
+    _key = _deserializer.readUint32();
 #pragma mark END SOLUTION
 }
@@ -11,17 +11,19 @@
 #define NLCrateEvent_h
 
 #include <cugl/cugl.h>
+#include "NLTickedEvent.h"
 using namespace cugl::netphysics;
 using namespace cugl;
 
-class CrateEvent : public NetEvent {
+class CrateEvent : public TickedEvent {
     
 protected:
     LWSerializer _serializer;
     LWDeserializer _deserializer;
     
     Vec2 _pos;
-    
+    /** The spawn key of the crate (see ObstacleIds) */
+    Uint32 _key;
     
 public:
     /**
@@ -35,6 +37,17 @@ public:
     
     static std::shared_ptr<NetEvent> allocCrateEvent(Vec2 pos);
     
+    /**
+     * Returns a new crate event for the crate with the given spawn key.
+     *
+     * The key determines the obstacle id of the crate, so that every peer
+     * assigns the same id no matter the order the events arrive in.
+     *
+     * @param pos   The crate position
+     * @param key   The spawn key of the crate
+     */
+    static std::shared_ptr<NetEvent> allocCrateEvent(Vec2 pos, Uint32 key);
+    
     /**
      * Serialize any paramater that the event contains to a vector of bytes.
      */
@@ -52,6 +65,9 @@ public:
     
     /** Gets the position of the event. */
     Vec2 getPos() { return _pos; }
+    
+    /** Gets the spawn key of the crate. */
+    Uint32 getKey() { return _key; }
 };
 
 
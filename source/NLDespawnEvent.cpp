@@ -0,0 +1,63 @@
+//
+//  NLDespawnEvent.cpp
+//  Networked Physics Lab
+//
+//  This class represents an event of despawning a group of fired crates.
+//  All crates are identified by their spawn key, so a single event can
+//  remove any number of crates on every peer at its execute tick.
+//
+//  Created by the Networked Physics Lab contributors on 10/18/26.
+//
+
+#include "NLDespawnEvent.h"
+
+/**
+ * This method is used by the NetEventController to create a new event of using a
+ * reference of the same type.
+ *
+ * Not that this method is not static, it differs from the static alloc() method
+ * and all methods must implement this method.
+ */
+std::shared_ptr<NetEvent> DespawnEvent::newEvent(){
+    return std::make_shared<DespawnEvent>();
+}
+
+std::shared_ptr<NetEvent> DespawnEvent::allocDespawnEvent(const std::vector<Uint32>& keys){
+    auto event = std::make_shared<DespawnEvent>();
+    event->_keys = keys;
+    return event;
+}
+
+/**
+ * Serialize any paramater that the event contains to a vector of bytes.
+ */
+std::vector<std::byte> DespawnEvent::serialize(){
+    _serializer.reset();
+    writeStamp(_serializer);
+    _serializer.writeUint32((Uint32)_keys.size());
+    for(Uint32 key : _keys){
+        _serializer.writeUint32(key);
+    }
+    return _serializer.serialize();
+}
+
+/**
+ * Deserialize a vector of bytes and set the corresponding parameters.
+ *
+ * @param data  a byte vector packed by serialize()
+ *
+ * This function should be the "reverse" of the serialize() function: it
+ * should be able to recreate a serialized event entirely, setting all the
+ * useful parameters of this class.
+ */
+void DespawnEvent::deserialize(const std::vector<std::byte>& data){
+    _deserializer.reset();
+    _deserializer.receive(data);
+    readStamp(_deserializer);
+    Uint32 count = _deserializer.readUint32();
+    _keys.clear();
+    _keys.reserve(count);
+    for(Uint32 ii = 0; ii < count; ii++){
+        _keys.push_back(_deserializer.readUint32());
+    }
+}
@@ -0,0 +1,62 @@
+//
+//  NLDespawnEvent.h
+//  Networked Physics Lab
+//
+//  This class represents an event of despawning a group of fired crates.
+//  All crates are identified by their spawn key, so a single event can
+//  remove any number of crates on every peer at its execute tick.
+//
+//  Created by the Networked Physics Lab contributors on 10/18/26.
+//
+
+#ifndef NLDespawnEvent_h
+#define NLDespawnEvent_h
+
+#include <cugl/cugl.h>
+#include <vector>
+#include "NLTickedEvent.h"
+using namespace cugl::netphysics;
+using namespace cugl;
+
+class DespawnEvent : public TickedEvent {
+    
+protected:
+    LWSerializer _serializer;
+    LWDeserializer _deserializer;
+    
+    /** The spawn keys of the crates to remove */
+    std::vector<Uint32> _keys;
+    
+public:
+    /**
+     * This method is used by the NetEventController to create a new event of using a
+     * reference of the same type.
+     *
+     * Not that this method is not static, it differs from the static alloc() method
+     * and all methods must implement this method.
+     */
+    std::shared_ptr<NetEvent> newEvent() override;
+    
+    static std::shared_ptr<NetEvent> allocDespawnEvent(const std::vector<Uint32>& keys);
+    
+    /**
+     * Serialize any paramater that the event contains to a vector of bytes.
+     */
+    std::vector<std::byte> serialize() override;
+    /**
+     * Deserialize a vector of bytes and set the corresponding parameters.
+     *
+     * @param data  a byte vector packed by serialize()
+     *
+     * This function should be the "reverse" of the serialize() function: it
+     * should be able to recreate a serialized event entirely, setting all the
+     * useful parameters of this class.
+     */
+    void deserialize(const std::vector<std::byte>& data) override;
+    
+    /** Gets the spawn keys of the crates to remove. */
+    const std::vector<Uint32>& getKeys() const { return _keys; }
+};
+
+
+#endif /* NLDespawnEvent_h */
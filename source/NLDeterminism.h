@@ -0,0 +1,77 @@
+//
+//  NLDeterminism.h
+//  Networked Physics Demo
+//
+//  This header describes the floating point policy that lock-step
+//  simulation depends on, and defines the NL_FP_* macros that say whether
+//  this build follows it.  It never fails the build itself, as the state
+//  synchronized mode does not need the policy; the game scene turns the
+//  macros into hard errors only when LOCKSTEP_MODE is set.  In lock-step,
+//  peers only exchange inputs, and every peer steps its own copy of the
+//  world.  The worlds only stay identical if every float operation rounds
+//  the same way on every peer.  The policy is:
+//
+//  1. Floats are IEEE 754 single precision, evaluated at their own
+//     precision (no x87 extended intermediates).  NL_FP_NATIVE_EVAL is
+//     0 if the compiler does not promise this (FLT_EVAL_METHOD -1).
+//  2. No value-changing optimizations: no -ffast-math, -Ofast or
+//     /fp:fast.  NL_FP_FAST_MATH flags the GCC and Clang variants and
+//     MSVC /fp:fast.  MSVC must use /fp:precise or /fp:strict.
+//  3. No contraction of a*b+c into a fused multiply-add, which rounds
+//     once instead of twice.  The compiler does not say whether it
+//     contracts, so NL_FP_NO_CONTRACTION is only set on targets without a
+//     fused multiply-add (x86 without FMA), or if the build defines
+//     NL_FP_CONTRACT_OFF.  A build that defines it must compile CUGL
+//     (and so Box2D) and the game with -ffp-contract=off (or
+//     /fp:precise without /fp:contract).
+//  4. No library transcendentals (sin, cos, atan2, sqrt is fine) in code
+//     whose results reach the simulation on another peer.  Their results
+//     differ between C libraries.  A peer that needs one computes it
+//     locally and sends the result in its input bundle.
+//  5. Every peer applies the inputs of a tick in the same order, and adds
+//     obstacles to the world in the same order.
+//
+//  Box2D itself calls sinf and cosf when rotating bodies, so lock-step is
+//  only deterministic between builds for the same platform and C library.
+//  Mixed platforms must use the state synchronized mode.
+//
+//  Author: Networked Physics Lab contributors
+//  Version: 10/18/26
+//
+#ifndef __NL_DETERMINISM_H__
+#define __NL_DETERMINISM_H__
+#include <cfloat>
+
+/** Whether value-changing float optimizations (-ffast-math or /fp:fast) are on */
+#if defined(__FAST_MATH__) || (defined(_MSC_VER) && defined(_M_FP_FAST))
+#define NL_FP_FAST_MATH 1
+#else
+#define NL_FP_FAST_MATH 0
+#endif
+
+/** Whether floats are evaluated at their own precision */
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+#define NL_FP_NATIVE_EVAL 1
+#else
+#define NL_FP_NATIVE_EVAL 0
+#endif
+
+/** Whether a*b+c can never be contracted into a fused multiply-add */
+#if defined(NL_FP_CONTRACT_OFF)
+#define NL_FP_NO_CONTRACTION 1
+#elif (defined(__x86_64__) || defined(__i386__)) && !defined(__FMA__)
+#define NL_FP_NO_CONTRACTION 1
+#elif (defined(_M_X64) || defined(_M_IX86)) && !defined(__AVX2__)
+#define NL_FP_NO_CONTRACTION 1
+#else
+#define NL_FP_NO_CONTRACTION 0
+#endif
+
+/** Whether every float operation rounds the same way on every peer of this platform */
+#if NL_FP_NATIVE_EVAL && NL_FP_NO_CONTRACTION && !NL_FP_FAST_MATH
+#define NL_FP_DETERMINISTIC 1
+#else
+#define NL_FP_DETERMINISTIC 0
+#endif
+
+#endif /* __NL_DETERMINISM_H__ */
@@ -0,0 +1,57 @@
+//
+//  NLDropEvent.cpp
+//  Networked Physics Lab
+//
+//  This class announces that a peer leaves the lock-step simulation.  Only
+//  the host decides to drop a stalled peer, and every peer (the host
+//  included) drops it from the same tick, so that the peers keep stepping
+//  the same inputs.
+//
+//  Created by the Networked Physics Lab contributors on 10/18/26.
+//
+
+#include "NLDropEvent.h"
+
+/**
+ * This method is used by the NetEventController to create a new event of using a
+ * reference of the same type.
+ *
+ * Not that this method is not static, it differs from the static alloc() method
+ * and all methods must implement this method.
+ */
+std::shared_ptr<NetEvent> DropEvent::newEvent(){
+    return std::make_shared<DropEvent>();
+}
+
+std::shared_ptr<NetEvent> DropEvent::allocDropEvent(Uint32 peer, Uint64 tick){
+    auto event = std::make_shared<DropEvent>();
+    event->_peer = peer;
+    event->_tick = tick;
+    return event;
+}
+
+/**
+ * Serialize any paramater that the event contains to a vector of bytes.
+ */
+std::vector<std::byte> DropEvent::serialize(){
+    _serializer.reset();
+    _serializer.writeUint32(_peer);
+    _serializer.writeUint64(_tick);
+    return _serializer.serialize();
+}
+
+/**
+ * Deserialize a vector of bytes and set the corresponding parameters.
+ *
+ * @param data  a byte vector packed by serialize()
+ *
+ * This function should be the "reverse" of the serialize() function: it
+ * should be able to recreate a serialized event entirely, setting all the
+ * useful parameters of this class.
+ */
+void DropEvent::deserialize(const std::vector<std::byte>& data){
+    _deserializer.reset();
+    _deserializer.receive(data);
+    _peer = _deserializer.readUint32();
+    _tick = _deserializer.readUint64();
+}
@@ -0,0 +1,66 @@
+//
+//  NLDropEvent.h
+//  Networked Physics Lab
+//
+//  This class announces that a peer leaves the lock-step simulation.  Only
+//  the host decides to drop a stalled peer, and every peer (the host
+//  included) drops it from the same tick, so that the peers keep stepping
+//  the same inputs.
+//
+//  Created by the Networked Physics Lab contributors on 10/18/26.
+//
+
+#ifndef NLDropEvent_h
+#define NLDropEvent_h
+
+#include <cugl/cugl.h>
+using namespace cugl::netphysics;
+using namespace cugl;
+
+class DropEvent : public NetEvent {
+    
+protected:
+    LWSerializer _serializer;
+    LWDeserializer _deserializer;
+    
+    /** The short UID of the dropped peer */
+    Uint32 _peer;
+    /** The first tick stepped without the dropped peer */
+    Uint64 _tick;
+    
+public:
+    /**
+     * This method is used by the NetEventController to create a new event of using a
+     * reference of the same type.
+     *
+     * Not that this method is not static, it differs from the static alloc() method
+     * and all methods must implement this method.
+     */
+    std::shared_ptr<NetEvent> newEvent() override;
+    
+    static std::shared_ptr<NetEvent> allocDropEvent(Uint32 peer, Uint64 tick);
+    
+    /**
+     * Serialize any paramater that the event contains to a vector of bytes.
+     */
+    std::vector<std::byte> serialize() override;
+    /**
+     * Deserialize a vector of bytes and set the corresponding parameters.
+     *
+     * @param data  a byte vector packed by serialize()
+     *
+     * This function should be the "reverse" of the serialize() function: it
+     * should be able to recreate a serialized event entirely, setting all the
+     * useful parameters of this class.
+     */
+    void deserialize(const std::vector<std::byte>& data) override;
+    
+    /** Gets the short UID of the dropped peer. */
+    Uint32 getPeer() const { return _peer; }
+    
+    /** Gets the first tick stepped without the dropped peer. */
+    Uint64 getTick() const { return _tick; }
+};
+
+
+#endif /* NLDropEvent_h */
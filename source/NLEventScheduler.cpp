@@ -0,0 +1,177 @@
+//
+//  NLEventScheduler.cpp
+//  Networked Physics Demo
+//
+//  This class holds received ticked events until their execute tick.
+//  Events are delivered by the network whenever they arrive, which differs
+//  from peer to peer.  The scheduler releases every event at the tick it
+//  was stamped with, in the same order on every peer.  Events that arrive
+//  after their tick has passed are late; they are counted and either
+//  rejected or handed to a late handler (such as a rollback).
+//
+//  Events sent by this peer may also be echoed locally as soon as they are
+//  sent.  The echo is only a preview: when the event itself is released
+//  (or rejected), a reconcile handler replaces the preview with the result
+//  every peer agrees on.
+//
+//  Author: Networked Physics Lab contributors
+//  Version: 10/18/26
+//
+#include "NLEventScheduler.h"
+#include "NLStats.h"
+#include <algorithm>
+
+using namespace cugl;
+
+/**
+ * Returns true if the first event is applied after the second one.
+ *
+ * This makes the standard heap a min-heap on the event order.
+ */
+static bool later(const std::shared_ptr<TickedEvent>& a, const std::shared_ptr<TickedEvent>& b) {
+    return b->precedes(*a);
+}
+
+#pragma mark Constructors
+/**
+ * Initializes an empty scheduler.
+ *
+ * @param peer  The short UID of this peer
+ * @param delay The default number of ticks before an event is applied
+ */
+void EventScheduler::init(Uint32 peer, Uint32 delay) {
+    _peer = peer;
+    _delay = delay;
+    _seq = 0;
+    _queue.clear();
+    _echoes.clear();
+}
+
+#pragma mark Internal Helpers
+/**
+ * Confirms the echoed event with the same stamp, if any.
+ *
+ * The reconcile handler is called before the event is applied.
+ *
+ * @param event The received event
+ * @param now   The current tick
+ */
+void EventScheduler::confirm(const std::shared_ptr<TickedEvent>& event, Uint64 now) {
+    if (event->getSender() != _peer) {
+        return;
+    }
+    auto it = _echoes.find(event->getSequence());
+    if (it == _echoes.end()) {
+        return;
+    }
+    Echo echo = it->second;
+    _echoes.erase(it);
+    if (_stats) {
+        _stats->count("echo.confirmed");
+        _stats->sample("echo.shown_ticks", (float)(now-echo.echoed));
+        if (echo.reordered) {
+            _stats->count("echo.reordered");
+        }
+    }
+    if (_reconcileHandler) {
+        _reconcileHandler(echo.event, echo.echoed, now);
+    }
+}
+
+#pragma mark Scheduling
+/**
+ * Stamps an outgoing event with the given delay.
+ *
+ * @param event The event to send
+ * @param tick  The current tick
+ * @param delay The number of ticks before the event is applied
+ */
+void EventScheduler::stamp(const std::shared_ptr<TickedEvent>& event, Uint64 tick, Uint32 delay) {
+    event->stamp(tick, delay, _peer, _seq++);
+}
+
+/**
+ * Records that a stamped outgoing event was echoed locally.
+ *
+ * The event is still applied when it comes back from the network. When
+ * it is released (or rejected as late), the reconcile handler is called
+ * first, so that the echo can be undone.
+ *
+ * @param event The stamped event sent by this peer
+ * @param now   The current tick
+ */
+void EventScheduler::echo(const std::shared_ptr<TickedEvent>& event, Uint64 now) {
+    Echo echo;
+    echo.event = event;
+    echo.echoed = now;
+    echo.reordered = false;
+    _echoes[event->getSequence()] = echo;
+    if (_stats) {
+        _stats->count("echo.shown");
+    }
+}
+
+/**
+ * Adds a received event to the schedule.
+ *
+ * If the execute tick of the event has passed, it is handed to the late
+ * handler instead. A late echoed event is confirmed first.
+ *
+ * @param event The received event
+ * @param now   The current tick
+ *
+ * @return false if the event was late and rejected
+ */
+bool EventScheduler::schedule(const std::shared_ptr<TickedEvent>& event, Uint64 now) {
+    if (event->getExecuteTick() < now) {
+        confirm(event, now);
+        if (_stats) {
+            _stats->count("events.late");
+            _stats->sample("events.late_ticks", (float)(now-event->getExecuteTick()));
+        }
+        if (_lateHandler && _lateHandler(event, now)) {
+            return true;
+        }
+        if (_stats) {
+            _stats->count("events.rejected");
+        }
+        return false;
+    }
+    
+    if (_stats) {
+        _stats->count("events.scheduled");
+        _stats->sample("events.slack_ticks", (float)(event->getExecuteTick()-now));
+    }
+    _queue.push_back(event);
+    std::push_heap(_queue.begin(), _queue.end(), later);
+    return true;
+}
+
+/**
+ * Removes and returns the events due at the given tick.
+ *
+ * The events are returned in the same order on every peer. Echoed
+ * events among them are confirmed.
+ *
+ * @param tick  The current tick
+ *
+ * @return the events due at the given tick
+ */
+std::vector<std::shared_ptr<TickedEvent>> EventScheduler::release(Uint64 tick) {
+    std::vector<std::shared_ptr<TickedEvent>> result;
+    while (!_queue.empty() && _queue.front()->getExecuteTick() <= tick) {
+        std::pop_heap(_queue.begin(), _queue.end(), later);
+        auto event = _queue.back();
+        _queue.pop_back();
+        confirm(event, tick);
+        
+        // Any echo this precedes was shown out of order
+        for(auto it = _echoes.begin(); it != _echoes.end(); ++it) {
+            if (event->precedes(*(it->second.event))) {
+                it->second.reordered = true;
+            }
+        }
+        result.push_back(event);
+    }
+    return result;
+}
@@ -0,0 +1,228 @@
+//
+//  NLEventScheduler.h
+//  Networked Physics Demo
+//
+//  This class holds received ticked events until their execute tick.
+//  Events are delivered by the network whenever they arrive, which differs
+//  from peer to peer.  The scheduler releases every event at the tick it
+//  was stamped with, in the same order on every peer.  Events that arrive
+//  after their tick has passed are late; they are counted and either
+//  rejected or handed to a late handler (such as a rollback).
+//
+//  Events sent by this peer may also be echoed locally as soon as they are
+//  sent.  The echo is only a preview: when the event itself is released
+//  (or rejected), a reconcile handler replaces the preview with the result
+//  every peer agrees on.
+//
+//  Author: Networked Physics Lab contributors
+//  Version: 10/18/26
+//
+#ifndef __NL_EVENT_SCHEDULER_H__
+#define __NL_EVENT_SCHEDULER_H__
+#include <cugl/cugl.h>
+#include <functional>
+#include <vector>
+#include <unordered_map>
+#include "NLTickedEvent.h"
+
+class NetLabStats;
+
+/**
+ * This class releases ticked events at their execute tick.
+ *
+ * The scheduler also stamps outgoing events, as it knows the input delay
+ * and the sequence number of this peer.
+ */
+class EventScheduler {
+public:
+    /**
+     * The handler of late events.
+     *
+     * The handler takes the late event and the current tick. It returns true
+     * if it handled the event, and false if the event should be rejected.
+     */
+    typedef std::function<bool(const std::shared_ptr<TickedEvent>& event, Uint64 now)> LateHandler;
+
+    /**
+     * The handler of confirmed local echoes.
+     *
+     * The handler takes the confirmed event, the tick it was echoed at,
+     * and the current tick. It must undo the echo, as the event is then
+     * applied (or rejected) like any other.
+     */
+    typedef std::function<void(const std::shared_ptr<TickedEvent>& event, Uint64 echoed, Uint64 now)> ReconcileHandler;
+
+protected:
+    /** An event of this peer that was echoed before it was confirmed */
+    struct Echo {
+        /** The echoed event */
+        std::shared_ptr<TickedEvent> event;
+        /** The tick the event was echoed at */
+        Uint64 echoed;
+        /** Whether an event that precedes it was released after it was echoed */
+        bool reordered;
+    };
+
+    /** The pending events, as a heap with the earliest event on top */
+    std::vector<std::shared_ptr<TickedEvent>> _queue;
+    /** The default number of ticks between sending an event and applying it */
+    Uint32 _delay;
+    /** The short UID of this peer */
+    Uint32 _peer;
+    /** The sequence number of the next event sent by this peer */
+    Uint32 _seq;
+    /** The handler of late events (rejected if not set) */
+    LateHandler _lateHandler;
+    /** The unconfirmed echoed events, indexed by sequence number */
+    std::unordered_map<Uint32, Echo> _echoes;
+    /** The handler of confirmed local echoes (may be empty) */
+    ReconcileHandler _reconcileHandler;
+    /** The statistics log for event timing (may be null) */
+    NetLabStats* _stats;
+
+    /**
+     * Confirms the echoed event with the same stamp, if any.
+     *
+     * The reconcile handler is called before the event is applied.
+     *
+     * @param event The received event
+     * @param now   The current tick
+     */
+    void confirm(const std::shared_ptr<TickedEvent>& event, Uint64 now);
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates an empty scheduler with no input delay.
+     */
+    EventScheduler() : _delay(0), _peer(0), _seq(0), _stats(nullptr) {}
+
+    /**
+     * Initializes an empty scheduler.
+     *
+     * @param peer  The short UID of this peer
+     * @param delay The default number of ticks before an event is applied
+     */
+    void init(Uint32 peer, Uint32 delay);
+
+    /**
+     * Discards all pending events and unconfirmed echoes.
+     */
+    void clear() {
+        _queue.clear();
+        _echoes.clear();
+    }
+
+#pragma mark Attributes
+    /**
+     * Sets the default number of ticks before an event is applied.
+     *
+     * A larger delay hides more latency, at the cost of responsiveness.
+     *
+     * @param delay The default number of ticks before an event is applied
+     */
+    void setDelay(Uint32 delay) { _delay = delay; }
+
+    /**
+     * Returns the default number of ticks before an event is applied.
+     *
+     * @return the default number of ticks before an event is applied.
+     */
+    Uint32 getDelay() const { return _delay; }
+
+    /**
+     * Sets the handler of late events.
+     *
+     * If there is no handler, late events are rejected.
+     *
+     * @param handler   The handler of late events
+     */
+    void setLateHandler(LateHandler handler) { _lateHandler = handler; }
+
+    /**
+     * Sets the handler of confirmed local echoes.
+     *
+     * @param handler   The handler of confirmed local echoes
+     */
+    void setReconcileHandler(ReconcileHandler handler) { _reconcileHandler = handler; }
+
+    /**
+     * Sets the statistics log for event timing.
+     *
+     * @param stats The statistics log (or nullptr)
+     */
+    void setStats(NetLabStats* stats) { _stats = stats; }
+
+    /**
+     * Returns the number of pending events.
+     *
+     * @return the number of pending events.
+     */
+    size_t size() const { return _queue.size(); }
+
+    /**
+     * Returns the number of echoed events not yet confirmed.
+     *
+     * @return the number of echoed events not yet confirmed.
+     */
+    size_t getUnconfirmed() const { return _echoes.size(); }
+
+#pragma mark Scheduling
+    /**
+     * Stamps an outgoing event with the default delay.
+     *
+     * @param event The event to send
+     * @param tick  The current tick
+     */
+    void stamp(const std::shared_ptr<TickedEvent>& event, Uint64 tick) {
+        stamp(event, tick, _delay);
+    }
+
+    /**
+     * Stamps an outgoing event with the given delay.
+     *
+     * @param event The event to send
+     * @param tick  The current tick
+     * @param delay The number of ticks before the event is applied
+     */
+    void stamp(const std::shared_ptr<TickedEvent>& event, Uint64 tick, Uint32 delay);
+
+    /**
+     * Records that a stamped outgoing event was echoed locally.
+     *
+     * The event is still applied when it comes back from the network. When
+     * it is released (or rejected as late), the reconcile handler is called
+     * first, so that the echo can be undone.
+     *
+     * @param event The stamped event sent by this peer
+     * @param now   The current tick
+     */
+    void echo(const std::shared_ptr<TickedEvent>& event, Uint64 now);
+
+    /**
+     * Adds a received event to the schedule.
+     *
+     * If the execute tick of the event has passed, it is handed to the late
+     * handler instead. A late echoed event is confirmed first.
+     *
+     * @param event The received event
+     * @param now   The current tick
+     *
+     * @return false if the event was late and rejected
+     */
+    bool schedule(const std::shared_ptr<TickedEvent>& event, Uint64 now);
+
+    /**
+     * Removes and returns the events due at the given tick.
+     *
+     * The events are returned in the same order on every peer. Echoed
+     * events among them are confirmed.
+     *
+     * @param tick  The current tick
+     *
+     * @return the events due at the given tick
+     */
+    std::vector<std::shared_ptr<TickedEvent>> release(Uint64 tick);
+};
+
+#endif /* __NL_EVENT_SCHEDULER_H__ */
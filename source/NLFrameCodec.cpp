@@ -0,0 +1,317 @@
+//
+//  NLFrameCodec.cpp
+//  Networked Physics Demo
+//
+//  This class compresses outgoing frames of obstacle state.  Such frames
+//  are very redundant: the ids are close together, resting obstacles have
+//  the same zeroed velocities, and most obstacles barely move between
+//  frames.  The codec is a byte-oriented LZ77 (in the style of LZ4) whose
+//  window starts with a preset dictionary shared by every peer, so that
+//  even a small frame can refer to typical records.  A frame is only sent
+//  compressed if that makes it smaller, which the first byte flags.
+//
+//  The game only uses the codec as a measurement harness.  The physics
+//  controller sends its own state updates, so no frame is ever sent
+//  encoded.  When CODEC_CORPUS is set (it is 0, so off, by default), the
+//  game encodes its own state frames to measure the codec, and reports
+//  the codec.* statistics once.
+//
+//  Author: Networked Physics Lab contributors
+//  Version: 10/18/26
+//
+#include "NLFrameCodec.h"
+#include "NLStats.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace cugl;
+
+/** The shortest match worth encoding */
+#define MIN_MATCH   4
+/** The farthest a match may refer back */
+#define MAX_OFFSET  65535
+/** The number of bits in a match table index */
+#define HASH_BITS   12
+
+#pragma mark Internal Helpers
+/**
+ * Returns the four bytes at the given address.
+ *
+ * @param src   The address to read
+ *
+ * @return the four bytes at the given address.
+ */
+static Uint32 read32(const Uint8* src) {
+    Uint32 result;
+    std::memcpy(&result, src, sizeof(Uint32));
+    return result;
+}
+
+/**
+ * Returns the match table index of four bytes.
+ *
+ * @param value The four bytes
+ *
+ * @return the match table index of four bytes.
+ */
+static Uint32 hash32(Uint32 value) {
+    return (value*2654435761u) >> (32-HASH_BITS);
+}
+
+/**
+ * Appends a length beyond a full nibble, as a run of 255s and a remainder.
+ *
+ * @param out   The encoded frame
+ * @param value The length minus 15
+ */
+static void writeRun(std::vector<std::byte>& out, size_t value) {
+    while (value >= 255) {
+        out.push_back(std::byte(255));
+        value -= 255;
+    }
+    out.push_back(std::byte(value));
+}
+
+/**
+ * Reads a length written by {@link writeRun}, adding it to value.
+ *
+ * @param src   The encoded frame
+ * @param size  The size of the encoded frame
+ * @param pos   The read position (updated)
+ * @param value The length so far (updated)
+ *
+ * @return true if the run was complete
+ */
+static bool readRun(const Uint8* src, size_t size, size_t& pos, size_t& value) {
+    Uint8 next;
+    do {
+        if (pos >= size) {
+            return false;
+        }
+        next = src[pos++];
+        value += next;
+    } while (next == 255);
+    return true;
+}
+
+/**
+ * Appends a single sequence of literals and an (optional) match.
+ *
+ * @param out       The encoded frame
+ * @param literals  The literals
+ * @param count     The number of literals
+ * @param offset    The distance back to the match
+ * @param length    The match length (0 for the last sequence)
+ */
+static void writeSequence(std::vector<std::byte>& out, const Uint8* literals, size_t count,
+                          size_t offset, size_t length) {
+    size_t extra = length > 0 ? length-MIN_MATCH : 0;
+    Uint8 token = (Uint8)((std::min<size_t>(count,15) << 4) | std::min<size_t>(extra,15));
+    out.push_back(std::byte(token));
+    if (count >= 15) {
+        writeRun(out, count-15);
+    }
+    const std::byte* start = reinterpret_cast<const std::byte*>(literals);
+    out.insert(out.end(), start, start+count);
+    if (length == 0) {
+        return;
+    }
+    out.push_back(std::byte(offset & 0xff));
+    out.push_back(std::byte(offset >> 8));
+    if (extra >= 15) {
+        writeRun(out, extra-15);
+    }
+}
+
+#pragma mark Constructors
+/**
+ * Creates a codec with no dictionary.
+ */
+FrameCodec::FrameCodec() : _minimum(32), _stats(nullptr) {
+    _dictTable.resize(1 << HASH_BITS, 0);
+}
+
+/**
+ * Initializes the codec with the given dictionary.
+ *
+ * Only the last 64KB of the dictionary can be referenced.
+ *
+ * @param dictionary    The preset dictionary (may be empty)
+ * @param minimum       The smallest frame that is worth compressing
+ */
+void FrameCodec::init(const std::vector<std::byte>& dictionary, size_t minimum) {
+    size_t skip = dictionary.size() > MAX_OFFSET ? dictionary.size()-MAX_OFFSET : 0;
+    _dictionary.assign(dictionary.begin()+skip, dictionary.end());
+    _minimum = minimum;
+
+    // Later positions win, as they are nearer to the frame
+    _dictTable.assign(1 << HASH_BITS, 0);
+    const Uint8* src = reinterpret_cast<const Uint8*>(_dictionary.data());
+    for(size_t ii = 0; ii+MIN_MATCH <= _dictionary.size(); ii++) {
+        _dictTable[hash32(read32(src+ii))] = (Uint32)(ii+1);
+    }
+}
+
+/**
+ * Removes the dictionary from this codec.
+ */
+void FrameCodec::clear() {
+    _dictionary.clear();
+    _dictTable.assign(1 << HASH_BITS, 0);
+    _window.clear();
+}
+
+#pragma mark Coding
+/**
+ * Returns the encoded frame.
+ *
+ * The frame is compressed only if it is at least the minimum size and
+ * compression makes it smaller. Otherwise it is sent raw.
+ *
+ * @param frame The frame contents
+ *
+ * @return the encoded frame.
+ */
+std::vector<std::byte> FrameCodec::encode(const std::vector<std::byte>& frame) {
+    Timestamp start;
+    std::vector<std::byte> result;
+    if (frame.size() >= _minimum) {
+        _window.assign(_dictionary.begin(), _dictionary.end());
+        _window.insert(_window.end(), frame.begin(), frame.end());
+        _table = _dictTable;
+
+        result.reserve(frame.size()+frame.size()/255+16);
+        result.push_back(std::byte(LZ));
+        for(size_t value = frame.size(); ; value >>= 7) {
+            if (value < 0x80) {
+                result.push_back(std::byte(value));
+                break;
+            }
+            result.push_back(std::byte((value & 0x7f) | 0x80));
+        }
+
+        // Greedy parse: take the first match the table offers
+        const Uint8* src = reinterpret_cast<const Uint8*>(_window.data());
+        size_t end = _window.size();
+        size_t anchor = _dictionary.size();
+        size_t pos = anchor;
+        while (pos+MIN_MATCH <= end) {
+            Uint32 value = read32(src+pos);
+            Uint32& slot = _table[hash32(value)];
+            size_t match = slot;
+            slot = (Uint32)(pos+1);
+            if (match == 0 || pos-(match-1) > MAX_OFFSET || read32(src+match-1) != value) {
+                pos++;
+                continue;
+            }
+            match--;
+            size_t length = MIN_MATCH;
+            while (pos+length < end && src[match+length] == src[pos+length]) {
+                length++;
+            }
+            writeSequence(result, src+anchor, pos-anchor, pos-match, length);
+            pos += length;
+            anchor = pos;
+        }
+        writeSequence(result, src+anchor, end-anchor, 0, 0);
+
+        if (result.size() > frame.size()) {
+            result.clear();
+        }
+    }
+
+    bool compressed = !result.empty();
+    if (!compressed) {
+        result.reserve(frame.size()+1);
+        result.push_back(std::byte(RAW));
+        result.insert(result.end(), frame.begin(), frame.end());
+    }
+
+    if (_stats) {
+        Timestamp end;
+        _stats->count("codec.frames");
+        _stats->count("codec.raw_bytes", frame.size());
+        _stats->count("codec.sent_bytes", result.size());
+        if (compressed) {
+            _stats->count("codec.compressed");
+        }
+        if (!frame.empty()) {
+            _stats->sample("codec.ratio", (float)result.size()/frame.size());
+        }
+        _stats->sample("codec.encode_us", (float)end.ellapsedMicros(start));
+    }
+    return result;
+}
+
+/**
+ * Decodes a frame produced by {@link #encode}.
+ *
+ * @param data  The encoded frame
+ * @param frame The vector to store the frame contents
+ *
+ * @return true if the frame was well formed
+ */
+bool FrameCodec::decode(const std::vector<std::byte>& data, std::vector<std::byte>& frame) const {
+    if (data.empty()) {
+        return false;
+    }
+    const Uint8* src = reinterpret_cast<const Uint8*>(data.data());
+    size_t size = data.size();
+    if (!(src[0] & LZ)) {
+        frame.assign(data.begin()+1, data.end());
+        return true;
+    }
+
+    size_t pos = 1;
+    size_t total = 0;
+    for(int shift = 0; ; shift += 7) {
+        if (pos >= size || shift > 56) {
+            return false;
+        }
+        Uint8 next = src[pos++];
+        total |= (size_t)(next & 0x7f) << shift;
+        if (!(next & 0x80)) {
+            break;
+        }
+    }
+
+    frame.clear();
+    frame.reserve(total);
+    while (pos < size) {
+        Uint8 token = src[pos++];
+        size_t count = token >> 4;
+        if (count == 15 && !readRun(src, size, pos, count)) {
+            return false;
+        }
+        if (count > size-pos || frame.size()+count > total) {
+            return false;
+        }
+        frame.insert(frame.end(), data.begin()+pos, data.begin()+pos+count);
+        pos += count;
+        if (pos == size) {
+            break;
+        }
+
+        if (size-pos < 2) {
+            return false;
+        }
+        size_t offset = src[pos] | ((size_t)src[pos+1] << 8);
+        pos += 2;
+        size_t length = token & 15;
+        if (length == 15 && !readRun(src, size, pos, length)) {
+            return false;
+        }
+        length += MIN_MATCH;
+        if (offset == 0 || offset > frame.size()+_dictionary.size() || frame.size()+length > total) {
+            return false;
+        }
+
+        // Byte by byte, as a match may overlap the bytes it produces
+        for(size_t ii = 0; ii < length; ii++) {
+            size_t at = frame.size();
+            std::byte next = at >= offset ? frame[at-offset] : _dictionary[_dictionary.size()-(offset-at)];
+            frame.push_back(next);
+        }
+    }
+    return frame.size() == total;
+}
@@ -0,0 +1,127 @@
+//
+//  NLFrameCodec.h
+//  Networked Physics Demo
+//
+//  This class compresses outgoing frames of obstacle state.  Such frames
+//  are very redundant: the ids are close together, resting obstacles have
+//  the same zeroed velocities, and most obstacles barely move between
+//  frames.  The codec is a byte-oriented LZ77 (in the style of LZ4) whose
+//  window starts with a preset dictionary shared by every peer, so that
+//  even a small frame can refer to typical records.  A frame is only sent
+//  compressed if that makes it smaller, which the first byte flags.
+//
+//  The game only uses the codec as a measurement harness.  The physics
+//  controller sends its own state updates, so no frame is ever sent
+//  encoded.  When CODEC_CORPUS is set (it is 0, so off, by default), the
+//  game encodes its own state frames to measure the codec, and reports
+//  the codec.* statistics once.
+//
+//  Author: Networked Physics Lab contributors
+//  Version: 10/18/26
+//
+#ifndef __NL_FRAME_CODEC_H__
+#define __NL_FRAME_CODEC_H__
+#include <cugl/cugl.h>
+#include <vector>
+
+class NetLabStats;
+
+/**
+ * This class encodes and decodes frames with a preset dictionary.
+ *
+ * Every encoded frame starts with a flag byte. If its low bit is clear,
+ * the rest of the frame is the raw contents. Otherwise the rest is the
+ * length of the contents (as a varint) followed by LZ sequences. Each
+ * sequence is a token (the high nibble the number of literals and the low
+ * nibble the match length minus 4, with 15 extended by 255-runs), the
+ * literals, and then a two byte offset back into the dictionary or the
+ * frame itself.  The last sequence has no match.
+ *
+ * Every peer must use the same dictionary. The dictionary should hold a
+ * few typical frames, with the most common records at the end.
+ */
+class FrameCodec {
+public:
+    /** The flags of an encoded frame */
+    enum Flag : Uint8 {
+        /** The frame holds the raw contents */
+        RAW = 0,
+        /** The frame holds LZ sequences */
+        LZ  = 1
+    };
+
+protected:
+    /** The preset dictionary */
+    std::vector<std::byte> _dictionary;
+    /** The match table after hashing the dictionary */
+    std::vector<Uint32> _dictTable;
+    /** The match table of the current frame */
+    std::vector<Uint32> _table;
+    /** The dictionary followed by the current frame */
+    std::vector<std::byte> _window;
+    /** The smallest frame that is worth compressing */
+    size_t _minimum;
+    /** The statistics log for frame sizes and times (may be null) */
+    NetLabStats* _stats;
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates a codec with no dictionary.
+     */
+    FrameCodec();
+
+    /**
+     * Initializes the codec with the given dictionary.
+     *
+     * Only the last 64KB of the dictionary can be referenced.
+     *
+     * @param dictionary    The preset dictionary (may be empty)
+     * @param minimum       The smallest frame that is worth compressing
+     */
+    void init(const std::vector<std::byte>& dictionary, size_t minimum = 32);
+
+    /**
+     * Removes the dictionary from this codec.
+     */
+    void clear();
+
+    /**
+     * Sets the statistics log for frame sizes and times.
+     *
+     * @param stats The statistics log (or nullptr)
+     */
+    void setStats(NetLabStats* stats) { _stats = stats; }
+
+    /**
+     * Returns the preset dictionary.
+     *
+     * @return the preset dictionary.
+     */
+    const std::vector<std::byte>& getDictionary() const { return _dictionary; }
+
+#pragma mark Coding
+    /**
+     * Returns the encoded frame.
+     *
+     * The frame is compressed only if it is at least the minimum size and
+     * compression makes it smaller. Otherwise it is sent raw.
+     *
+     * @param frame The frame contents
+     *
+     * @return the encoded frame.
+     */
+    std::vector<std::byte> encode(const std::vector<std::byte>& frame);
+
+    /**
+     * Decodes a frame produced by {@link #encode}.
+     *
+     * @param data  The encoded frame
+     * @param frame The vector to store the frame contents
+     *
+     * @return true if the frame was well formed
+     */
+    bool decode(const std::vector<std::byte>& data, std::vector<std::byte>& frame) const;
+};
+
+#endif /* __NL_FRAME_CODEC_H__ */
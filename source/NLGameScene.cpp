@@ -31,6 +31,9 @@
 #include <string>
 #include <iostream>
 #include <sstream>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 using namespace cugl;
 using namespace cugl::netphysics;
@@ -54,6 +57,146 @@ using namespace cugl::netphysics;
 /** To automate the loading of crate files */
 #define NUM_CRATES 100
 
+/** Whether to sync dynamic nodes in one batch pass (instead of listeners) */
+#define BATCH_TRANSFORM_SYNC true
+/** Whether to draw factory crates with one instanced node per texture */
+#define INSTANCED_CRATES     true
+/** The number of crate textures */
+#define NUM_CRATE_TYPES      2
+/** Whether to draw remote obstacles from the snapshot buffer */
+#define REMOTE_INTERPOLATION false
+/** The number of tick states kept per remote obstacle */
+#define SNAPSHOT_CAPACITY    8
+/** How often (in ticks) owners send the state of their awake obstacles for interpolation */
+#define SNAPSHOT_INTERVAL    2
+/** The number of resident crates the crate factory keeps in the world (0 to disable pooling) */
+#define CRATE_POOL_SIZE      64
+/** How often (in ticks) to report the performance statistics */
+#define STATS_INTERVAL       600
+/** The maximum number of fired crates in the world */
+#define MAX_FIRED_CRATES     200
+/** The number of extra crates to despawn at once (so removals are batched) */
+#define DESPAWN_SLACK        16
+/** How often (in ticks) the host checks the crate population */
+#define POPULATION_INTERVAL  30
+/** How far ahead (in ticks) a despawn is scheduled, so every peer has it in time */
+#define DESPAWN_DELAY        30
+/** The number of crates in a volley */
+#define VOLLEY_SIZE          12
+/** The angle (in radians) covered by a volley */
+#define VOLLEY_SPREAD        0.8f
+/** The speed of the crates in a volley */
+#define VOLLEY_SPEED         30.0f
+/** Whether a volley is sent as one batch (instead of one message per crate) */
+#define VOLLEY_BATCHED       true
+/** Whether shared property changes are coalesced and flushed once per tick */
+#define PROPERTY_BATCHING    true
+/** The number of ticks between sending an event and applying it */
+#define INPUT_DELAY          6
+/** Whether late events are applied right away, for diagnosis (instead of rejected); late despawns are always rejected */
+#define APPLY_LATE_EVENTS    false
+/** Whether crates requested by this peer are drawn as soon as they are sent, until their event is applied */
+#define LOCAL_ECHO           false
+/** The age (in ticks) at which the host confirms a crate fired by another peer */
+#define PREDICT_ACK_AGE      2
+/** The number of ticks over which fired crates are compared across peers */
+#define DIVERGENCE_TICKS     30
+/** Whether the host sends fired crate trajectories to measure divergence */
+#define MEASURE_DIVERGENCE   true
+/** The maximum number of obstacles a peer leases at once (0 to disable migration) */
+#define AUTHORITY_BUDGET     24
+/** The number of consecutive ticks of contact before a peer acquires an obstacle */
+#define AUTHORITY_HYSTERESIS 6
+/** The number of ticks an acquired obstacle is owned before it must be renewed */
+#define AUTHORITY_LEASE      90
+/** The number of ticks before a peer may acquire an obstacle it lost again */
+#define AUTHORITY_COOLDOWN   60
+/** The extra ticks the host holds a lease, covering the delay of the grant */
+#define AUTHORITY_MARGIN     30
+/** How the init crates are assigned to peers (HOST, REGION or HASH) */
+#define OWNERSHIP_MODE       OwnershipPartition::Mode::HOST
+/** The number of ticks between peer status reports */
+#define STATUS_INTERVAL      60
+/** The number of silent ticks before a peer is considered gone */
+#define PEER_TIMEOUT         300
+/** The assumed bytes per update of an owned awake obstacle (the controller does not report its sends) */
+#define STATE_UPDATE_BYTES   40
+/** The upload a peer may use, in bytes per second */
+#define UPLINK_BUDGET        64000
+/** How state updates are spread between peers (MESH, RELAY or AUTO) */
+#define TOPOLOGY_MODE        Topology::Mode::MESH
+/** The bytes of transport header on every packet */
+#define PACKET_HEADER_BYTES  28
+/** The upload the relay may use, in bytes per second */
+#define RELAY_BUDGET         512000
+/** The number of ticks between latency probes */
+#define PROBE_INTERVAL       15
+/** Whether the state budget adapts to the measured links */
+#define CONGESTION_CONTROL   true
+/** The smallest state budget of a link, in bytes per second */
+#define MIN_STATE_BUDGET     4000
+/** The queue delay above which a link is congested, in microseconds */
+#define QUEUE_DELAY_TARGET   50000
+/** The number of recent host probes used to estimate its clock */
+#define CLOCK_SAMPLES        32
+/** The largest change to the fixed step rate when aligning ticks */
+#define MAX_DILATION         0.03
+/** The change to the fixed step rate per tick of error */
+#define DILATION_GAIN        0.01
+/** The tick error above which the tick catches up (or waits) instead of dilating */
+#define CLOCK_STEP_TICKS     30
+/** Whether fired crates are followed to the screens of the other peers */
+#define LATENCY_PROBE        false
+/** The ticks between automatic fires, for unattended probe runs (0 to disable) */
+#define LATENCY_AUTOFIRE     0
+/** The time after which an unanswered latency probe is dropped, in microseconds */
+#define LATENCY_TIMEOUT      2000000
+/** The number of state frames of this session run through the codec, to measure it (0 to disable; frames are never sent encoded) */
+#define CODEC_CORPUS         0
+/** Whether peers exchange only their inputs and each step the same world (lock-step) */
+#define LOCKSTEP_MODE        false
+/** The number of ticks between reading an input and applying it in lock-step */
+#define LOCKSTEP_DELAY       4
+/** The fixed updates the host waits for a missing input bundle before dropping its peer */
+#define LOCKSTEP_TIMEOUT     300
+/** The ticks between world hashes sent to the other peers (0 to disable) */
+#define WORLD_HASH_INTERVAL  0
+/** The quantization step of hashed positions, angles and velocities */
+#define HASH_QUANTUM         (1.0f/1024)
+/** The number of hashed ticks kept as snapshots for diagnosis */
+#define HASH_SNAPSHOTS       4
+/** The ticks between digests of the obstacle id bindings sent to the other peers (0 to disable) */
+#define IDS_DIGEST_INTERVAL  30
+/** The number of id digests kept to compare with the other peers */
+#define IDS_DIGEST_HISTORY   16
+/** Whether to record the session to the save directory, for replay */
+#define RECORD_SESSION       false
+/** The seed of every random stream */
+#define RANDOM_SEED          0xdeadbeef
+/** The random stream of the scene, shared by every peer */
+#define SCENE_STREAM         0
+/** The random stream of the first peer (streams below are shared, like the scene) */
+#define PEER_STREAM          16
+#if LOCKSTEP_DELAY > INPUT_DELAY
+#error "Lock-step peers may be LOCKSTEP_DELAY ticks apart, so ticked events need at least that delay"
+#endif
+// Lock-step needs the float policy of NLDeterminism.h; the state synchronized mode does not
+#if LOCKSTEP_MODE
+static_assert(std::numeric_limits<float>::is_iec559, "Lock-step simulation requires IEEE 754 floats");
+static_assert(std::numeric_limits<double>::is_iec559, "Lock-step simulation requires IEEE 754 doubles");
+#if NL_FP_FAST_MATH
+#error "Lock-step simulation requires precise floating point; do not build with -ffast-math or /fp:fast"
+#endif
+#if !NL_FP_NATIVE_EVAL
+#error "Lock-step simulation requires floats evaluated at their own precision (use SSE2, not x87)"
+#endif
+#if !NL_FP_NO_CONTRACTION
+#error "Lock-step peers may round floats differently; build with -ffp-contract=off and define NL_FP_CONTRACT_OFF"
+#endif
+#endif
+/** The number of crate events each peer sends per tick to stress test ids (0 to disable) */
+#define EVENT_STORM          0
+
 
 // Since these appear only once, we do not care about the magic numbers.
 // In an actual game, this information would go in a data file.
@@ -133,22 +276,23 @@ float GOAL_POS[] = { 6, 12};
 #define SOUND_THRESHOLD     3
 
 /**
- * Generate a pair of Obstacle and SceneNode using the given parameters
+ * Allocates a brand new crate of the given type.
+ *
+ * The crate is not shared; that is up to the caller.
  */
-std::pair<std::shared_ptr<physics2::Obstacle>, std::shared_ptr<scene2::SceneNode>> CrateFactory::createObstacle(Vec2 pos, float scale) {
-    //Choose randomly between wooden crates and iron crates.
-    int indx = (_rand() % 2 == 0 ? 2 : 1);
-    std::string name = (CRATE_PREFIX "0") + std::to_string(indx);
+CrateFactory::CrateSlot CrateFactory::allocCrate(int type, Vec2 pos, float scale) {
+    std::string name = (CRATE_PREFIX "0") + std::to_string(type);
     auto image = _assets->get<Texture>(name);
     Size boxSize(image->getSize() / scale / 2.f);
     
-    // TODO: allocate a box obstacle at pos with boxSize, set its angleSnap to 0, debugColor to DYNAMIC_COLOR, density to CRATE_DENSITY, friction to CRATE_FRICTION, and restitution to BASIC_RESTITUTION, after everything is set, make the object shared by calling setShared(). Then allocate a PolygonNode from image, set its anchor to center, and scale to 0.5f. Lastly return the pair of Obstacle and sceneNode.
-    
-    // NOTE: When an Obstacle is shared, function calls that change its state are monitored and automatically synchronized. However, every client calling this method is going to run the code above setting the properties. We don't want to share them redundantly, so sharing is turned on afterwards.
+    // TODO: allocate a box obstacle at pos with boxSize, set its angleSnap to 0, debugColor to DYNAMIC_COLOR, density to CRATE_DENSITY, friction to CRATE_FRICTION, and restitution to BASIC_RESTITUTION. Then allocate a PolygonNode from image, set its anchor to center, and scale to 0.5f.
     
 #pragma mark BEGIN SOLUTION
-    auto crate = physics2::BoxObstacle::alloc(pos, boxSize);
+    CrateSlot slot;
+    slot.type = type;
+    slot.obstacle = physics2::BoxObstacle::alloc(pos, boxSize);
     
+    auto crate = slot.obstacle;
     crate->setDebugColor(DYNAMIC_COLOR);
     crate->setAngleSnap(0); // Snap to the nearest degree
     
@@ -157,27 +301,301 @@ std::pair<std::shared_ptr<physics2::Obstacle>, std::shared_ptr<scene2::SceneNode
     crate->setFriction(CRATE_FRICTION);
     crate->setAngularDamping(CRATE_DAMPING);
     crate->setRestitution(BASIC_RESTITUTION);
+    
+    if (_instanced) {
+        // The scene draws this crate with the batch node of its type
+        slot.node = CrateProxyNode::alloc(type);
+    } else {
+        auto sprite = scene2::PolygonNode::allocWithTexture(image);
+        sprite->setAnchor(Vec2::ANCHOR_CENTER);
+        sprite->setScale(0.5f);
+        sprite->setName(name);
+        slot.node = sprite;
+    }
+    return slot;
+#pragma mark END SOLUTION
+}
+
+/**
+ * Takes a crate of the given type from the pool (or allocates one) and moves it to pos.
+ *
+ * A resident crate is already in the world, and must not be added again.
+ * If there is no free resident crate, this allocates a new crate, which
+ * the caller must add to the world.
+ *
+ * The crate is not shared; that is up to the caller.
+ */
+CrateFactory::CrateSlot CrateFactory::acquireCrate(int indx, Vec2 pos, float scale, bool resident) {
+    CrateSlot slot;
+    std::vector<CrateSlot>* free = nullptr;
+    if (_pooled) {
+        free = (resident ? &_parked[indx-1] : &_pool[indx-1]);
+    }
+    if (free != nullptr && !free->empty()) {
+        // Resident crates keep their body, the others got theirs released with the old world entry
+        slot = free->back();
+        free->pop_back();
+        auto crate = slot.obstacle;
+        crate->setShared(false);
+        crate->markRemoved(false);
+        crate->setPosition(pos);
+        crate->setAngle(0);
+        crate->setLinearVelocity(Vec2::ZERO);
+        crate->setAngularVelocity(0);
+        if (resident) {
+            crate->setEnabled(true);
+            crate->setAwake(true);
+        }
+        slot.node->setPosition(pos*scale);
+        slot.node->setAngle(0);
+        if (_stats) {
+            _stats->count(resident ? "spawn.resident" : "spawn.reuse");
+        }
+    } else {
+        slot = allocCrate(indx, pos, scale);
+        if (_stats) {
+            _stats->count("spawn.alloc");
+        }
+    }
+    return slot;
+}
+
+/**
+ * Generate a pair of Obstacle and SceneNode using the given parameters
+ *
+ * The key picks the crate type (see {@link #getCrateType}).
+ */
+std::pair<std::shared_ptr<physics2::Obstacle>, std::shared_ptr<scene2::SceneNode>> CrateFactory::createObstacle(Vec2 pos, float scale, Uint32 key) {
+    return createObstacle(CrateState(pos), scale, key);
+}
 
+/**
+ * Generate a pair of Obstacle and SceneNode in the given initial state.
+ *
+ * The state is applied before sharing is turned on, so it is not
+ * synchronized as separate property changes. The key picks the crate
+ * type (see {@link #getCrateType}).
+ */
+std::pair<std::shared_ptr<physics2::Obstacle>, std::shared_ptr<scene2::SceneNode>> CrateFactory::createObstacle(const CrateState& state, float scale, Uint32 key) {
+    Timestamp start;
+    
+    // NOTE: When an Obstacle is shared, function calls that change its state are monitored and automatically synchronized. However, every client calling this method is going to run the code setting the properties. We don't want to share them redundantly, so sharing is turned on afterwards.
+    CrateSlot slot = acquireCrate(getCrateType(key), state.position, scale, false);
+    auto crate = slot.obstacle;
+    crate->setAngle(state.angle);
+    crate->setLinearVelocity(state.velocity);
+    crate->setAngularVelocity(state.angularVelocity);
+    crate->setBullet(state.bullet);
+    crate->setFixedRotation(state.fixedRotation);
+    slot.node->setAngle(state.angle);
     crate->setShared(true);
     
-    auto sprite = scene2::PolygonNode::allocWithTexture(image);
-    sprite->setAnchor(Vec2::ANCHOR_CENTER);
-    sprite->setScale(0.5f);
+    if (_stats) {
+        Timestamp end;
+        _stats->sample("spawn.latency_us", (float)end.ellapsedMicros(start));
+    }
+    return std::make_pair(slot.obstacle, slot.node);
+}
+
+/**
+ * Generate a batch of crates in one pass.
+ *
+ * The velocities are set before sharing is turned on, so they are not
+ * synchronized as separate property changes. The crates are resident
+ * when possible (see {@link #isResident}), and those are already in the
+ * world. The crates take consecutive keys from the base key, which pick
+ * their types (see {@link #getCrateType}).
+ */
+std::vector<std::pair<std::shared_ptr<physics2::Obstacle>, std::shared_ptr<scene2::SceneNode>>> CrateFactory::createObstacles(Uint32 base, const std::vector<Vec2>& pos, const std::vector<Vec2>& vel, float scale) {
+    Timestamp start;
     
-    return std::make_pair(crate, sprite);
-#pragma mark END SOLUTION
+    std::vector<std::pair<std::shared_ptr<physics2::Obstacle>, std::shared_ptr<scene2::SceneNode>>> result;
+    result.reserve(pos.size());
+    for (size_t ii = 0; ii < pos.size(); ii++) {
+        CrateSlot slot = acquireCrate(getCrateType(base+(Uint32)ii), pos[ii], scale, true);
+        slot.obstacle->setLinearVelocity(vel[ii]);
+        slot.obstacle->setShared(true);
+        result.push_back(std::make_pair(slot.obstacle, slot.node));
+    }
+    
+    if (_stats) {
+        Timestamp end;
+        _stats->sample("spawn.batch_us", (float)end.ellapsedMicros(start));
+    }
+    return result;
+}
+
+#pragma mark Crate Pooling
+/**
+ * Turns on pooling and adds the given number of resident crates to the world.
+ *
+ * Resident crates are added with addInitObstacle() and disabled, so their
+ * bodies and fixtures exist before the first spawn. The world keeps them
+ * (with their ids) for good. The crates of {@link #createObstacles} are
+ * taken from them, so they must be added in the same order on every peer.
+ *
+ * Crates created from serialized parameters are added to the world by the
+ * physics controller, so they cannot be resident. They are pooled outside
+ * the world once recycled. If a pool runs dry, the factory falls back to
+ * allocating new crates.
+ *
+ * Any previous resident crates are dropped, as they belong to an old world.
+ *
+ * @param world The obstacle world
+ * @param count The number of resident crates
+ * @param scale The drawing scale
+ */
+void CrateFactory::prewarm(const std::shared_ptr<physics2::ObstacleWorld>& world, Uint32 count, float scale) {
+    _pooled = true;
+    _pool.resize(NUM_CRATE_TYPES);
+    _parked.assign(NUM_CRATE_TYPES, std::vector<CrateSlot>());
+    _parking.clear();
+    _residents.clear();
+    for (Uint32 ii = 0; ii < count; ii++) {
+        int type = (int)(ii % NUM_CRATE_TYPES)+1;
+        CrateSlot slot = allocCrate(type, Vec2::ZERO, scale);
+        world->addInitObstacle(slot.obstacle);
+        slot.obstacle->setEnabled(false);
+        _residents.insert(slot.obstacle.get());
+        _parked[type-1].push_back(slot);
+    }
+    if (_stats) {
+        _stats->count("spawn.prealloc", count);
+    }
+}
+
+/**
+ * Returns a despawned crate to the pool.
+ *
+ * A resident crate is disabled and stays in the world, so this returns
+ * true and the caller must unbind it from the scene graph. It can be
+ * reused from the next tick on (see {@link #restock}).
+ *
+ * Otherwise this returns false, and the caller must remove the obstacle
+ * from the world. It only becomes available again once {@link #reclaim}
+ * sees that the world has released its body.
+ */
+bool CrateFactory::recycle(const std::shared_ptr<physics2::Obstacle>& obj,
+                           const std::shared_ptr<scene2::SceneNode>& node) {
+    auto crate = std::dynamic_pointer_cast<physics2::BoxObstacle>(obj);
+    if (!_pooled || crate == nullptr) {
+        return false;
+    }
+    if (node->getParent() != nullptr) {
+        node->removeFromParent();
+    }
+    
+    // Recover the type from the proxy, or from the texture of the sprite
+    CrateSlot slot;
+    slot.obstacle = crate;
+    slot.node = node;
+    slot.type = 0;
+    auto proxy = std::dynamic_pointer_cast<CrateProxyNode>(node);
+    auto sprite = std::dynamic_pointer_cast<scene2::PolygonNode>(node);
+    if (proxy != nullptr) {
+        slot.type = proxy->getType();
+    } else if (sprite != nullptr) {
+        for (int ii = 1; ii <= NUM_CRATE_TYPES; ii++) {
+            std::string name = (CRATE_PREFIX "0") + std::to_string(ii);
+            if (sprite->getTexture() == _assets->get<Texture>(name)) {
+                slot.type = ii;
+            }
+        }
+    }
+    // Crates not made by the factory (like big crates) are not pooled
+    if (slot.type == 0) {
+        return false;
+    }
+    
+    if (isResident(obj)) {
+        // Park the crate where it is; nothing collides with a disabled body
+        crate->setLinearVelocity(Vec2::ZERO);
+        crate->setAngularVelocity(0);
+        crate->setEnabled(false);
+        _parking.push_back(slot);
+        return true;
+    }
+    _pending.push_back(slot);
+    return false;
+}
+
+/**
+ * Makes the resident crates recycled this tick available for reuse.
+ *
+ * This should be called once at the end of every tick, so that the
+ * order of reuse (and so the id of every spawned crate) is the same on
+ * every peer.
+ */
+void CrateFactory::restock() {
+    for (auto it = _parking.begin(); it != _parking.end(); ++it) {
+        _parked[it->type-1].push_back(*it);
+    }
+    _parking.clear();
+}
+
+/**
+ * Moves recycled crates whose bodies were released back to the pool.
+ *
+ * This should be called once per frame, after the scene graph has been
+ * synced, so that no node binding still refers to a recycled crate.
+ */
+void CrateFactory::reclaim() {
+    for (auto it = _pending.begin(); it != _pending.end(); ) {
+        if (it->obstacle->getBody() == nullptr) {
+            _pool[it->type-1].push_back(*it);
+            it = _pending.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+/**
+ * Returns the batch node that draws the crate with the given node.
+ *
+ * This returns nullptr if the node is not the proxy of an instanced crate.
+ */
+std::shared_ptr<CrateBatchNode> CrateFactory::getBatch(const std::shared_ptr<scene2::SceneNode>& node) const {
+    auto proxy = std::dynamic_pointer_cast<CrateProxyNode>(node);
+    if (proxy == nullptr || proxy->getType() < 1 || proxy->getType() > (int)_batches.size()) {
+        return nullptr;
+    }
+    return _batches[proxy->getType()-1];
+}
+
+/**
+ * Returns the number of crates available for reuse.
+ */
+size_t CrateFactory::getPoolSize() const {
+    size_t total = 0;
+    for (auto it = _pool.begin(); it != _pool.end(); ++it) {
+        total += it->size();
+    }
+    for (auto it = _parked.begin(); it != _parked.end(); ++it) {
+        total += it->size();
+    }
+    return total;
 }
 
 /**
  * Helper method for converting normal parameters into byte vectors used for syncing.
+ *
+ * The key identifies the crate on every peer (see {@link CratePopulation}).
  */
-std::shared_ptr<std::vector<std::byte>> CrateFactory::serializeParams(Vec2 pos, float scale) {
-    // TODO: Use _serializer to serialize pos and scale (remember to make a shared copy of the serializer reference, otherwise it will be lost if the serializer is reset).
+std::shared_ptr<std::vector<std::byte>> CrateFactory::serializeParams(const CrateState& state, float scale, Uint32 key) {
+    // TODO: Use _serializer to serialize the state and scale (remember to make a shared copy of the serializer reference, otherwise it will be lost if the serializer is reset).
 #pragma mark BEGIN SOLUTION
     _serializer.reset();
-    _serializer.writeFloat(pos.x);
-    _serializer.writeFloat(pos.y);
+    _serializer.writeFloat(state.position.x);
+    _serializer.writeFloat(state.position.y);
     _serializer.writeFloat(scale);
+    _serializer.writeUint32(key);
+    _serializer.writeFloat(state.angle);
+    _serializer.writeFloat(state.velocity.x);
+    _serializer.writeFloat(state.velocity.y);
+    _serializer.writeFloat(state.angularVelocity);
+    _serializer.writeBool(state.bullet);
+    _serializer.writeBool(state.fixedRotation);
     return std::make_shared<std::vector<std::byte>>(_serializer.serialize());
 #pragma mark END SOLUTION
 }
@@ -190,12 +608,25 @@ std::pair<std::shared_ptr<physics2::Obstacle>, std::shared_ptr<scene2::SceneNode
 #pragma mark BEGIN SOLUTION
     _deserializer.reset();
     _deserializer.receive(params);
+    CrateState state;
     float x = _deserializer.readFloat();
     float y = _deserializer.readFloat();
-    Vec2 pos = Vec2(x,y);
+    state.position = Vec2(x,y);
     float scale = _deserializer.readFloat();
-    return createObstacle(pos, scale);
+    Uint32 key = _deserializer.readUint32();
+    state.angle = _deserializer.readFloat();
+    x = _deserializer.readFloat();
+    y = _deserializer.readFloat();
+    state.velocity = Vec2(x,y);
+    state.angularVelocity = _deserializer.readFloat();
+    state.bullet = _deserializer.readBool();
+    state.fixedRotation = _deserializer.readBool();
+    auto pair = createObstacle(state, scale, key);
 #pragma mark END SOLUTION
+    if (_spawnListener) {
+        _spawnListener(key, pair.first, pair.second, params);
+    }
+    return pair;
 }
 
 
@@ -210,6 +641,9 @@ std::pair<std::shared_ptr<physics2::Obstacle>, std::shared_ptr<scene2::SceneNode
 GameScene::GameScene() : cugl::Scene2(),
 _complete(false),
 _debug(false),
+_batchSync(BATCH_TRANSFORM_SYNC),
+_interpolateRemote(false),
+_tick(0),
 _isHost(false)
 {    
 }
@@ -287,9 +721,114 @@ bool GameScene::init(const std::shared_ptr<AssetManager>& assets, const Rect rec
     _input.init();
     _input.update(0);
 
-    _rand.seed(0xdeadbeef);
+    _rand.seed(RANDOM_SEED, SCENE_STREAM);
+    _peerRand.seed(RANDOM_SEED, PEER_STREAM+getShortUID());
 
     _crateFact = CrateFactory::alloc(_assets);
+    _crateFact->setInstanced(INSTANCED_CRATES);
+    _crateFact->setStats(&_stats);
+    _props.clear();
+    _props.setStats(&_stats);
+    _snapshots.init(SNAPSHOT_CAPACITY);
+    _stats.clear();
+    _tick = 0;
+    _heldTicks = 0;
+    _codedFrames = 0;
+    _ids.init(getShortUID(), IDS_DIGEST_HISTORY);
+    _ids.setStats(&_stats);
+    _scheduler.init(getShortUID(), INPUT_DELAY);
+    _scheduler.setStats(&_stats);
+    // There is no rollback, so a late event applied now would not agree with the other peers
+    _scheduler.setLateHandler([this](const std::shared_ptr<TickedEvent>& event, Uint64 now) {
+        // Other peers already removed these crates at their tick, so removing them now would not agree either
+        if (std::dynamic_pointer_cast<DespawnEvent>(event)) {
+            _stats.count("despawn.late");
+            CULogError("Despawn for tick %llu arrived at tick %llu and was rejected",
+                       (unsigned long long)event->getExecuteTick(), (unsigned long long)now);
+            return false;
+        }
+        if (!APPLY_LATE_EVENTS) {
+            CULogError("Event for tick %llu arrived at tick %llu and was rejected",
+                       (unsigned long long)event->getExecuteTick(), (unsigned long long)now);
+            return false;
+        }
+        _stats.count("events.applied_late");
+        processTickedEvent(event);
+        return true;
+    });
+    // The echo is only drawn, so undoing it leaves the simulation as every other peer has it
+    _scheduler.setReconcileHandler([this](const std::shared_ptr<TickedEvent>& event, Uint64 echoed, Uint64 now) {
+        if (auto crateEvent = std::dynamic_pointer_cast<CrateEvent>(event)) {
+            removeEcho(crateEvent->getKey());
+        }
+    });
+    _echoes.clear();
+    _inputTimes.clear();
+    _predictor.init(DIVERGENCE_TICKS);
+    _predictor.setStats(&_stats);
+    _predictor.setListener({PREDICT_ACK_AGE, DIVERGENCE_TICKS},
+                           [this](Uint32 key, const std::shared_ptr<physics2::Obstacle>& obj,
+                                  const std::vector<Vec2>& trajectory) {
+        sendSpawnAck(key, obj, trajectory);
+    });
+    _authority.init(AUTHORITY_BUDGET, AUTHORITY_HYSTERESIS, AUTHORITY_LEASE, AUTHORITY_COOLDOWN);
+    _authority.setStats(&_stats);
+    _arbiter.init(AUTHORITY_LEASE+AUTHORITY_MARGIN);
+    _arbiter.setStats(&_stats);
+    // NOTE: This assumes short UIDs are handed out in join order and nobody has left
+    // yet, so the room is peers 1 through N. Nothing reports the actual UIDs.
+    _partition.init(OWNERSHIP_MODE, rect);
+    std::vector<Uint32> peers;
+    for(Uint32 ii = 1; ii <= getNumPlayers(); ii++) {
+        peers.push_back(ii);
+    }
+    if (getShortUID() < 1 || getShortUID() > getNumPlayers()) {
+        _stats.count("partition.uid_outside_room");
+        CULogError("Short UID %u is outside 1..%u, so the partition gives it nothing",
+                   getShortUID(), getNumPlayers());
+    }
+    _partition.setPeers(peers, 0);
+    // The host relays, as it is the peer most likely to have a good uplink
+    _topology.init(TOPOLOGY_MODE, peers.empty() ? 0 : peers.front(), PACKET_HEADER_BYTES,
+                   (Uint32)(1.0f/FIXED_TIMESTEP_S), UPLINK_BUDGET, RELAY_BUDGET);
+    _topology.setStats(&_stats);
+    _lockstep.init(peers, LOCKSTEP_DELAY);
+    _lockstep.setStats(&_stats);
+    _pendingInput.clear();
+    _hasher.init(HASH_SNAPSHOTS, HASH_QUANTUM);
+    _hasher.setStats(&_stats);
+    _hasher.setMismatchHandler([this](Uint64 tick, Uint32 peer, Uint64 local, Uint64 remote) {
+        reportDesync(tick, peer, local, remote);
+    });
+    _upstreamBytes = 0;
+    _stateBytes = 0;
+    _sentBytes = 0;
+    _links.clear();
+    _probeSeq = 0;
+    _echoes.clear();
+    _eventBytes = 0;
+    _sendBudget = UPLINK_BUDGET;
+    _sendTokens = _sendBudget;
+    _epoch.mark();
+    _clock.init(CLOCK_SAMPLES, (Uint64)(FIXED_TIMESTEP_S*1000000), MAX_DILATION, DILATION_GAIN);
+    _baseStep = Application::get()->getFixedStep();
+    _latency.init(LATENCY_TIMEOUT);
+    _latency.setStats(&_stats);
+    _autoFireTick = LATENCY_AUTOFIRE;
+    _population.init(MAX_FIRED_CRATES, rect);
+    _crateFact->setSpawnListener([this](Uint32 key, const std::shared_ptr<physics2::Obstacle>& obj,
+                                        const std::shared_ptr<scene2::SceneNode>& node,
+                                        const std::vector<std::byte>& params) {
+        // Shared spawns never pass through the events, so replay needs them apart
+        _recorder.recordSpawn(params);
+        _population.add(key, obj, node, _tick);
+        bool mine = ObstacleIds::getPeer(key) == getShortUID();
+        _predictor.track(key, obj, mine && !_isHost);
+        if (LATENCY_PROBE && !mine && hasSharedTime()) {
+            _latency.mark(key, LatencyProbe::CREATE, getSharedTime(Timestamp()));
+            _latency.bind(obj.get(), key);
+        }
+    });
 
     // IMPORTANT: SCALING MUST BE UNIFORM
     // This means that we cannot change the aspect ratio of the physics world
@@ -324,6 +863,7 @@ bool GameScene::init(const std::shared_ptr<AssetManager>& assets, const Rect rec
     _active = true;
     _complete = false;
     setDebug(false);
+    setRemoteInterpolation(REMOTE_INTERPOLATION);
 
     //Make a std::function reference of the linkSceneToObs function in game scene for network controller
     std::function<void(const std::shared_ptr<physics2::Obstacle>&,const std::shared_ptr<scene2::SceneNode>&)> linkSceneToObsFunc = [=](const std::shared_ptr<physics2::Obstacle>& obs, const std::shared_ptr<scene2::SceneNode>& node) {
@@ -336,32 +876,102 @@ bool GameScene::init(const std::shared_ptr<AssetManager>& assets, const Rect rec
      * TODO: Acquire the ownership of _cannon2 if this machine is not the host.
      */
 #pragma mark BEGIN SOLUTION
-    _network->enablePhysics(_world, linkSceneToObsFunc);
-    
-    if(!isHost){
-        _network->getPhysController()->acquireObs(_cannon2, 0);
+    // In lock-step every peer steps its own world, so nothing is synchronized.
+    // A replay has no connection, and spawns its shared crates from the recording.
+    if (!LOCKSTEP_MODE && !_replay.isOpen()) {
+        _network->enablePhysics(_world, linkSceneToObsFunc);
+        
+        if(!isHost){
+            _network->getPhysController()->acquireObs(_cannon2, 0);
+        }
+        
+        _factId = _network->getPhysController()->attachFactory(_crateFact);
     }
-
-    _factId = _network->getPhysController()->attachFactory(_crateFact);
 #pragma mark END SOLUTION
 
 //TODO: For task 5, attach CrateEvent to the network controller
 #pragma mark BEGIN SOLUTION
-    _network->attachEventType<CrateEvent>();
+    attachEventType<CrateEvent>();
 #pragma mark END SOLUTION
+    attachEventType<DespawnEvent>();
+    attachEventType<SpawnBatchEvent>();
+    attachEventType<SpawnAckEvent>();
+    attachEventType<PeerStatusEvent>();
+    attachEventType<PingEvent>();
+    attachEventType<LatencyEvent>();
+    attachEventType<InputBundleEvent>();
+    attachEventType<DropEvent>();
+    attachEventType<WorldHashEvent>();
+    attachEventType<IdDigestEvent>();
+    attachEventType<AuthorityEvent>();
+    attachEventType<StateFrameEvent>();
+    
+    // The types are attached, so the recording can refer to them
+    _recorder.setStats(&_stats);
+    if (RECORD_SESSION && !_replay.isOpen()) {
+        std::string path = Application::get()->getSaveDirectory() + "session_" +
+                           std::to_string(getShortUID()) + ".nlrs";
+        if (_recorder.open(path, getShortUID(), getNumPlayers(), isHost)) {
+            CULog("Recording the session to %s", path.c_str());
+        }
+    }
     
     // XNA nostalgia
     Application::get()->setClearColor(Color4f::CORNFLOWER);
     return true;
 }
 
+/**
+ * Initializes the controller to replay a recorded session.
+ *
+ * The network controller is never used, so it need not be connected.
+ * The peer identity comes from the recording, and so do the shared
+ * crates, which are spawned without the physics controller.
+ * Call {@link #replay} to run the session.
+ *
+ * @param assets    The (loaded) assets for this game mode
+ * @param network   The (unconnected) network controller
+ * @param path      The recorded session
+ *
+ * @return true if the controller is initialized properly, false otherwise.
+ */
+bool GameScene::initReplay(const std::shared_ptr<AssetManager>& assets, const std::shared_ptr<NetEventController> network, const std::string& path) {
+    if (!_replay.open(path)) {
+        CULogError("Could not read the recorded session %s", path.c_str());
+        return false;
+    }
+    return init(assets, network, _replay.isHost());
+}
+
 /**
  * Disposes of all (non-static) resources allocated to this mode.
  */
 void GameScene::dispose() {
     if (_active) {
+        Application::get()->setFixedStep(_baseStep);
         removeAllChildren();
         _input.dispose();
+        _transformSync.clear();
+        _crateBatches.clear();
+        _snapshots.clear();
+        _population.clear();
+        _scheduler.clear();
+        _echoes.clear();
+        _inputTimes.clear();
+        _predictor.clear();
+        _authority.clear();
+        _arbiter.clear();
+        _topology.clear();
+        _links.clear();
+        _latency.clear();
+        _lockstep.clear();
+        _hasher.clear();
+        _ids.clear();
+        _recorder.close(_stateBytes);
+        _replay.close();
+        _codec.clear();
+        _codedFrames = 0;
+        _props.clear();
         _world = nullptr;
         _worldnode = nullptr;
         _debugnode = nullptr;
@@ -391,6 +1001,22 @@ std::vector<std::shared_ptr<scene2::PolygonNode>> nodes;
 void GameScene::reset() {
     _worldnode->removeAllChildren();
     _debugnode->removeAllChildren();
+    _transformSync.clear();
+    _snapshots.clear();
+    _population.clear();
+    _scheduler.clear();
+    _echoes.clear();
+    _inputTimes.clear();
+    _predictor.clear();
+    _authority.clear();
+    _arbiter.clear();
+    _topology.clear();
+    _latency.clear();
+    _hasher.clear();
+    _ids.clear();
+    // The game goes back to the menu, so the session is over
+    _recorder.close(_stateBytes);
+    _props.clear();
     setComplete(false);
     populate();
     Application::get()->resetLeftOver();
@@ -398,10 +1024,20 @@ void GameScene::reset() {
 
 /**
  * This method adds a crate at the given position during the init process.
+ *
+ * The index of the crate picks its type, as every peer adds the init
+ * crates in the same order.
  */
-std::shared_ptr<physics2::Obstacle> GameScene::addInitCrate(cugl::Vec2 pos) {
-    auto pair =  _crateFact->createObstacle(pos, _scale);
-    addInitObstacle(pair.first,pair.second);
+std::shared_ptr<physics2::Obstacle> GameScene::addInitCrate(cugl::Vec2 pos, Uint32 index) {
+    auto pair =  _crateFact->createObstacle(pos, _scale, index);
+    if (_partition.getMode() == OwnershipPartition::Mode::HOST) {
+        addInitObstacle(pair.first,pair.second);
+    } else {
+        // Ownership is assigned once every crate is known (see populate)
+        _world->addInitObstacle(pair.first);
+        _partition.add(pair.first);
+        linkSceneToObs(pair.first, pair.second);
+    }
     return pair.first;
 }
 
@@ -409,27 +1045,118 @@ std::shared_ptr<physics2::Obstacle> GameScene::addInitCrate(cugl::Vec2 pos) {
  * This method adds a crate that had been fired by the player's cannon amid the simulation.
  *
  * If this machine is host, the crate should be fire from the left cannon (_cannon1), vice versa.
+ *
+ * @return the spawn key of the crate
  */
-void GameScene::fireCrate() {
-    //TODO: Add a new crate to the simulation using the addSharedObstacle() method from the physics controller, and set its velocity in the direction the cannon is aimed scaled by (50 * _input.getFirePower()).
+Uint32 GameScene::fireCrate() {
+    //TODO: Add a new crate to the simulation using the addSharedObstacle() method from the physics controller, launched with a velocity in the direction the cannon is aimed scaled by (50 * _input.getFirePower()). Put the velocity in the CrateState so it arrives with the creation message.
     //HINT: You can use the serializedParams() method of the crate factory to help you serialize the parameters.
 #pragma mark BEGIN SOLUTION
     auto cannon = _isHost ? _cannon1 : _cannon2;
-    auto params = _crateFact->serializeParams(cannon->getPosition(), _scale);
-    auto pair = _network->getPhysController()->addSharedObstacle(_factId, params);
+    // The top byte of the key is this peer, so keys never collide across peers
+    Uint32 key = _ids.reserve();
     float angle = cannon->getAngle() + M_PI_2;
     Vec2 forward(SDL_cosf(angle), SDL_sinf(angle));
-    pair.first->setLinearVelocity(forward * 50 *_input.getFirePower());
+    
+    // The launch velocity travels in the creation message, not as a later change
+    CrateState state(cannon->getPosition());
+    state.velocity = forward * 50 *_input.getFirePower();
+    auto params = _crateFact->serializeParams(state, _scale, key);
+    if (!_replay.isOpen()) {
+        _network->getPhysController()->addSharedObstacle(_factId, params);
+    }
+    return key;
 #pragma mark END SOLUTION
 }
 
+/**
+ * This method adds a fired crate to the next input bundle (lock-step only).
+ *
+ * The launch is aimed here, so that no other peer computes the direction
+ * with its own math library. Only one crate may be fired per bundle.
+ *
+ * @return the spawn key of the crate
+ */
+Uint32 GameScene::queueFire() {
+    if (_pendingInput.fireKey != 0) {
+        _stats.count("lockstep.fire_merged");
+        return _pendingInput.fireKey;
+    }
+    auto cannon = _isHost ? _cannon1 : _cannon2;
+    float angle = cannon->getAngle() + M_PI_2;
+    Vec2 forward(SDL_cosf(angle), SDL_sinf(angle));
+    _pendingInput.fireKey = _ids.reserve();
+    _pendingInput.firePos = cannon->getPosition();
+    _pendingInput.fireVel = forward * 50 *_input.getFirePower();
+    return _pendingInput.fireKey;
+}
+
+
+/**
+ * This method fires a fan of crates from the player's cannon at once.
+ *
+ * The crates are sent as a single SpawnBatchEvent with a contiguous range
+ * of spawn keys, unless VOLLEY_BATCHED is off, in which case they are
+ * added one at a time with addSharedObstacle() (for comparison).
+ */
+void GameScene::fireVolley() {
+    Timestamp start;
+    auto cannon = _isHost ? _cannon1 : _cannon2;
+    float aim = cannon->getAngle() + M_PI_2;
+    
+    std::vector<Vec2> pos;
+    std::vector<Vec2> vel;
+    pos.reserve(VOLLEY_SIZE);
+    vel.reserve(VOLLEY_SIZE);
+    for (int ii = 0; ii < VOLLEY_SIZE; ii++) {
+        // Stagger the crates along their direction so they do not overlap
+        float angle = aim + VOLLEY_SPREAD*((float)ii/(VOLLEY_SIZE-1)-0.5f);
+        Vec2 forward(SDL_cosf(angle), SDL_sinf(angle));
+        pos.push_back(cannon->getPosition() + forward*(1.0f+(ii % 3)));
+        vel.push_back(forward*VOLLEY_SPEED);
+    }
+    
+    // Lock-step has no shared obstacles, so volleys always go out as an event
+    if (VOLLEY_BATCHED || LOCKSTEP_MODE) {
+        // Reserve a contiguous range of keys for the whole batch
+        Uint32 base = _ids.reserve(VOLLEY_SIZE);
+        auto event = SpawnBatchEvent::allocSpawnBatchEvent(base, _scale, pos, vel);
+        pushTickedEvent(event);
+        _stats.count("volley.messages");
+        _stats.count("volley.payload_bytes", event->serialize().size());
+    } else {
+        for (int ii = 0; ii < VOLLEY_SIZE; ii++) {
+            Uint32 key = _ids.reserve();
+            CrateState state(pos[ii]);
+            state.velocity = vel[ii];
+            auto params = _crateFact->serializeParams(state, _scale, key);
+            if (!_replay.isOpen()) {
+                _network->getPhysController()->addSharedObstacle(_factId, params);
+            }
+            _stats.count("volley.messages");
+            _stats.count("volley.payload_bytes", params->size());
+        }
+    }
+    
+    Timestamp end;
+    _stats.sample(VOLLEY_BATCHED ? "volley.batched_us" : "volley.single_us",
+                  (float)end.ellapsedMicros(start));
+}
 
 /**
  * This method takes a crateEvent and processes it.
  */
 void GameScene::processCrateEvent(const std::shared_ptr<CrateEvent>& event){
-    //Choose randomly between wooden crates and iron crates.
-    int indx = (_rand() % 2 == 0 ? 2 : 1);
+    //Choose between wooden crates and iron crates.
+    //Keyed crates choose by key, as peers may process events in a different order.
+    Uint32 key = event->getKey();
+    bool keyed = ObstacleIds::getPeer(key) != 0;
+    int indx;
+    if (keyed) {
+        indx = CrateFactory::getCrateType(key);
+    } else {
+        indx = (_rand.below(2) == 0 ? 2 : 1);
+    }
     std::string name = (CRATE_PREFIX "0") + std::to_string(indx);
     auto image = _assets->get<Texture>(name);
     Size boxSize(image->getSize() / _scale);
@@ -454,78 +1181,1042 @@ void GameScene::processCrateEvent(const std::shared_ptr<CrateEvent>& event){
     //TODO: add the crate and sprite to the simulation
     //NOTE: since both the host and client will receive a CrateEvent, we don't want to use addSharedObstacle() for it because it will create two separate crate. Instead you should use addInitObstacle(), which has the same top-bit id and if all clients called init obstacle the same amount of times, the same low-bit id. There is a potential race condition where multiple clients calling addInitObstacle() can cause id to be mixed up(clients send CrateEvent at the same time). In this lab, we will not address that race condition. But you could send along an obstacle id to ensure that all clients have that id for the obstacle.
 #pragma mark BEGIN SOLUTION
-    addInitObstacle(crate,sprite);
+    if (!keyed) {
+        addInitObstacle(crate,sprite);
+        return;
+    }
+    
+    // Ticked events are applied in the same order everywhere, so the crate gets the same id
+    _ids.bind(_world, crate, key);
+    if(_isHost){
+        _world->getOwned().insert({crate,0});
+    }
+    linkSceneToObs(crate, sprite);
+    _population.add(key, crate, sprite, _tick);
+    
+    // The crate is drawn from the next frame on
+    auto input = _inputTimes.find(key);
+    if (input != _inputTimes.end()) {
+        Timestamp now;
+        _stats.sample("input.wait_us", (float)now.ellapsedMicros(input->second));
+        _inputTimes.erase(input);
+    }
 #pragma mark END SOLUTION
 }
 
 /**
- * Lays out the game geography.
- *
- * Pay close attention to how we attach physics objects to a scene graph.
- * The simplest way is to make a subclass.  However,
- * for simple objects you can just use a callback function to lightly couple
- * them.  This is what we do with the crates.
+ * This method sends a storm of crate events for stress testing.
  *
- * This method is really, really long.  In practice, you would replace this
- * with your serialization loader, which would process a level file.
+ * Every peer sends EVENT_STORM crate events each tick, so that events from
+ * different peers keep arriving at the same time. Every peer should still
+ * agree on the id of every crate, which the id digests check.
  */
-void GameScene::populate() {
-    _world = physics2::ObstacleWorld::alloc(Rect(0,0,DEFAULT_WIDTH,DEFAULT_HEIGHT),Vec2(0,DEFAULT_GRAVITY));
-    _world->activateCollisionCallbacks(true);
-    _world->onBeginContact = [this](b2Contact* contact) {
-        beginContact(contact);
-    };
-    _world->beforeSolve = [this](b2Contact* contact, const b2Manifold* oldManifold) {
-        beforeSolve(contact,oldManifold);
-    };
-    
-    
-    std::shared_ptr<Texture> image;
-        
-#pragma mark : Wall polygon 1
-        
-    // Create ground pieces
-    // All walls share the same texture
-    image  = _assets->get<Texture>(EARTH_TEXTURE);
-    std::string wname = "wall";
+void GameScene::sendEventStorm() {
+    for (int ii = 0; ii < EVENT_STORM; ii++) {
+        Vec2 pos(_peerRand.range(4.0f, DEFAULT_WIDTH-4.0f), DEFAULT_HEIGHT-2.0f);
+        pushTickedEvent(CrateEvent::allocCrateEvent(pos, _ids.reserve()));
+    }
+    _stats.count("storm.events", EVENT_STORM);
+}
 
-    // Create the polygon outline
-    Poly2 wall1(reinterpret_cast<Vec2*>(WALL1),11);
-    EarclipTriangulator triangulator;
-    triangulator.set(wall1.vertices);
-    triangulator.calculate();
-    wall1.setIndices(triangulator.getTriangulation());
-    triangulator.clear();
+/**
+ * This method constructs every crate of a spawn batch in one pass.
+ *
+ * The peer that fired the batch owns the crates.
+ */
+void GameScene::processSpawnBatchEvent(const std::shared_ptr<SpawnBatchEvent>& event){
+    Timestamp start;
+    auto pairs = _crateFact->createObstacles(event->getBaseKey(), event->getPositions(), event->getVelocities(), event->getScale());
+    bool owned = ObstacleIds::getPeer(event->getBaseKey()) == getShortUID();
+    for(size_t ii = 0; ii < pairs.size(); ii++){
+        auto& obj = pairs[ii].first;
+        // Resident crates never left the world, and keep their id
+        _ids.bind(_world, obj, event->getBaseKey()+(Uint32)ii);
+        if (owned) {
+            _world->getOwned().insert({obj,0});
+        }
+        linkSceneToObs(obj, pairs[ii].second);
+        _population.add(event->getBaseKey()+(Uint32)ii, obj, pairs[ii].second, _tick);
+        _predictor.track(event->getBaseKey()+(Uint32)ii, obj, owned && !_isHost);
+    }
+    Timestamp end;
+    _stats.sample("volley.receive_us", (float)end.ellapsedMicros(start));
+}
 
-    //std::shared_ptr<physics2::PolygonObstacle> wallobj;
-    wallobj1 = physics2::PolygonObstacle::allocWithAnchor(wall1,Vec2::ANCHOR_CENTER);
-    wallobj1->setDebugColor(STATIC_COLOR);
-    wallobj1->setName(wname);
+/**
+ * This method removes the fired crates listed in the despawn event.
+ *
+ * It must be called at the tick of the event, so that every peer removes
+ * the crates at the same point in the simulation.
+ */
+void GameScene::processDespawnEvent(const std::shared_ptr<DespawnEvent>& event){
+    for(Uint32 key : event->getKeys()){
+        auto entry = _population.remove(key);
+        _ids.unbind(key);
+        if (entry.obstacle == nullptr) {
+            continue;
+        }
+        // Every peer removes the crate locally, so nothing must be synced
+        entry.obstacle->setShared(false);
+        _world->getOwned().erase(entry.obstacle);
+        auto batch = _crateFact->getBatch(entry.node);
+        if (entry.node->getParent() != nullptr) {
+            entry.node->removeFromParent();
+        }
+        if (_crateFact->recycle(entry.obstacle, entry.node)) {
+            // A resident crate stays in the world, so it is not dropped on its own
+            _transformSync.remove(entry.obstacle);
+            if (batch != nullptr) {
+                batch->remove(entry.obstacle);
+            }
+        } else {
+            entry.obstacle->markRemoved(true);
+        }
+        _stats.count("despawn.crates");
+    }
+    _stats.count("despawn.events");
+}
 
-    // Set the physics attributes
-    wallobj1->setBodyType(b2_staticBody);
-    wallobj1->setDensity(BASIC_DENSITY);
-    wallobj1->setFriction(BASIC_FRICTION);
-    wallobj1->setRestitution(BASIC_RESTITUTION);
+/**
+ * This method applies a ticked event released by the scheduler.
+ *
+ * @param event The event to apply
+ */
+void GameScene::processTickedEvent(const std::shared_ptr<TickedEvent>& event){
+    if(auto crateEvent = std::dynamic_pointer_cast<CrateEvent>(event)){
+        CULog("BIG CRATE GOT");
+        processCrateEvent(crateEvent);
+    }
+    else if(auto despawnEvent = std::dynamic_pointer_cast<DespawnEvent>(event)){
+        processDespawnEvent(despawnEvent);
+    }
+    else if(auto spawnEvent = std::dynamic_pointer_cast<SpawnBatchEvent>(event)){
+        processSpawnBatchEvent(spawnEvent);
+    }
+}
 
-    // Add the scene graph nodes to this object
-    wall1 *= _scale;
-    wallsprite1 = scene2::PolygonNode::allocWithTexture(image,wall1);
+/**
+ * This method confirms a crate fired by this peer with the host's acknowledgement.
+ *
+ * Acknowledgements are broadcast, so only the peer that fired the crate
+ * uses them. If the crate is still predicted, it is confirmed with the
+ * last state of the host's trajectory, which samples the prediction error
+ * (the crate itself is left alone, as this peer owns it). If the
+ * trajectory covers every tracked age, it is also compared with ours to
+ * sample the divergence.
+ */
+void GameScene::processSpawnAckEvent(const std::shared_ptr<SpawnAckEvent>& event){
+    // Acknowledgements are broadcast, but only matter to the peer that fired
+    Uint32 key = event->getKey();
+    const std::vector<Vec2>& trajectory = event->getTrajectory();
+    if (ObstacleIds::getPeer(key) != getShortUID() || trajectory.empty()) {
+        return;
+    }
     
-#pragma mark : Wall polygon 2
-    Poly2 wall2(reinterpret_cast<Vec2*>(WALL2),9);
-    triangulator.set(wall2.vertices);
-    triangulator.calculate();
-    wall2.setIndices(triangulator.getTriangulation());
-    triangulator.clear();
-
-    wallobj2 = physics2::PolygonObstacle::allocWithAnchor(wall2,Vec2::ANCHOR_CENTER);
-    wallobj2->setDebugColor(STATIC_COLOR);
-    wallobj2->setName(wname);
+    if (_predictor.isPredicted(key)) {
+        _predictor.confirm(key, trajectory.back(), event->getVelocity(), (Uint32)trajectory.size());
+    }
+    if (trajectory.size() >= DIVERGENCE_TICKS) {
+        _predictor.compare(key, trajectory);
+    }
+}
 
-    // Set the physics attributes
-    wallobj2->setBodyType(b2_staticBody);
-    wallobj2->setDensity(BASIC_DENSITY);
+/**
+ * This method acknowledges a crate fired by another peer.
+ *
+ * Only the host acknowledges crates, once they reach a milestone age.
+ *
+ * @param key           The spawn key
+ * @param obj           The crate obstacle
+ * @param trajectory    The positions of the crate on this peer
+ */
+void GameScene::sendSpawnAck(Uint32 key, const std::shared_ptr<physics2::Obstacle>& obj,
+                             const std::vector<Vec2>& trajectory){
+    if (!_isHost || ObstacleIds::getPeer(key) == getShortUID()) {
+        return;
+    }
+    if (trajectory.size() >= DIVERGENCE_TICKS && !MEASURE_DIVERGENCE) {
+        return;
+    }
+    if (sendOptionalEvent(SpawnAckEvent::allocSpawnAckEvent(key, obj->getLinearVelocity(), trajectory))) {
+        _stats.count("predict.acks");
+    }
+}
+
+/**
+ * This method stamps an event with the input delay and sends it.
+ *
+ * The event is applied at the stamped tick on every peer, including
+ * this one (events are echoed back to the sender). With LOCAL_ECHO, a
+ * crate event is also drawn right away (see {@link #showEcho}).
+ *
+ * @param event The event to send
+ */
+void GameScene::pushTickedEvent(const std::shared_ptr<NetEvent>& event){
+    auto ticked = std::dynamic_pointer_cast<TickedEvent>(event);
+    if (ticked != nullptr) {
+        _scheduler.stamp(ticked, _tick);
+        auto crateEvent = std::dynamic_pointer_cast<CrateEvent>(event);
+        if (LOCAL_ECHO && crateEvent != nullptr && ObstacleIds::getPeer(crateEvent->getKey()) != 0) {
+            _scheduler.echo(ticked, _tick);
+            showEcho(crateEvent);
+        }
+    }
+    sendEvent(event);
+}
+
+/**
+ * This method draws a crate requested by this peer before it is applied.
+ *
+ * The echo is a sprite at the spawn position, with the texture the crate
+ * will have. It has no body, so it never touches the simulation. When
+ * the event is released (or rejected), the scheduler confirms the echo,
+ * and it is removed before the crate itself is created.
+ *
+ * @param event The crate event sent by this peer
+ */
+void GameScene::showEcho(const std::shared_ptr<CrateEvent>& event){
+    Uint32 key = event->getKey();
+    std::string name = (CRATE_PREFIX "0") + std::to_string(CrateFactory::getCrateType(key));
+    auto sprite = scene2::PolygonNode::allocWithTexture(_assets->get<Texture>(name));
+    sprite->setAnchor(Vec2::ANCHOR_CENTER);
+    sprite->setPosition(event->getPos() * _scale);
+    _worldnode->addChild(sprite);
+    _echoes[key] = sprite;
+    
+    // The echo is drawn from the next frame on, like the crate without it
+    auto input = _inputTimes.find(key);
+    if (input != _inputTimes.end()) {
+        Timestamp now;
+        _stats.sample("input.echo_us", (float)now.ellapsedMicros(input->second));
+    }
+}
+
+/**
+ * This method removes the echo of a crate, if any.
+ *
+ * @param key   The spawn key of the crate
+ */
+void GameScene::removeEcho(Uint32 key){
+    auto it = _echoes.find(key);
+    if (it == _echoes.end()) {
+        return;
+    }
+    if (it->second->getParent() != nullptr) {
+        it->second->removeFromParent();
+    }
+    _echoes.erase(it);
+}
+
+/**
+ * This method waits for the input bundles of this tick, and applies them.
+ *
+ * Our own bundle for a later tick is sent before the inputs are applied.
+ * Peers that stall the simulation for too long are dropped by the host,
+ * which tells every other peer the tick to drop them from. The other
+ * peers keep waiting until then.
+ *
+ * @return true if the tick can be stepped
+ */
+bool GameScene::stepLockstep(){
+    if (!_lockstep.isReady(_tick)) {
+        // Peers that each dropped on their own timer would drop at different ticks
+        if (_isHost && _lockstep.getStalls() >= LOCKSTEP_TIMEOUT) {
+            for(Uint32 peer : _lockstep.getMissing(_tick)) {
+                CULog("Dropping peer %u, which sent no input for tick %llu", peer, (unsigned long long)_tick);
+                _lockstep.drop(peer, _tick);
+                sendEvent(DropEvent::allocDropEvent(peer, _tick));
+                _stats.count("lockstep.dropped");
+            }
+        }
+        return false;
+    }
+    
+    auto event = InputBundleEvent::allocInputBundleEvent(_isHost, _pendingInput.turn, _pendingInput.fireKey,
+                                                         _pendingInput.firePos, _pendingInput.fireVel,
+                                                         _pendingInput.crateKey);
+    auto bundle = std::dynamic_pointer_cast<InputBundleEvent>(event);
+    _scheduler.stamp(bundle, _tick, LOCKSTEP_DELAY);
+    _lockstep.add(bundle, _tick);
+    sendEvent(event);
+    _pendingInput.clear();
+    _stats.count("lockstep.bundles");
+    
+    for(auto& e : _lockstep.release(_tick)){
+        processInputBundleEvent(e);
+    }
+    return true;
+}
+
+/**
+ * This method drops a peer from the lock-step simulation, as the host said.
+ *
+ * A peer can only have stepped past the tick if it had the bundle of the
+ * dropped peer, which the host never got. Its world then differs from the
+ * host, which is reported.
+ */
+void GameScene::processDropEvent(const std::shared_ptr<DropEvent>& event){
+    if (event->getTick() < _tick) {
+        CULogError("Peer %u was dropped at tick %llu, which we already stepped with it",
+                   event->getPeer(), (unsigned long long)event->getTick());
+        _stats.count("lockstep.late_drop");
+    }
+    if (_lockstep.drop(event->getPeer(), event->getTick())) {
+        CULog("Dropping peer %u from tick %llu", event->getPeer(), (unsigned long long)event->getTick());
+        _stats.count("lockstep.dropped");
+    }
+}
+
+/**
+ * This method applies the inputs of one peer for this tick (lock-step only).
+ *
+ * The host controls the left cannon, and every other peer the right one.
+ */
+void GameScene::processInputBundleEvent(const std::shared_ptr<InputBundleEvent>& event){
+    auto cannon = event->isFromHost() ? _cannon1 : _cannon2;
+    if (event->getTurn() != 0) {
+        cannon->setAngle(cannon->getAngle() + event->getTurn());
+    }
+    
+    Uint32 key = event->getFireKey();
+    if (key != 0) {
+        CrateState state(event->getFirePosition());
+        state.velocity = event->getFireVelocity();
+        auto pair = _crateFact->createObstacle(state, _scale, key);
+        _ids.bind(_world, pair.first, key);
+        linkSceneToObs(pair.first, pair.second);
+        _population.add(key, pair.first, pair.second, _tick);
+    }
+    
+    key = event->getBigCrateKey();
+    if (key != 0) {
+        auto crate = CrateEvent::allocCrateEvent(Vec2(DEFAULT_WIDTH/2,DEFAULT_HEIGHT/2), key);
+        processCrateEvent(std::dynamic_pointer_cast<CrateEvent>(crate));
+    }
+}
+
+/**
+ * This method reports the first tick our world differs from another peer.
+ *
+ * The snapshot of our world at that tick is written to the save directory.
+ * The other peer sees the same mismatch, and writes its own snapshot.
+ */
+void GameScene::reportDesync(Uint64 tick, Uint32 peer, Uint64 local, Uint64 remote){
+    Uint64 since = tick >= WORLD_HASH_INTERVAL ? tick-WORLD_HASH_INTERVAL : 0;
+    CULogError("World diverged from peer %u after tick %llu, by tick %llu (%016llx vs %016llx)", peer,
+               (unsigned long long)since, (unsigned long long)tick,
+               (unsigned long long)local, (unsigned long long)remote);
+    std::string path = Application::get()->getSaveDirectory() + "desync_" +
+                       std::to_string(getShortUID()) + "_" + std::to_string(tick) + ".txt";
+    if (_hasher.dump(tick, path)) {
+        CULog("Wrote the world at tick %llu to %s", (unsigned long long)tick, path.c_str());
+    }
+}
+
+/**
+ * This method chooses fired crates to despawn if there are too many.
+ *
+ * Only the host chooses, so that peers never remove different crates.
+ * The choice is broadcast as a single DespawnEvent.
+ */
+void GameScene::limitPopulation(){
+    if (!_isHost || _tick % POPULATION_INTERVAL != 0) {
+        return;
+    }
+    auto keys = _population.selectVictims(DESPAWN_SLACK);
+    if (!keys.empty()) {
+        auto event = DespawnEvent::allocDespawnEvent(keys);
+        _scheduler.stamp(std::dynamic_pointer_cast<TickedEvent>(event), _tick, DESPAWN_DELAY);
+        sendEvent(event);
+    }
+}
+
+/**
+ * This method reports that this peer is present, with its upstream load.
+ *
+ * The upstream load is an estimate, not a measurement: the number of awake
+ * obstacles owned by this peer, times the other peers, times the assumed
+ * STATE_UPDATE_BYTES, per second.
+ */
+void GameScene::sendPeerStatus(){
+    Uint32 owned = (Uint32)_world->getOwned().size();
+    Uint32 rate = (Uint32)(_upstreamBytes/(STATUS_INTERVAL*FIXED_TIMESTEP_S));
+    _upstreamBytes = 0;
+    sendEvent(PeerStatusEvent::allocPeerStatusEvent(getShortUID(), owned, rate, _topology.isRelaying()));
+}
+
+/**
+ * This method records the status report of a peer.
+ *
+ * The other peers follow the topology announced by the relay.
+ */
+void GameScene::processPeerStatusEvent(const std::shared_ptr<PeerStatusEvent>& event){
+    _partition.touch(event->getPeer(), _tick);
+    std::string prefix = "peer." + std::to_string(event->getPeer());
+    _stats.set(prefix + ".owned", event->getOwned());
+    _stats.set(prefix + ".upstream_est_Bps", event->getUpstream());
+
+    // The topology compares payloads, which do not depend on the fan-out
+    size_t receivers = _partition.getPeers().size();
+    if (receivers > 1) {
+        _topology.report(event->getPeer(), (Uint32)(event->getUpstream()/(receivers-1)));
+    }
+    if (event->getPeer() == _topology.getRelay() && event->getPeer() != getShortUID()) {
+        auto mode = event->isRelaying() ? Topology::Mode::RELAY : Topology::Mode::MESH;
+        if (_topology.follow(mode)) {
+            CULog("Following the %s topology", _topology.isRelaying() ? "relay" : "mesh");
+            applyTopology();
+        }
+    }
+}
+
+/**
+ * Returns the number of awake dynamic obstacles owned by this peer.
+ *
+ * These are the obstacles the network sends state updates for.
+ *
+ * @return the number of awake dynamic obstacles owned by this peer.
+ */
+size_t GameScene::countOwnedAwake() const {
+    size_t awake = 0;
+    for(auto it = _world->getOwned().begin(); it != _world->getOwned().end(); ++it) {
+        if (it->first->getBodyType() == b2_dynamicBody && it->first->isAwake()) {
+            awake++;
+        }
+    }
+    return awake;
+}
+
+/**
+ * Returns the obstacles with their ids, sorted by id.
+ *
+ * These are the obstacles the network controller would send this tick, as
+ * it sends every awake dynamic obstacle we own.
+ *
+ * @param all   Whether to include every obstacle, and not just those sent
+ *
+ * @return the obstacles with their ids, sorted by id.
+ */
+std::vector<std::pair<Uint64, physics2::Obstacle*>> GameScene::selectStateFrame(bool all) const {
+    std::vector<std::pair<Uint64, physics2::Obstacle*>> sent;
+    auto& ids = _world->getObjToId();
+    for(auto it = ids.begin(); it != ids.end(); ++it) {
+        physics2::Obstacle* obj = it->first.get();
+        if (all || (obj->getBodyType() == b2_dynamicBody && obj->isAwake() &&
+                    _world->getOwned().count(it->first))) {
+            sent.push_back(std::make_pair(it->second, obj));
+        }
+    }
+    std::sort(sent.begin(), sent.end());
+    return sent;
+}
+
+/**
+ * Returns the state records of the obstacles, sorted by id.
+ *
+ * This is the frame the network controller would send this tick, as it
+ * sends every awake dynamic obstacle we own.
+ *
+ * @param all   Whether to include every obstacle, and not just those sent
+ *
+ * @return the state records of the obstacles, sorted by id.
+ */
+std::vector<std::byte> GameScene::writeStateFrame(bool all) const {
+    auto sent = selectStateFrame(all);
+    LWSerializer serializer;
+    for(auto it = sent.begin(); it != sent.end(); ++it) {
+        physics2::Obstacle* obj = it->second;
+        serializer.writeUint64(it->first);
+        Vec2 pos = obj->getPosition();
+        Vec2 vel = obj->getLinearVelocity();
+        serializer.writeFloat(pos.x);
+        serializer.writeFloat(pos.y);
+        serializer.writeFloat(obj->getAngle());
+        serializer.writeFloat(vel.x);
+        serializer.writeFloat(vel.y);
+        serializer.writeFloat(obj->getAngularVelocity());
+    }
+    return serializer.serialize();
+}
+
+/**
+ * This method broadcasts a latency probe to the other peers.
+ *
+ * The probe echoes the last probe received from every other peer.
+ */
+void GameScene::sendProbe(){
+    Uint32 self = getShortUID();
+    Uint64 now = Timestamp().ellapsedMicros(_epoch);
+    _probeSeq++;
+    for(Uint32 peer : _partition.getPeers()) {
+        if (peer == self) {
+            continue;
+        }
+        auto it = _links.find(peer);
+        if (it == _links.end()) {
+            CongestionController link;
+            link.init(UPLINK_BUDGET, MIN_STATE_BUDGET, UPLINK_BUDGET, UPLINK_BUDGET/20.0f, 0.7f, QUEUE_DELAY_TARGET);
+            it = _links.emplace(peer, link).first;
+        }
+        it->second.probe(_probeSeq, now);
+    }
+    
+    // Echoes ride on our own probe, so nobody sends a separate answer
+    std::vector<PingEvent::Echo> echoes;
+    echoes.reserve(_echoes.size());
+    for(auto& entry : _echoes) {
+        PingEvent::Echo echo = entry.second;
+        echo.hold = now-echo.hold;
+        echoes.push_back(echo);
+    }
+    _echoes.clear();
+    sendEvent(PingEvent::allocPingEvent(self, _probeSeq, now, _tick, _isHost, echoes));
+}
+
+/**
+ * This method holds a probe for our next echo, and measures our own
+ * probes echoed by its origin.
+ */
+void GameScene::processPingEvent(const std::shared_ptr<PingEvent>& event){
+    Uint32 self = getShortUID();
+    Uint64 now = Timestamp().ellapsedMicros(_epoch);
+    if (event->getOrigin() == self) {
+        return;
+    }
+    PingEvent::Echo held;
+    held.origin = event->getOrigin();
+    held.seq = event->getSequence();
+    held.time = event->getTime();
+    held.hold = now;
+    _echoes[event->getOrigin()] = held;
+    
+    // Every peer sees every echo, but only the origin has the probe
+    for(auto& echo : event->getEchoes()) {
+        if (echo.origin != self || echo.hold > now-echo.time) {
+            continue;
+        }
+        // The time the echo was held is not part of the round trip
+        Uint64 arrival = now-echo.hold;
+        auto it = _links.find(event->getOrigin());
+        if (it != _links.end()) {
+            _stats.sample("link.rtt_ms", (arrival-echo.time)/1000.0f);
+            it->second.acknowledge(echo.seq, arrival);
+        }
+        // As if the probe left when the host sent its own, and was answered at once
+        if (event->isFromHost() && !_isHost) {
+            _clock.sample(echo.time+echo.hold, event->getTime(), event->getTick(), now);
+        }
+    }
+}
+
+/**
+ * This method keeps the tick of a client aligned with the host.
+ *
+ * Small errors are corrected by dilating the fixed step by a few
+ * percent. Large errors (e.g. right after the clock is synchronized)
+ * are corrected at once, but the tick never skips or repeats a tick:
+ * a peer that is behind steps through the missing ticks, applying the
+ * events due at each one, and a peer that is ahead waits.
+ */
+void GameScene::alignTick(){
+    // Lock-step ticks are paced by the slowest peer instead
+    if (_isHost || !_clock.isSynced() || LOCKSTEP_MODE) {
+        return;
+    }
+    Uint64 now = Timestamp().ellapsedMicros(_epoch);
+    double target = _clock.getTick(now);
+    double error = target-(double)_tick;
+    if (std::abs(error) > CLOCK_STEP_TICKS) {
+        Uint64 goal = (Uint64)std::max(0.0, std::round(target));
+        CULog("Moving tick %llu to %llu to match the host", (unsigned long long)_tick, (unsigned long long)goal);
+        _stats.count("clock.stepped");
+        if (goal > _tick) {
+            catchUp(goal);
+        } else {
+            // Events were stamped and hashes recorded for these ticks, so they never run twice
+            _heldTicks = _tick-goal;
+        }
+    }
+    _stats.sample("clock.tick_error", (float)error);
+    
+    // A dilation above 1 means we are behind, so the step gets shorter
+    double dilation = _clock.getDilation(now, _tick);
+    Application::get()->setFixedStep((Uint32)(_baseStep/dilation));
+}
+
+/**
+ * This method steps through the ticks up to the given one.
+ *
+ * Every missing tick is a full tick (see {@link #stepTick}), as the other
+ * peers ran it: its events are applied before the physics step, so that
+ * no queued event is released late, and its snapshots, hashes and digests
+ * are recorded.
+ *
+ * @param goal  The tick to catch up to
+ */
+void GameScene::catchUp(Uint64 goal){
+    while (_tick < goal && stepTick()) {
+        _stats.count("clock.caught_up");
+    }
+}
+
+/**
+ * Returns true if this peer can stamp times on the host clock.
+ *
+ * @return true if this peer can stamp times on the host clock.
+ */
+bool GameScene::hasSharedTime() const {
+    return _isHost || _clock.isSynced();
+}
+
+/**
+ * Returns the given time in microseconds of the host clock.
+ *
+ * The host clock is the time since the host scene started. This is only
+ * meaningful if {@link #hasSharedTime} is true.
+ *
+ * @param time  The local time
+ *
+ * @return the given time in microseconds of the host clock.
+ */
+Uint64 GameScene::getSharedTime(const Timestamp& time) const {
+    Uint64 local = time.ellapsedMicros(_epoch);
+    if (_isHost) {
+        return local;
+    }
+    return (Uint64)std::max(0.0, _clock.toRemote(local));
+}
+
+/**
+ * This method records the report of a peer that drew one of our crates.
+ */
+void GameScene::processLatencyEvent(const std::shared_ptr<LatencyEvent>& event){
+    // Every peer sees every report, but only the firing peer has the probe
+    if (ObstacleIds::getPeer(event->getKey()) != getShortUID()) {
+        return;
+    }
+    _latency.complete(event->getKey(), event->getCreateTime(), event->getLinkTime(), event->getPixelTime());
+}
+
+/**
+ * This method requests the obstacles our bodies keep pushing.
+ *
+ * On the host, it also answers every request received since the last
+ * tick, so that each obstacle is leased to at most one peer. Nothing is
+ * leased while the relay owns every obstacle.
+ */
+void GameScene::requestAuthority() {
+    // The relay owns every dynamic obstacle, so there is nothing to lease
+    if (_topology.isRelaying()) {
+        return;
+    }
+    auto& ids = _world->getObjToId();
+    std::vector<Uint64> requests;
+    for(auto& obj : _authority.update(_world, _tick)) {
+        auto it = ids.find(obj);
+        if (it != ids.end()) {
+            requests.push_back(it->second);
+        } else {
+            _authority.deny(obj, _tick);
+        }
+    }
+    // Requests are echoed back, so the host queues its own like any other
+    if (!requests.empty()) {
+        sendEvent(AuthorityEvent::allocRequestEvent(getShortUID(), requests));
+    }
+    if (_isHost) {
+        for(auto& verdict : _arbiter.resolve(_tick)) {
+            sendEvent(AuthorityEvent::allocGrantEvent(verdict.peer, verdict.granted, verdict.denied));
+        }
+    }
+}
+
+/**
+ * This method queues a lease request, or applies the host's answer.
+ *
+ * Requests only matter on the host. A grant only matters to the peer it
+ * is for, which acquires the granted obstacles.
+ */
+void GameScene::processAuthorityEvent(const std::shared_ptr<AuthorityEvent>& event){
+    if (!event->isGrant()) {
+        if (_isHost) {
+            _arbiter.request(event->getPeer(), event->getIds());
+        }
+        return;
+    }
+    if (event->getPeer() != getShortUID()) {
+        return;
+    }
+    auto& objs = _world->getIdToObj();
+    for(Uint64 id : event->getIds()) {
+        auto it = objs.find(id);
+        if (it != objs.end() && !it->second->isRemoved() && !_replay.isOpen()) {
+            _network->getPhysController()->acquireObs(it->second, AUTHORITY_LEASE);
+        }
+    }
+    for(Uint64 id : event->getDenied()) {
+        auto it = objs.find(id);
+        if (it != objs.end()) {
+            _authority.deny(it->second, _tick);
+        }
+    }
+}
+
+/**
+ * This method sends the state of the awake obstacles we own.
+ *
+ * The network controller applies its state updates without showing them
+ * to us, so the peers that draw our obstacles from their snapshot buffer
+ * need these frames. They only change how obstacles are drawn, so they are
+ * optional.
+ */
+void GameScene::sendStateFrame(){
+    auto sent = selectStateFrame(false);
+    if (sent.empty()) {
+        return;
+    }
+    std::vector<StateFrameEvent::Record> records;
+    records.reserve(sent.size());
+    for(auto it = sent.begin(); it != sent.end(); ++it) {
+        StateFrameEvent::Record record;
+        record.id = it->first;
+        record.pos = it->second->getPosition();
+        record.vel = it->second->getLinearVelocity();
+        record.angle = it->second->getAngle();
+        records.push_back(record);
+    }
+    if (sendOptionalEvent(StateFrameEvent::allocStateFrameEvent(getShortUID(), _tick, records))) {
+        _stats.count("snapshot.sent");
+    }
+}
+
+/**
+ * This method adds the states of a received frame to the snapshot buffer.
+ *
+ * The arrival of the frame is measured first, so that the render delay
+ * of its peer follows its transit time and jitter. States of obstacles we
+ * own (or do not know) are ignored.
+ */
+void GameScene::processStateFrameEvent(const std::shared_ptr<StateFrameEvent>& event){
+    if (!_interpolateRemote || event->getPeer() == getShortUID()) {
+        return;
+    }
+    _snapshots.arrive(event->getPeer(), event->getTick(), _tick);
+    auto& objs = _world->getIdToObj();
+    auto& owned = _world->getOwned();
+    for(auto& record : event->getRecords()) {
+        auto it = objs.find(record.id);
+        if (it == objs.end() || it->second->isRemoved() || owned.count(it->second)) {
+            continue;
+        }
+        SnapshotBuffer::Snapshot state;
+        state.tick = event->getTick();
+        state.pos = record.pos;
+        state.vel = record.vel;
+        state.angle = record.angle;
+        if (!_snapshots.receive(it->second.get(), event->getPeer(), state)) {
+            _stats.count("snapshot.reordered");
+        }
+    }
+}
+
+/**
+ * This method stamps the crates fired since the last network flush.
+ *
+ * It should be called right after the network controller sends its
+ * outgoing messages.
+ */
+void GameScene::markNetworkFlush() {
+    if (LATENCY_PROBE && hasSharedTime()) {
+        _latency.markPending(LatencyProbe::SEND, getSharedTime(Timestamp()));
+    }
+}
+
+/**
+ * Returns the short UID of this peer (or of the recorded peer on replay).
+ *
+ * @return the short UID of this peer.
+ */
+Uint32 GameScene::getShortUID() const {
+    return _replay.isOpen() ? _replay.getShortUID() : _network->getShortUID();
+}
+
+/**
+ * Returns the number of players (or of recorded players on replay).
+ *
+ * @return the number of players.
+ */
+Uint32 GameScene::getNumPlayers() const {
+    return _replay.isOpen() ? _replay.getNumPlayers() : _network->getNumPlayers();
+}
+
+/**
+ * This method sends an event to the network.
+ *
+ * The event is recorded if the session is recorded. On replay, the event
+ * is only counted, as its echo is part of the recording.
+ *
+ * @param event The event to send
+ */
+void GameScene::sendEvent(const std::shared_ptr<NetEvent>& event){
+    size_t size = event->serialize().size();
+    _eventBytes += size;
+    _sendTokens -= size;
+    if (_replay.isOpen()) {
+        _sentBytes += size;
+        return;
+    }
+    _recorder.recordOut(event);
+    _network->pushOutEvent(event);
+}
+
+/**
+ * This method sends an event only if the links have room for it.
+ *
+ * This is for events that only measure the session (hashes, digests,
+ * acknowledgements and latency reports). Events the game needs are sent
+ * with {@link #sendEvent}, which always sends them.
+ *
+ * @param event The event to send
+ *
+ * @return true if the event was sent
+ */
+bool GameScene::sendOptionalEvent(const std::shared_ptr<NetEvent>& event){
+    if (CONGESTION_CONTROL && _sendTokens < event->serialize().size()) {
+        _stats.count("congestion.skipped");
+        return false;
+    }
+    sendEvent(event);
+    return true;
+}
+
+/**
+ * This method takes the next inbound event, if any.
+ *
+ * The event is recorded if the session is recorded. On replay, the event
+ * comes from the recording instead of the network.
+ *
+ * @param event The inbound event
+ *
+ * @return true if there was an inbound event
+ */
+bool GameScene::receiveEvent(std::shared_ptr<NetEvent>& event){
+    if (_replay.isOpen()) {
+        if (!_replay.isInAvailable()) {
+            return false;
+        }
+        event = _replay.popInEvent();
+        return true;
+    }
+    if (!_network->isInAvailable()) {
+        return false;
+    }
+    event = _network->popInEvent();
+    _recorder.recordIn(event);
+    return true;
+}
+
+/**
+ * This method adapts the state budget of every link once per period.
+ *
+ * The smallest budget caps how many obstacles this peer may lease, as
+ * every owned awake obstacle costs a state update each tick.
+ */
+void GameScene::updateCongestion(){
+    if (_links.empty()) {
+        return;
+    }
+    Uint64 now = Timestamp().ellapsedMicros(_epoch);
+    // Events are measured; the state is the estimate of every owned awake obstacle
+    Uint64 used = _upstreamBytes/_links.size()+_eventBytes;
+    _eventBytes = 0;
+    float budget = UPLINK_BUDGET;
+    for(auto it = _links.begin(); it != _links.end(); ++it) {
+        it->second.update(now, used);
+        budget = std::min(budget, it->second.getBudget());
+        std::string prefix = "link." + std::to_string(it->first);
+        _stats.set(prefix + ".budget_Bps", (Uint64)it->second.getBudget());
+        _stats.set(prefix + ".queue_us", it->second.getQueueDelay());
+    }
+    
+    _sendBudget = budget;
+    if (CONGESTION_CONTROL) {
+        // Leases come on top of what we own already, so they get what is left
+        size_t affordable = (size_t)(budget*FIXED_TIMESTEP_S/STATE_UPDATE_BYTES);
+        size_t baseline = countOwnedAwake();
+        baseline = baseline > _authority.getLeased() ? baseline-_authority.getLeased() : 0;
+        _authority.setLimit(affordable > baseline ? affordable-baseline : 0);
+        _stats.set("authority.limit", affordable > baseline ? affordable-baseline : 0);
+    }
+}
+
+/**
+ * This method drops the peers that have gone silent.
+ *
+ * The init crates are then reassigned over the remaining peers. On the
+ * relay, the topology is then reevaluated against the reported loads.
+ */
+void GameScene::updatePeers(){
+    if (_partition.expire(getShortUID(), _tick, PEER_TIMEOUT)) {
+        auto& peers = _partition.getPeers();
+        for(auto it = _links.begin(); it != _links.end(); ) {
+            if (std::find(peers.begin(), peers.end(), it->first) == peers.end()) {
+                it = _links.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        _topology.retain(peers);
+        rebalanceOwnership();
+    }
+    if (getShortUID() == _topology.getRelay()) {
+        if (_topology.select()) {
+            CULog("Switched to the %s topology", _topology.isRelaying() ? "relay" : "mesh");
+            applyTopology();
+        } else if (_topology.isRelaying()) {
+            // Crates fired by the other peers since the last report
+            applyTopology();
+        }
+    }
+    _stats.set("topology.relay_active", _topology.isRelaying());
+}
+
+/**
+ * This method moves ownership to match the topology in use.
+ *
+ * The physics controller broadcasts the updates of the obstacles a peer
+ * owns, so the relay carries every update by owning every dynamic obstacle
+ * (except the cannons). The other peers then only send inputs and events.
+ * Back in the mesh, the init crates are reassigned over the peers, and
+ * obstacles are leased again as they are pushed.
+ */
+void GameScene::applyTopology(){
+    if (LOCKSTEP_MODE || _replay.isOpen()) {
+        return;
+    }
+    if (!_topology.isRelaying()) {
+        rebalanceOwnership();
+        return;
+    }
+    if (getShortUID() != _topology.getRelay()) {
+        return;
+    }
+    auto& owned = _world->getOwned();
+    for(auto it = _world->getObjToId().begin(); it != _world->getObjToId().end(); ++it) {
+        const std::shared_ptr<physics2::Obstacle>& obj = it->first;
+        if (obj == _cannon1 || obj == _cannon2 || obj->getBodyType() != b2_dynamicBody) {
+            continue;
+        }
+        if (obj->isEnabled() && !obj->isRemoved() && owned.find(obj) == owned.end()) {
+            _network->getPhysController()->acquireObs(obj, 0);
+            _stats.count("topology.acquired");
+        }
+    }
+}
+
+/**
+ * This method reassigns the init crates over the remaining peers.
+ *
+ * Every remaining peer acquires the crates newly assigned to it.
+ */
+void GameScene::rebalanceOwnership(){
+    if (LOCKSTEP_MODE || _replay.isOpen() || _partition.getMode() == OwnershipPartition::Mode::HOST) {
+        return;
+    }
+    CULog("Reassigning crates over %zu peers", _partition.getPeers().size());
+    _stats.count("partition.rebalanced");
+    auto& owned = _world->getOwned();
+    for(auto& obj : _partition.getAssigned(getShortUID())) {
+        if (owned.find(obj) == owned.end()) {
+            _network->getPhysController()->acquireObs(obj, 0);
+            _stats.count("partition.acquired");
+        }
+    }
+}
+
+/**
+ * Lays out the game geography.
+ *
+ * Pay close attention to how we attach physics objects to a scene graph.
+ * The simplest way is to make a subclass.  However,
+ * for simple objects you can just use a callback function to lightly couple
+ * them.  This is what we do with the crates.
+ *
+ * This method is really, really long.  In practice, you would replace this
+ * with your serialization loader, which would process a level file.
+ */
+void GameScene::populate() {
+    _partition.clear();
+    _world = physics2::ObstacleWorld::alloc(Rect(0,0,DEFAULT_WIDTH,DEFAULT_HEIGHT),Vec2(0,DEFAULT_GRAVITY));
+    _world->activateCollisionCallbacks(true);
+    _world->onBeginContact = [this](b2Contact* contact) {
+        beginContact(contact);
+    };
+    _world->beforeSolve = [this](b2Contact* contact, const b2Manifold* oldManifold) {
+        beforeSolve(contact,oldManifold);
+    };
+    
+    
+    std::shared_ptr<Texture> image;
+    
+#pragma mark : Crate batches
+    // One instanced renderer per crate texture, drawn beneath everything else
+    _crateBatches.clear();
+    if (INSTANCED_CRATES) {
+        for (int ii = 1; ii <= NUM_CRATE_TYPES; ii++) {
+            std::string name = (CRATE_PREFIX "0") + std::to_string(ii);
+            auto batch = CrateBatchNode::allocWithTexture(_assets->get<Texture>(name), 0.5f);
+            batch->setSnapshots(_interpolateRemote ? &_snapshots : nullptr);
+            _crateBatches.push_back(batch);
+            _worldnode->addChild(batch);
+        }
+    }
+    _crateFact->setBatches(_crateBatches);
+        
+#pragma mark : Wall polygon 1
+        
+    // Create ground pieces
+    // All walls share the same texture
+    image  = _assets->get<Texture>(EARTH_TEXTURE);
+    std::string wname = "wall";
+
+    // Create the polygon outline
+    Poly2 wall1(reinterpret_cast<Vec2*>(WALL1),11);
+    EarclipTriangulator triangulator;
+    triangulator.set(wall1.vertices);
+    triangulator.calculate();
+    wall1.setIndices(triangulator.getTriangulation());
+    triangulator.clear();
+
+    //std::shared_ptr<physics2::PolygonObstacle> wallobj;
+    wallobj1 = physics2::PolygonObstacle::allocWithAnchor(wall1,Vec2::ANCHOR_CENTER);
+    wallobj1->setDebugColor(STATIC_COLOR);
+    wallobj1->setName(wname);
+
+    // Set the physics attributes
+    wallobj1->setBodyType(b2_staticBody);
+    wallobj1->setDensity(BASIC_DENSITY);
+    wallobj1->setFriction(BASIC_FRICTION);
+    wallobj1->setRestitution(BASIC_RESTITUTION);
+
+    // Add the scene graph nodes to this object
+    wall1 *= _scale;
+    wallsprite1 = scene2::PolygonNode::allocWithTexture(image,wall1);
+    
+#pragma mark : Wall polygon 2
+    Poly2 wall2(reinterpret_cast<Vec2*>(WALL2),9);
+    triangulator.set(wall2.vertices);
+    triangulator.calculate();
+    wall2.setIndices(triangulator.getTriangulation());
+    triangulator.clear();
+
+    wallobj2 = physics2::PolygonObstacle::allocWithAnchor(wall2,Vec2::ANCHOR_CENTER);
+    wallobj2->setDebugColor(STATIC_COLOR);
+    wallobj2->setName(wname);
+
+    // Set the physics attributes
+    wallobj2->setBodyType(b2_staticBody);
+    wallobj2->setDensity(BASIC_DENSITY);
     wallobj2->setFriction(BASIC_FRICTION);
     wallobj2->setRestitution(BASIC_RESTITUTION);
 
@@ -534,16 +2225,16 @@ void GameScene::populate() {
     wallsprite2 = scene2::PolygonNode::allocWithTexture(image,wall2);
         
 #pragma mark : Crates
-    float f1 = _rand() % (int)(DEFAULT_WIDTH - 4) + 2;
-    float f2 = _rand() % (int)(DEFAULT_HEIGHT - 4) + 2;
+    float f1 = _rand.below((int)(DEFAULT_WIDTH - 4)) + 2;
+    float f2 = _rand.below((int)(DEFAULT_HEIGHT - 4)) + 2;
     Vec2 boxPos(f1, f2);
         
     for (int ii = 0; ii < NUM_CRATES; ii++) {
-        f1 = _rand() % (int)(DEFAULT_WIDTH - 6) + 3;
-        f2 = _rand() % (int)(DEFAULT_HEIGHT - 6) + 3;
+        f1 = _rand.below((int)(DEFAULT_WIDTH - 6)) + 3;
+        f2 = _rand.below((int)(DEFAULT_HEIGHT - 6)) + 3;
         // Pick a crate and random and generate the key
         Vec2 boxPos(f1, f2);
-        addInitCrate(boxPos);
+        addInitCrate(boxPos, ii);
     }
         
 #pragma mark : Cannon
@@ -572,16 +2263,43 @@ void GameScene::populate() {
     addInitObstacle(wallobj2, wallsprite2);  // All walls share the same texture
     addInitObstacle(_cannon1, _cannon1Node);
     addInitObstacle(_cannon2, _cannon2Node);
+    
+    // Each peer starts out owning its own share of the crates
+    for(auto& obj : _partition.getAssigned(getShortUID())) {
+        _world->getOwned().insert({obj,0});
+    }
+    
+    // Pool after the level is laid out, so that only spawns draw from it
+    if (CRATE_POOL_SIZE > 0) {
+        _crateFact->prewarm(_world, CRATE_POOL_SIZE, _scale);
+    }
+    
+    // Every peer lays out the same level, so every peer has the same dictionary
+    _codec.init(writeStateFrame(true));
+    _codec.setStats(&_stats);
 }
 
 void GameScene::linkSceneToObs(const std::shared_ptr<physics2::Obstacle>& obj,
     const std::shared_ptr<scene2::SceneNode>& node) {
+    if (LATENCY_PROBE && hasSharedTime()) {
+        _latency.link(obj.get(), getSharedTime(Timestamp()));
+    }
+
+    // Instanced crates are drawn by their batch node, not the proxy
+    auto batch = _crateFact->getBatch(node);
+    if (batch != nullptr) {
+        batch->add(obj);
+        return;
+    }
 
     node->setPosition(obj->getPosition() * _scale);
     _worldnode->addChild(node);
 
     // Dynamic objects need constant updating
-    if (obj->getBodyType() == b2_dynamicBody) {
+    if (obj->getBodyType() == b2_dynamicBody && _batchSync) {
+        _transformSync.add(obj, node);
+    }
+    else if (obj->getBodyType() == b2_dynamicBody) {
         scene2::SceneNode* weak = node.get(); // No need for smart pointer in callback
         obj->setListener([=](physics2::Obstacle* obs) {
             float leftover = Application::get()->getLeftOver() / 1000000.f;
@@ -593,6 +2311,28 @@ void GameScene::linkSceneToObs(const std::shared_ptr<physics2::Obstacle>& obj,
     }
 }
 
+/**
+ * Sets whether remote obstacles are drawn from the snapshot buffer.
+ *
+ * If true, every peer sends the state of its awake obstacles in frames of
+ * its own, and obstacles owned by other peers are drawn from the received
+ * frames, interpolated a short delay in the past. The delay of each peer
+ * follows the transit time and jitter of its frames. Otherwise they are
+ * drawn at their extrapolated physics pose, as corrected by the network
+ * controller. This only affects batched and instanced nodes.
+ *
+ * @param value whether remote obstacles are drawn from the snapshot buffer.
+ */
+void GameScene::setRemoteInterpolation(bool value) {
+    _interpolateRemote = value;
+    _snapshots.clear();
+    const SnapshotBuffer* source = value ? &_snapshots : nullptr;
+    _transformSync.setSnapshots(source);
+    for (auto it = _crateBatches.begin(); it != _crateBatches.end(); ++it) {
+        (*it)->setSnapshots(source);
+    }
+}
+
 /**
  * Adds the physics object to the physics world and loosely couples it to the scene graph
  *
@@ -623,7 +2363,26 @@ union {
 
 #if USING_PHYSICS
 void GameScene::preUpdate(float dt) {
-    _input.update(dt);
+    if (_replay.isOpen()) {
+        const SessionInput& frame = _replay.getInput();
+        _input.replay(frame.vertical, frame.power,
+                      frame.flags & SessionInput::FIRED, frame.flags & SessionInput::VOLLEY,
+                      frame.flags & SessionInput::BIG_CRATE, frame.flags & SessionInput::DEBUG);
+    } else {
+        _input.update(dt);
+    }
+    if (_recorder.isOpen()) {
+        SessionInput frame;
+        frame.flags = (_input.didFire() ? SessionInput::FIRED : 0) |
+                      (_input.didVolley() ? SessionInput::VOLLEY : 0) |
+                      (_input.didBigCrate() ? SessionInput::BIG_CRATE : 0) |
+                      (_input.didDebug() ? SessionInput::DEBUG : 0) |
+                      (_input.getVertical() != 0 ? SessionInput::TURN : 0);
+        frame.vertical = _input.getVertical();
+        // The power only matters when firing, so charging frames stay identical
+        frame.power = _input.didFire() ? _input.getFirePower() : 0;
+        _recorder.recordFrame(frame, dt);
+    }
     
     if(_input.getFirePower()>0.f){
         _chargeBar->setVisible(true);
@@ -641,44 +2400,347 @@ void GameScene::preUpdate(float dt) {
         Application::get()->quit();
     }
     
-    if (_input.didFire()) {
-        fireCrate();
+    // Unattended probe runs fire on their own, as if the key was just released
+    bool autofire = LATENCY_AUTOFIRE > 0 && _tick >= _autoFireTick;
+    if (_input.didFire() || autofire) {
+        Timestamp input = autofire ? Timestamp() : _input.getFireTime();
+        Uint32 key = LOCKSTEP_MODE ? queueFire() : fireCrate();
+        if (LATENCY_PROBE && hasSharedTime()) {
+            _latency.mark(key, LatencyProbe::INPUT, getSharedTime(input));
+            _latency.mark(key, LatencyProbe::FIRE, getSharedTime(Timestamp()));
+        }
+        if (autofire) {
+            _autoFireTick = _tick+LATENCY_AUTOFIRE;
+        }
+    }
+    
+    if (_input.didVolley()) {
+        fireVolley();
     }
     
 //TODO: if _input.didBigCrate(), allocate a crate event for the center of the screen(use DEFAULT_WIDTH/2 and DEFAULT_HEIGHT/2) and send it using the pushOutEvent() method in the network controller.
 #pragma mark BEGIN SOLUTION
     if (_input.didBigCrate()){
         CULog("BIG CRATE COMING");
-        _network->pushOutEvent(CrateEvent::allocCrateEvent(Vec2(DEFAULT_WIDTH/2,DEFAULT_HEIGHT/2)));
+        Uint32 key = _ids.reserve();
+        _inputTimes[key] = Timestamp();
+        if (LOCKSTEP_MODE) {
+            _pendingInput.crateKey = key;
+        } else {
+            pushTickedEvent(CrateEvent::allocCrateEvent(Vec2(DEFAULT_WIDTH/2,DEFAULT_HEIGHT/2), key));
+        }
     }
 #pragma mark END SOLUTION
     
     float turnRate = _isHost ? DEFAULT_TURN_RATE : -DEFAULT_TURN_RATE;
     auto cannon = _isHost ? _cannon1 : _cannon2;
-    cannon->setAngle(_input.getVertical() * turnRate + cannon->getAngle());
+    if (LOCKSTEP_MODE) {
+        // The turn is applied with the bundle, on every peer at once
+        _pendingInput.turn += _input.getVertical() * turnRate;
+    } else if (PROPERTY_BATCHING) {
+        // Written (and sent) at most once per tick, and only if changed
+        _props.setAngle(cannon, _input.getVertical() * turnRate + _props.getAngle(cannon));
+    } else {
+        cannon->setAngle(_input.getVertical() * turnRate + cannon->getAngle());
+        _stats.count("props.set");
+        _stats.count("props.written");
+        _stats.count(_input.getVertical() == 0 ? "cannon.idle_writes" : "cannon.turn_writes");
+    }
 }
 
 void GameScene::postUpdate(float dt) {
-    //Nothing to do now
+    // Read the leftover once for all batched nodes
+    float leftover = Application::get()->getLeftOver() / 1000000.f;
+    if (_interpolateRemote) {
+        _snapshots.setRenderTime(leftover, FIXED_TIMESTEP_S);
+    }
+    if (_batchSync) {
+        _transformSync.update(leftover, _scale);
+    }
+    for (auto it = _crateBatches.begin(); it != _crateBatches.end(); ++it) {
+        (*it)->update(leftover, _scale);
+    }
+    
+    // Nothing refers to the recycled crates any more
+    _crateFact->reclaim();
+    
+    // The crates linked since the last frame are drawn by this one
+    if (LATENCY_PROBE && hasSharedTime()) {
+        Uint32 self = getShortUID();
+        auto drawn = _latency.markPending(LatencyProbe::PIXEL, getSharedTime(Timestamp()));
+        for(Uint32 key : drawn) {
+            LatencyProbe::Record record;
+            _latency.take(key, record);
+            sendOptionalEvent(LatencyEvent::allocLatencyEvent(self, key,
+                                                              record.times[LatencyProbe::CREATE],
+                                                              record.times[LatencyProbe::LINK],
+                                                              record.times[LatencyProbe::PIXEL]));
+        }
+    }
 }
 
 void GameScene::fixedUpdate() {
+    // A peer ahead of the host waits, leaving received events for later
+    if (_heldTicks > 0) {
+        _heldTicks--;
+        _stats.count("clock.held");
+        return;
+    }
+    if (!stepTick()) {
+        return;
+    }
+    // Replays run as fast as they can, so wall clock alignment is meaningless
+    if (!_replay.isOpen()) {
+        alignTick();
+    }
+}
+
+/**
+ * This method runs one fixed tick of the simulation.
+ *
+ * This is all the work of a tick: receiving and applying events, the
+ * physics step, the snapshots, hashes and digests, and the periodic
+ * reports. A peer that catches up with the host runs this for every tick
+ * it missed, so that none of it is skipped.
+ *
+ * @return false if the tick is waiting for the inputs of other peers
+ */
+bool GameScene::stepTick() {
+    Timestamp start;
+    _recorder.recordTick();
+    
+    if (EVENT_STORM > 0) {
+        sendEventStorm();
+    }
+    
     //TODO: check for available incoming events from the network controller and call processCrateEvent if it is a CrateEvent.
     
     //Hint: You can check if ptr points to an object of class A using std::dynamic_pointer_cast<A>(ptr). You should always check isInAvailable() before popInEvent().
     
 #pragma mark BEGIN SOLUTION
-    if(_network->isInAvailable()){
-        auto e = _network->popInEvent();
-        if(auto crateEvent = std::dynamic_pointer_cast<CrateEvent>(e)){
-            CULog("BIG CRATE GOT");
-            processCrateEvent(crateEvent);
+    std::shared_ptr<NetEvent> e;
+    while(receiveEvent(e)){
+        // Input bundles gate the tick itself, so they skip the scheduler
+        if(auto bundle = std::dynamic_pointer_cast<InputBundleEvent>(e)){
+            _lockstep.add(bundle, _tick);
+        }
+        else if(auto dropEvent = std::dynamic_pointer_cast<DropEvent>(e)){
+            processDropEvent(dropEvent);
+        }
+        // Events wait for their tick, so every peer applies them at the same point
+        else if(auto ticked = std::dynamic_pointer_cast<TickedEvent>(e)){
+            _scheduler.schedule(ticked, _tick);
+        }
+        else if(auto ackEvent = std::dynamic_pointer_cast<SpawnAckEvent>(e)){
+            processSpawnAckEvent(ackEvent);
+        }
+        else if(auto statusEvent = std::dynamic_pointer_cast<PeerStatusEvent>(e)){
+            processPeerStatusEvent(statusEvent);
+        }
+        else if(auto pingEvent = std::dynamic_pointer_cast<PingEvent>(e)){
+            processPingEvent(pingEvent);
+        }
+        else if(auto latencyEvent = std::dynamic_pointer_cast<LatencyEvent>(e)){
+            processLatencyEvent(latencyEvent);
+        }
+        else if(auto hashEvent = std::dynamic_pointer_cast<WorldHashEvent>(e)){
+            if (hashEvent->getPeer() != getShortUID()) {
+                _hasher.receive(hashEvent->getPeer(), hashEvent->getTick(), hashEvent->getHash());
+            }
+        }
+        else if(auto digestEvent = std::dynamic_pointer_cast<IdDigestEvent>(e)){
+            if (digestEvent->getPeer() != getShortUID()) {
+                _ids.receive(digestEvent->getPeer(), digestEvent->getTick(), digestEvent->getDigest());
+            }
+        }
+        else if(auto authorityEvent = std::dynamic_pointer_cast<AuthorityEvent>(e)){
+            processAuthorityEvent(authorityEvent);
+        }
+        else if(auto frameEvent = std::dynamic_pointer_cast<StateFrameEvent>(e)){
+            processStateFrameEvent(frameEvent);
         }
     }
 #pragma mark END SOLUTION
+    
+    if (LOCKSTEP_MODE && !stepLockstep()) {
+        return false;
+    }
+    
+    for(auto& e : _scheduler.release(_tick)){
+        processTickedEvent(e);
+    }
+    limitPopulation();
+    
+    // Coalesced property changes go out as one write per field
+    if (PROPERTY_BATCHING) {
+        size_t written = _props.flush();
+        _stats.count(_input.getVertical() == 0 ? "cannon.idle_writes" : "cannon.turn_writes", written);
+    }
+    _stats.count(_input.getVertical() == 0 ? "cannon.idle_ticks" : "cannon.turn_ticks");
+    
+    // The network applied its corrections since the last step
+    _authority.measure(_world);
     _world->update(FIXED_TIMESTEP_S);
+    _predictor.update();
+    _authority.record(_world);
+    
+    // Remote obstacles are drawn from the frames of their owners
+    if (_interpolateRemote) {
+        _snapshots.prune(_world, _tick);
+        if (!LOCKSTEP_MODE && _tick % SNAPSHOT_INTERVAL == 0) {
+            sendStateFrame();
+        }
+    }
+    
+    // Every peer hashes the same tick, right after stepping it
+    if (WORLD_HASH_INTERVAL > 0 && _tick % WORLD_HASH_INTERVAL == 0) {
+        Uint64 hash = _hasher.compute(_world, _tick);
+        sendOptionalEvent(WorldHashEvent::allocWorldHashEvent(getShortUID(), _tick, hash));
+    }
+    if (IDS_DIGEST_INTERVAL > 0 && _tick % IDS_DIGEST_INTERVAL == 0) {
+        Uint64 digest = _ids.record(_tick);
+        sendOptionalEvent(IdDigestEvent::allocIdDigestEvent(getShortUID(), _tick, digest));
+    }
+    
+    // The codec is a measurement harness only: the controller sends its own
+    // frames, so we encode ours here to measure it, and never send the result
+    if (_codedFrames < CODEC_CORPUS) {
+        auto frame = writeStateFrame(false);
+        if (!frame.empty()) {
+            std::vector<std::byte> decoded;
+            if (!_codec.decode(_codec.encode(frame), decoded) || decoded != frame) {
+                _stats.count("codec.mismatch");
+            }
+            if (++_codedFrames == CODEC_CORPUS) {
+                _stats.report("Codec measurements", "codec.");
+            }
+        }
+    }
+    
+    // Every awake obstacle we own is sent to every other peer. The controller
+    // does not report what it sends, so this is an estimate from a model.
+    if (!LOCKSTEP_MODE) {
+        size_t receivers = _partition.getPeers().empty() ? 0 : _partition.getPeers().size()-1;
+        Uint64 bytes = countOwnedAwake()*receivers*STATE_UPDATE_BYTES;
+        _upstreamBytes += bytes;
+        _stateBytes += bytes;
+        
+        // Optional events get what the state leaves of the budget, up to a second of it
+        float spare = _sendBudget*FIXED_TIMESTEP_S-(receivers > 0 ? bytes/receivers : 0);
+        _sendTokens = std::min(_sendTokens+spare, _sendBudget);
+        
+        // Take over the obstacles our own bodies keep pushing, once the host agrees
+        requestAuthority();
+    }
+    
+    // Crates despawned this tick may be reused from the next one
+    _crateFact->restock();
+    _tick++;
+    if (_tick % PROBE_INTERVAL == 0) {
+        sendProbe();
+    }
+    if (_tick % STATUS_INTERVAL == 0) {
+        updateCongestion();
+        sendPeerStatus();
+        updatePeers();
+        if (LATENCY_PROBE && hasSharedTime()) {
+            _latency.expire(getSharedTime(Timestamp()));
+        }
+    }
+    Timestamp end;
+    _stats.sample("tick.time_us", (float)end.ellapsedMicros(start));
+    if (_tick % STATS_INTERVAL == 0) {
+        _stats.set("spawn.pool", _crateFact->getPoolSize());
+        _stats.set("world.fired", _population.size());
+        _stats.set("world.obstacles", _world->getObstacles().size());
+        _stats.set("scene.nodes", _worldnode->getChildCount());
+        _stats.setMemory("mem");
+        _stats.set("authority.leased", _authority.getLeased());
+        if (_interpolateRemote) {
+            _stats.set("snapshot.tracks", _snapshots.size());
+            for(Uint32 peer : _partition.getPeers()) {
+                if (peer != getShortUID()) {
+                    std::string prefix = "snapshot." + std::to_string(peer);
+                    _stats.sample(prefix + ".delay_ticks", _snapshots.getDelay(peer));
+                    _stats.sample(prefix + ".jitter_ticks", _snapshots.getJitter(peer));
+                }
+            }
+        }
+        if (_clock.isSynced()) {
+            Uint64 now = Timestamp().ellapsedMicros(_epoch);
+            _stats.sample("clock.offset_ms", (float)(_clock.getOffset(now)/1000));
+            _stats.sample("clock.drift_ppm", (float)_clock.getDrift());
+        }
+        _stats.report("Tick " + std::to_string(_tick));
+    }
+    return true;
 }
 
+/**
+ * This method spawns a recorded shared crate (replay only).
+ *
+ * The factory notifies the spawn listener, as when the physics controller
+ * spawned the crate live, and the crate is added to the world the same way.
+ *
+ * @param params    The recorded factory parameters
+ */
+void GameScene::replaySpawn(const std::vector<std::byte>& params){
+    auto pair = _crateFact->createObstacle(params);
+    _world->addObstacle(pair.first);
+    linkSceneToObs(pair.first, pair.second);
+}
+
+/**
+ * Replays the recorded session as fast as possible, and reports.
+ *
+ * Every frame is stepped with its recorded time, and ends after the ticks
+ * it stepped, as in a live session. The report compares the bytes sent
+ * on replay with the recording, and the tick times are reported as
+ * during a live session.
+ */
+void GameScene::replay() {
+    if (!_replay.isOpen()) {
+        return;
+    }
+    Uint64 frames = 0;
+    Uint64 ticks = 0;
+    Uint64 spawns = 0;
+    float dt = 0;
+    Timestamp start;
+    for(auto step = _replay.next(); step != SessionReplay::DONE; step = _replay.next()) {
+        if (step == SessionReplay::FRAME) {
+            if (frames > 0) {
+                postUpdate(dt);
+            }
+            dt = _replay.getFrameTime();
+            preUpdate(dt);
+            frames++;
+        } else if (step == SessionReplay::SPAWN) {
+            replaySpawn(_replay.getSpawn());
+            spawns++;
+        } else {
+            fixedUpdate();
+            ticks++;
+        }
+    }
+    if (frames > 0) {
+        postUpdate(dt);
+    }
+    Timestamp end;
+    
+    if (!_replay.isComplete()) {
+        CULogError("The recorded session was cut short, so it has no totals to compare");
+    }
+    _stats.set("replay.frames", frames);
+    _stats.set("replay.ticks", ticks);
+    _stats.set("replay.spawns", spawns);
+    _stats.set("replay.time_ms", end.ellapsedMillis(start));
+    _stats.set("replay.sent_bytes", _sentBytes);
+    _stats.set("replay.recorded_sent_bytes", _replay.getSentBytes());
+    _stats.set("replay.state_est_bytes", _stateBytes);
+    _stats.set("replay.recorded_state_est_bytes", _replay.getStateBytes());
+    _stats.report("Replay");
+}
 
 #else
 /**
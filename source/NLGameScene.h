@@ -20,13 +20,73 @@
 #include <vector>
 #include <format>
 #include <string>
-#include <random>
+#include <unordered_map>
+#include <unordered_set>
+#include "RDRandom.h"
 #include "NLInput.h"
 #include "NLCrateEvent.h"
+#include "NLTransformSync.h"
+#include "NLCrateBatchNode.h"
+#include "NLSnapshotBuffer.h"
+#include "NLStats.h"
+#include "NLPopulation.h"
+#include "NLDespawnEvent.h"
+#include "NLSpawnEvent.h"
+#include "NLPropertyBatch.h"
+#include "NLObstacleIds.h"
+#include "NLEventScheduler.h"
+#include "NLSpawnPrediction.h"
+#include "NLSpawnAckEvent.h"
+#include "NLAuthority.h"
+#include "NLAuthorityEvent.h"
+#include "NLPartition.h"
+#include "NLPeerStatusEvent.h"
+#include "NLTopology.h"
+#include "NLPingEvent.h"
+#include "NLCongestion.h"
+#include "NLClockSync.h"
+#include "NLLatencyProbe.h"
+#include "NLLatencyEvent.h"
+#include "NLFrameCodec.h"
+#include "NLLockstep.h"
+#include "NLDropEvent.h"
+#include "NLWorldHash.h"
+#include "NLWorldHashEvent.h"
+#include "NLIdDigestEvent.h"
+#include "NLRecorder.h"
+#include "NLStateFrameEvent.h"
 
 using namespace cugl::netphysics;
 using namespace cugl;
 
+/**
+ * The initial state of a spawned crate.
+ *
+ * This is carried inside the creation message, so that every peer creates
+ * the crate in exactly the state it was launched in, rather than creating
+ * it at rest and receiving the launch as a separate property change.
+ */
+struct CrateState {
+    /** The initial position */
+    Vec2 position;
+    /** The initial angle */
+    float angle;
+    /** The initial linear velocity */
+    Vec2 velocity;
+    /** The initial angular velocity */
+    float angularVelocity;
+    /** Whether the crate uses continuous collision detection */
+    bool bullet;
+    /** Whether the crate is prevented from rotating */
+    bool fixedRotation;
+
+    /**
+     * Creates the state of a crate at rest at the given position.
+     */
+    CrateState(Vec2 pos = Vec2::ZERO) : position(pos), angle(0), angularVelocity(0),
+    bullet(false), fixedRotation(false) {}
+};
+
 /**
  * The factory class for crate objects.
  *
@@ -35,15 +95,65 @@ using namespace cugl;
  * clients in the simulations.
  */
 class CrateFactory : public cugl::netphysics::ObstacleFactory {
+protected:
+    /** A crate obstacle with its scene node, kept for reuse */
+    struct CrateSlot {
+        /** The crate obstacle */
+        std::shared_ptr<physics2::BoxObstacle> obstacle;
+        /** The scene node (or proxy node) for the crate */
+        std::shared_ptr<scene2::SceneNode> node;
+        /** The crate type (index into the pool) */
+        int type;
+    };
+
+    /** Whether crates are recycled through a pool instead of being reallocated */
+    bool _pooled;
+    /** The free crates outside the world, indexed by crate type */
+    std::vector<std::vector<CrateSlot>> _pool;
+    /** Recycled crates whose bodies have not yet been released by the world */
+    std::vector<CrateSlot> _pending;
+    /** The free resident crates (in the world, body disabled), indexed by crate type */
+    std::vector<std::vector<CrateSlot>> _parked;
+    /** Resident crates recycled this tick, which are not reused before the next one */
+    std::vector<CrateSlot> _parking;
+    /** The crates that stay in the world between uses */
+    std::unordered_set<const physics2::Obstacle*> _residents;
+    /** The batch nodes that draw instanced crates, indexed by crate type */
+    std::vector<std::shared_ptr<CrateBatchNode>> _batches;
+    /** The statistics log for allocation counts and spawn latency (may be null) */
+    NetLabStats* _stats;
+    /** The listener notified of every crate spawned from serialized parameters */
+    std::function<void(Uint32, const std::shared_ptr<physics2::Obstacle>&,
+                       const std::shared_ptr<scene2::SceneNode>&,
+                       const std::vector<std::byte>&)> _spawnListener;
+
+    /**
+     * Allocates a brand new crate of the given type.
+     *
+     * The crate is not shared; that is up to the caller.
+     */
+    CrateSlot allocCrate(int type, Vec2 pos, float scale);
+
+    /**
+     * Takes a crate of the given type from the pool (or allocates one) and moves it to pos.
+     *
+     * A resident crate is already in the world, and must not be added again.
+     * If there is no free resident crate, this allocates a new crate, which
+     * the caller must add to the world.
+     *
+     * The crate is not shared; that is up to the caller.
+     */
+    CrateSlot acquireCrate(int type, Vec2 pos, float scale, bool resident);
+
 public:
     /** Pointer to the AssetManager for texture access, etc. */
     std::shared_ptr<cugl::AssetManager> _assets;
-    /** Deterministic random generator for crate type */
-    std::mt19937 _rand;
     /** Serializer for supporting parameters */
     LWSerializer _serializer;
     /** Deserializer for supporting parameters */
     LWDeserializer _deserializer;
+    /** Whether crates are drawn by a shared CrateBatchNode instead of their own sprite */
+    bool _instanced;
 
     /**
      * Allocates a new instance of the factory using the given AssetManager.
@@ -59,18 +169,160 @@ public:
      */
     void init(std::shared_ptr<AssetManager>& assets) {
         _assets = assets;
-        _rand.seed(0xdeadbeef);
+        _instanced = false;
+        _pooled = false;
+        _stats = nullptr;
+    }
+
+    /**
+     * Returns the crate type of the given spawn key.
+     *
+     * Peers may process spawns in a different order, so the type is derived
+     * from the key, which every peer agrees on.
+     */
+    static int getCrateType(Uint32 key) { return key % 2 == 0 ? 2 : 1; }
+
+    /**
+     * Sets whether crates are drawn by a shared CrateBatchNode.
+     *
+     * If true, createObstacle returns a CrateProxyNode instead of a
+     * PolygonNode. The scene gets the batch node of the crate from
+     * {@link #getBatch}.
+     */
+    void setInstanced(bool value) { _instanced = value; }
+
+    /**
+     * Sets the batch nodes that draw instanced crates.
+     *
+     * There must be one batch node per crate type, in type order. Crates
+     * keep their type when pooled, so they move to the new batch nodes if
+     * these are replaced (e.g. when the level is reset).
+     */
+    void setBatches(const std::vector<std::shared_ptr<CrateBatchNode>>& batches) { _batches = batches; }
+
+    /**
+     * Returns the batch node that draws the crate with the given node.
+     *
+     * This returns nullptr if the node is not the proxy of an instanced crate.
+     */
+    std::shared_ptr<CrateBatchNode> getBatch(const std::shared_ptr<scene2::SceneNode>& node) const;
+
+    /**
+     * Sets the statistics log for allocation counts and spawn latency.
+     */
+    void setStats(NetLabStats* stats) { _stats = stats; }
+
+    /**
+     * Sets the listener notified of every crate spawned from serialized parameters.
+     *
+     * The listener receives the spawn key of the crate along with the crate
+     * itself, and the parameters it was spawned from. It is called on every
+     * peer, including the one that spawned it.
+     */
+    void setSpawnListener(const std::function<void(Uint32, const std::shared_ptr<physics2::Obstacle>&,
+                                                   const std::shared_ptr<scene2::SceneNode>&,
+                                                   const std::vector<std::byte>&)>& listener) {
+        _spawnListener = listener;
+    }
+
+#pragma mark Pooling
+    /**
+     * Turns on pooling and adds the given number of resident crates to the world.
+     *
+     * Resident crates are added with addInitObstacle() and disabled, so their
+     * bodies and fixtures exist before the first spawn. The world keeps them
+     * (with their ids) for good. The crates of {@link #createObstacles} are
+     * taken from them, so they must be added in the same order on every peer.
+     *
+     * Crates created from serialized parameters are added to the world by the
+     * physics controller, so they cannot be resident. They are pooled outside
+     * the world once recycled. If a pool runs dry, the factory falls back to
+     * allocating new crates.
+     *
+     * Any previous resident crates are dropped, as they belong to an old world.
+     *
+     * @param world The obstacle world
+     * @param count The number of resident crates
+     * @param scale The drawing scale
+     */
+    void prewarm(const std::shared_ptr<physics2::ObstacleWorld>& world, Uint32 count, float scale);
+
+    /**
+     * Returns true if the crate stays in the world between uses.
+     */
+    bool isResident(const std::shared_ptr<physics2::Obstacle>& obj) const {
+        return _residents.count(obj.get()) > 0;
     }
+
+    /**
+     * Returns a despawned crate to the pool.
+     *
+     * A resident crate is disabled and stays in the world, so this returns
+     * true and the caller must unbind it from the scene graph. It can be
+     * reused from the next tick on (see {@link #restock}).
+     *
+     * Otherwise this returns false, and the caller must remove the obstacle
+     * from the world. It only becomes available again once {@link #reclaim}
+     * sees that the world has released its body.
+     */
+    bool recycle(const std::shared_ptr<physics2::Obstacle>& obj,
+                 const std::shared_ptr<scene2::SceneNode>& node);
+
+    /**
+     * Makes the resident crates recycled this tick available for reuse.
+     *
+     * This should be called once at the end of every tick, so that the
+     * order of reuse (and so the id of every spawned crate) is the same on
+     * every peer.
+     */
+    void restock();
+
+    /**
+     * Moves recycled crates whose bodies were released back to the pool.
+     *
+     * This should be called once per frame, after the scene graph has been
+     * synced, so that no node binding still refers to a recycled crate.
+     */
+    void reclaim();
+
+    /**
+     * Returns the number of crates available for reuse.
+     */
+    size_t getPoolSize() const;
     
     /**
      * Generate a pair of Obstacle and SceneNode using the given parameters
+     *
+     * The key picks the crate type (see {@link #getCrateType}).
      */
-    std::pair<std::shared_ptr<physics2::Obstacle>, std::shared_ptr<scene2::SceneNode>> createObstacle(Vec2 pos, float scale);
+    std::pair<std::shared_ptr<physics2::Obstacle>, std::shared_ptr<scene2::SceneNode>> createObstacle(Vec2 pos, float scale, Uint32 key);
+
+    /**
+     * Generate a pair of Obstacle and SceneNode in the given initial state.
+     *
+     * The state is applied before sharing is turned on, so it is not
+     * synchronized as separate property changes. The key picks the crate
+     * type (see {@link #getCrateType}).
+     */
+    std::pair<std::shared_ptr<physics2::Obstacle>, std::shared_ptr<scene2::SceneNode>> createObstacle(const CrateState& state, float scale, Uint32 key);
+
+    /**
+     * Generate a batch of crates in one pass.
+     *
+     * The velocities are set before sharing is turned on, so they are not
+     * synchronized as separate property changes. The crates are resident
+     * when possible (see {@link #isResident}), and those are already in the
+     * world. The crates take consecutive keys from the base key, which pick
+     * their types (see {@link #getCrateType}).
+     */
+    std::vector<std::pair<std::shared_ptr<physics2::Obstacle>, std::shared_ptr<scene2::SceneNode>>> createObstacles(Uint32 base, const std::vector<Vec2>& pos, const std::vector<Vec2>& vel, float scale);
 
     /**
      * Helper method for converting normal parameters into byte vectors used for syncing.
+     *
+     * The key identifies the crate on every peer (see {@link CratePopulation}).
      */
-    std::shared_ptr<std::vector<std::byte>> serializeParams(Vec2 pos, float scale);
+    std::shared_ptr<std::vector<std::byte>> serializeParams(const CrateState& state, float scale, Uint32 key);
     
     /**
      * Generate a pair of Obstacle and SceneNode using serialized parameters.
@@ -109,7 +361,10 @@ protected:
     /** The scale between the physics world and the screen (MUST BE UNIFORM) */
     float _scale;
 
-    std::mt19937 _rand;
+    /** The random generator shared by every peer (same seed and stream) */
+    Random _rand;
+    /** The random generator of this peer alone (a stream per peer) */
+    Random _peerRand;
 
     std::shared_ptr<CrateFactory> _crateFact;
     Uint32 _factId;
@@ -129,6 +384,86 @@ protected:
     bool _complete;
     /** Whether or not debug mode is active */
     bool _debug;
+    /** Whether dynamic nodes are synced in one batch pass instead of listeners */
+    bool _batchSync;
+    /** The dense table of dynamic obstacle/node bindings (batch sync only) */
+    TransformSync _transformSync;
+    /** The instanced crate renderers, indexed by crate type */
+    std::vector<std::shared_ptr<CrateBatchNode>> _crateBatches;
+    /** Whether remote obstacles are drawn from the snapshot buffer */
+    bool _interpolateRemote;
+    /** The received states of remote obstacles */
+    SnapshotBuffer _snapshots;
+    /** The performance counters and timing samples */
+    NetLabStats _stats;
+    /** The number of fixed ticks simulated so far */
+    Uint64 _tick;
+    /** The fired crates, bounded in number */
+    CratePopulation _population;
+    /** The spawn keys reserved by this peer, and the ids bound to every key */
+    ObstacleIds _ids;
+    /** The received events waiting for their tick */
+    EventScheduler _scheduler;
+    /** The time of each local big crate input, by spawn key, until the crate appears */
+    std::unordered_map<Uint32, Timestamp> _inputTimes;
+    /** The echoes of crates requested by this peer, by spawn key, until their event is applied */
+    std::unordered_map<Uint32, std::shared_ptr<scene2::SceneNode>> _echoes;
+    /** The early history of fired crates, predicted until the host confirms them */
+    SpawnPredictor _predictor;
+    /** The policy choosing which obstacles this peer should own */
+    AuthorityPolicy _authority;
+    /** The leases granted by the host (only used on the host) */
+    AuthorityArbiter _arbiter;
+    /** The assignment of init crates to peers */
+    OwnershipPartition _partition;
+    /** The choice between a full mesh and a relay for state updates */
+    Topology _topology;
+    /** The estimated bytes sent for our obstacles since the last status report */
+    Uint64 _upstreamBytes;
+    /** The congestion control of the link to every other peer, by short UID */
+    std::unordered_map<Uint32, CongestionController> _links;
+    /** The sequence number of the last latency probe */
+    Uint32 _probeSeq;
+    /** The last probe of every other peer, echoed by our next probe (hold is the receipt time until then) */
+    std::unordered_map<Uint32, PingEvent::Echo> _echoes;
+    /** The payload bytes of the events sent since the last congestion update */
+    Uint64 _eventBytes;
+    /** The bytes optional events may still use, per link */
+    float _sendTokens;
+    /** The smallest budget over all links, in bytes per second */
+    float _sendBudget;
+    /** The time the scene started, for probe times */
+    Timestamp _epoch;
+    /** The estimate of the host clock and tick (clients only) */
+    ClockSync _clock;
+    /** The undilated fixed step of the application, in microseconds */
+    Uint32 _baseStep;
+    /** The ticks left to wait for the host, after getting too far ahead of it */
+    Uint64 _heldTicks;
+    /** The fired crates followed to the screens of the other peers */
+    LatencyProbe _latency;
+    /** The tick of the next automatic fire (probe runs only) */
+    Uint64 _autoFireTick;
+    /** The codec for state frames, with the level layout as its dictionary (measured only, see CODEC_CORPUS) */
+    FrameCodec _codec;
+    /** The state frames run through the codec so far */
+    Uint32 _codedFrames;
+    /** The input bundles of every peer, until their tick (lock-step only) */
+    LockstepBuffer _lockstep;
+    /** The input of this peer for its next bundle (lock-step only) */
+    LockstepInput _pendingInput;
+    /** The world hashes of this peer, compared against the other peers */
+    WorldHash _hasher;
+    /** The recording of this session (if enabled) */
+    SessionRecorder _recorder;
+    /** The recorded session driving this scene (replay only) */
+    SessionReplay _replay;
+    /** The estimated bytes sent for our obstacles this session */
+    Uint64 _stateBytes;
+    /** The payload bytes of the events sent this session (replay only) */
+    Uint64 _sentBytes;
+    /** The shared property changes waiting for the next tick */
+    SharedPropertyBatch _props;
     
     std::shared_ptr<NetEventController> _network;
     
@@ -136,8 +471,11 @@ protected:
     
     /**
      * This method adds a crate at the given position during the init process.
+     *
+     * The index of the crate picks its type, as every peer adds the init
+     * crates in the same order.
      */
-    std::shared_ptr<cugl::physics2::Obstacle> addInitCrate(cugl::Vec2 pos);
+    std::shared_ptr<cugl::physics2::Obstacle> addInitCrate(cugl::Vec2 pos, Uint32 index);
     
     /**
      * Lays out the game geography.
@@ -170,7 +508,12 @@ protected:
     /**
      * This method links a scene node to the obstacle.
      *
-     * This method adds a listener so that the sceneNode will move along with the obstacle.
+     * For dynamic obstacles, this method either adds a listener so that the
+     * sceneNode will move along with the obstacle, or (in batch sync mode)
+     * adds the pair to the transform table updated in {@link #postUpdate}.
+     *
+     * Proxy nodes named after a crate texture are not added to the scene
+     * graph. Instead, the obstacle is drawn by the matching CrateBatchNode.
      */
     void linkSceneToObs(const std::shared_ptr<cugl::physics2::Obstacle>& obj,
         const std::shared_ptr<cugl::scene2::SceneNode>& node);
@@ -179,14 +522,430 @@ protected:
      * This method adds a crate that had been fired by the player's cannon amid the simulation.
      *
      * If this machine is host, the crate should be fire from the left cannon (_cannon1), vice versa.
+     *
+     * @return the spawn key of the crate
+     */
+    Uint32 fireCrate();
+    
+    /**
+     * This method adds a fired crate to the next input bundle (lock-step only).
+     *
+     * The launch is aimed here, so that no other peer computes the direction
+     * with its own math library. Only one crate may be fired per bundle.
+     *
+     * @return the spawn key of the crate
      */
-    void fireCrate();
+    Uint32 queueFire();
     
+    /**
+     * This method fires a fan of crates from the player's cannon at once.
+     *
+     * The crates are sent as a single SpawnBatchEvent with a contiguous range
+     * of spawn keys, unless VOLLEY_BATCHED is off, in which case they are
+     * added one at a time with addSharedObstacle() (for comparison).
+     */
+    void fireVolley();
+
     /**
      * This method takes a crateEvent and processes it.
      */
     void processCrateEvent(const std::shared_ptr<CrateEvent>& event);
 
+    /**
+     * This method sends a storm of crate events for stress testing.
+     *
+     * Every peer sends EVENT_STORM crate events each tick, so that events from
+     * different peers keep arriving at the same time. Every peer should still
+     * agree on the id of every crate, which the id digests check.
+     */
+    void sendEventStorm();
+
+    /**
+     * This method constructs every crate of a spawn batch in one pass.
+     *
+     * The peer that fired the batch owns the crates.
+     */
+    void processSpawnBatchEvent(const std::shared_ptr<SpawnBatchEvent>& event);
+
+    /**
+     * This method removes the fired crates listed in the despawn event.
+     *
+     * It must be called at the tick of the event, so that every peer removes
+     * the crates at the same point in the simulation.
+     */
+    void processDespawnEvent(const std::shared_ptr<DespawnEvent>& event);
+
+    /**
+     * This method applies a ticked event released by the scheduler.
+     *
+     * @param event The event to apply
+     */
+    void processTickedEvent(const std::shared_ptr<TickedEvent>& event);
+
+    /**
+     * This method confirms a crate fired by this peer with the host's acknowledgement.
+     *
+     * Acknowledgements are broadcast, so only the peer that fired the crate
+     * uses them. If the crate is still predicted, it is confirmed with the
+     * last state of the host's trajectory, which samples the prediction error
+     * (the crate itself is left alone, as this peer owns it). If the
+     * trajectory covers every tracked age, it is also compared with ours to
+     * sample the divergence.
+     */
+    void processSpawnAckEvent(const std::shared_ptr<SpawnAckEvent>& event);
+
+    /**
+     * This method acknowledges a crate fired by another peer.
+     *
+     * Only the host acknowledges crates, once they reach a milestone age.
+     *
+     * @param key           The spawn key
+     * @param obj           The crate obstacle
+     * @param trajectory    The positions of the crate on this peer
+     */
+    void sendSpawnAck(Uint32 key, const std::shared_ptr<physics2::Obstacle>& obj,
+                      const std::vector<Vec2>& trajectory);
+
+    /**
+     * This method stamps an event with the input delay and sends it.
+     *
+     * The event is applied at the stamped tick on every peer, including
+     * this one (events are echoed back to the sender). With LOCAL_ECHO, a
+     * crate event is also drawn right away (see {@link #showEcho}).
+     *
+     * @param event The event to send
+     */
+    void pushTickedEvent(const std::shared_ptr<NetEvent>& event);
+
+    /**
+     * This method draws a crate requested by this peer before it is applied.
+     *
+     * The echo is a sprite at the spawn position, with the texture the crate
+     * will have. It has no body, so it never touches the simulation. When
+     * the event is released (or rejected), the scheduler confirms the echo,
+     * and it is removed before the crate itself is created.
+     *
+     * @param event The crate event sent by this peer
+     */
+    void showEcho(const std::shared_ptr<CrateEvent>& event);
+
+    /**
+     * This method removes the echo of a crate, if any.
+     *
+     * @param key   The spawn key of the crate
+     */
+    void removeEcho(Uint32 key);
+
+    /**
+     * This method waits for the input bundles of this tick, and applies them.
+     *
+     * Our own bundle for a later tick is sent before the inputs are applied.
+     * Peers that stall the simulation for too long are dropped by the host,
+     * which tells every other peer the tick to drop them from. The other
+     * peers keep waiting until then.
+     *
+     * @return true if the tick can be stepped
+     */
+    bool stepLockstep();
+
+    /**
+     * This method drops a peer from the lock-step simulation, as the host said.
+     *
+     * A peer can only have stepped past the tick if it had the bundle of the
+     * dropped peer, which the host never got. Its world then differs from the
+     * host, which is reported.
+     */
+    void processDropEvent(const std::shared_ptr<DropEvent>& event);
+
+    /**
+     * This method applies the inputs of one peer for this tick (lock-step only).
+     *
+     * The host controls the left cannon, and every other peer the right one.
+     */
+    void processInputBundleEvent(const std::shared_ptr<InputBundleEvent>& event);
+
+    /**
+     * This method reports the first tick our world differs from another peer.
+     *
+     * The snapshot of our world at that tick is written to the save directory.
+     * The other peer sees the same mismatch, and writes its own snapshot.
+     */
+    void reportDesync(Uint64 tick, Uint32 peer, Uint64 local, Uint64 remote);
+
+    /**
+     * This method chooses fired crates to despawn if there are too many.
+     *
+     * Only the host chooses, so that peers never remove different crates.
+     * The choice is broadcast as a single DespawnEvent.
+     */
+    void limitPopulation();
+
+    /**
+     * This method reports that this peer is present, with its upstream load.
+     *
+     * The upstream load is an estimate, not a measurement: the number of awake
+     * obstacles owned by this peer, times the other peers, times the assumed
+     * STATE_UPDATE_BYTES, per second.
+     */
+    void sendPeerStatus();
+
+    /**
+     * This method records the status report of a peer.
+     *
+     * The other peers follow the topology announced by the relay.
+     */
+    void processPeerStatusEvent(const std::shared_ptr<PeerStatusEvent>& event);
+
+    /**
+     * Returns the number of awake dynamic obstacles owned by this peer.
+     *
+     * These are the obstacles the network sends state updates for.
+     *
+     * @return the number of awake dynamic obstacles owned by this peer.
+     */
+    size_t countOwnedAwake() const;
+
+    /**
+     * Returns the obstacles with their ids, sorted by id.
+     *
+     * These are the obstacles the network controller would send this tick, as
+     * it sends every awake dynamic obstacle we own.
+     *
+     * @param all   Whether to include every obstacle, and not just those sent
+     *
+     * @return the obstacles with their ids, sorted by id.
+     */
+    std::vector<std::pair<Uint64, physics2::Obstacle*>> selectStateFrame(bool all) const;
+
+    /**
+     * Returns the state records of the obstacles, sorted by id.
+     *
+     * This is the frame the network controller would send this tick, as it
+     * sends every awake dynamic obstacle we own.
+     *
+     * @param all   Whether to include every obstacle, and not just those sent
+     *
+     * @return the state records of the obstacles, sorted by id.
+     */
+    std::vector<std::byte> writeStateFrame(bool all) const;
+
+    /**
+     * This method broadcasts a latency probe to the other peers.
+     *
+     * The probe echoes the last probe received from every other peer.
+     */
+    void sendProbe();
+
+    /**
+     * This method holds a probe for our next echo, and measures our own
+     * probes echoed by its origin.
+     */
+    void processPingEvent(const std::shared_ptr<PingEvent>& event);
+
+    /**
+     * This method keeps the tick of a client aligned with the host.
+     *
+     * Small errors are corrected by dilating the fixed step by a few
+     * percent. Large errors (e.g. right after the clock is synchronized)
+     * are corrected at once, but the tick never skips or repeats a tick:
+     * a peer that is behind steps through the missing ticks, applying the
+     * events due at each one, and a peer that is ahead waits.
+     */
+    void alignTick();
+
+    /**
+     * This method steps through the ticks up to the given one.
+     *
+     * Every missing tick is a full tick (see {@link #stepTick}), as the other
+     * peers ran it: its events are applied before the physics step, so that
+     * no queued event is released late, and its snapshots, hashes and digests
+     * are recorded.
+     *
+     * @param goal  The tick to catch up to
+     */
+    void catchUp(Uint64 goal);
+
+    /**
+     * This method runs one fixed tick of the simulation.
+     *
+     * This is all the work of a tick: receiving and applying events, the
+     * physics step, the snapshots, hashes and digests, and the periodic
+     * reports. A peer that catches up with the host runs this for every tick
+     * it missed, so that none of it is skipped.
+     *
+     * @return false if the tick is waiting for the inputs of other peers
+     */
+    bool stepTick();
+
+    /**
+     * Returns true if this peer can stamp times on the host clock.
+     *
+     * @return true if this peer can stamp times on the host clock.
+     */
+    bool hasSharedTime() const;
+
+    /**
+     * Returns the given time in microseconds of the host clock.
+     *
+     * The host clock is the time since the host scene started. This is only
+     * meaningful if {@link #hasSharedTime} is true.
+     *
+     * @param time  The local time
+     *
+     * @return the given time in microseconds of the host clock.
+     */
+    Uint64 getSharedTime(const Timestamp& time) const;
+
+    /**
+     * This method records the report of a peer that drew one of our crates.
+     */
+    void processLatencyEvent(const std::shared_ptr<LatencyEvent>& event);
+
+    /**
+     * This method adapts the state budget of every link once per period.
+     *
+     * The smallest budget caps how many obstacles this peer may lease, as
+     * every owned awake obstacle costs a state update each tick, and what is
+     * left of it paces the optional events.
+     */
+    void updateCongestion();
+
+    /**
+     * This method requests the obstacles our bodies keep pushing.
+     *
+     * On the host, it also answers every request received since the last
+     * tick, so that each obstacle is leased to at most one peer. Nothing is
+     * leased while the relay owns every obstacle.
+     */
+    void requestAuthority();
+
+    /**
+     * This method queues a lease request, or applies the host's answer.
+     *
+     * Requests only matter on the host. A grant only matters to the peer it
+     * is for, which acquires the granted obstacles.
+     */
+    void processAuthorityEvent(const std::shared_ptr<AuthorityEvent>& event);
+
+    /**
+     * This method sends the state of the awake obstacles we own.
+     *
+     * The network controller applies its state updates without showing them
+     * to us, so the peers that draw our obstacles from their snapshot buffer
+     * need these frames. They only change how obstacles are drawn, so they are
+     * optional.
+     */
+    void sendStateFrame();
+
+    /**
+     * This method adds the states of a received frame to the snapshot buffer.
+     *
+     * The arrival of the frame is measured first, so that the render delay
+     * of its peer follows its transit time and jitter. States of obstacles we
+     * own (or do not know) are ignored.
+     */
+    void processStateFrameEvent(const std::shared_ptr<StateFrameEvent>& event);
+
+    /**
+     * This method drops the peers that have gone silent.
+     *
+     * The init crates are then reassigned over the remaining peers. On the
+     * relay, the topology is then reevaluated against the reported loads.
+     */
+    void updatePeers();
+
+    /**
+     * This method moves ownership to match the topology in use.
+     *
+     * The physics controller broadcasts the updates of the obstacles a peer
+     * owns, so the relay carries every update by owning every dynamic obstacle
+     * (except the cannons). The other peers then only send inputs and events.
+     * Back in the mesh, the init crates are reassigned over the peers, and
+     * obstacles are leased again as they are pushed.
+     */
+    void applyTopology();
+
+    /**
+     * This method reassigns the init crates over the remaining peers.
+     *
+     * Every remaining peer acquires the crates newly assigned to it.
+     */
+    void rebalanceOwnership();
+
+    /**
+     * Returns the short UID of this peer (or of the recorded peer on replay).
+     *
+     * @return the short UID of this peer.
+     */
+    Uint32 getShortUID() const;
+
+    /**
+     * Returns the number of players (or of recorded players on replay).
+     *
+     * @return the number of players.
+     */
+    Uint32 getNumPlayers() const;
+
+    /**
+     * Attaches an event type to the network, the recorder and the replay.
+     *
+     * Every event type must be attached through this method, so that the
+     * recorded types are in the same order on replay.
+     */
+    template <typename T>
+    void attachEventType() {
+        if (!_replay.isOpen()) {
+            _network->attachEventType<T>();
+        }
+        _recorder.attachEventType<T>();
+        _replay.attachEventType<T>();
+    }
+
+    /**
+     * This method sends an event to the network.
+     *
+     * The event is recorded if the session is recorded. On replay, the event
+     * is only counted, as its echo is part of the recording.
+     *
+     * @param event The event to send
+     */
+    void sendEvent(const std::shared_ptr<NetEvent>& event);
+
+    /**
+     * This method sends an event only if the links have room for it.
+     *
+     * This is for events that only measure the session (hashes, digests,
+     * acknowledgements and latency reports). Events the game needs are sent
+     * with {@link #sendEvent}, which always sends them.
+     *
+     * @param event The event to send
+     *
+     * @return true if the event was sent
+     */
+    bool sendOptionalEvent(const std::shared_ptr<NetEvent>& event);
+
+    /**
+     * This method takes the next inbound event, if any.
+     *
+     * The event is recorded if the session is recorded. On replay, the event
+     * comes from the recording instead of the network.
+     *
+     * @param event The inbound event
+     *
+     * @return true if there was an inbound event
+     */
+    bool receiveEvent(std::shared_ptr<NetEvent>& event);
+
+    /**
+     * This method spawns a recorded shared crate (replay only).
+     *
+     * The factory notifies the spawn listener, as when the physics controller
+     * spawned the crate live, and the crate is added to the world the same way.
+     *
+     * @param params    The recorded factory parameters
+     */
+    void replaySpawn(const std::vector<std::byte>& params);
+
     /**
      * Returns the active screen size of this scene.
      *
@@ -271,6 +1030,22 @@ public:
      * @return  true if the controller is initialized properly, false otherwise.
      */
     bool init(const std::shared_ptr<cugl::AssetManager>& assets, const cugl::Rect rect, const cugl::Vec2 gravity, const std::shared_ptr<NetEventController> network, bool isHost);
+
+    /**
+     * Initializes the controller to replay a recorded session.
+     *
+     * The network controller is never used, so it need not be connected.
+     * The peer identity comes from the recording, and so do the shared
+     * crates, which are spawned without the physics controller.
+     * Call {@link #replay} to run the session.
+     *
+     * @param assets    The (loaded) assets for this game mode
+     * @param network   The (unconnected) network controller
+     * @param path      The recorded session
+     *
+     * @return true if the controller is initialized properly, false otherwise.
+     */
+    bool initReplay(const std::shared_ptr<cugl::AssetManager>& assets, const std::shared_ptr<NetEventController> network, const std::string& path);
     
     
 #pragma mark -
@@ -290,6 +1065,36 @@ public:
      * @return true if debug mode is active.
      */
     bool isDebug( ) const { return _debug; }
+
+    /**
+     * Returns true if dynamic nodes are synced in one batch pass.
+     *
+     * If false, every dynamic obstacle updates its node with a listener.
+     *
+     * @return true if dynamic nodes are synced in one batch pass.
+     */
+    bool isBatchSync( ) const { return _batchSync; }
+
+    /**
+     * Returns true if remote obstacles are drawn from the snapshot buffer.
+     *
+     * @return true if remote obstacles are drawn from the snapshot buffer.
+     */
+    bool isRemoteInterpolation( ) const { return _interpolateRemote; }
+
+    /**
+     * Sets whether remote obstacles are drawn from the snapshot buffer.
+     *
+     * If true, every peer sends the state of its awake obstacles in frames of
+     * its own, and obstacles owned by other peers are drawn from the received
+     * frames, interpolated a short delay in the past. The delay of each peer
+     * follows the transit time and jitter of its frames. Otherwise they are
+     * drawn at their extrapolated physics pose, as corrected by the network
+     * controller. This only affects batched and instanced nodes.
+     *
+     * @param value whether remote obstacles are drawn from the snapshot buffer.
+     */
+    void setRemoteInterpolation(bool value);
     
     /**
      * Sets whether debug mode is active.
@@ -326,6 +1131,24 @@ public:
     virtual void postUpdate(float timestep);
     virtual void fixedUpdate();
 
+    /**
+     * This method stamps the crates fired since the last network flush.
+     *
+     * It should be called right after the network controller sends its
+     * outgoing messages.
+     */
+    void markNetworkFlush();
+
+    /**
+     * Replays the recorded session as fast as possible, and reports.
+     *
+     * Every frame is stepped with its recorded time, and ends after the ticks
+     * it stepped, as in a live session. The report compares the bytes sent
+     * on replay with the recording, and the tick times are reported as
+     * during a live session.
+     */
+    void replay();
+
 #else
     /**
      * The method called to update the game mode.
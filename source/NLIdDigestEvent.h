@@ -0,0 +1,71 @@
+//
+//  NLIdDigestEvent.h
+//  Networked Physics Lab
+//
+//  This class carries the digest of the obstacle id bindings of a peer at
+//  a given tick.  Peers that applied the same spawns in the same order have
+//  the same digest at the same tick, so a mismatch means that a crate has a
+//  different id on two peers.
+//
+//  Created by the Networked Physics Lab contributors on 10/18/26.
+//
+
+#ifndef NLIdDigestEvent_h
+#define NLIdDigestEvent_h
+
+#include <cugl/cugl.h>
+using namespace cugl::netphysics;
+using namespace cugl;
+
+class IdDigestEvent : public NetEvent {
+    
+protected:
+    LWSerializer _serializer;
+    LWDeserializer _deserializer;
+    
+    /** The short UID of the peer that sent its digest */
+    Uint32 _peer;
+    /** The tick of the digest */
+    Uint64 _tick;
+    /** The digest of the id bindings */
+    Uint64 _digest;
+    
+public:
+    /**
+     * This method is used by the NetEventController to create a new event of using a
+     * reference of the same type.
+     *
+     * Not that this method is not static, it differs from the static alloc() method
+     * and all methods must implement this method.
+     */
+    std::shared_ptr<NetEvent> newEvent() override;
+    
+    static std::shared_ptr<NetEvent> allocIdDigestEvent(Uint32 peer, Uint64 tick, Uint64 digest);
+    
+    /**
+     * Serialize any paramater that the event contains to a vector of bytes.
+     */
+    std::vector<std::byte> serialize() override;
+    /**
+     * Deserialize a vector of bytes and set the corresponding parameters.
+     *
+     * @param data  a byte vector packed by serialize()
+     *
+     * This function should be the "reverse" of the serialize() function: it
+     * should be able to recreate a serialized event entirely, setting all the
+     * useful parameters of this class.
+     */
+    void deserialize(const std::vector<std::byte>& data) override;
+    
+    /** Gets the short UID of the peer that sent its digest. */
+    Uint32 getPeer() const { return _peer; }
+    
+    /** Gets the tick of the digest. */
+    Uint64 getTick() const { return _tick; }
+    
+    /** Gets the digest of the id bindings. */
+    Uint64 getDigest() const { return _digest; }
+};
+
+
+#endif /* NLIdDigestEvent_h */
@@ -26,6 +26,8 @@ using namespace cugl;
 #define EXIT_KEY  KeyCode::ESCAPE
 /** The fire key for firing a crate */
 #define FIRE_KEY  KeyCode::SPACE
+/** The key for firing a volley of crates */
+#define VOLLEY_KEY KeyCode::V
 /** The max charge time of a fire in milliseconds */
 #define FIRE_CHARGE_TIME 2000.f
 
@@ -60,6 +62,8 @@ _keyReset(false),
 _keyDebug(false),
 _keyExit(false),
 _fired(false),
+_keyVolley(false),
+_volleyPressed(false),
 _firePower(0.0f),
 _horizontal(0.0f),
 _vertical(0.0f) {
@@ -140,6 +144,7 @@ void NetLabInput::update(float dt) {
     _keyReset  = keys->keyPressed(RESET_KEY);
     _keyDebug  = keys->keyPressed(DEBUG_KEY);
     _keyExit   = keys->keyPressed(EXIT_KEY);
+    _keyVolley = keys->keyPressed(VOLLEY_KEY);
     
     if(keys->keyPressed(FIRE_KEY)){
         _timestamp.mark();
@@ -147,7 +152,7 @@ void NetLabInput::update(float dt) {
     }
     
     if (keys->keyReleased(FIRE_KEY)){
-        cugl::Timestamp curr;
+        _fireTime.mark();
         _keyFired = true;
     }
     else if(keys->keyDown(FIRE_KEY)){
@@ -186,6 +191,7 @@ void NetLabInput::update(float dt) {
     _debugPressed = _keyDebug;
     _exitPressed  = _keyExit;
     _fired        = _keyFired;
+    _volleyPressed = _keyVolley;
     
     // Directional controls
     _horizontal = 0.0f;
@@ -211,9 +217,36 @@ void NetLabInput::update(float dt) {
     _keyDebug = false;
     _keyReset = false;
     _keyDebug = false;
+    _keyVolley = false;
 #endif
 }
 
+/**
+ * Sets the input results of a frame recorded in an earlier session.
+ *
+ * This replaces update() on replay. The fire time is the current time.
+ *
+ * @param vertical  The vertical movement
+ * @param power     The fire power
+ * @param fired     Whether the fire key was released
+ * @param volley    Whether the volley key was pressed
+ * @param bigCrate  Whether the big crate key was pressed
+ * @param debug     Whether the debug key was pressed
+ */
+void NetLabInput::replay(float vertical, float power, bool fired, bool volley, bool bigCrate, bool debug) {
+    _resetPressed = bigCrate;
+    _debugPressed = debug;
+    _exitPressed  = false;
+    _fired        = fired;
+    _volleyPressed = volley;
+    _firePower    = power;
+    if (fired) {
+        _fireTime.mark();
+    }
+    _horizontal = 0.0f;
+    _vertical   = vertical;
+}
+
 /**
  * Clears any buffered inputs so that we may start fresh.
  */
@@ -222,6 +255,7 @@ void NetLabInput::clear() {
     _debugPressed = false;
     _exitPressed  = false;
     _fired = false;
+    _volleyPressed = false;
     
     _horizontal = 0.0f;
     _vertical   = 0.0f;
@@ -261,8 +295,10 @@ void NetLabInput::touchEndedCB(const cugl::TouchEvent& event, bool focus) {
         _keyReset = fast && diff.x < -EVENT_SWIPE_LENGTH;
         _keyExit  = fast && diff.x > EVENT_SWIPE_LENGTH;
         _keyDebug = fast && diff.y > EVENT_SWIPE_LENGTH;
+        _keyVolley = fast && diff.y < -EVENT_SWIPE_LENGTH;
     }
     else{
+        _fireTime = event.timestamp;
         _keyFired = true;
     }
     _keyUp = false;
@@ -49,6 +49,8 @@ private:
     bool  _keyExit;
     /** Whether the key for fired was down */
     bool  _keyFired;
+    /** Whether the volley key is down */
+    bool  _keyVolley;
     
     float _firePower;
 
@@ -72,6 +74,10 @@ protected:
     float _vertical;
     /** Whether the fire action was chosen. */
     bool _fired;
+    /** Whether the volley action was chosen. */
+    bool _volleyPressed;
+    /** The time the last fire input was read */
+    cugl::Timestamp _fireTime;
     
 public:
 #pragma mark -
@@ -130,6 +136,20 @@ public:
      * Clears any buffered inputs so that we may start fresh.
      */
     void clear();
+
+    /**
+     * Sets the input results of a frame recorded in an earlier session.
+     *
+     * This replaces update() on replay. The fire time is the current time.
+     *
+     * @param vertical  The vertical movement
+     * @param power     The fire power
+     * @param fired     Whether the fire key was released
+     * @param volley    Whether the volley key was pressed
+     * @param bigCrate  Whether the big crate key was pressed
+     * @param debug     Whether the debug key was pressed
+     */
+    void replay(float vertical, float power, bool fired, bool volley, bool bigCrate, bool debug);
     
 #pragma mark -
 #pragma mark Input Results
@@ -180,6 +200,22 @@ public:
      */
     bool didFire() const { return _fired; }
     
+    /**
+     * Returns the time the last fire input was read.
+     *
+     * This is the release of the fire key, or the end of the touch.
+     *
+     * @return the time the last fire input was read.
+     */
+    const cugl::Timestamp& getFireTime() const { return _fireTime; }
+    
+    /**
+     * Returns true if the volley button was pressed.
+     *
+     * @return true if the volley button was pressed.
+     */
+    bool didVolley() const { return _volleyPressed; }
+    
     float getFirePower() const { return _firePower; }
     
 #pragma mark -
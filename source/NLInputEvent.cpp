@@ -0,0 +1,93 @@
+//
+//  NLInputEvent.cpp
+//  Networked Physics Lab
+//
+//  This class represents the input bundle of one peer for one tick in the
+//  lock-step mode.  Every peer sends exactly one bundle per tick, even if
+//  it is empty, as the others cannot step that tick until they have it.
+//  A fired crate carries its launch position and velocity as computed by
+//  the sender, so that no other peer has to aim with its own math library.
+//
+//  Created by the Networked Physics Lab contributors on 10/18/26.
+//
+
+#include "NLInputEvent.h"
+
+/**
+ * This method is used by the NetEventController to create a new event of using a
+ * reference of the same type.
+ *
+ * Not that this method is not static, it differs from the static alloc() method
+ * and all methods must implement this method.
+ */
+std::shared_ptr<NetEvent> InputBundleEvent::newEvent(){
+    return std::make_shared<InputBundleEvent>();
+}
+
+std::shared_ptr<NetEvent> InputBundleEvent::allocInputBundleEvent(bool host, float turn, Uint32 fireKey,
+                                                                  Vec2 firePos, Vec2 fireVel, Uint32 crateKey){
+    auto event = std::make_shared<InputBundleEvent>();
+    event->_host = host;
+    event->_turn = turn;
+    event->_fireKey = fireKey;
+    event->_firePos = firePos;
+    event->_fireVel = fireVel;
+    event->_crateKey = crateKey;
+    return event;
+}
+
+/**
+ * Serialize any paramater that the event contains to a vector of bytes.
+ */
+std::vector<std::byte> InputBundleEvent::serialize(){
+    _serializer.reset();
+    writeStamp(_serializer);
+    _serializer.writeBool(_host);
+    _serializer.writeFloat(_turn);
+    // Most bundles fire nothing, so the crates are only written if present
+    _serializer.writeBool(_fireKey != 0);
+    if (_fireKey != 0) {
+        _serializer.writeUint32(_fireKey);
+        _serializer.writeFloat(_firePos.x);
+        _serializer.writeFloat(_firePos.y);
+        _serializer.writeFloat(_fireVel.x);
+        _serializer.writeFloat(_fireVel.y);
+    }
+    _serializer.writeBool(_crateKey != 0);
+    if (_crateKey != 0) {
+        _serializer.writeUint32(_crateKey);
+    }
+    return _serializer.serialize();
+}
+
+/**
+ * Deserialize a vector of bytes and set the corresponding parameters.
+ *
+ * @param data  a byte vector packed by serialize()
+ *
+ * This function should be the "reverse" of the serialize() function: it
+ * should be able to recreate a serialized event entirely, setting all the
+ * useful parameters of this class.
+ */
+void InputBundleEvent::deserialize(const std::vector<std::byte>& data){
+    _deserializer.reset();
+    _deserializer.receive(data);
+    readStamp(_deserializer);
+    _host = _deserializer.readBool();
+    _turn = _deserializer.readFloat();
+    _fireKey = 0;
+    if (_deserializer.readBool()) {
+        // Read into locals, as argument evaluation order is unspecified
+        _fireKey = _deserializer.readUint32();
+        float px = _deserializer.readFloat();
+        float py = _deserializer.readFloat();
+        float vx = _deserializer.readFloat();
+        float vy = _deserializer.readFloat();
+        _firePos.set(px,py);
+        _fireVel.set(vx,vy);
+    }
+    _crateKey = 0;
+    if (_deserializer.readBool()) {
+        _crateKey = _deserializer.readUint32();
+    }
+}
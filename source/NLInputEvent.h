@@ -0,0 +1,89 @@
+//
+//  NLInputEvent.h
+//  Networked Physics Lab
+//
+//  This class represents the input bundle of one peer for one tick in the
+//  lock-step mode.  Every peer sends exactly one bundle per tick, even if
+//  it is empty, as the others cannot step that tick until they have it.
+//  A fired crate carries its launch position and velocity as computed by
+//  the sender, so that no other peer has to aim with its own math library.
+//
+//  Created by the Networked Physics Lab contributors on 10/18/26.
+//
+
+#ifndef NLInputEvent_h
+#define NLInputEvent_h
+
+#include <cugl/cugl.h>
+#include "NLTickedEvent.h"
+using namespace cugl::netphysics;
+using namespace cugl;
+
+class InputBundleEvent : public TickedEvent {
+    
+protected:
+    LWSerializer _serializer;
+    LWDeserializer _deserializer;
+    
+    /** Whether the sender is the host (and so controls the left cannon) */
+    bool _host;
+    /** The change to the cannon angle */
+    float _turn;
+    /** The spawn key of the fired crate (0 if none) */
+    Uint32 _fireKey;
+    /** The launch position of the fired crate */
+    Vec2 _firePos;
+    /** The launch velocity of the fired crate */
+    Vec2 _fireVel;
+    /** The spawn key of the requested big crate (0 if none) */
+    Uint32 _crateKey;
+    
+public:
+    /**
+     * This method is used by the NetEventController to create a new event of using a
+     * reference of the same type.
+     *
+     * Not that this method is not static, it differs from the static alloc() method
+     * and all methods must implement this method.
+     */
+    std::shared_ptr<NetEvent> newEvent() override;
+    
+    static std::shared_ptr<NetEvent> allocInputBundleEvent(bool host, float turn, Uint32 fireKey,
+                                                           Vec2 firePos, Vec2 fireVel, Uint32 crateKey);
+    
+    /**
+     * Serialize any paramater that the event contains to a vector of bytes.
+     */
+    std::vector<std::byte> serialize() override;
+    /**
+     * Deserialize a vector of bytes and set the corresponding parameters.
+     *
+     * @param data  a byte vector packed by serialize()
+     *
+     * This function should be the "reverse" of the serialize() function: it
+     * should be able to recreate a serialized event entirely, setting all the
+     * useful parameters of this class.
+     */
+    void deserialize(const std::vector<std::byte>& data) override;
+    
+    /** Gets whether the sender is the host. */
+    bool isFromHost() const { return _host; }
+    
+    /** Gets the change to the cannon angle. */
+    float getTurn() const { return _turn; }
+    
+    /** Gets the spawn key of the fired crate (0 if none). */
+    Uint32 getFireKey() const { return _fireKey; }
+    
+    /** Gets the launch position of the fired crate. */
+    Vec2 getFirePosition() const { return _firePos; }
+    
+    /** Gets the launch velocity of the fired crate. */
+    Vec2 getFireVelocity() const { return _fireVel; }
+    
+    /** Gets the spawn key of the requested big crate (0 if none). */
+    Uint32 getBigCrateKey() const { return _crateKey; }
+};
+
+
+#endif /* NLInputEvent_h */
@@ -0,0 +1,67 @@
+//
+//  NLLatencyEvent.cpp
+//  Networked Physics Lab
+//
+//  This class reports when a fired crate reached the screen of a peer.
+//  The peer that created the crate sends the times it created, linked and
+//  first drew the crate, on the host clock.  Only the peer that fired the
+//  crate (the peer of its spawn key) uses the report.
+//
+//  Created by the Networked Physics Lab contributors on 10/18/26.
+//
+
+#include "NLLatencyEvent.h"
+
+/**
+ * This method is used by the NetEventController to create a new event of using a
+ * reference of the same type.
+ *
+ * Not that this method is not static, it differs from the static alloc() method
+ * and all methods must implement this method.
+ */
+std::shared_ptr<NetEvent> LatencyEvent::newEvent(){
+    return std::make_shared<LatencyEvent>();
+}
+
+std::shared_ptr<NetEvent> LatencyEvent::allocLatencyEvent(Uint32 reporter, Uint32 key,
+                                                          Uint64 create, Uint64 link, Uint64 pixel){
+    auto event = std::make_shared<LatencyEvent>();
+    event->_reporter = reporter;
+    event->_key = key;
+    event->_create = create;
+    event->_link = link;
+    event->_pixel = pixel;
+    return event;
+}
+
+/**
+ * Serialize any paramater that the event contains to a vector of bytes.
+ */
+std::vector<std::byte> LatencyEvent::serialize(){
+    _serializer.reset();
+    _serializer.writeUint32(_reporter);
+    _serializer.writeUint32(_key);
+    _serializer.writeUint64(_create);
+    _serializer.writeUint64(_link);
+    _serializer.writeUint64(_pixel);
+    return _serializer.serialize();
+}
+
+/**
+ * Deserialize a vector of bytes and set the corresponding parameters.
+ *
+ * @param data  a byte vector packed by serialize()
+ *
+ * This function should be the "reverse" of the serialize() function: it
+ * should be able to recreate a serialized event entirely, setting all the
+ * useful parameters of this class.
+ */
+void LatencyEvent::deserialize(const std::vector<std::byte>& data){
+    _deserializer.reset();
+    _deserializer.receive(data);
+    _reporter = _deserializer.readUint32();
+    _key = _deserializer.readUint32();
+    _create = _deserializer.readUint64();
+    _link = _deserializer.readUint64();
+    _pixel = _deserializer.readUint64();
+}
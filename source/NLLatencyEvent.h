@@ -0,0 +1,82 @@
+//
+//  NLLatencyEvent.h
+//  Networked Physics Lab
+//
+//  This class reports when a fired crate reached the screen of a peer.
+//  The peer that created the crate sends the times it created, linked and
+//  first drew the crate, on the host clock.  Only the peer that fired the
+//  crate (the peer of its spawn key) uses the report.
+//
+//  Created by the Networked Physics Lab contributors on 10/18/26.
+//
+
+#ifndef NLLatencyEvent_h
+#define NLLatencyEvent_h
+
+#include <cugl/cugl.h>
+using namespace cugl::netphysics;
+using namespace cugl;
+
+class LatencyEvent : public NetEvent {
+    
+protected:
+    LWSerializer _serializer;
+    LWDeserializer _deserializer;
+    
+    /** The short UID of the peer reporting */
+    Uint32 _reporter;
+    /** The spawn key of the crate */
+    Uint32 _key;
+    /** The time the crate was created, in microseconds of the host clock */
+    Uint64 _create;
+    /** The time the crate was linked to its node, in microseconds of the host clock */
+    Uint64 _link;
+    /** The time the crate was first drawn, in microseconds of the host clock */
+    Uint64 _pixel;
+    
+public:
+    /**
+     * This method is used by the NetEventController to create a new event of using a
+     * reference of the same type.
+     *
+     * Not that this method is not static, it differs from the static alloc() method
+     * and all methods must implement this method.
+     */
+    std::shared_ptr<NetEvent> newEvent() override;
+    
+    static std::shared_ptr<NetEvent> allocLatencyEvent(Uint32 reporter, Uint32 key,
+                                                       Uint64 create, Uint64 link, Uint64 pixel);
+    
+    /**
+     * Serialize any paramater that the event contains to a vector of bytes.
+     */
+    std::vector<std::byte> serialize() override;
+    /**
+     * Deserialize a vector of bytes and set the corresponding parameters.
+     *
+     * @param data  a byte vector packed by serialize()
+     *
+     * This function should be the "reverse" of the serialize() function: it
+     * should be able to recreate a serialized event entirely, setting all the
+     * useful parameters of this class.
+     */
+    void deserialize(const std::vector<std::byte>& data) override;
+    
+    /** Gets the short UID of the peer reporting. */
+    Uint32 getReporter() const { return _reporter; }
+    
+    /** Gets the spawn key of the crate. */
+    Uint32 getKey() const { return _key; }
+    
+    /** Gets the time the crate was created, in microseconds of the host clock. */
+    Uint64 getCreateTime() const { return _create; }
+    
+    /** Gets the time the crate was linked to its node, in microseconds of the host clock. */
+    Uint64 getLinkTime() const { return _link; }
+    
+    /** Gets the time the crate was first drawn, in microseconds of the host clock. */
+    Uint64 getPixelTime() const { return _pixel; }
+};
+
+
+#endif /* NLLatencyEvent_h */
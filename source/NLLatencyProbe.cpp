@@ -0,0 +1,227 @@
+//
+//  NLLatencyProbe.cpp
+//  Networked Physics Demo
+//
+//  This class follows fired crates from the input to the first frame that
+//  draws them on another peer.  The firing peer stamps the input, the call
+//  to fire and the network flush that sends the crate.  Every other peer
+//  stamps the creation of the crate, its link to the scene graph and the
+//  first frame after the link, and reports these back.  All stamps are on
+//  the host clock, so that the hops between peers can be measured.
+//
+//  Author: Networked Physics Lab contributors
+//  Version: 10/18/26
+//
+#include "NLLatencyProbe.h"
+#include "NLStats.h"
+
+using namespace cugl;
+
+/** The statistics key of the hop ending at each hop (none for the first) */
+static const char* HOP_KEYS[LatencyProbe::HOPS] = {
+    nullptr,
+    "probe.input_fire_ms",
+    "probe.fire_send_ms",
+    "probe.send_create_ms",
+    "probe.create_link_ms",
+    "probe.link_pixel_ms"
+};
+
+#pragma mark Constructors
+/**
+ * Initializes an empty probe set.
+ *
+ * @param timeout   The time after which an open probe is dropped
+ */
+void LatencyProbe::init(Uint64 timeout) {
+    _timeout = timeout;
+    clear();
+}
+
+/**
+ * Drops all open probes.
+ */
+void LatencyProbe::clear() {
+    _records.clear();
+    _bound.clear();
+}
+
+#pragma mark Stamping
+/**
+ * Stamps a hop of the given probe, opening the probe if necessary.
+ *
+ * @param id    The spawn key of the crate
+ * @param hop   The hop reached
+ * @param time  The current time
+ */
+void LatencyProbe::mark(Uint32 id, Hop hop, Uint64 time) {
+    auto it = _records.find(id);
+    if (it == _records.end()) {
+        Record record;
+        record.mask = 0;
+        record.started = time;
+        record.reports = 0;
+        it = _records.emplace(id, record).first;
+    }
+    Record& record = it->second;
+    if (!(record.mask & (1 << hop))) {
+        record.times[hop] = time;
+        record.mask |= (1 << hop);
+    }
+}
+
+/**
+ * Stamps a hop of every probe waiting for it.
+ *
+ * A probe is waiting if it reached the previous hop, but not this one.
+ *
+ * @param hop   The hop reached
+ * @param time  The current time
+ *
+ * @return the spawn keys of the probes stamped
+ */
+std::vector<Uint32> LatencyProbe::markPending(Hop hop, Uint64 time) {
+    std::vector<Uint32> result;
+    if (hop == INPUT) {
+        return result;
+    }
+    Uint8 before = 1 << (hop-1);
+    for(auto it = _records.begin(); it != _records.end(); ++it) {
+        Record& record = it->second;
+        if ((record.mask & before) && !(record.mask & (1 << hop))) {
+            record.times[hop] = time;
+            record.mask |= (1 << hop);
+            result.push_back(it->first);
+        }
+    }
+    return result;
+}
+
+/**
+ * Associates a created crate with its probe, until it is linked.
+ *
+ * @param obj   The created crate
+ * @param id    The spawn key of the crate
+ */
+void LatencyProbe::bind(physics2::Obstacle* obj, Uint32 id) {
+    _bound[obj] = id;
+}
+
+/**
+ * Stamps the link of the given crate, if it has a probe.
+ *
+ * @param obj   The crate linked to its scene node
+ * @param time  The current time
+ *
+ * @return true if the crate has a probe
+ */
+bool LatencyProbe::link(physics2::Obstacle* obj, Uint64 time) {
+    auto it = _bound.find(obj);
+    if (it == _bound.end()) {
+        return false;
+    }
+    // Pooled crates are reused, so the binding only lasts until the link
+    Uint32 id = it->second;
+    _bound.erase(it);
+    if (_records.find(id) == _records.end()) {
+        return false;
+    }
+    mark(id, LINK, time);
+    return true;
+}
+
+#pragma mark Reporting
+/**
+ * Removes the given probe, returning its times.
+ *
+ * @param id        The spawn key of the crate
+ * @param record    The record to copy the times into
+ *
+ * @return true if the probe was open
+ */
+bool LatencyProbe::take(Uint32 id, Record& record) {
+    auto it = _records.find(id);
+    if (it == _records.end()) {
+        return false;
+    }
+    record = it->second;
+    _records.erase(it);
+    return true;
+}
+
+/**
+ * Completes the given probe with the times reported by another peer.
+ *
+ * This adds a sample for every hop reached on either peer, and for the
+ * total. The probe stays open for the reports of the other peers.
+ *
+ * @param id        The spawn key of the crate
+ * @param create    The time the crate was created on the other peer
+ * @param link      The time the crate was linked on the other peer
+ * @param pixel     The time the crate was drawn on the other peer
+ *
+ * @return true if the probe was open
+ */
+bool LatencyProbe::complete(Uint32 id, Uint64 create, Uint64 link, Uint64 pixel) {
+    auto it = _records.find(id);
+    if (it == _records.end()) {
+        return false;
+    }
+    Record record = it->second;
+    it->second.reports++;
+    record.times[CREATE] = create;
+    record.times[LINK]   = link;
+    record.times[PIXEL]  = pixel;
+    record.mask |= (1 << CREATE) | (1 << LINK) | (1 << PIXEL);
+    if (_stats == nullptr) {
+        return true;
+    }
+
+    // Hops between peers go negative if the clock estimate is off
+    for(int hop = FIRE; hop < HOPS; hop++) {
+        if ((record.mask & (1 << hop)) && (record.mask & (1 << (hop-1)))) {
+            Sint64 delta = (Sint64)record.times[hop]-(Sint64)record.times[hop-1];
+            _stats->sample(HOP_KEYS[hop], delta/1000.0f);
+        }
+    }
+    if (record.mask & (1 << INPUT)) {
+        Sint64 delta = (Sint64)record.times[PIXEL]-(Sint64)record.times[INPUT];
+        _stats->sample("probe.total_ms", delta/1000.0f);
+    }
+    _stats->count("probe.reports");
+    return true;
+}
+
+/**
+ * Drops the probes that were opened more than the timeout ago.
+ *
+ * @param time  The current time
+ *
+ * @return the number of probes dropped without any report
+ */
+size_t LatencyProbe::expire(Uint64 time) {
+    size_t lost = 0;
+    for(auto it = _records.begin(); it != _records.end(); ) {
+        const Record& record = it->second;
+        if (time < record.started+_timeout) {
+            ++it;
+            continue;
+        }
+        // Only the firing peer expects reports
+        if ((record.mask & (1 << FIRE)) && record.reports == 0) {
+            lost++;
+        }
+        it = _records.erase(it);
+    }
+    for(auto it = _bound.begin(); it != _bound.end(); ) {
+        if (_records.find(it->second) == _records.end()) {
+            it = _bound.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    if (_stats && lost > 0) {
+        _stats->count("probe.lost", lost);
+    }
+    return lost;
+}
@@ -0,0 +1,185 @@
+//
+//  NLLatencyProbe.h
+//  Networked Physics Demo
+//
+//  This class follows fired crates from the input to the first frame that
+//  draws them on another peer.  The firing peer stamps the input, the call
+//  to fire and the network flush that sends the crate.  Every other peer
+//  stamps the creation of the crate, its link to the scene graph and the
+//  first frame after the link, and reports these back.  All stamps are on
+//  the host clock, so that the hops between peers can be measured.
+//
+//  Author: Networked Physics Lab contributors
+//  Version: 10/18/26
+//
+#ifndef __NL_LATENCY_PROBE_H__
+#define __NL_LATENCY_PROBE_H__
+#include <cugl/cugl.h>
+#include <unordered_map>
+#include <vector>
+
+class NetLabStats;
+
+/**
+ * This class records the time a fired crate passes each hop of the pipeline.
+ *
+ * Probes are identified by the spawn key of the crate, which is the same
+ * on every peer. All times are in microseconds of the host clock. A hop is
+ * only stamped the first time it is reached.
+ *
+ * The firing peer completes a probe for every report it receives, adding
+ * one sample per hop to the statistics log. Probes that are not complete
+ * within the timeout are dropped.
+ */
+class LatencyProbe {
+public:
+    /** The hops of a probe, in pipeline order */
+    enum Hop : Uint8 {
+        /** The fire input was read (firing peer) */
+        INPUT  = 0,
+        /** The crate was fired (firing peer) */
+        FIRE   = 1,
+        /** The frame with the crate was flushed (firing peer) */
+        SEND   = 2,
+        /** The crate was created (remote peer) */
+        CREATE = 3,
+        /** The crate was linked to its scene node (remote peer) */
+        LINK   = 4,
+        /** The first frame after the link was drawn (remote peer) */
+        PIXEL  = 5,
+        /** The number of hops */
+        HOPS   = 6
+    };
+
+    /** The times of a single probe */
+    struct Record {
+        /** The time of each hop */
+        Uint64 times[HOPS];
+        /** The mask of the hops reached */
+        Uint8 mask;
+        /** The time of the first hop reached, for expiry */
+        Uint64 started;
+        /** The number of reports received (firing peer only) */
+        Uint32 reports;
+    };
+
+protected:
+    /** The open probes, by spawn key */
+    std::unordered_map<Uint32, Record> _records;
+    /** The probes of the created crates waiting for their link */
+    std::unordered_map<cugl::physics2::Obstacle*, Uint32> _bound;
+    /** The time after which an open probe is dropped */
+    Uint64 _timeout;
+    /** The statistics log for the hop samples (may be null) */
+    NetLabStats* _stats;
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates an empty probe set.
+     */
+    LatencyProbe() : _timeout(0), _stats(nullptr) {}
+
+    /**
+     * Initializes an empty probe set.
+     *
+     * @param timeout   The time after which an open probe is dropped
+     */
+    void init(Uint64 timeout);
+
+    /**
+     * Drops all open probes.
+     */
+    void clear();
+
+    /**
+     * Sets the statistics log for the hop samples.
+     *
+     * @param stats The statistics log (or nullptr)
+     */
+    void setStats(NetLabStats* stats) { _stats = stats; }
+
+#pragma mark Stamping
+    /**
+     * Stamps a hop of the given probe, opening the probe if necessary.
+     *
+     * @param id    The spawn key of the crate
+     * @param hop   The hop reached
+     * @param time  The current time
+     */
+    void mark(Uint32 id, Hop hop, Uint64 time);
+
+    /**
+     * Stamps a hop of every probe waiting for it.
+     *
+     * A probe is waiting if it reached the previous hop, but not this one.
+     *
+     * @param hop   The hop reached
+     * @param time  The current time
+     *
+     * @return the spawn keys of the probes stamped
+     */
+    std::vector<Uint32> markPending(Hop hop, Uint64 time);
+
+    /**
+     * Associates a created crate with its probe, until it is linked.
+     *
+     * @param obj   The created crate
+     * @param id    The spawn key of the crate
+     */
+    void bind(cugl::physics2::Obstacle* obj, Uint32 id);
+
+    /**
+     * Stamps the link of the given crate, if it has a probe.
+     *
+     * @param obj   The crate linked to its scene node
+     * @param time  The current time
+     *
+     * @return true if the crate has a probe
+     */
+    bool link(cugl::physics2::Obstacle* obj, Uint64 time);
+
+#pragma mark Reporting
+    /**
+     * Removes the given probe, returning its times.
+     *
+     * @param id        The spawn key of the crate
+     * @param record    The record to copy the times into
+     *
+     * @return true if the probe was open
+     */
+    bool take(Uint32 id, Record& record);
+
+    /**
+     * Completes the given probe with the times reported by another peer.
+     *
+     * This adds a sample for every hop reached on either peer, and for the
+     * total. The probe stays open for the reports of the other peers.
+     *
+     * @param id        The spawn key of the crate
+     * @param create    The time the crate was created on the other peer
+     * @param link      The time the crate was linked on the other peer
+     * @param pixel     The time the crate was drawn on the other peer
+     *
+     * @return true if the probe was open
+     */
+    bool complete(Uint32 id, Uint64 create, Uint64 link, Uint64 pixel);
+
+    /**
+     * Drops the probes that were opened more than the timeout ago.
+     *
+     * @param time  The current time
+     *
+     * @return the number of probes dropped without any report
+     */
+    size_t expire(Uint64 time);
+
+    /**
+     * Returns the number of open probes.
+     *
+     * @return the number of open probes.
+     */
+    size_t size() const { return _records.size(); }
+};
+
+#endif /* __NL_LATENCY_PROBE_H__ */
@@ -0,0 +1,184 @@
+//
+//  NLLockstep.cpp
+//  Networked Physics Demo
+//
+//  This class gates the simulation in the lock-step mode.  Peers do not
+//  exchange obstacle states at all.  Each peer sends one input bundle per
+//  tick, stamped with an input delay, and a tick is only stepped once the
+//  bundles of every peer for that tick have arrived.  Every peer then
+//  applies the same inputs in the same order and steps an identical world
+//  (see NLDeterminism.h for what that requires).  The bandwidth only
+//  depends on the number of peers, and not on the number of obstacles.
+//
+//  Author: Networked Physics Lab contributors
+//  Version: 10/18/26
+//
+#include "NLLockstep.h"
+#include "NLStats.h"
+#include <algorithm>
+
+using namespace cugl;
+
+#pragma mark Constructors
+/**
+ * Initializes an empty buffer.
+ *
+ * @param peers The short UIDs of the peers in the simulation
+ * @param delay The ticks between reading an input and applying it
+ */
+void LockstepBuffer::init(const std::vector<Uint32>& peers, Uint32 delay) {
+    clear();
+    setPeers(peers);
+    _start = delay;
+}
+
+/**
+ * Discards all bundles.
+ */
+void LockstepBuffer::clear() {
+    _bundles.clear();
+    _dropped.clear();
+    _stalls = 0;
+}
+
+/**
+ * Sets the peers in the simulation.
+ *
+ * Ticks only wait for the bundles of these peers.
+ *
+ * @param peers The short UIDs of the peers in the simulation
+ */
+void LockstepBuffer::setPeers(const std::vector<Uint32>& peers) {
+    _peers = peers;
+    std::sort(_peers.begin(), _peers.end());
+}
+
+/**
+ * Drops a peer from the simulation, starting at the given tick.
+ *
+ * Ticks from then on no longer wait for the bundles of the peer, and
+ * discard them. A peer already dropped from an earlier tick stays so.
+ *
+ * @param peer  The short UID of the dropped peer
+ * @param tick  The first tick stepped without the peer
+ *
+ * @return true if the peer was dropped by this call
+ */
+bool LockstepBuffer::drop(Uint32 peer, Uint64 tick) {
+    if (!isMember(peer, tick)) {
+        return false;
+    }
+    _dropped[peer] = tick;
+    return true;
+}
+
+/**
+ * Returns true if the given peer takes part in the given tick.
+ *
+ * @param peer  The short UID of the peer
+ * @param tick  The tick to step
+ *
+ * @return true if the given peer takes part in the given tick.
+ */
+bool LockstepBuffer::isMember(Uint32 peer, Uint64 tick) const {
+    if (!std::binary_search(_peers.begin(), _peers.end(), peer)) {
+        return false;
+    }
+    auto it = _dropped.find(peer);
+    return it == _dropped.end() || tick < it->second;
+}
+
+#pragma mark Bundles
+/**
+ * Adds a bundle to the buffer.
+ *
+ * A second bundle from the same peer for the same tick (such as the
+ * echo of our own bundle) is ignored, as are bundles for past ticks.
+ *
+ * @param bundle    The input bundle
+ * @param now       The current tick
+ *
+ * @return true if the bundle was added
+ */
+bool LockstepBuffer::add(const std::shared_ptr<InputBundleEvent>& bundle, Uint64 now) {
+    Uint64 tick = bundle->getExecuteTick();
+    if (tick < now) {
+        if (_stats) {
+            _stats->count("lockstep.stale");
+        }
+        return false;
+    }
+    return _bundles[tick].emplace(bundle->getSender(), bundle).second;
+}
+
+/**
+ * Returns true if every peer has sent its bundle for the given tick.
+ *
+ * Every call that returns false counts as a stall.
+ *
+ * @param tick  The tick to step
+ *
+ * @return true if every peer has sent its bundle for the given tick.
+ */
+bool LockstepBuffer::isReady(Uint64 tick) {
+    bool ready = tick < _start || getMissing(tick).empty();
+    if (!ready) {
+        _stalls++;
+        if (_stats) {
+            _stats->count("lockstep.stalls");
+        }
+    } else if (_stalls > 0) {
+        if (_stats) {
+            _stats->sample("lockstep.stall_updates", (float)_stalls);
+        }
+        _stalls = 0;
+    }
+    return ready;
+}
+
+/**
+ * Returns the peers that have not sent their bundle for the given tick.
+ *
+ * @param tick  The tick to step
+ *
+ * @return the peers that have not sent their bundle for the given tick.
+ */
+std::vector<Uint32> LockstepBuffer::getMissing(Uint64 tick) const {
+    std::vector<Uint32> result;
+    auto it = _bundles.find(tick);
+    for(Uint32 peer : _peers) {
+        if (!isMember(peer, tick)) {
+            continue;
+        }
+        if (it == _bundles.end() || it->second.find(peer) == it->second.end()) {
+            result.push_back(peer);
+        }
+    }
+    return result;
+}
+
+/**
+ * Removes and returns the bundles of the given tick.
+ *
+ * The bundles are in order of their peer, so that every peer applies
+ * them in the same order. Bundles of dropped peers are discarded.
+ *
+ * @param tick  The tick to step
+ *
+ * @return the bundles of the given tick.
+ */
+std::vector<std::shared_ptr<InputBundleEvent>> LockstepBuffer::release(Uint64 tick) {
+    std::vector<std::shared_ptr<InputBundleEvent>> result;
+    auto it = _bundles.find(tick);
+    if (it == _bundles.end()) {
+        return result;
+    }
+    // The inner map is ordered by peer already
+    for(auto jt = it->second.begin(); jt != it->second.end(); ++jt) {
+        if (isMember(jt->first, tick)) {
+            result.push_back(jt->second);
+        }
+    }
+    _bundles.erase(_bundles.begin(), ++it);
+    return result;
+}
@@ -0,0 +1,201 @@
+//
+//  NLLockstep.h
+//  Networked Physics Demo
+//
+//  This class gates the simulation in the lock-step mode.  Peers do not
+//  exchange obstacle states at all.  Each peer sends one input bundle per
+//  tick, stamped with an input delay, and a tick is only stepped once the
+//  bundles of every peer for that tick have arrived.  Every peer then
+//  applies the same inputs in the same order and steps an identical world
+//  (see NLDeterminism.h for what that requires).  The bandwidth only
+//  depends on the number of peers, and not on the number of obstacles.
+//
+//  Author: Networked Physics Lab contributors
+//  Version: 10/18/26
+//
+#ifndef __NL_LOCKSTEP_H__
+#define __NL_LOCKSTEP_H__
+#include <cugl/cugl.h>
+#include <map>
+#include <vector>
+#include "NLDeterminism.h"
+#include "NLInputEvent.h"
+
+class NetLabStats;
+
+/**
+ * The input of this peer gathered for its next bundle.
+ */
+struct LockstepInput {
+    /** The change to the cannon angle */
+    float turn;
+    /** The spawn key of the fired crate (0 if none) */
+    Uint32 fireKey;
+    /** The launch position of the fired crate */
+    cugl::Vec2 firePos;
+    /** The launch velocity of the fired crate */
+    cugl::Vec2 fireVel;
+    /** The spawn key of the requested big crate (0 if none) */
+    Uint32 crateKey;
+
+    /**
+     * Creates an empty input.
+     */
+    LockstepInput() { clear(); }
+
+    /**
+     * Empties this input, once it was sent.
+     */
+    void clear() {
+        turn = 0;
+        fireKey = 0;
+        firePos = cugl::Vec2::ZERO;
+        fireVel = cugl::Vec2::ZERO;
+        crateKey = 0;
+    }
+};
+
+/**
+ * This class holds the input bundles of every peer until their tick.
+ *
+ * The first ticks (before the input delay) have no bundles, and are always
+ * ready. A peer that does not send its bundle stalls every other peer, so
+ * the caller should drop peers that stall for too long. Every peer must
+ * drop a peer from the same tick, or their inputs differ.
+ */
+class LockstepBuffer {
+protected:
+    /** The received bundles, by tick and then by short UID */
+    std::map<Uint64, std::map<Uint32, std::shared_ptr<InputBundleEvent>>> _bundles;
+    /** The short UIDs of the peers in the simulation, in order */
+    std::vector<Uint32> _peers;
+    /** The first tick without each dropped peer */
+    std::map<Uint32, Uint64> _dropped;
+    /** The first tick that needs bundles */
+    Uint64 _start;
+    /** The number of consecutive failed waits for the current tick */
+    Uint32 _stalls;
+    /** The statistics log for stalls (may be null) */
+    NetLabStats* _stats;
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates an empty buffer with no peers.
+     */
+    LockstepBuffer() : _start(0), _stalls(0), _stats(nullptr) {}
+
+    /**
+     * Initializes an empty buffer.
+     *
+     * @param peers The short UIDs of the peers in the simulation
+     * @param delay The ticks between reading an input and applying it
+     */
+    void init(const std::vector<Uint32>& peers, Uint32 delay);
+
+    /**
+     * Discards all bundles.
+     */
+    void clear();
+
+    /**
+     * Sets the statistics log for stalls.
+     *
+     * @param stats The statistics log (or nullptr)
+     */
+    void setStats(NetLabStats* stats) { _stats = stats; }
+
+    /**
+     * Sets the peers in the simulation.
+     *
+     * Ticks only wait for the bundles of these peers.
+     *
+     * @param peers The short UIDs of the peers in the simulation
+     */
+    void setPeers(const std::vector<Uint32>& peers);
+
+    /**
+     * Returns the peers in the simulation.
+     *
+     * @return the peers in the simulation.
+     */
+    const std::vector<Uint32>& getPeers() const { return _peers; }
+
+    /**
+     * Drops a peer from the simulation, starting at the given tick.
+     *
+     * Ticks from then on no longer wait for the bundles of the peer, and
+     * discard them. A peer already dropped from an earlier tick stays so.
+     *
+     * @param peer  The short UID of the dropped peer
+     * @param tick  The first tick stepped without the peer
+     *
+     * @return true if the peer was dropped by this call
+     */
+    bool drop(Uint32 peer, Uint64 tick);
+
+    /**
+     * Returns true if the given peer takes part in the given tick.
+     *
+     * @param peer  The short UID of the peer
+     * @param tick  The tick to step
+     *
+     * @return true if the given peer takes part in the given tick.
+     */
+    bool isMember(Uint32 peer, Uint64 tick) const;
+
+#pragma mark Bundles
+    /**
+     * Adds a bundle to the buffer.
+     *
+     * A second bundle from the same peer for the same tick (such as the
+     * echo of our own bundle) is ignored, as are bundles for past ticks.
+     *
+     * @param bundle    The input bundle
+     * @param now       The current tick
+     *
+     * @return true if the bundle was added
+     */
+    bool add(const std::shared_ptr<InputBundleEvent>& bundle, Uint64 now);
+
+    /**
+     * Returns true if every peer has sent its bundle for the given tick.
+     *
+     * Every call that returns false counts as a stall.
+     *
+     * @param tick  The tick to step
+     *
+     * @return true if every peer has sent its bundle for the given tick.
+     */
+    bool isReady(Uint64 tick);
+
+    /**
+     * Returns the peers that have not sent their bundle for the given tick.
+     *
+     * @param tick  The tick to step
+     *
+     * @return the peers that have not sent their bundle for the given tick.
+     */
+    std::vector<Uint32> getMissing(Uint64 tick) const;
+
+    /**
+     * Removes and returns the bundles of the given tick.
+     *
+     * The bundles are in order of their peer, so that every peer applies
+     * them in the same order. Bundles of dropped peers are discarded.
+     *
+     * @param tick  The tick to step
+     *
+     * @return the bundles of the given tick.
+     */
+    std::vector<std::shared_ptr<InputBundleEvent>> release(Uint64 tick);
+
+    /**
+     * Returns the number of consecutive failed waits for the current tick.
+     *
+     * @return the number of consecutive failed waits for the current tick.
+     */
+    Uint32 getStalls() const { return _stalls; }
+};
+
+#endif /* __NL_LOCKSTEP_H__ */
@@ -0,0 +1,212 @@
+//
+//  NLObstacleIds.cpp
+//  Networked Physics Demo
+//
+//  This class keeps spawned obstacles consistent across peers.  Every peer
+//  owns a disjoint block of spawn keys (the top byte is its short UID), and
+//  events carry the keys of the obstacles they create, so crates are known
+//  by the same key everywhere.  The obstacle id is assigned by the world
+//  itself through addInitObstacle(), which numbers obstacles in the order
+//  they are added.  Keyed obstacles are only added by ticked events, which
+//  every peer applies in the same order, so they get the same id on every
+//  peer.  To catch the cases where they do not (e.g. a late event), the
+//  peers exchange a digest of their key to id bindings.
+//
+//  Author: Networked Physics Lab contributors
+//  Version: 10/18/26
+//
+#include "NLObstacleIds.h"
+#include "NLStats.h"
+#include <algorithm>
+
+using namespace cugl;
+
+/** The FNV-1a offset basis */
+#define DIGEST_BASIS    0xcbf29ce484222325ULL
+/** The FNV-1a prime */
+#define DIGEST_PRIME    0x100000001b3ULL
+
+/**
+ * Folds the bytes of a value into an FNV-1a digest.
+ *
+ * @param digest    The digest so far
+ * @param value     The value to fold in
+ * @param bytes     The number of low bytes of value to fold
+ *
+ * @return the updated digest
+ */
+static Uint64 fold(Uint64 digest, Uint64 value, int bytes) {
+    for(int ii = 0; ii < bytes; ii++) {
+        digest ^= (value >> (8*ii)) & 0xFF;
+        digest *= DIGEST_PRIME;
+    }
+    return digest;
+}
+
+#pragma mark Constructors
+/**
+ * Initializes the key reservation for the given peer.
+ *
+ * @param peer      The short UID of this peer
+ * @param capacity  The number of digests kept for comparison
+ */
+void ObstacleIds::init(Uint32 peer, size_t capacity) {
+    _peer = peer & 0xFF;
+    _next = 0;
+    _capacity = std::max(capacity, (size_t)1);
+    clear();
+}
+
+/**
+ * Removes all bindings and digests (but keeps the key sequence).
+ */
+void ObstacleIds::clear() {
+    _bound.clear();
+    _history.clear();
+    _pending.clear();
+}
+
+#pragma mark Keys
+/**
+ * Reserves a contiguous block of keys, returning the first one.
+ *
+ * The sequence wraps after 2^24 keys, which is far more than the number
+ * of obstacles alive at once.
+ *
+ * @param count The number of keys to reserve
+ *
+ * @return the first key of the block
+ */
+Uint32 ObstacleIds::reserve(Uint32 count) {
+    // Never let a block straddle the wrap, so keys in a block are contiguous
+    if ((_next & 0xFFFFFF) + count > 0x1000000) {
+        _next = 0;
+    }
+    Uint32 key = (_peer << 24) | (_next & 0xFFFFFF);
+    _next += count;
+    return key;
+}
+
+#pragma mark Binding
+/**
+ * Adds the obstacle to the world, and binds its id to the key.
+ *
+ * The obstacle is added with addInitObstacle(), unless it is already in
+ * the world (like a resident crate), in which case it keeps its id. This
+ * must only be called when applying a ticked event, so that every peer
+ * adds the same obstacles in the same order.
+ *
+ * @param world The obstacle world
+ * @param obj   The obstacle to add
+ * @param key   The spawn key of the obstacle
+ *
+ * @return the id of the obstacle
+ */
+Uint64 ObstacleIds::bind(const std::shared_ptr<physics2::ObstacleWorld>& world,
+                         const std::shared_ptr<physics2::Obstacle>& obj, Uint32 key) {
+    auto& ids = world->getObjToId();
+    auto it = ids.find(obj);
+    if (it == ids.end()) {
+        world->addInitObstacle(obj);
+        it = ids.find(obj);
+    }
+    Uint64 id = (it == ids.end() ? 0 : it->second);
+    _bound[key] = id;
+    if (_stats) {
+        _stats->count("ids.bound");
+    }
+    return id;
+}
+
+#pragma mark Digests
+/**
+ * Returns the digest of every binding.
+ *
+ * The digest only depends on the set of (key, id) pairs, not on the
+ * order in which they were bound.
+ *
+ * @return the digest of every binding.
+ */
+Uint64 ObstacleIds::digest() const {
+    // The map is sorted by key, so every peer folds the pairs in the same order
+    Uint64 result = DIGEST_BASIS;
+    for(auto it = _bound.begin(); it != _bound.end(); ++it) {
+        result = fold(result, it->first, 4);
+        result = fold(result, it->second, 8);
+    }
+    return result;
+}
+
+/**
+ * Records the digest of this tick, and returns it.
+ *
+ * Digests of other peers waiting for this tick are compared.
+ *
+ * @param tick  The current tick
+ *
+ * @return the digest of every binding.
+ */
+Uint64 ObstacleIds::record(Uint64 tick) {
+    Uint64 local = digest();
+    _history.push_back(std::make_pair(tick, local));
+    while (_history.size() > _capacity) {
+        _history.pop_front();
+    }
+    
+    auto waiting = _pending.find(tick);
+    if (waiting != _pending.end()) {
+        for(auto& entry : waiting->second) {
+            compare(tick, entry.first, local, entry.second);
+        }
+    }
+    // Nothing older can be compared any more
+    _pending.erase(_pending.begin(), _pending.upper_bound(tick));
+    return local;
+}
+
+/**
+ * Compares the digest of another peer, now or once we record that tick.
+ *
+ * Digests for ticks older than the history are dropped.
+ *
+ * @param peer      The other peer
+ * @param tick      The tick of the digest
+ * @param digest    The digest of the other peer
+ */
+void ObstacleIds::receive(Uint32 peer, Uint64 tick, Uint64 digest) {
+    if (_history.empty() || tick > _history.back().first) {
+        _pending[tick].push_back(std::make_pair(peer, digest));
+        return;
+    }
+    for(auto it = _history.begin(); it != _history.end(); ++it) {
+        if (it->first == tick) {
+            compare(tick, peer, it->second, digest);
+            return;
+        }
+    }
+    if (_stats) {
+        _stats->count("ids.digest_expired");
+    }
+}
+
+/**
+ * Compares the digest of another peer with ours.
+ *
+ * @param tick      The tick of the digests
+ * @param peer      The other peer
+ * @param local     Our digest
+ * @param remote    The digest of the other peer
+ */
+void ObstacleIds::compare(Uint64 tick, Uint32 peer, Uint64 local, Uint64 remote) {
+    if (local == remote) {
+        if (_stats) {
+            _stats->count("ids.agreed");
+        }
+        return;
+    }
+    if (_stats) {
+        _stats->count("ids.mismatch");
+    }
+    CULogError("Peer %u disagrees on obstacle ids at tick %llu (%016llx vs %016llx)", peer,
+               (unsigned long long)tick, (unsigned long long)local, (unsigned long long)remote);
+}
@@ -0,0 +1,180 @@
+//
+//  NLObstacleIds.h
+//  Networked Physics Demo
+//
+//  This class keeps spawned obstacles consistent across peers.  Every peer
+//  owns a disjoint block of spawn keys (the top byte is its short UID), and
+//  events carry the keys of the obstacles they create, so crates are known
+//  by the same key everywhere.  The obstacle id is assigned by the world
+//  itself through addInitObstacle(), which numbers obstacles in the order
+//  they are added.  Keyed obstacles are only added by ticked events, which
+//  every peer applies in the same order, so they get the same id on every
+//  peer.  To catch the cases where they do not (e.g. a late event), the
+//  peers exchange a digest of their key to id bindings.
+//
+//  Author: Networked Physics Lab contributors
+//  Version: 10/18/26
+//
+#ifndef __NL_OBSTACLE_IDS_H__
+#define __NL_OBSTACLE_IDS_H__
+#include <cugl/cugl.h>
+#include <deque>
+#include <map>
+#include <vector>
+
+class NetLabStats;
+
+/**
+ * This class reserves spawn keys and tracks the ids bound to them.
+ *
+ * A spawn key is 32 bits: the top byte is the short UID of the peer that
+ * reserved it and the rest is a sequence number. Peers never reserve the
+ * same key, so no round trip is needed to agree on one.
+ *
+ * The ids are never rewritten behind the back of the physics controller.
+ * Instead, the digest of every binding is recorded at regular ticks and
+ * compared with the digests of the other peers at the same ticks.
+ */
+class ObstacleIds {
+protected:
+    /** The short UID of this peer */
+    Uint32 _peer;
+    /** The next sequence number of this peer */
+    Uint32 _next;
+    /** The obstacle id bound to each live key, sorted by key */
+    std::map<Uint32, Uint64> _bound;
+    /** The most recent digests (tick and digest), oldest first */
+    std::deque<std::pair<Uint64, Uint64>> _history;
+    /** The digests of other peers for ticks not recorded yet, by tick */
+    std::map<Uint64, std::vector<std::pair<Uint32, Uint64>>> _pending;
+    /** The number of digests kept */
+    size_t _capacity;
+    /** The statistics log for bindings and mismatches (may be null) */
+    NetLabStats* _stats;
+
+    /**
+     * Compares the digest of another peer with ours.
+     *
+     * @param tick      The tick of the digests
+     * @param peer      The other peer
+     * @param local     Our digest
+     * @param remote    The digest of the other peer
+     */
+    void compare(Uint64 tick, Uint32 peer, Uint64 local, Uint64 remote);
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates a key reservation for peer 0.
+     */
+    ObstacleIds() : _peer(0), _next(0), _capacity(1), _stats(nullptr) {}
+
+    /**
+     * Initializes the key reservation for the given peer.
+     *
+     * @param peer      The short UID of this peer
+     * @param capacity  The number of digests kept for comparison
+     */
+    void init(Uint32 peer, size_t capacity);
+
+    /**
+     * Removes all bindings and digests (but keeps the key sequence).
+     */
+    void clear();
+
+    /**
+     * Sets the statistics log for bindings and mismatches.
+     *
+     * @param stats The statistics log (or nullptr)
+     */
+    void setStats(NetLabStats* stats) { _stats = stats; }
+
+#pragma mark Keys
+    /**
+     * Reserves a contiguous block of keys, returning the first one.
+     *
+     * The sequence wraps after 2^24 keys, which is far more than the number
+     * of obstacles alive at once.
+     *
+     * @param count The number of keys to reserve
+     *
+     * @return the first key of the block
+     */
+    Uint32 reserve(Uint32 count = 1);
+
+    /**
+     * Returns the short UID of the peer that reserved the key.
+     *
+     * @param key   The spawn key
+     *
+     * @return the short UID of the peer that reserved the key.
+     */
+    static Uint32 getPeer(Uint32 key) { return key >> 24; }
+
+#pragma mark Binding
+    /**
+     * Adds the obstacle to the world, and binds its id to the key.
+     *
+     * The obstacle is added with addInitObstacle(), unless it is already in
+     * the world (like a resident crate), in which case it keeps its id. This
+     * must only be called when applying a ticked event, so that every peer
+     * adds the same obstacles in the same order.
+     *
+     * @param world The obstacle world
+     * @param obj   The obstacle to add
+     * @param key   The spawn key of the obstacle
+     *
+     * @return the id of the obstacle
+     */
+    Uint64 bind(const std::shared_ptr<cugl::physics2::ObstacleWorld>& world,
+                const std::shared_ptr<cugl::physics2::Obstacle>& obj, Uint32 key);
+
+    /**
+     * Forgets the binding of a key, once its obstacle leaves play.
+     *
+     * @param key   The spawn key
+     */
+    void unbind(Uint32 key) { _bound.erase(key); }
+
+    /**
+     * Returns the number of keys bound.
+     *
+     * @return the number of keys bound.
+     */
+    size_t size() const { return _bound.size(); }
+
+#pragma mark Digests
+    /**
+     * Returns the digest of every binding.
+     *
+     * The digest only depends on the set of (key, id) pairs, not on the
+     * order in which they were bound.
+     *
+     * @return the digest of every binding.
+     */
+    Uint64 digest() const;
+
+    /**
+     * Records the digest of this tick, and returns it.
+     *
+     * Digests of other peers waiting for this tick are compared.
+     *
+     * @param tick  The current tick
+     *
+     * @return the digest of every binding.
+     */
+    Uint64 record(Uint64 tick);
+
+    /**
+     * Compares the digest of another peer, now or once we record that tick.
+     *
+     * Digests for ticks older than the history are dropped.
+     *
+     * @param peer      The other peer
+     * @param tick      The tick of the digest
+     * @param digest    The digest of the other peer
+     */
+    void receive(Uint32 peer, Uint64 tick, Uint64 digest);
+};
+
+#endif /* __NL_OBSTACLE_IDS_H__ */
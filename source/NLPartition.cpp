@@ -0,0 +1,155 @@
+//
+//  NLPartition.cpp
+//  Networked Physics Demo
+//
+//  This class splits the ownership of the init obstacles between the peers.
+//  By default the host owns (and so synchronizes) every init obstacle, which
+//  makes its uplink the bottleneck as the room grows.  Instead, obstacles
+//  can be assigned by world region or by a hash of their creation order.
+//  Every peer computes the same assignment from the same sorted list of
+//  peers, so no messages are needed to agree on it.  When a peer goes
+//  silent, its obstacles are reassigned over the peers that remain.
+//
+//  Author: Networked Physics Lab contributors
+//  Version: 10/18/26
+//
+#include "NLPartition.h"
+#include <algorithm>
+
+using namespace cugl;
+
+/**
+ * Returns a well-mixed hash of an integer.
+ *
+ * This is the lowbias32 mixer, which spreads consecutive indices evenly.
+ *
+ * @param x The integer to hash
+ *
+ * @return a well-mixed hash of an integer.
+ */
+static Uint32 mix(Uint32 x) {
+    x ^= x >> 16;
+    x *= 0x7feb352d;
+    x ^= x >> 15;
+    x *= 0x846ca68b;
+    x ^= x >> 16;
+    return x;
+}
+
+#pragma mark Constructors
+/**
+ * Initializes an empty partition.
+ *
+ * @param mode      The assignment mode
+ * @param bounds    The world bounds
+ */
+void OwnershipPartition::init(Mode mode, const Rect bounds) {
+    _mode = mode;
+    _bounds = bounds;
+    _obstacles.clear();
+    _peers.clear();
+    _heard.clear();
+}
+
+/**
+ * Sets the peers that share the obstacles.
+ *
+ * Every peer is considered heard from at the given tick.
+ *
+ * @param peers The short UIDs of the peers (in any order)
+ * @param tick  The current tick
+ */
+void OwnershipPartition::setPeers(const std::vector<Uint32>& peers, Uint64 tick) {
+    _peers = peers;
+    std::sort(_peers.begin(), _peers.end());
+    _peers.erase(std::unique(_peers.begin(), _peers.end()), _peers.end());
+    _heard.clear();
+    for(auto it = _peers.begin(); it != _peers.end(); ++it) {
+        _heard[*it] = tick;
+    }
+}
+
+#pragma mark Presence
+/**
+ * Records that the given peer was heard from.
+ *
+ * Peers that are not part of the partition are ignored.
+ *
+ * @param peer  The short UID of the peer
+ * @param tick  The current tick
+ */
+void OwnershipPartition::touch(Uint32 peer, Uint64 tick) {
+    auto it = _heard.find(peer);
+    if (it != _heard.end()) {
+        it->second = std::max(it->second, tick);
+    }
+}
+
+/**
+ * Removes the peers that were not heard from within the timeout.
+ *
+ * The obstacles of the removed peers are reassigned to the remaining
+ * ones. The given peer (this machine) is never removed.
+ *
+ * @param self      The short UID of this peer
+ * @param tick      The current tick
+ * @param timeout   The number of silent ticks before a peer is gone
+ *
+ * @return true if any peer was removed
+ */
+bool OwnershipPartition::expire(Uint32 self, Uint64 tick, Uint64 timeout) {
+    size_t before = _peers.size();
+    for(auto it = _peers.begin(); it != _peers.end(); ) {
+        if (*it != self && tick > _heard[*it]+timeout) {
+            _heard.erase(*it);
+            it = _peers.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    return _peers.size() != before;
+}
+
+#pragma mark Assignment
+/**
+ * Returns the short UID of the peer that owns the given obstacle.
+ *
+ * This is 0 in HOST mode, or if there are no peers.
+ *
+ * @param index The creation index of the obstacle
+ *
+ * @return the short UID of the peer that owns the given obstacle.
+ */
+Uint32 OwnershipPartition::getOwner(size_t index) const {
+    if (_mode == Mode::HOST || _peers.empty() || index >= _obstacles.size()) {
+        return 0;
+    }
+    size_t count = _peers.size();
+    size_t slot = 0;
+    if (_mode == Mode::REGION) {
+        // Use the spawn position, so that the assignment never depends on the simulation
+        float x = (_obstacles[index]->getPosition().x-_bounds.origin.x)/_bounds.size.width;
+        slot = (size_t)std::max(0.0f, x*count);
+        slot = std::min(slot, count-1);
+    } else {
+        slot = mix((Uint32)index) % count;
+    }
+    return _peers[slot];
+}
+
+/**
+ * Returns the obstacles assigned to the given peer.
+ *
+ * @param peer  The short UID of the peer
+ *
+ * @return the obstacles assigned to the given peer.
+ */
+std::vector<std::shared_ptr<physics2::Obstacle>> OwnershipPartition::getAssigned(Uint32 peer) const {
+    std::vector<std::shared_ptr<physics2::Obstacle>> result;
+    for(size_t ii = 0; ii < _obstacles.size(); ii++) {
+        if (!_obstacles[ii]->isRemoved() && getOwner(ii) == peer) {
+            result.push_back(_obstacles[ii]);
+        }
+    }
+    return result;
+}
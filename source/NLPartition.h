@@ -0,0 +1,157 @@
+//
+//  NLPartition.h
+//  Networked Physics Demo
+//
+//  This class splits the ownership of the init obstacles between the peers.
+//  By default the host owns (and so synchronizes) every init obstacle, which
+//  makes its uplink the bottleneck as the room grows.  Instead, obstacles
+//  can be assigned by world region or by a hash of their creation order.
+//  Every peer computes the same assignment from the same sorted list of
+//  peers, so no messages are needed to agree on it.  When a peer goes
+//  silent, its obstacles are reassigned over the peers that remain.
+//
+//  Author: Networked Physics Lab contributors
+//  Version: 10/18/26
+//
+#ifndef __NL_PARTITION_H__
+#define __NL_PARTITION_H__
+#include <cugl/cugl.h>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * This class assigns init obstacles to peers.
+ *
+ * Obstacles must be added in the same order on every peer (which is the
+ * case for obstacles created by populate). The peers are identified by
+ * their short UIDs; when the set of peers changes, the assignment of every
+ * obstacle is recomputed over the remaining peers.
+ *
+ * A peer is considered gone once nothing has been heard from it for a
+ * timeout. Every peer must use the same timeout, so that they all agree on
+ * the new assignment (up to the delivery delay of the last message).
+ */
+class OwnershipPartition {
+public:
+    /** How init obstacles are assigned to peers */
+    enum class Mode : int {
+        /** The host owns every obstacle */
+        HOST = 0,
+        /** The world is split into vertical strips, one per peer */
+        REGION = 1,
+        /** Obstacles are spread by a hash of their creation order */
+        HASH = 2
+    };
+
+protected:
+    /** The assignment mode */
+    Mode _mode;
+    /** The world bounds (for region assignment) */
+    cugl::Rect _bounds;
+    /** The init obstacles, in creation order */
+    std::vector<std::shared_ptr<cugl::physics2::Obstacle>> _obstacles;
+    /** The short UIDs of the peers, in ascending order */
+    std::vector<Uint32> _peers;
+    /** The last tick each peer was heard from */
+    std::unordered_map<Uint32, Uint64> _heard;
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates a partition where the host owns everything.
+     */
+    OwnershipPartition() : _mode(Mode::HOST) {}
+
+    /**
+     * Initializes an empty partition.
+     *
+     * @param mode      The assignment mode
+     * @param bounds    The world bounds
+     */
+    void init(Mode mode, const cugl::Rect bounds);
+
+    /**
+     * Removes all obstacles (but keeps the peers).
+     */
+    void clear() { _obstacles.clear(); }
+
+#pragma mark Attributes
+    /**
+     * Returns the assignment mode.
+     *
+     * @return the assignment mode.
+     */
+    Mode getMode() const { return _mode; }
+
+    /**
+     * Sets the peers that share the obstacles.
+     *
+     * Every peer is considered heard from at the given tick.
+     *
+     * @param peers The short UIDs of the peers (in any order)
+     * @param tick  The current tick
+     */
+    void setPeers(const std::vector<Uint32>& peers, Uint64 tick);
+
+    /**
+     * Returns the short UIDs of the peers, in ascending order.
+     *
+     * @return the short UIDs of the peers, in ascending order.
+     */
+    const std::vector<Uint32>& getPeers() const { return _peers; }
+
+#pragma mark Presence
+    /**
+     * Records that the given peer was heard from.
+     *
+     * Peers that are not part of the partition are ignored.
+     *
+     * @param peer  The short UID of the peer
+     * @param tick  The current tick
+     */
+    void touch(Uint32 peer, Uint64 tick);
+
+    /**
+     * Removes the peers that were not heard from within the timeout.
+     *
+     * The obstacles of the removed peers are reassigned to the remaining
+     * ones. The given peer (this machine) is never removed.
+     *
+     * @param self      The short UID of this peer
+     * @param tick      The current tick
+     * @param timeout   The number of silent ticks before a peer is gone
+     *
+     * @return true if any peer was removed
+     */
+    bool expire(Uint32 self, Uint64 tick, Uint64 timeout);
+
+#pragma mark Assignment
+    /**
+     * Adds an init obstacle to the partition.
+     *
+     * @param obj   The init obstacle
+     */
+    void add(const std::shared_ptr<cugl::physics2::Obstacle>& obj) { _obstacles.push_back(obj); }
+
+    /**
+     * Returns the short UID of the peer that owns the given obstacle.
+     *
+     * This is 0 in HOST mode, or if there are no peers.
+     *
+     * @param index The creation index of the obstacle
+     *
+     * @return the short UID of the peer that owns the given obstacle.
+     */
+    Uint32 getOwner(size_t index) const;
+
+    /**
+     * Returns the obstacles assigned to the given peer.
+     *
+     * @param peer  The short UID of the peer
+     *
+     * @return the obstacles assigned to the given peer.
+     */
+    std::vector<std::shared_ptr<cugl::physics2::Obstacle>> getAssigned(Uint32 peer) const;
+};
+
+#endif /* __NL_PARTITION_H__ */
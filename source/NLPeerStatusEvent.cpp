@@ -0,0 +1,64 @@
+//
+//  NLPeerStatusEvent.cpp
+//  Networked Physics Lab
+//
+//  This class represents a peer reporting that it is still present, along
+//  with how many obstacles it owns and an estimate of the bytes per second
+//  it sends to keep them in sync.  Peers that stop reporting are treated as
+//  gone, and their obstacles are reassigned.  The relay peer also announces
+//  whether it is relaying, so that the other peers follow its topology.
+//
+//  Created by the Networked Physics Lab contributors on 10/18/26.
+//
+
+#include "NLPeerStatusEvent.h"
+
+/**
+ * This method is used by the NetEventController to create a new event of using a
+ * reference of the same type.
+ *
+ * Not that this method is not static, it differs from the static alloc() method
+ * and all methods must implement this method.
+ */
+std::shared_ptr<NetEvent> PeerStatusEvent::newEvent(){
+    return std::make_shared<PeerStatusEvent>();
+}
+
+std::shared_ptr<NetEvent> PeerStatusEvent::allocPeerStatusEvent(Uint32 peer, Uint32 owned, Uint32 upstream, bool relay){
+    auto event = std::make_shared<PeerStatusEvent>();
+    event->_peer = peer;
+    event->_owned = owned;
+    event->_upstream = upstream;
+    event->_relay = relay;
+    return event;
+}
+
+/**
+ * Serialize any paramater that the event contains to a vector of bytes.
+ */
+std::vector<std::byte> PeerStatusEvent::serialize(){
+    _serializer.reset();
+    _serializer.writeUint32(_peer);
+    _serializer.writeUint32(_owned);
+    _serializer.writeUint32(_upstream);
+    _serializer.writeBool(_relay);
+    return _serializer.serialize();
+}
+
+/**
+ * Deserialize a vector of bytes and set the corresponding parameters.
+ *
+ * @param data  a byte vector packed by serialize()
+ *
+ * This function should be the "reverse" of the serialize() function: it
+ * should be able to recreate a serialized event entirely, setting all the
+ * useful parameters of this class.
+ */
+void PeerStatusEvent::deserialize(const std::vector<std::byte>& data){
+    _deserializer.reset();
+    _deserializer.receive(data);
+    _peer = _deserializer.readUint32();
+    _owned = _deserializer.readUint32();
+    _upstream = _deserializer.readUint32();
+    _relay = _deserializer.readBool();
+}
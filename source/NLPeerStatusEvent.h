@@ -0,0 +1,77 @@
+//
+//  NLPeerStatusEvent.h
+//  Networked Physics Lab
+//
+//  This class represents a peer reporting that it is still present, along
+//  with how many obstacles it owns and an estimate of the bytes per second
+//  it sends to keep them in sync.  Peers that stop reporting are treated as
+//  gone, and their obstacles are reassigned.  The relay peer also announces
+//  whether it is relaying, so that the other peers follow its topology.
+//
+//  Created by the Networked Physics Lab contributors on 10/18/26.
+//
+
+#ifndef NLPeerStatusEvent_h
+#define NLPeerStatusEvent_h
+
+#include <cugl/cugl.h>
+using namespace cugl::netphysics;
+using namespace cugl;
+
+class PeerStatusEvent : public NetEvent {
+    
+protected:
+    LWSerializer _serializer;
+    LWDeserializer _deserializer;
+    
+    /** The short UID of the reporting peer */
+    Uint32 _peer;
+    /** The number of obstacles owned by the peer */
+    Uint32 _owned;
+    /** The estimated bytes per second the peer sends for its obstacles */
+    Uint32 _upstream;
+    /** Whether the peer relays every state update */
+    bool _relay;
+    
+public:
+    /**
+     * This method is used by the NetEventController to create a new event of using a
+     * reference of the same type.
+     *
+     * Not that this method is not static, it differs from the static alloc() method
+     * and all methods must implement this method.
+     */
+    std::shared_ptr<NetEvent> newEvent() override;
+    
+    static std::shared_ptr<NetEvent> allocPeerStatusEvent(Uint32 peer, Uint32 owned, Uint32 upstream, bool relay);
+    
+    /**
+     * Serialize any paramater that the event contains to a vector of bytes.
+     */
+    std::vector<std::byte> serialize() override;
+    /**
+     * Deserialize a vector of bytes and set the corresponding parameters.
+     *
+     * @param data  a byte vector packed by serialize()
+     *
+     * This function should be the "reverse" of the serialize() function: it
+     * should be able to recreate a serialized event entirely, setting all the
+     * useful parameters of this class.
+     */
+    void deserialize(const std::vector<std::byte>& data) override;
+    
+    /** Gets the short UID of the reporting peer. */
+    Uint32 getPeer() const { return _peer; }
+    
+    /** Gets the number of obstacles owned by the peer. */
+    Uint32 getOwned() const { return _owned; }
+    
+    /** Gets the estimated bytes per second the peer sends for its obstacles. */
+    Uint32 getUpstream() const { return _upstream; }
+    
+    /** Gets whether the peer relays every state update. */
+    bool isRelaying() const { return _relay; }
+};
+
+
+#endif /* NLPeerStatusEvent_h */
@@ -0,0 +1,88 @@
+//
+//  NLPingEvent.cpp
+//  Networked Physics Lab
+//
+//  This class represents a latency probe.  Every peer broadcasts a probe
+//  with its clock and tick at regular intervals.  There are no separate
+//  answers: each probe echoes the last probe received from every other
+//  peer, with the time it was held.  The round trip time, and the probes
+//  that never come back, drive the congestion controller.  The clock and
+//  tick of the host let clients synchronize their tick with it.
+//
+//  Created by the Networked Physics Lab contributors on 10/18/26.
+//
+
+#include "NLPingEvent.h"
+
+/**
+ * This method is used by the NetEventController to create a new event of using a
+ * reference of the same type.
+ *
+ * Not that this method is not static, it differs from the static alloc() method
+ * and all methods must implement this method.
+ */
+std::shared_ptr<NetEvent> PingEvent::newEvent(){
+    return std::make_shared<PingEvent>();
+}
+
+std::shared_ptr<NetEvent> PingEvent::allocPingEvent(Uint32 origin, Uint32 seq, Uint64 time, Uint64 tick,
+                                                    bool host, const std::vector<Echo>& echoes){
+    auto event = std::make_shared<PingEvent>();
+    event->_origin = origin;
+    event->_seq = seq;
+    event->_time = time;
+    event->_tick = tick;
+    event->_fromHost = host;
+    event->_echoes = echoes;
+    return event;
+}
+
+/**
+ * Serialize any paramater that the event contains to a vector of bytes.
+ */
+std::vector<std::byte> PingEvent::serialize(){
+    _serializer.reset();
+    _serializer.writeUint32(_origin);
+    _serializer.writeUint32(_seq);
+    _serializer.writeUint64(_time);
+    _serializer.writeUint64(_tick);
+    _serializer.writeBool(_fromHost);
+    _serializer.writeUint32((Uint32)_echoes.size());
+    for(auto& echo : _echoes){
+        _serializer.writeUint32(echo.origin);
+        _serializer.writeUint32(echo.seq);
+        _serializer.writeUint64(echo.time);
+        _serializer.writeUint64(echo.hold);
+    }
+    return _serializer.serialize();
+}
+
+/**
+ * Deserialize a vector of bytes and set the corresponding parameters.
+ *
+ * @param data  a byte vector packed by serialize()
+ *
+ * This function should be the "reverse" of the serialize() function: it
+ * should be able to recreate a serialized event entirely, setting all the
+ * useful parameters of this class.
+ */
+void PingEvent::deserialize(const std::vector<std::byte>& data){
+    _deserializer.reset();
+    _deserializer.receive(data);
+    _origin = _deserializer.readUint32();
+    _seq = _deserializer.readUint32();
+    _time = _deserializer.readUint64();
+    _tick = _deserializer.readUint64();
+    _fromHost = _deserializer.readBool();
+    Uint32 count = _deserializer.readUint32();
+    _echoes.clear();
+    _echoes.reserve(count);
+    for(Uint32 ii = 0; ii < count; ii++){
+        Echo echo;
+        echo.origin = _deserializer.readUint32();
+        echo.seq = _deserializer.readUint32();
+        echo.time = _deserializer.readUint64();
+        echo.hold = _deserializer.readUint64();
+        _echoes.push_back(echo);
+    }
+}
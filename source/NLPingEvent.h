@@ -0,0 +1,102 @@
+//
+//  NLPingEvent.h
+//  Networked Physics Lab
+//
+//  This class represents a latency probe.  Every peer broadcasts a probe
+//  with its clock and tick at regular intervals.  There are no separate
+//  answers: each probe echoes the last probe received from every other
+//  peer, with the time it was held.  The round trip time, and the probes
+//  that never come back, drive the congestion controller.  The clock and
+//  tick of the host let clients synchronize their tick with it.
+//
+//  Created by the Networked Physics Lab contributors on 10/18/26.
+//
+
+#ifndef NLPingEvent_h
+#define NLPingEvent_h
+
+#include <cugl/cugl.h>
+#include <vector>
+using namespace cugl::netphysics;
+using namespace cugl;
+
+class PingEvent : public NetEvent {
+public:
+    /** The echo of a probe from another peer */
+    struct Echo {
+        /** The short UID of the peer that sent the probe */
+        Uint32 origin;
+        /** The sequence number of the probe */
+        Uint32 seq;
+        /** The time the probe was sent, in microseconds of the origin's clock */
+        Uint64 time;
+        /** The time the probe was held before this echo, in microseconds */
+        Uint64 hold;
+    };
+    
+protected:
+    LWSerializer _serializer;
+    LWDeserializer _deserializer;
+    
+    /** The short UID of the peer that sent the probe */
+    Uint32 _origin;
+    /** The sequence number of the probe */
+    Uint32 _seq;
+    /** The time the probe was sent, in microseconds of the origin's clock */
+    Uint64 _time;
+    /** The tick of the origin when it sent the probe */
+    Uint64 _tick;
+    /** Whether the origin is the host */
+    bool _fromHost;
+    /** The echoes of the last probes the origin received */
+    std::vector<Echo> _echoes;
+    
+public:
+    /**
+     * This method is used by the NetEventController to create a new event of using a
+     * reference of the same type.
+     *
+     * Not that this method is not static, it differs from the static alloc() method
+     * and all methods must implement this method.
+     */
+    std::shared_ptr<NetEvent> newEvent() override;
+    
+    static std::shared_ptr<NetEvent> allocPingEvent(Uint32 origin, Uint32 seq, Uint64 time, Uint64 tick,
+                                                    bool host, const std::vector<Echo>& echoes);
+    
+    /**
+     * Serialize any paramater that the event contains to a vector of bytes.
+     */
+    std::vector<std::byte> serialize() override;
+    /**
+     * Deserialize a vector of bytes and set the corresponding parameters.
+     *
+     * @param data  a byte vector packed by serialize()
+     *
+     * This function should be the "reverse" of the serialize() function: it
+     * should be able to recreate a serialized event entirely, setting all the
+     * useful parameters of this class.
+     */
+    void deserialize(const std::vector<std::byte>& data) override;
+    
+    /** Gets the short UID of the peer that sent the probe. */
+    Uint32 getOrigin() const { return _origin; }
+    
+    /** Gets the sequence number of the probe. */
+    Uint32 getSequence() const { return _seq; }
+    
+    /** Gets the time the probe was sent, in microseconds of the origin's clock. */
+    Uint64 getTime() const { return _time; }
+    
+    /** Gets the tick of the origin when it sent the probe. */
+    Uint64 getTick() const { return _tick; }
+    
+    /** Gets whether the origin is the host. */
+    bool isFromHost() const { return _fromHost; }
+    
+    /** Gets the echoes of the last probes the origin received. */
+    const std::vector<Echo>& getEchoes() const { return _echoes; }
+};
+
+
+#endif /* NLPingEvent_h */
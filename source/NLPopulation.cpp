@@ -0,0 +1,133 @@
+//
+//  NLPopulation.cpp
+//  Networked Physics Demo
+//
+//  This class bounds the number of factory-spawned obstacles in the world.
+//  Every spawned crate is registered under its spawn key (which is the same
+//  on every peer).  When the population exceeds its limit, the least
+//  relevant crates are chosen for removal: first those outside the world
+//  bounds, then those that are asleep, and then the oldest.  The removal
+//  itself is done by the game scene with a single DespawnEvent.
+//
+//  Author: Networked Physics Lab contributors
+//  Version: 10/18/26
+//
+#include "NLPopulation.h"
+#include <box2d/b2_body.h>
+#include <algorithm>
+#include <tuple>
+
+using namespace cugl;
+
+#pragma mark Constructors
+/**
+ * Initializes an empty population.
+ *
+ * @param capacity  The maximum number of spawned obstacles
+ * @param bounds    The region outside of which obstacles are irrelevant
+ */
+void CratePopulation::init(size_t capacity, const Rect bounds) {
+    _capacity = capacity;
+    _bounds = bounds;
+    clear();
+}
+
+/**
+ * Removes all obstacles from this population.
+ */
+void CratePopulation::clear() {
+    _entries.clear();
+    _doomed = 0;
+}
+
+#pragma mark Population
+/**
+ * Registers a newly spawned obstacle.
+ *
+ * @param key   The spawn key
+ * @param obj   The spawned obstacle
+ * @param node  The scene node of the obstacle
+ * @param tick  The current tick
+ */
+void CratePopulation::add(Uint32 key, const std::shared_ptr<physics2::Obstacle>& obj,
+                          const std::shared_ptr<scene2::SceneNode>& node, Uint64 tick) {
+    Entry entry;
+    entry.key = key;
+    entry.obstacle = obj;
+    entry.node = node;
+    entry.spawned = tick;
+    entry.doomed = false;
+    _entries[key] = entry;
+}
+
+/**
+ * Unregisters the obstacle with the given key, returning its entry.
+ *
+ * If there is no such obstacle, the entry returned has no obstacle.
+ *
+ * @param key   The spawn key
+ *
+ * @return the entry of the removed obstacle
+ */
+CratePopulation::Entry CratePopulation::remove(Uint32 key) {
+    Entry result;
+    auto it = _entries.find(key);
+    if (it == _entries.end()) {
+        result.key = key;
+        result.doomed = false;
+        return result;
+    }
+    result = it->second;
+    if (result.doomed) {
+        _doomed--;
+    }
+    _entries.erase(it);
+    return result;
+}
+
+/**
+ * Chooses the obstacles to remove so that the population fits its limit.
+ *
+ * The chosen obstacles are marked as doomed, and will not be chosen again.
+ * Irrelevant obstacles are chosen first: those out of bounds, then those
+ * that are asleep, and finally the oldest ones. The keys are returned in
+ * ascending order.
+ *
+ * @param slack The number of extra obstacles to remove (to batch removals)
+ *
+ * @return the spawn keys of the obstacles to remove
+ */
+std::vector<Uint32> CratePopulation::selectVictims(size_t slack) {
+    std::vector<Uint32> result;
+    size_t alive = _entries.size()-_doomed;
+    if (alive <= _capacity) {
+        return result;
+    }
+    size_t count = std::min(alive-_capacity+slack, alive);
+
+    // Rank by (in bounds, awake, spawn tick); the smallest is least relevant
+    typedef std::tuple<bool,bool,Uint64,Uint32> Rank;
+    std::vector<Rank> ranks;
+    ranks.reserve(alive);
+    for(auto it = _entries.begin(); it != _entries.end(); ++it) {
+        const Entry& entry = it->second;
+        if (entry.doomed) {
+            continue;
+        }
+        b2Body* body = entry.obstacle->getBody();
+        bool inside = _bounds.contains(entry.obstacle->getPosition());
+        bool awake  = body != nullptr && body->IsAwake();
+        ranks.push_back(std::make_tuple(inside,awake,entry.spawned,entry.key));
+    }
+    std::partial_sort(ranks.begin(), ranks.begin()+count, ranks.end());
+
+    result.reserve(count);
+    for(size_t ii = 0; ii < count; ii++) {
+        Uint32 key = std::get<3>(ranks[ii]);
+        _entries[key].doomed = true;
+        result.push_back(key);
+    }
+    _doomed += count;
+    std::sort(result.begin(),result.end());
+    return result;
+}
@@ -0,0 +1,127 @@
+//
+//  NLPopulation.h
+//  Networked Physics Demo
+//
+//  This class bounds the number of factory-spawned obstacles in the world.
+//  Every spawned crate is registered under its spawn key (which is the same
+//  on every peer).  When the population exceeds its limit, the least
+//  relevant crates are chosen for removal: first those outside the world
+//  bounds, then those that are asleep, and then the oldest.  The removal
+//  itself is done by the game scene with a single DespawnEvent.
+//
+//  Author: Networked Physics Lab contributors
+//  Version: 10/18/26
+//
+#ifndef __NL_POPULATION_H__
+#define __NL_POPULATION_H__
+#include <cugl/cugl.h>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * This class tracks the factory-spawned obstacles in the world.
+ *
+ * The population only selects which obstacles to remove. It does not remove
+ * them from the world itself, as that must happen at the same tick on every
+ * peer.  The caller is expected to broadcast the keys chosen by
+ * {@link #selectVictims} and then call {@link #remove} once the removal is due.
+ */
+class CratePopulation {
+public:
+    /** A spawned obstacle and its scene node */
+    struct Entry {
+        /** The spawn key (identical on every peer) */
+        Uint32 key;
+        /** The spawned obstacle */
+        std::shared_ptr<cugl::physics2::Obstacle> obstacle;
+        /** The scene node of the obstacle */
+        std::shared_ptr<cugl::scene2::SceneNode> node;
+        /** The tick this obstacle was spawned */
+        Uint64 spawned;
+        /** Whether this obstacle was already chosen for removal */
+        bool doomed;
+    };
+
+protected:
+    /** The spawned obstacles, indexed by spawn key */
+    std::unordered_map<Uint32, Entry> _entries;
+    /** The maximum number of spawned obstacles */
+    size_t _capacity;
+    /** The number of doomed obstacles still in the world */
+    size_t _doomed;
+    /** The region outside of which obstacles are considered irrelevant */
+    cugl::Rect _bounds;
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates an empty population with no limit.
+     */
+    CratePopulation() : _capacity(SIZE_MAX), _doomed(0) {}
+
+    /**
+     * Initializes an empty population.
+     *
+     * @param capacity  The maximum number of spawned obstacles
+     * @param bounds    The region outside of which obstacles are irrelevant
+     */
+    void init(size_t capacity, const cugl::Rect bounds);
+
+    /**
+     * Removes all obstacles from this population.
+     */
+    void clear();
+
+#pragma mark Population
+    /**
+     * Registers a newly spawned obstacle.
+     *
+     * @param key   The spawn key
+     * @param obj   The spawned obstacle
+     * @param node  The scene node of the obstacle
+     * @param tick  The current tick
+     */
+    void add(Uint32 key, const std::shared_ptr<cugl::physics2::Obstacle>& obj,
+             const std::shared_ptr<cugl::scene2::SceneNode>& node, Uint64 tick);
+
+    /**
+     * Unregisters the obstacle with the given key, returning its entry.
+     *
+     * If there is no such obstacle, the entry returned has no obstacle.
+     *
+     * @param key   The spawn key
+     *
+     * @return the entry of the removed obstacle
+     */
+    Entry remove(Uint32 key);
+
+    /**
+     * Chooses the obstacles to remove so that the population fits its limit.
+     *
+     * The chosen obstacles are marked as doomed, and will not be chosen again.
+     * Irrelevant obstacles are chosen first: those out of bounds, then those
+     * that are asleep, and finally the oldest ones. The keys are returned in
+     * ascending order.
+     *
+     * @param slack The number of extra obstacles to remove (to batch removals)
+     *
+     * @return the spawn keys of the obstacles to remove
+     */
+    std::vector<Uint32> selectVictims(size_t slack);
+
+    /**
+     * Returns the number of obstacles in this population.
+     *
+     * @return the number of obstacles in this population.
+     */
+    size_t size() const { return _entries.size(); }
+
+    /**
+     * Returns the maximum number of spawned obstacles.
+     *
+     * @return the maximum number of spawned obstacles.
+     */
+    size_t getCapacity() const { return _capacity; }
+};
+
+#endif /* __NL_POPULATION_H__ */
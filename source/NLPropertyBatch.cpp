@@ -0,0 +1,187 @@
+//
+//  NLPropertyBatch.cpp
+//  Networked Physics Demo
+//
+//  This class coalesces changes to the properties of shared obstacles.
+//  Every setter called on a shared obstacle is monitored by the physics
+//  controller and may be sent to the other peers.  Instead of calling the
+//  setters directly (possibly several times a tick, possibly with the value
+//  the obstacle already has), gameplay code marks the fields dirty here, and
+//  the batch writes each changed field at most once per tick.
+//
+//  Author: Networked Physics Lab contributors
+//  Version: 10/18/26
+//
+#include "NLPropertyBatch.h"
+#include "NLStats.h"
+
+using namespace cugl;
+
+#pragma mark Internal Helpers
+/**
+ * Returns the record for the given obstacle, creating it if necessary.
+ *
+ * @param obj   The obstacle
+ *
+ * @return the record for the given obstacle
+ */
+SharedPropertyBatch::Record& SharedPropertyBatch::acquire(const std::shared_ptr<physics2::Obstacle>& obj) {
+    if (_stats) {
+        _stats->count("props.set");
+    }
+    for(auto it = _records.begin(); it != _records.end(); ++it) {
+        if (it->obstacle == obj) {
+            return *it;
+        }
+    }
+    Record record;
+    record.obstacle = obj;
+    record.mask = 0;
+    record.angle = 0;
+    record.angularVelocity = 0;
+    _records.push_back(record);
+    return _records.back();
+}
+
+/**
+ * Returns the record for the given obstacle, or nullptr if none.
+ *
+ * @param obj   The obstacle
+ *
+ * @return the record for the given obstacle, or nullptr if none.
+ */
+const SharedPropertyBatch::Record* SharedPropertyBatch::find(const std::shared_ptr<physics2::Obstacle>& obj) const {
+    for(auto it = _records.begin(); it != _records.end(); ++it) {
+        if (it->obstacle == obj) {
+            return &(*it);
+        }
+    }
+    return nullptr;
+}
+
+#pragma mark Setters
+/**
+ * Marks the angle of the obstacle as dirty.
+ *
+ * @param obj   The obstacle
+ * @param value The new angle
+ */
+void SharedPropertyBatch::setAngle(const std::shared_ptr<physics2::Obstacle>& obj, float value) {
+    Record& record = acquire(obj);
+    record.mask |= ANGLE;
+    record.angle = value;
+}
+
+/**
+ * Marks the position of the obstacle as dirty.
+ *
+ * @param obj   The obstacle
+ * @param value The new position
+ */
+void SharedPropertyBatch::setPosition(const std::shared_ptr<physics2::Obstacle>& obj, const Vec2 value) {
+    Record& record = acquire(obj);
+    record.mask |= POSITION;
+    record.position = value;
+}
+
+/**
+ * Marks the linear velocity of the obstacle as dirty.
+ *
+ * @param obj   The obstacle
+ * @param value The new linear velocity
+ */
+void SharedPropertyBatch::setLinearVelocity(const std::shared_ptr<physics2::Obstacle>& obj, const Vec2 value) {
+    Record& record = acquire(obj);
+    record.mask |= LINEAR_VELOCITY;
+    record.velocity = value;
+}
+
+/**
+ * Marks the angular velocity of the obstacle as dirty.
+ *
+ * @param obj   The obstacle
+ * @param value The new angular velocity
+ */
+void SharedPropertyBatch::setAngularVelocity(const std::shared_ptr<physics2::Obstacle>& obj, float value) {
+    Record& record = acquire(obj);
+    record.mask |= ANGULAR_VELOCITY;
+    record.angularVelocity = value;
+}
+
+#pragma mark Getters
+/**
+ * Returns the angle of the obstacle, including any pending change.
+ *
+ * @param obj   The obstacle
+ *
+ * @return the angle of the obstacle, including any pending change.
+ */
+float SharedPropertyBatch::getAngle(const std::shared_ptr<physics2::Obstacle>& obj) const {
+    const Record* record = find(obj);
+    if (record != nullptr && (record->mask & ANGLE)) {
+        return record->angle;
+    }
+    return obj->getAngle();
+}
+
+#pragma mark Flushing
+/**
+ * Writes all pending changes to their obstacles.
+ *
+ * This should be called once per tick, before the physics step. Fields
+ * set to the value the obstacle already has are dropped.
+ *
+ * @return the number of fields written
+ */
+size_t SharedPropertyBatch::flush() {
+    size_t written = 0;
+    size_t dropped = 0;
+    for(auto it = _records.begin(); it != _records.end(); ++it) {
+        physics2::Obstacle* obs = it->obstacle.get();
+        if (obs->isRemoved() || !obs->isEnabled()) {
+            continue;
+        }
+
+        // Drop the fields that would not change anything
+        Uint8 mask = it->mask;
+        if ((mask & ANGLE) && it->angle == obs->getAngle()) {
+            mask &= ~ANGLE;
+        }
+        if ((mask & POSITION) && it->position == obs->getPosition()) {
+            mask &= ~POSITION;
+        }
+        if ((mask & LINEAR_VELOCITY) && it->velocity == obs->getLinearVelocity()) {
+            mask &= ~LINEAR_VELOCITY;
+        }
+        if ((mask & ANGULAR_VELOCITY) && it->angularVelocity == obs->getAngularVelocity()) {
+            mask &= ~ANGULAR_VELOCITY;
+        }
+
+        if (mask & ANGLE) {
+            obs->setAngle(it->angle);
+            written++;
+        }
+        if (mask & POSITION) {
+            obs->setPosition(it->position);
+            written++;
+        }
+        if (mask & LINEAR_VELOCITY) {
+            obs->setLinearVelocity(it->velocity);
+            written++;
+        }
+        if (mask & ANGULAR_VELOCITY) {
+            obs->setAngularVelocity(it->angularVelocity);
+            written++;
+        }
+        for(Uint8 bits = it->mask & ~mask; bits; bits &= bits-1) {
+            dropped++;
+        }
+    }
+    _records.clear();
+
+    if (_stats) {
+        _stats->count("props.written", written);
+        _stats->count("props.noop", dropped);
+    }
+    return written;
+}
@@ -0,0 +1,169 @@
+//
+//  NLPropertyBatch.h
+//  Networked Physics Demo
+//
+//  This class coalesces changes to the properties of shared obstacles.
+//  Every setter called on a shared obstacle is monitored by the physics
+//  controller and may be sent to the other peers.  Instead of calling the
+//  setters directly (possibly several times a tick, possibly with the value
+//  the obstacle already has), gameplay code marks the fields dirty here, and
+//  the batch writes each changed field at most once per tick.
+//
+//  Author: Networked Physics Lab contributors
+//  Version: 10/18/26
+//
+#ifndef __NL_PROPERTY_BATCH_H__
+#define __NL_PROPERTY_BATCH_H__
+#include <cugl/cugl.h>
+#include <vector>
+
+class NetLabStats;
+
+/**
+ * This class coalesces property changes of shared obstacles within a tick.
+ *
+ * Each obstacle with pending changes has one record, holding a mask of the
+ * dirty fields and their latest values. Setting the same field twice in a
+ * tick simply overwrites the value. On {@link #flush}, fields whose value is
+ * the same as the obstacle's current value are dropped, and the rest are
+ * written to the obstacle in one pass.
+ *
+ * Reads through this class see the pending value, so that incremental
+ * updates (like turning the cannon) accumulate correctly between flushes.
+ */
+class SharedPropertyBatch {
+public:
+    /** The fields that may be batched */
+    enum Field : Uint8 {
+        /** The obstacle angle */
+        ANGLE            = 1 << 0,
+        /** The obstacle position */
+        POSITION         = 1 << 1,
+        /** The obstacle linear velocity */
+        LINEAR_VELOCITY  = 1 << 2,
+        /** The obstacle angular velocity */
+        ANGULAR_VELOCITY = 1 << 3
+    };
+
+protected:
+    /** The pending changes of a single obstacle */
+    struct Record {
+        /** The obstacle to change */
+        std::shared_ptr<cugl::physics2::Obstacle> obstacle;
+        /** The mask of dirty fields */
+        Uint8 mask;
+        /** The pending angle */
+        float angle;
+        /** The pending position */
+        cugl::Vec2 position;
+        /** The pending linear velocity */
+        cugl::Vec2 velocity;
+        /** The pending angular velocity */
+        float angularVelocity;
+    };
+
+    /** The pending records (there are only ever a few, so this is unsorted) */
+    std::vector<Record> _records;
+    /** The statistics log for set and write counts (may be null) */
+    NetLabStats* _stats;
+
+    /**
+     * Returns the record for the given obstacle, creating it if necessary.
+     *
+     * @param obj   The obstacle
+     *
+     * @return the record for the given obstacle
+     */
+    Record& acquire(const std::shared_ptr<cugl::physics2::Obstacle>& obj);
+
+    /**
+     * Returns the record for the given obstacle, or nullptr if none.
+     *
+     * @param obj   The obstacle
+     *
+     * @return the record for the given obstacle, or nullptr if none.
+     */
+    const Record* find(const std::shared_ptr<cugl::physics2::Obstacle>& obj) const;
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates an empty property batch.
+     */
+    SharedPropertyBatch() : _stats(nullptr) {}
+
+    /**
+     * Discards all pending changes.
+     */
+    void clear() { _records.clear(); }
+
+    /**
+     * Sets the statistics log for set and write counts.
+     *
+     * @param stats The statistics log (or nullptr)
+     */
+    void setStats(NetLabStats* stats) { _stats = stats; }
+
+#pragma mark Setters
+    /**
+     * Marks the angle of the obstacle as dirty.
+     *
+     * @param obj   The obstacle
+     * @param value The new angle
+     */
+    void setAngle(const std::shared_ptr<cugl::physics2::Obstacle>& obj, float value);
+
+    /**
+     * Marks the position of the obstacle as dirty.
+     *
+     * @param obj   The obstacle
+     * @param value The new position
+     */
+    void setPosition(const std::shared_ptr<cugl::physics2::Obstacle>& obj, const cugl::Vec2 value);
+
+    /**
+     * Marks the linear velocity of the obstacle as dirty.
+     *
+     * @param obj   The obstacle
+     * @param value The new linear velocity
+     */
+    void setLinearVelocity(const std::shared_ptr<cugl::physics2::Obstacle>& obj, const cugl::Vec2 value);
+
+    /**
+     * Marks the angular velocity of the obstacle as dirty.
+     *
+     * @param obj   The obstacle
+     * @param value The new angular velocity
+     */
+    void setAngularVelocity(const std::shared_ptr<cugl::physics2::Obstacle>& obj, float value);
+
+#pragma mark Getters
+    /**
+     * Returns the angle of the obstacle, including any pending change.
+     *
+     * @param obj   The obstacle
+     *
+     * @return the angle of the obstacle, including any pending change.
+     */
+    float getAngle(const std::shared_ptr<cugl::physics2::Obstacle>& obj) const;
+
+    /**
+     * Returns the number of obstacles with pending changes.
+     *
+     * @return the number of obstacles with pending changes.
+     */
+    size_t size() const { return _records.size(); }
+
+#pragma mark Flushing
+    /**
+     * Writes all pending changes to their obstacles.
+     *
+     * This should be called once per tick, before the physics step. Fields
+     * set to the value the obstacle already has are dropped.
+     *
+     * @return the number of fields written
+     */
+    size_t flush();
+};
+
+#endif /* __NL_PROPERTY_BATCH_H__ */
@@ -0,0 +1,511 @@
+//
+//  NLRecorder.cpp
+//  Networked Physics Demo
+//
+//  These classes record a session to a compact binary file, and replay it.
+//  The recorder captures the local input of every frame, the start of every
+//  fixed tick, every event received from the network (with its payload)
+//  and every event sent (type and size only, for bandwidth).  Identical
+//  consecutive frames are stored as a single run.  Replay reads the whole
+//  file back and steps the game scene through the same frames, ticks and
+//  inbound events as fast as possible, without a connection.  The state
+//  updates that the physics controller exchanges internally are not visible
+//  to the game, so remote obstacles are not replayed, only their events.
+//
+//  Author: Networked Physics Lab contributors
+//  Version: 10/18/26
+//
+#include "NLRecorder.h"
+#include "NLStats.h"
+#include <cstring>
+
+using namespace cugl;
+
+/** The magic number at the start of every recording */
+#define SESSION_MAGIC       "NLRS"
+/** The version of the recording format */
+#define SESSION_VERSION     2
+/** The buffered bytes that trigger a write to disk */
+#define FLUSH_BYTES         65536
+
+/** The tag of a run of frames */
+#define TAG_FRAMES  'F'
+/** The tag of the start of a tick */
+#define TAG_TICK    'T'
+/** The tag of an inbound event */
+#define TAG_IN      'I'
+/** The tag of a sent event */
+#define TAG_OUT     'O'
+/** The tag of a spawned shared obstacle */
+#define TAG_SPAWN   'S'
+/** The tag of the end of the session */
+#define TAG_END     'E'
+
+#pragma mark -
+#pragma mark Recorder
+/**
+ * Opens the given file and writes the session header.
+ *
+ * @param path      The file to write
+ * @param self      The short UID of this peer
+ * @param players   The number of players in the session
+ * @param host      Whether this peer is the host
+ *
+ * @return true if the file was opened
+ */
+bool SessionRecorder::open(const std::string& path, Uint32 self, Uint32 players, bool host) {
+    close();
+    _file.open(path, std::ios::binary | std::ios::trunc);
+    if (!_file.is_open()) {
+        return false;
+    }
+    _buffer.clear();
+    _buffer.reserve(FLUSH_BYTES*2);
+    _buffer.insert(_buffer.end(), SESSION_MAGIC, SESSION_MAGIC+4);
+    _buffer.push_back(SESSION_VERSION);
+    writeVarint(self);
+    writeVarint(players);
+    _buffer.push_back(host ? 1 : 0);
+    _frameRun = 0;
+    _ticks = 0;
+    _sentBytes = 0;
+    return true;
+}
+
+/**
+ * Writes the end of the session and closes the file.
+ *
+ * @param stateBytes    The estimated bytes of state updates sent
+ */
+void SessionRecorder::close(Uint64 stateBytes) {
+    if (!_file.is_open()) {
+        return;
+    }
+    endRun();
+    _buffer.push_back(TAG_END);
+    writeVarint(_ticks);
+    writeVarint(_sentBytes);
+    writeVarint(stateBytes);
+    flush(true);
+    _file.close();
+}
+
+/**
+ * Writes a varint to the buffer.
+ *
+ * @param value The value to write
+ */
+void SessionRecorder::writeVarint(Uint64 value) {
+    while (value >= 0x80) {
+        _buffer.push_back((Uint8)(value | 0x80));
+        value >>= 7;
+    }
+    _buffer.push_back((Uint8)value);
+}
+
+/**
+ * Writes a float to the buffer.
+ *
+ * @param value The value to write
+ */
+void SessionRecorder::writeFloat(float value) {
+    Uint32 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    for(int ii = 0; ii < 4; ii++) {
+        _buffer.push_back((Uint8)(bits >> (8*ii)));
+    }
+}
+
+/**
+ * Writes the current run of frames to the buffer, if any.
+ */
+void SessionRecorder::endRun() {
+    if (_frameRun == 0) {
+        return;
+    }
+    _buffer.push_back(TAG_FRAMES);
+    writeVarint(_frameRun);
+    _buffer.push_back(_frame.flags);
+    if (_frame.flags & SessionInput::TURN) {
+        writeFloat(_frame.vertical);
+    }
+    if (_frame.flags & SessionInput::FIRED) {
+        writeFloat(_frame.power);
+    }
+    for(float dt : _frameTimes) {
+        writeFloat(dt);
+    }
+    _frameRun = 0;
+    _frameTimes.clear();
+}
+
+/**
+ * Writes the buffer to the file, if it is large enough.
+ *
+ * @param force Whether to write the buffer regardless of its size
+ */
+void SessionRecorder::flush(bool force) {
+    if (_buffer.empty() || (!force && _buffer.size() < FLUSH_BYTES)) {
+        return;
+    }
+    _file.write((const char*)_buffer.data(), _buffer.size());
+    if (_stats) {
+        _stats->count("record.bytes", _buffer.size());
+    }
+    _buffer.clear();
+}
+
+/**
+ * Returns the index of the type of the event, or -1 if not attached.
+ *
+ * @param event The event
+ *
+ * @return the index of the type of the event, or -1 if not attached.
+ */
+int SessionRecorder::getType(const std::shared_ptr<NetEvent>& event) const {
+    auto it = _types.find(std::type_index(typeid(*event)));
+    return it == _types.end() ? -1 : it->second;
+}
+
+/**
+ * Records the input and time of a frame.
+ *
+ * @param input The input of the frame
+ * @param dt    The time of the frame, in seconds
+ */
+void SessionRecorder::recordFrame(const SessionInput& input, float dt) {
+    if (!_file.is_open()) {
+        return;
+    }
+    // Most frames are idle, or hold the same turn as the last one
+    if (_frameRun > 0 && input == _frame) {
+        _frameRun++;
+        _frameTimes.push_back(dt);
+        return;
+    }
+    endRun();
+    _frame = input;
+    _frameRun = 1;
+    _frameTimes.push_back(dt);
+    flush();
+}
+
+/**
+ * Records the start of a fixed tick.
+ */
+void SessionRecorder::recordTick() {
+    if (!_file.is_open()) {
+        return;
+    }
+    endRun();
+    _buffer.push_back(TAG_TICK);
+    _ticks++;
+    flush();
+}
+
+/**
+ * Records an event received from the network, with its payload.
+ *
+ * @param event The event received
+ */
+void SessionRecorder::recordIn(const std::shared_ptr<NetEvent>& event) {
+    if (!_file.is_open()) {
+        return;
+    }
+    int type = getType(event);
+    if (type < 0) {
+        if (_stats) {
+            _stats->count("record.unknown");
+        }
+        return;
+    }
+    auto payload = event->serialize();
+    endRun();
+    _buffer.push_back(TAG_IN);
+    _buffer.push_back((Uint8)type);
+    writeVarint(payload.size());
+    const Uint8* bytes = (const Uint8*)payload.data();
+    _buffer.insert(_buffer.end(), bytes, bytes+payload.size());
+    flush();
+}
+
+/**
+ * Records the type and size of an event sent to the network.
+ *
+ * @param event The event sent
+ */
+void SessionRecorder::recordOut(const std::shared_ptr<NetEvent>& event) {
+    if (!_file.is_open()) {
+        return;
+    }
+    int type = getType(event);
+    if (type < 0) {
+        if (_stats) {
+            _stats->count("record.unknown");
+        }
+        return;
+    }
+    // Sent events come back as inbound events, so the payload is not needed
+    size_t size = event->serialize().size();
+    endRun();
+    _buffer.push_back(TAG_OUT);
+    _buffer.push_back((Uint8)type);
+    writeVarint(size);
+    _sentBytes += size;
+    flush();
+}
+
+/**
+ * Records the parameters of a shared obstacle spawned by the crate factory.
+ *
+ * This is every shared crate, spawned by any peer, as they reach the
+ * game through the physics controller and not as events.
+ *
+ * @param params    The serialized factory parameters
+ */
+void SessionRecorder::recordSpawn(const std::vector<std::byte>& params) {
+    if (!_file.is_open()) {
+        return;
+    }
+    endRun();
+    _buffer.push_back(TAG_SPAWN);
+    writeVarint(params.size());
+    const Uint8* bytes = (const Uint8*)params.data();
+    _buffer.insert(_buffer.end(), bytes, bytes+params.size());
+    flush();
+}
+
+#pragma mark -
+#pragma mark Replay
+/**
+ * Reads the given file and its session header.
+ *
+ * @param path  The file to read
+ *
+ * @return true if the file is a recorded session
+ */
+bool SessionReplay::open(const std::string& path) {
+    close();
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::streamsize size = file.tellg();
+    file.seekg(0);
+    _data.resize(size > 0 ? (size_t)size : 0);
+    if (_data.empty() || !file.read((char*)_data.data(), size)) {
+        close();
+        return false;
+    }
+
+    Uint64 self, players;
+    if (_data.size() < 5 || std::memcmp(_data.data(), SESSION_MAGIC, 4) != 0 ||
+        _data[4] != SESSION_VERSION) {
+        close();
+        return false;
+    }
+    _pos = 5;
+    if (!readVarint(self) || !readVarint(players) || _pos >= _data.size()) {
+        close();
+        return false;
+    }
+    _self = (Uint32)self;
+    _players = (Uint32)players;
+    _host = _data[_pos++] != 0;
+    return true;
+}
+
+/**
+ * Discards the recording.
+ */
+void SessionReplay::close() {
+    _data.clear();
+    _pos = 0;
+    _events.clear();
+    _frame = SessionInput();
+    _frameRun = 0;
+    _frameTimes.clear();
+    _spawn.clear();
+    _complete = false;
+    _ticks = 0;
+    _sentBytes = 0;
+    _stateBytes = 0;
+}
+
+/**
+ * Reads a varint, returning false if the data ends first.
+ *
+ * @param value The value read
+ *
+ * @return true if the value was read
+ */
+bool SessionReplay::readVarint(Uint64& value) {
+    value = 0;
+    for(int shift = 0; shift < 64 && _pos < _data.size(); shift += 7) {
+        Uint8 byte = _data[_pos++];
+        value |= (Uint64)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Reads a float, returning false if the data ends first.
+ *
+ * @param value The value read
+ *
+ * @return true if the value was read
+ */
+bool SessionReplay::readFloat(float& value) {
+    if (_data.size()-_pos < 4) {
+        return false;
+    }
+    Uint32 bits = 0;
+    for(int ii = 0; ii < 4; ii++) {
+        bits |= (Uint32)_data[_pos++] << (8*ii);
+    }
+    std::memcpy(&value, &bits, sizeof(value));
+    return true;
+}
+
+/**
+ * Reads an inbound event, and queues it for the current tick.
+ *
+ * @return true if the event was read
+ */
+bool SessionReplay::readEvent() {
+    Uint64 size;
+    if (_pos >= _data.size()) {
+        return false;
+    }
+    Uint8 type = _data[_pos++];
+    if (type >= _prototypes.size() || !readVarint(size) || _data.size()-_pos < size) {
+        return false;
+    }
+    const std::byte* bytes = (const std::byte*)_data.data()+_pos;
+    auto event = _prototypes[type]->newEvent();
+    event->deserialize(std::vector<std::byte>(bytes, bytes+size));
+    _events.push_back(event);
+    _pos += size;
+    return true;
+}
+
+/**
+ * Reads a sent event, and adds its size to the sent bytes.
+ *
+ * @return true if the event was read
+ */
+bool SessionReplay::readSent() {
+    Uint64 size;
+    if (_pos >= _data.size()) {
+        return false;
+    }
+    _pos++; // The type is only needed for inbound events
+    if (!readVarint(size)) {
+        return false;
+    }
+    _sentBytes += size;
+    return true;
+}
+
+/**
+ * Advances to the next frame, tick or spawn of the recording.
+ *
+ * The events sent in between are added to the sent bytes.
+ *
+ * @return the kind of the next step
+ */
+SessionReplay::Step SessionReplay::next() {
+    if (_frameRun > 0) {
+        _frameRun--;
+        return FRAME;
+    }
+    _events.clear();
+    while (_pos < _data.size()) {
+        Uint8 tag = _data[_pos++];
+        Uint64 value;
+        switch (tag) {
+            case TAG_FRAMES:
+                if (!readVarint(value) || value == 0 || _pos >= _data.size()) {
+                    return DONE;
+                }
+                _frame = SessionInput();
+                _frame.flags = _data[_pos++];
+                if ((_frame.flags & SessionInput::TURN) && !readFloat(_frame.vertical)) {
+                    return DONE;
+                }
+                if ((_frame.flags & SessionInput::FIRED) && !readFloat(_frame.power)) {
+                    return DONE;
+                }
+                // Every frame of the run has its own time
+                if (value > (_data.size()-_pos)/sizeof(float)) {
+                    return DONE;
+                }
+                _frameTimes.resize(value);
+                for(float& dt : _frameTimes) {
+                    if (!readFloat(dt)) {
+                        return DONE;
+                    }
+                }
+                _frameRun = (Uint32)value-1;
+                return FRAME;
+            case TAG_TICK:
+                // The events of this tick follow it, up to the next frame or tick
+                while (_pos < _data.size() && (_data[_pos] == TAG_IN || _data[_pos] == TAG_OUT)) {
+                    bool inbound = _data[_pos++] == TAG_IN;
+                    if (!(inbound ? readEvent() : readSent())) {
+                        return DONE;
+                    }
+                }
+                return TICK;
+            case TAG_IN:
+                // Events are only polled in a tick, so this one is dropped
+                if (!readEvent()) {
+                    return DONE;
+                }
+                _events.clear();
+                break;
+            case TAG_OUT:
+                if (!readSent()) {
+                    return DONE;
+                }
+                break;
+            case TAG_SPAWN:
+            {
+                if (!readVarint(value) || _data.size()-_pos < value) {
+                    return DONE;
+                }
+                const std::byte* bytes = (const std::byte*)_data.data()+_pos;
+                _spawn.assign(bytes, bytes+value);
+                _pos += value;
+                return SPAWN;
+            }
+            case TAG_END:
+            {
+                Uint64 ticks, sent, state;
+                if (readVarint(ticks) && readVarint(sent) && readVarint(state)) {
+                    _complete = true;
+                    _ticks = ticks;
+                    _stateBytes = state;
+                }
+                return DONE;
+            }
+            default:
+                return DONE;
+        }
+    }
+    return DONE;
+}
+
+/**
+ * Returns the next inbound event of the current tick.
+ *
+ * @return the next inbound event of the current tick.
+ */
+std::shared_ptr<NetEvent> SessionReplay::popInEvent() {
+    auto event = _events.front();
+    _events.pop_front();
+    return event;
+}
@@ -0,0 +1,465 @@
+//
+//  NLRecorder.h
+//  Networked Physics Demo
+//
+//  These classes record a session to a compact binary file, and replay it.
+//  The recorder captures the local input and time of every frame, the start
+//  of every fixed tick, every event received from the network (with its
+//  payload), every event sent (type and size only, for bandwidth) and the
+//  parameters of every shared obstacle spawned by the crate factory.
+//  Consecutive frames with the same input are stored as a single run.
+//  Replay reads the whole file back and steps the game scene through the
+//  same frames, ticks, inbound events and spawns as fast as possible,
+//  without a connection.  The state updates that the physics controller
+//  exchanges internally are not visible to the game, so obstacles are
+//  spawned again but not moved by other peers.
+//
+//  The file format is a header ("NLRS", version, short UID, players, host)
+//  followed by records, each starting with a tag byte:
+//
+//      'F' frames:  varint run, flags byte, [vertical], [fire power],
+//                   one frame time (float seconds) per frame of the run
+//      'T' tick:    (no body)
+//      'I' inbound: type byte, varint size, payload
+//      'O' sent:    type byte, varint size
+//      'S' spawn:   varint size, factory parameters
+//      'E' end:     varint ticks, varint sent bytes, varint estimated state bytes
+//
+//  Author: Networked Physics Lab contributors
+//  Version: 10/18/26
+//
+#ifndef __NL_RECORDER_H__
+#define __NL_RECORDER_H__
+#include <cugl/cugl.h>
+#include <deque>
+#include <fstream>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+using namespace cugl::netphysics;
+
+class NetLabStats;
+
+/**
+ * The local input of a single frame, as recorded.
+ */
+struct SessionInput {
+    /** The flags of a recorded frame */
+    enum Flag : Uint8 {
+        /** The fire key was released */
+        FIRED     = 1,
+        /** The volley key was pressed */
+        VOLLEY    = 2,
+        /** The big crate key was pressed */
+        BIG_CRATE = 4,
+        /** The debug key was pressed */
+        DEBUG     = 8,
+        /** The cannon was turned (vertical is recorded) */
+        TURN      = 16
+    };
+
+    /** The flags of this frame */
+    Uint8 flags;
+    /** The vertical input (the cannon turn) */
+    float vertical;
+    /** The fire power (only recorded for frames that fire) */
+    float power;
+
+    /**
+     * Creates an idle input.
+     */
+    SessionInput() : flags(0), vertical(0), power(0) {}
+
+    /**
+     * Returns true if both inputs are recorded the same way.
+     *
+     * @param other The input to compare
+     *
+     * @return true if both inputs are recorded the same way.
+     */
+    bool operator==(const SessionInput& other) const {
+        return flags == other.flags && vertical == other.vertical && power == other.power;
+    }
+};
+
+/**
+ * This class writes a session to a file.
+ *
+ * Event types must be attached in the same order as on the replay, as the
+ * file only stores their index. Writes are buffered, and go to disk in
+ * large blocks.
+ */
+class SessionRecorder {
+protected:
+    /** The file written to */
+    std::ofstream _file;
+    /** The bytes not written yet */
+    std::vector<Uint8> _buffer;
+    /** The index of every attached event type */
+    std::unordered_map<std::type_index, Uint8> _types;
+    /** The input of the current run of frames */
+    SessionInput _frame;
+    /** The number of frames in the current run */
+    Uint32 _frameRun;
+    /** The frame times of the current run, in seconds */
+    std::vector<float> _frameTimes;
+    /** The number of ticks recorded */
+    Uint64 _ticks;
+    /** The payload bytes of all sent events */
+    Uint64 _sentBytes;
+    /** The statistics log for the recording size (may be null) */
+    NetLabStats* _stats;
+
+    /**
+     * Writes a varint to the buffer.
+     *
+     * @param value The value to write
+     */
+    void writeVarint(Uint64 value);
+
+    /**
+     * Writes a float to the buffer.
+     *
+     * @param value The value to write
+     */
+    void writeFloat(float value);
+
+    /**
+     * Writes the current run of frames to the buffer, if any.
+     */
+    void endRun();
+
+    /**
+     * Writes the buffer to the file, if it is large enough.
+     *
+     * @param force Whether to write the buffer regardless of its size
+     */
+    void flush(bool force = false);
+
+    /**
+     * Returns the index of the type of the event, or -1 if not attached.
+     *
+     * @param event The event
+     *
+     * @return the index of the type of the event, or -1 if not attached.
+     */
+    int getType(const std::shared_ptr<NetEvent>& event) const;
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates a recorder with no file.
+     */
+    SessionRecorder() : _frameRun(0), _ticks(0), _sentBytes(0), _stats(nullptr) {}
+
+    /**
+     * Deletes this recorder, closing the file.
+     */
+    ~SessionRecorder() { close(); }
+
+    /**
+     * Opens the given file and writes the session header.
+     *
+     * @param path      The file to write
+     * @param self      The short UID of this peer
+     * @param players   The number of players in the session
+     * @param host      Whether this peer is the host
+     *
+     * @return true if the file was opened
+     */
+    bool open(const std::string& path, Uint32 self, Uint32 players, bool host);
+
+    /**
+     * Writes the end of the session and closes the file.
+     *
+     * @param stateBytes    The estimated bytes of state updates sent
+     */
+    void close(Uint64 stateBytes = 0);
+
+    /**
+     * Returns true if a file is open.
+     *
+     * @return true if a file is open.
+     */
+    bool isOpen() const { return _file.is_open(); }
+
+    /**
+     * Sets the statistics log for the recording size.
+     *
+     * @param stats The statistics log (or nullptr)
+     */
+    void setStats(NetLabStats* stats) { _stats = stats; }
+
+    /**
+     * Attaches an event type, so that its events can be recorded.
+     *
+     * Types must be attached in the same order as on the replay.
+     */
+    template <typename T>
+    void attachEventType() {
+        Uint8 index = (Uint8)_types.size();
+        _types.emplace(std::type_index(typeid(T)), index);
+    }
+
+#pragma mark Recording
+    /**
+     * Records the input and time of a frame.
+     *
+     * @param input The input of the frame
+     * @param dt    The time of the frame, in seconds
+     */
+    void recordFrame(const SessionInput& input, float dt);
+
+    /**
+     * Records the start of a fixed tick.
+     */
+    void recordTick();
+
+    /**
+     * Records an event received from the network, with its payload.
+     *
+     * @param event The event received
+     */
+    void recordIn(const std::shared_ptr<NetEvent>& event);
+
+    /**
+     * Records the type and size of an event sent to the network.
+     *
+     * @param event The event sent
+     */
+    void recordOut(const std::shared_ptr<NetEvent>& event);
+
+    /**
+     * Records the parameters of a shared obstacle spawned by the crate factory.
+     *
+     * This is every shared crate, spawned by any peer, as they reach the
+     * game through the physics controller and not as events.
+     *
+     * @param params    The serialized factory parameters
+     */
+    void recordSpawn(const std::vector<std::byte>& params);
+};
+
+/**
+ * This class reads a recorded session back, one step at a time.
+ *
+ * Event types must be attached in the same order as on the recording.
+ * The whole file is read into memory when opened, so that reading never
+ * slows down the replay.
+ */
+class SessionReplay {
+public:
+    /** The kind of a replay step */
+    enum Step {
+        /** A frame, whose input is getInput() */
+        FRAME,
+        /** A fixed tick, whose inbound events are queued */
+        TICK,
+        /** A shared obstacle spawned, whose parameters are getSpawn() */
+        SPAWN,
+        /** The end of the recording (or a corrupt record) */
+        DONE
+    };
+
+protected:
+    /** The contents of the file */
+    std::vector<Uint8> _data;
+    /** The read position */
+    size_t _pos;
+    /** An event of every attached type, to allocate events from */
+    std::vector<std::shared_ptr<NetEvent>> _prototypes;
+    /** The inbound events of the current tick */
+    std::deque<std::shared_ptr<NetEvent>> _events;
+    /** The input of the current run of frames */
+    SessionInput _frame;
+    /** The number of frames left in the current run */
+    Uint32 _frameRun;
+    /** The frame times of the current run, in seconds */
+    std::vector<float> _frameTimes;
+    /** The parameters of the current spawn */
+    std::vector<std::byte> _spawn;
+    /** The short UID of the recording peer */
+    Uint32 _self;
+    /** The number of players in the session */
+    Uint32 _players;
+    /** Whether the recording peer was the host */
+    bool _host;
+    /** Whether the end record was read */
+    bool _complete;
+    /** The number of ticks in the session (from the end record) */
+    Uint64 _ticks;
+    /** The payload bytes of all events sent (summed while reading) */
+    Uint64 _sentBytes;
+    /** The estimated bytes of state updates sent (from the end record) */
+    Uint64 _stateBytes;
+
+    /**
+     * Reads a varint, returning false if the data ends first.
+     *
+     * @param value The value read
+     *
+     * @return true if the value was read
+     */
+    bool readVarint(Uint64& value);
+
+    /**
+     * Reads a float, returning false if the data ends first.
+     *
+     * @param value The value read
+     *
+     * @return true if the value was read
+     */
+    bool readFloat(float& value);
+
+    /**
+     * Reads an inbound event, and queues it for the current tick.
+     *
+     * @return true if the event was read
+     */
+    bool readEvent();
+
+    /**
+     * Reads a sent event, and adds its size to the sent bytes.
+     *
+     * @return true if the event was read
+     */
+    bool readSent();
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates a replay with no file.
+     */
+    SessionReplay() : _pos(0), _frameRun(0), _self(0), _players(0), _host(false),
+    _complete(false), _ticks(0), _sentBytes(0), _stateBytes(0) {}
+
+    /**
+     * Reads the given file and its session header.
+     *
+     * @param path  The file to read
+     *
+     * @return true if the file is a recorded session
+     */
+    bool open(const std::string& path);
+
+    /**
+     * Discards the recording.
+     */
+    void close();
+
+    /**
+     * Returns true if a recording is open.
+     *
+     * @return true if a recording is open.
+     */
+    bool isOpen() const { return !_data.empty(); }
+
+    /**
+     * Attaches an event type, so that its events can be replayed.
+     *
+     * Types must be attached in the same order as on the recording.
+     */
+    template <typename T>
+    void attachEventType() {
+        _prototypes.push_back(std::make_shared<T>());
+    }
+
+#pragma mark Replay
+    /**
+     * Advances to the next frame, tick or spawn of the recording.
+     *
+     * The events sent in between are added to the sent bytes.
+     *
+     * @return the kind of the next step
+     */
+    Step next();
+
+    /**
+     * Returns the input of the current frame.
+     *
+     * @return the input of the current frame.
+     */
+    const SessionInput& getInput() const { return _frame; }
+
+    /**
+     * Returns the time of the current frame, in seconds.
+     *
+     * @return the time of the current frame, in seconds.
+     */
+    float getFrameTime() const { return _frameTimes[_frameTimes.size()-1-_frameRun]; }
+
+    /**
+     * Returns the factory parameters of the current spawn.
+     *
+     * @return the factory parameters of the current spawn.
+     */
+    const std::vector<std::byte>& getSpawn() const { return _spawn; }
+
+    /**
+     * Returns true if the current tick has inbound events left.
+     *
+     * @return true if the current tick has inbound events left.
+     */
+    bool isInAvailable() const { return !_events.empty(); }
+
+    /**
+     * Returns the next inbound event of the current tick.
+     *
+     * @return the next inbound event of the current tick.
+     */
+    std::shared_ptr<NetEvent> popInEvent();
+
+#pragma mark Attributes
+    /**
+     * Returns the short UID of the recording peer.
+     *
+     * @return the short UID of the recording peer.
+     */
+    Uint32 getShortUID() const { return _self; }
+
+    /**
+     * Returns the number of players in the session.
+     *
+     * @return the number of players in the session.
+     */
+    Uint32 getNumPlayers() const { return _players; }
+
+    /**
+     * Returns true if the recording peer was the host.
+     *
+     * @return true if the recording peer was the host.
+     */
+    bool isHost() const { return _host; }
+
+    /**
+     * Returns true if the recording ended cleanly, with its totals.
+     *
+     * @return true if the recording ended cleanly, with its totals.
+     */
+    bool isComplete() const { return _complete; }
+
+    /**
+     * Returns the number of ticks in the session.
+     *
+     * @return the number of ticks in the session.
+     */
+    Uint64 getTicks() const { return _ticks; }
+
+    /**
+     * Returns the payload bytes of the events sent so far in the session.
+     *
+     * @return the payload bytes of the events sent so far in the session.
+     */
+    Uint64 getSentBytes() const { return _sentBytes; }
+
+    /**
+     * Returns the estimated bytes of state updates sent in the session.
+     *
+     * @return the estimated bytes of state updates sent in the session.
+     */
+    Uint64 getStateBytes() const { return _stateBytes; }
+};
+
+#endif /* __NL_RECORDER_H__ */
@@ -0,0 +1,274 @@
+//
+//  NLSnapshotBuffer.cpp
+//  Networked Physics Demo
+//
+//  This class provides render-side interpolation for obstacles owned by a
+//  remote peer.  Rather than drawing the latest corrected pose (or
+//  extrapolating it by the leftover time), we keep the last few states that
+//  were received for each remote obstacle and draw them a short delay in the
+//  past, blending between the two states that bracket the render time.
+//
+//  The physics controller applies its own state updates without showing
+//  them to the game, so the owner of an obstacle also sends its state in
+//  frames of its own, stamped with its tick.  The delay of every sending
+//  peer adapts to the measured transit time and jitter of its frames.
+//
+//  Author: Networked Physics Lab contributors
+//  Version: 10/18/26
+//
+#include "NLSnapshotBuffer.h"
+#include <unordered_set>
+#include <cmath>
+
+using namespace cugl;
+
+/** The minimum render delay in ticks */
+#define MIN_DELAY           1.0
+/** The gain of the running estimates (1/16, as in RFC 3550) */
+#define ESTIMATE_GAIN       (1.0/16)
+/** The maximum time (in ticks) to extrapolate past the newest state */
+#define MAX_EXTRAPOLATION   4.0
+/** The time (in ticks) past the newest state after which the physics pose is drawn */
+#define STALE_TICKS         30.0
+
+#pragma mark Constructors
+/**
+ * Creates an empty snapshot buffer.
+ *
+ * You must initialize this buffer before use.
+ */
+SnapshotBuffer::SnapshotBuffer() :
+_capacity(0),
+_tick(0),
+_renderTime(0),
+_step(FIXED_TIMESTEP_S) {
+}
+
+/**
+ * Initializes an empty snapshot buffer.
+ *
+ * @param capacity  The number of states kept per obstacle (at least 3)
+ *
+ * @return true if initialization was successful.
+ */
+bool SnapshotBuffer::init(size_t capacity) {
+    if (capacity < 3) {
+        return false;
+    }
+    _capacity = capacity;
+    clear();
+    return true;
+}
+
+/**
+ * Removes all states from this buffer, and resets the jitter estimates.
+ */
+void SnapshotBuffer::clear() {
+    _tracks.clear();
+    _links.clear();
+    _tick = 0;
+    _renderTime = 0;
+}
+
+#pragma mark Internal Helpers
+/**
+ * Adds a state to a track, overwriting the oldest if full.
+ *
+ * @param track The track to modify
+ * @param state The received state
+ */
+void SnapshotBuffer::push(Track& track, const Snapshot& state) {
+    track.states[track.head] = state;
+    track.head = (track.head+1) % _capacity;
+    track.count = std::min(track.count+1, _capacity);
+}
+
+#pragma mark Receiving
+/**
+ * Measures the arrival of a state frame from the given peer.
+ *
+ * This should be called once per frame, before its states are added
+ * with {@link #receive}. Frames older than the newest one of the peer
+ * are reordered, and are not measured.
+ *
+ * @param peer  The peer that sent the frame
+ * @param sent  The tick of the peer when it sent the frame
+ * @param now   The current tick
+ */
+void SnapshotBuffer::arrive(Uint32 peer, Uint64 sent, Uint64 now) {
+    Link& link = _links[peer];
+    double transit = (double)now-(double)sent;
+    if (link.arrivals == 0) {
+        link.transit = transit;
+        link.interval = 1;
+        link.jitter = 0;
+    } else if (sent <= link.lastSent) {
+        return;
+    } else {
+        double gap = (double)(sent-link.lastSent);
+        link.interval = link.arrivals == 1 ? gap : link.interval+(gap-link.interval)*ESTIMATE_GAIN;
+        link.jitter += (std::abs(transit-link.lastTransit)-link.jitter)*ESTIMATE_GAIN;
+        link.transit += (transit-link.transit)*ESTIMATE_GAIN;
+    }
+    link.arrivals++;
+    link.lastSent = sent;
+    link.lastTransit = transit;
+
+    // The newest state is up to an interval old when it arrives, and late by the jitter
+    double delay = link.transit+link.interval+2*link.jitter;
+    double limit = std::max(MIN_DELAY, (_capacity-2)*link.interval);
+    link.delay = (float)std::max(MIN_DELAY, std::min(delay, limit));
+}
+
+/**
+ * Adds a received state of a remote obstacle.
+ *
+ * States that are not newer than the newest state of the obstacle
+ * arrived out of order, and are dropped.
+ *
+ * @param obs   The obstacle
+ * @param peer  The peer that sent the state
+ * @param state The received state
+ *
+ * @return true if the state was added
+ */
+bool SnapshotBuffer::receive(const physics2::Obstacle* obs, Uint32 peer, const Snapshot& state) {
+    Track& track = _tracks[obs];
+    if (track.states.empty()) {
+        track.states.resize(_capacity);
+        track.head = 0;
+        track.count = 0;
+    } else if (track.peer != peer) {
+        // A new owner has its own clock, so the old states do not compare
+        track.count = 0;
+    }
+    track.peer = peer;
+    if (track.count > 0 && track.states[(track.head+_capacity-1) % _capacity].tick >= state.tick) {
+        return false;
+    }
+    push(track, state);
+    return true;
+}
+
+/**
+ * Drops the obstacles that are no longer remote.
+ *
+ * This should be called once per fixed tick. Obstacles that left the
+ * world, or that are now in its owned set, lose their states.
+ *
+ * @param world The physics world
+ * @param tick  The current tick
+ */
+void SnapshotBuffer::prune(const std::shared_ptr<physics2::ObstacleWorld>& world, Uint64 tick) {
+    _tick = tick;
+    if (_tracks.empty()) {
+        return;
+    }
+
+    std::unordered_set<const physics2::Obstacle*> remote;
+    auto& owned = world->getOwned();
+    for(auto it = world->getObstacles().begin(); it != world->getObstacles().end(); ++it) {
+        const std::shared_ptr<physics2::Obstacle>& obj = *it;
+        if (obj->isEnabled() && !obj->isRemoved() && !owned.count(obj)) {
+            remote.insert(obj.get());
+        }
+    }
+    for(auto it = _tracks.begin(); it != _tracks.end(); ) {
+        if (!remote.count(it->first)) {
+            it = _tracks.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+#pragma mark Sampling
+/**
+ * Sets the render time for the current animation frame.
+ *
+ * This should be called once per frame before any call to {@link #sample}.
+ *
+ * @param leftover  The time (in seconds) since the last physics step
+ * @param step      The length (in seconds) of a fixed step
+ */
+void SnapshotBuffer::setRenderTime(float leftover, float step) {
+    _step = step;
+    _renderTime = (double)_tick + leftover/step;
+}
+
+/**
+ * Computes the interpolated pose of the given obstacle.
+ *
+ * If the obstacle has no buffered states (e.g. it is owned locally), or
+ * if its states are too old to extrapolate, this method returns false
+ * and the pose is unchanged.
+ *
+ * @param obs   The obstacle
+ * @param pos   The interpolated position
+ * @param angle The interpolated angle
+ *
+ * @return true if the obstacle has an interpolated pose
+ */
+bool SnapshotBuffer::sample(const physics2::Obstacle* obs, Vec2& pos, float& angle) const {
+    auto it = _tracks.find(obs);
+    if (it == _tracks.end() || it->second.count == 0) {
+        return false;
+    }
+
+    const Track& track = it->second;
+    double time = _renderTime-getDelay(track.peer);
+    size_t first = (track.head+_capacity-track.count) % _capacity;
+    const Snapshot* prev = &track.states[first];
+    if (time <= prev->tick) {
+        pos = prev->pos;
+        angle = prev->angle;
+        return true;
+    }
+
+    // Find the two states that bracket the render time
+    for(size_t ii = 1; ii < track.count; ii++) {
+        const Snapshot* next = &track.states[(first+ii) % _capacity];
+        if (time < next->tick) {
+            float alpha = (float)((time-prev->tick)/(next->tick-prev->tick));
+            pos = prev->pos + (next->pos-prev->pos)*alpha;
+            angle = prev->angle + (next->angle-prev->angle)*alpha;
+            return true;
+        }
+        prev = next;
+    }
+
+    // Starved: extrapolate a short distance from the newest state, until it is stale
+    double ahead = time-prev->tick;
+    if (ahead > STALE_TICKS) {
+        return false;
+    }
+    ahead = std::min(ahead, MAX_EXTRAPOLATION);
+    pos = prev->pos + prev->vel*(float)(ahead*_step);
+    angle = prev->angle;
+    return true;
+}
+
+#pragma mark Statistics
+/**
+ * Returns the render delay of the given peer in ticks.
+ *
+ * @param peer  The sending peer
+ *
+ * @return the render delay of the given peer in ticks.
+ */
+float SnapshotBuffer::getDelay(Uint32 peer) const {
+    auto it = _links.find(peer);
+    return it == _links.end() || it->second.arrivals == 0 ? (float)MIN_DELAY : it->second.delay;
+}
+
+/**
+ * Returns the transit jitter of the given peer in ticks.
+ *
+ * @param peer  The sending peer
+ *
+ * @return the transit jitter of the given peer in ticks.
+ */
+float SnapshotBuffer::getJitter(Uint32 peer) const {
+    auto it = _links.find(peer);
+    return it == _links.end() ? 0.0f : (float)it->second.jitter;
+}
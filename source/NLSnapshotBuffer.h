@@ -0,0 +1,216 @@
+//
+//  NLSnapshotBuffer.h
+//  Networked Physics Demo
+//
+//  This class provides render-side interpolation for obstacles owned by a
+//  remote peer.  Rather than drawing the latest corrected pose (or
+//  extrapolating it by the leftover time), we keep the last few states that
+//  were received for each remote obstacle and draw them a short delay in the
+//  past, blending between the two states that bracket the render time.
+//
+//  The physics controller applies its own state updates without showing
+//  them to the game, so the owner of an obstacle also sends its state in
+//  frames of its own, stamped with its tick.  The delay of every sending
+//  peer adapts to the measured transit time and jitter of its frames.
+//
+//  Author: Networked Physics Lab contributors
+//  Version: 10/18/26
+//
+#ifndef __NL_SNAPSHOT_BUFFER_H__
+#define __NL_SNAPSHOT_BUFFER_H__
+#include <cugl/cugl.h>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * This class buffers the received states of remote obstacles for interpolation.
+ *
+ * States arrive with {@link #receive}, stamped with the tick of the peer
+ * that sent them, and the arrival of every frame is measured with
+ * {@link #arrive}. The render delay of a peer is its mean transit time,
+ * plus its send interval, plus twice its jitter (the running estimate of
+ * RFC 3550). It is given in ticks, and always leaves room for two states
+ * to bracket the render time.
+ */
+class SnapshotBuffer {
+public:
+    /** A single received state of an obstacle */
+    struct Snapshot {
+        /** The tick of the sender when this state was sent */
+        Uint64 tick;
+        /** The obstacle position */
+        cugl::Vec2 pos;
+        /** The obstacle linear velocity */
+        cugl::Vec2 vel;
+        /** The obstacle angle */
+        float angle;
+    };
+
+protected:
+    /** The received states of a single obstacle */
+    struct Track {
+        /** The ring buffer of states (capacity is fixed at init) */
+        std::vector<Snapshot> states;
+        /** The index of the next state to write */
+        size_t head;
+        /** The number of valid states */
+        size_t count;
+        /** The peer that sent the states */
+        Uint32 peer;
+    };
+
+    /** The arrival statistics of the frames of a single peer */
+    struct Link {
+        /** The number of frames that arrived */
+        Uint64 arrivals;
+        /** The sender tick of the newest frame */
+        Uint64 lastSent;
+        /** The transit time (in ticks) of the newest frame */
+        double lastTransit;
+        /** The running mean of the transit time (in ticks) */
+        double transit;
+        /** The running mean of the send interval (in ticks) */
+        double interval;
+        /** The running jitter of the transit time (in ticks) */
+        double jitter;
+        /** The render delay (in ticks) */
+        float delay;
+    };
+
+    /** The received states of every remote obstacle */
+    std::unordered_map<const cugl::physics2::Obstacle*, Track> _tracks;
+    /** The arrival statistics of every sending peer */
+    std::unordered_map<Uint32, Link> _links;
+    /** The number of states kept per obstacle */
+    size_t _capacity;
+    /** The current tick */
+    Uint64 _tick;
+    /** The current time (in ticks) for this frame, before the delay */
+    double _renderTime;
+    /** The length (in seconds) of a fixed step */
+    float _step;
+
+    /**
+     * Adds a state to a track, overwriting the oldest if full.
+     *
+     * @param track The track to modify
+     * @param state The received state
+     */
+    void push(Track& track, const Snapshot& state);
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates an empty snapshot buffer.
+     *
+     * You must initialize this buffer before use.
+     */
+    SnapshotBuffer();
+
+    /**
+     * Initializes an empty snapshot buffer.
+     *
+     * @param capacity  The number of states kept per obstacle (at least 3)
+     *
+     * @return true if initialization was successful.
+     */
+    bool init(size_t capacity);
+
+    /**
+     * Removes all states from this buffer, and resets the jitter estimates.
+     */
+    void clear();
+
+#pragma mark Receiving
+    /**
+     * Measures the arrival of a state frame from the given peer.
+     *
+     * This should be called once per frame, before its states are added
+     * with {@link #receive}. Frames older than the newest one of the peer
+     * are reordered, and are not measured.
+     *
+     * @param peer  The peer that sent the frame
+     * @param sent  The tick of the peer when it sent the frame
+     * @param now   The current tick
+     */
+    void arrive(Uint32 peer, Uint64 sent, Uint64 now);
+
+    /**
+     * Adds a received state of a remote obstacle.
+     *
+     * States that are not newer than the newest state of the obstacle
+     * arrived out of order, and are dropped.
+     *
+     * @param obs   The obstacle
+     * @param peer  The peer that sent the state
+     * @param state The received state
+     *
+     * @return true if the state was added
+     */
+    bool receive(const cugl::physics2::Obstacle* obs, Uint32 peer, const Snapshot& state);
+
+    /**
+     * Drops the obstacles that are no longer remote.
+     *
+     * This should be called once per fixed tick. Obstacles that left the
+     * world, or that are now in its owned set, lose their states.
+     *
+     * @param world The physics world
+     * @param tick  The current tick
+     */
+    void prune(const std::shared_ptr<cugl::physics2::ObstacleWorld>& world, Uint64 tick);
+
+#pragma mark Sampling
+    /**
+     * Sets the render time for the current animation frame.
+     *
+     * This should be called once per frame before any call to {@link #sample}.
+     *
+     * @param leftover  The time (in seconds) since the last physics step
+     * @param step      The length (in seconds) of a fixed step
+     */
+    void setRenderTime(float leftover, float step);
+
+    /**
+     * Computes the interpolated pose of the given obstacle.
+     *
+     * If the obstacle has no buffered states (e.g. it is owned locally), or
+     * if its states are too old to extrapolate, this method returns false
+     * and the pose is unchanged.
+     *
+     * @param obs   The obstacle
+     * @param pos   The interpolated position
+     * @param angle The interpolated angle
+     *
+     * @return true if the obstacle has an interpolated pose
+     */
+    bool sample(const cugl::physics2::Obstacle* obs, cugl::Vec2& pos, float& angle) const;
+
+#pragma mark Statistics
+    /**
+     * Returns the render delay of the given peer in ticks.
+     *
+     * @param peer  The sending peer
+     *
+     * @return the render delay of the given peer in ticks.
+     */
+    float getDelay(Uint32 peer) const;
+
+    /**
+     * Returns the transit jitter of the given peer in ticks.
+     *
+     * @param peer  The sending peer
+     *
+     * @return the transit jitter of the given peer in ticks.
+     */
+    float getJitter(Uint32 peer) const;
+
+    /**
+     * Returns the number of obstacles with buffered states.
+     *
+     * @return the number of obstacles with buffered states.
+     */
+    size_t size() const { return _tracks.size(); }
+};
+
+#endif /* __NL_SNAPSHOT_BUFFER_H__ */
@@ -0,0 +1,75 @@
+//
+//  NLSpawnAckEvent.cpp
+//  Networked Physics Lab
+//
+//  This class represents the host acknowledging a crate fired by a peer.
+//  It carries the state the host has for the crate, so that the peer can
+//  measure the error of its prediction, and the trajectory of the crate on the
+//  host, so that the peer can measure how far its own copy diverged.
+//
+//  Created by the Networked Physics Lab contributors on 10/18/26.
+//
+
+#include "NLSpawnAckEvent.h"
+
+/**
+ * This method is used by the NetEventController to create a new event of using a
+ * reference of the same type.
+ *
+ * Not that this method is not static, it differs from the static alloc() method
+ * and all methods must implement this method.
+ */
+std::shared_ptr<NetEvent> SpawnAckEvent::newEvent(){
+    return std::make_shared<SpawnAckEvent>();
+}
+
+std::shared_ptr<NetEvent> SpawnAckEvent::allocSpawnAckEvent(Uint32 key, Vec2 vel,
+                                                            const std::vector<Vec2>& trajectory){
+    auto event = std::make_shared<SpawnAckEvent>();
+    event->_key = key;
+    event->_vel = vel;
+    event->_trajectory = trajectory;
+    return event;
+}
+
+/**
+ * Serialize any paramater that the event contains to a vector of bytes.
+ */
+std::vector<std::byte> SpawnAckEvent::serialize(){
+    _serializer.reset();
+    _serializer.writeUint32(_key);
+    _serializer.writeFloat(_vel.x);
+    _serializer.writeFloat(_vel.y);
+    _serializer.writeUint32((Uint32)_trajectory.size());
+    for(size_t ii = 0; ii < _trajectory.size(); ii++){
+        _serializer.writeFloat(_trajectory[ii].x);
+        _serializer.writeFloat(_trajectory[ii].y);
+    }
+    return _serializer.serialize();
+}
+
+/**
+ * Deserialize a vector of bytes and set the corresponding parameters.
+ *
+ * @param data  a byte vector packed by serialize()
+ *
+ * This function should be the "reverse" of the serialize() function: it
+ * should be able to recreate a serialized event entirely, setting all the
+ * useful parameters of this class.
+ */
+void SpawnAckEvent::deserialize(const std::vector<std::byte>& data){
+    _deserializer.reset();
+    _deserializer.receive(data);
+    _key = _deserializer.readUint32();
+    float vx = _deserializer.readFloat();
+    float vy = _deserializer.readFloat();
+    _vel = Vec2(vx,vy);
+    Uint32 count = _deserializer.readUint32();
+    _trajectory.clear();
+    _trajectory.reserve(count);
+    for(Uint32 ii = 0; ii < count; ii++){
+        float x = _deserializer.readFloat();
+        float y = _deserializer.readFloat();
+        _trajectory.push_back(Vec2(x,y));
+    }
+}
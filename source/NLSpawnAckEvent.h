@@ -0,0 +1,73 @@
+//
+//  NLSpawnAckEvent.h
+//  Networked Physics Lab
+//
+//  This class represents the host acknowledging a crate fired by a peer.
+//  It carries the state the host has for the crate, so that the peer can
+//  measure the error of its prediction, and the trajectory of the crate on the
+//  host, so that the peer can measure how far its own copy diverged.
+//
+//  Created by the Networked Physics Lab contributors on 10/18/26.
+//
+
+#ifndef NLSpawnAckEvent_h
+#define NLSpawnAckEvent_h
+
+#include <cugl/cugl.h>
+#include <vector>
+using namespace cugl::netphysics;
+using namespace cugl;
+
+class SpawnAckEvent : public NetEvent {
+    
+protected:
+    LWSerializer _serializer;
+    LWDeserializer _deserializer;
+    
+    /** The spawn key of the crate */
+    Uint32 _key;
+    /** The velocity of the crate at the end of the trajectory */
+    Vec2 _vel;
+    /** The positions of the crate on the host, from its spawn on */
+    std::vector<Vec2> _trajectory;
+    
+public:
+    /**
+     * This method is used by the NetEventController to create a new event of using a
+     * reference of the same type.
+     *
+     * Not that this method is not static, it differs from the static alloc() method
+     * and all methods must implement this method.
+     */
+    std::shared_ptr<NetEvent> newEvent() override;
+    
+    static std::shared_ptr<NetEvent> allocSpawnAckEvent(Uint32 key, Vec2 vel,
+                                                        const std::vector<Vec2>& trajectory);
+    
+    /**
+     * Serialize any paramater that the event contains to a vector of bytes.
+     */
+    std::vector<std::byte> serialize() override;
+    /**
+     * Deserialize a vector of bytes and set the corresponding parameters.
+     *
+     * @param data  a byte vector packed by serialize()
+     *
+     * This function should be the "reverse" of the serialize() function: it
+     * should be able to recreate a serialized event entirely, setting all the
+     * useful parameters of this class.
+     */
+    void deserialize(const std::vector<std::byte>& data) override;
+    
+    /** Gets the spawn key of the crate. */
+    Uint32 getKey() const { return _key; }
+    
+    /** Gets the velocity of the crate at the end of the trajectory. */
+    Vec2 getVelocity() const { return _vel; }
+    
+    /** Gets the positions of the crate on the host, from its spawn on. */
+    const std::vector<Vec2>& getTrajectory() const { return _trajectory; }
+};
+
+
+#endif /* NLSpawnAckEvent_h */
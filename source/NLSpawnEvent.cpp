@@ -0,0 +1,81 @@
+//
+//  NLSpawnEvent.cpp
+//  Networked Physics Lab
+//
+//  This class represents an event of spawning a batch of crates at once.
+//  The whole batch shares one message and one contiguous range of spawn
+//  keys, instead of costing one creation message per crate.
+//
+//  Created by the Networked Physics Lab contributors on 10/18/26.
+//
+
+#include "NLSpawnEvent.h"
+
+/**
+ * This method is used by the NetEventController to create a new event of using a
+ * reference of the same type.
+ *
+ * Not that this method is not static, it differs from the static alloc() method
+ * and all methods must implement this method.
+ */
+std::shared_ptr<NetEvent> SpawnBatchEvent::newEvent(){
+    return std::make_shared<SpawnBatchEvent>();
+}
+
+std::shared_ptr<NetEvent> SpawnBatchEvent::allocSpawnBatchEvent(Uint32 baseKey, float scale,
+                                                                const std::vector<Vec2>& pos,
+                                                                const std::vector<Vec2>& vel){
+    auto event = std::make_shared<SpawnBatchEvent>();
+    event->_baseKey = baseKey;
+    event->_scale = scale;
+    event->_pos = pos;
+    event->_vel = vel;
+    return event;
+}
+
+/**
+ * Serialize any paramater that the event contains to a vector of bytes.
+ */
+std::vector<std::byte> SpawnBatchEvent::serialize(){
+    _serializer.reset();
+    writeStamp(_serializer);
+    _serializer.writeUint32(_baseKey);
+    _serializer.writeFloat(_scale);
+    _serializer.writeUint32((Uint32)_pos.size());
+    for(size_t ii = 0; ii < _pos.size(); ii++){
+        _serializer.writeFloat(_pos[ii].x);
+        _serializer.writeFloat(_pos[ii].y);
+        _serializer.writeFloat(_vel[ii].x);
+        _serializer.writeFloat(_vel[ii].y);
+    }
+    return _serializer.serialize();
+}
+
+/**
+ * Deserialize a vector of bytes and set the corresponding parameters.
+ *
+ * @param data  a byte vector packed by serialize()
+ *
+ * This function should be the "reverse" of the serialize() function: it
+ * should be able to recreate a serialized event entirely, setting all the
+ * useful parameters of this class.
+ */
+void SpawnBatchEvent::deserialize(const std::vector<std::byte>& data){
+    _deserializer.reset();
+    _deserializer.receive(data);
+    readStamp(_deserializer);
+    _baseKey = _deserializer.readUint32();
+    _scale = _deserializer.readFloat();
+    Uint32 count = _deserializer.readUint32();
+    _pos.resize(count);
+    _vel.resize(count);
+    for(Uint32 ii = 0; ii < count; ii++){
+        // Read into locals, as argument evaluation order is unspecified
+        float px = _deserializer.readFloat();
+        float py = _deserializer.readFloat();
+        float vx = _deserializer.readFloat();
+        float vy = _deserializer.readFloat();
+        _pos[ii].set(px,py);
+        _vel[ii].set(vx,vy);
+    }
+}
@@ -0,0 +1,79 @@
+//
+//  NLSpawnEvent.h
+//  Networked Physics Lab
+//
+//  This class represents an event of spawning a batch of crates at once.
+//  The whole batch shares one message and one contiguous range of spawn
+//  keys, instead of costing one creation message per crate.
+//
+//  Created by the Networked Physics Lab contributors on 10/18/26.
+//
+
+#ifndef NLSpawnEvent_h
+#define NLSpawnEvent_h
+
+#include <cugl/cugl.h>
+#include <vector>
+#include "NLTickedEvent.h"
+using namespace cugl::netphysics;
+using namespace cugl;
+
+class SpawnBatchEvent : public TickedEvent {
+    
+protected:
+    LWSerializer _serializer;
+    LWDeserializer _deserializer;
+    
+    /** The spawn key of the first crate (the rest follow contiguously) */
+    Uint32 _baseKey;
+    /** The drawing scale of the crates */
+    float _scale;
+    /** The initial crate positions */
+    std::vector<Vec2> _pos;
+    /** The initial crate velocities, parallel to _pos */
+    std::vector<Vec2> _vel;
+    
+public:
+    /**
+     * This method is used by the NetEventController to create a new event of using a
+     * reference of the same type.
+     *
+     * Not that this method is not static, it differs from the static alloc() method
+     * and all methods must implement this method.
+     */
+    std::shared_ptr<NetEvent> newEvent() override;
+    
+    static std::shared_ptr<NetEvent> allocSpawnBatchEvent(Uint32 baseKey, float scale,
+                                                          const std::vector<Vec2>& pos,
+                                                          const std::vector<Vec2>& vel);
+    
+    /**
+     * Serialize any paramater that the event contains to a vector of bytes.
+     */
+    std::vector<std::byte> serialize() override;
+    /**
+     * Deserialize a vector of bytes and set the corresponding parameters.
+     *
+     * @param data  a byte vector packed by serialize()
+     *
+     * This function should be the "reverse" of the serialize() function: it
+     * should be able to recreate a serialized event entirely, setting all the
+     * useful parameters of this class.
+     */
+    void deserialize(const std::vector<std::byte>& data) override;
+    
+    /** Gets the spawn key of the first crate. */
+    Uint32 getBaseKey() const { return _baseKey; }
+    
+    /** Gets the drawing scale of the crates. */
+    float getScale() const { return _scale; }
+    
+    /** Gets the initial crate positions. */
+    const std::vector<Vec2>& getPositions() const { return _pos; }
+    
+    /** Gets the initial crate velocities. */
+    const std::vector<Vec2>& getVelocities() const { return _vel; }
+};
+
+
+#endif /* NLSpawnEvent_h */
@@ -0,0 +1,156 @@
+//
+//  NLSpawnPrediction.cpp
+//  Networked Physics Demo
+//
+//  This class tracks fired crates through their first ticks.
+//  A crate fired by this peer is simulated at once, before any other peer
+//  has seen it.  It stays predicted until the host acknowledges it with its
+//  own state for the crate.  The firing peer owns the crate, so its state is
+//  never corrected; the error is only measured.  The trajectory of every
+//  fired crate is recorded, so that peers can measure how far apart their
+//  copies drift.
+//
+//  Author: Networked Physics Lab contributors
+//  Version: 10/18/26
+//
+#include "NLSpawnPrediction.h"
+#include "NLStats.h"
+#include <algorithm>
+
+using namespace cugl;
+
+/** How many recorded lengths a track is kept, waiting for the other peers */
+#define TRACK_LIFETIME  4
+
+#pragma mark Constructors
+/**
+ * Initializes an empty predictor.
+ *
+ * @param length    The number of ages recorded per crate
+ */
+void SpawnPredictor::init(Uint32 length) {
+    _length = length;
+    _tracks.clear();
+}
+
+/**
+ * Returns true if the crate is still waiting for confirmation.
+ *
+ * @param key   The spawn key
+ *
+ * @return true if the crate is still waiting for confirmation.
+ */
+bool SpawnPredictor::isPredicted(Uint32 key) const {
+    auto it = _tracks.find(key);
+    return it != _tracks.end() && it->second.predicted;
+}
+
+#pragma mark Tracking
+/**
+ * Starts tracking a newly spawned crate.
+ *
+ * @param key       The spawn key
+ * @param obj       The crate obstacle
+ * @param predicted Whether this peer fired the crate and waits for the host
+ */
+void SpawnPredictor::track(Uint32 key, const std::shared_ptr<physics2::Obstacle>& obj, bool predicted) {
+    Track track;
+    track.obstacle = obj;
+    track.positions.reserve(_length);
+    track.velocities.reserve(_length);
+    track.age = 0;
+    track.predicted = predicted;
+    _tracks[key] = track;
+    if (predicted && _stats) {
+        _stats->count("predict.spawned");
+    }
+}
+
+/**
+ * Records the state of every tracked crate.
+ *
+ * This should be called once per tick, after the physics step.
+ */
+void SpawnPredictor::update() {
+    for(auto it = _tracks.begin(); it != _tracks.end(); ) {
+        Track& track = it->second;
+        physics2::Obstacle* obs = track.obstacle.get();
+        // Despawned crates are removed or, if resident, disabled
+        if (obs->isRemoved() || !obs->isEnabled() || track.age >= TRACK_LIFETIME*_length) {
+            if (track.predicted && _stats) {
+                _stats->count("predict.unconfirmed");
+            }
+            it = _tracks.erase(it);
+            continue;
+        }
+        
+        if (track.positions.size() < _length) {
+            track.positions.push_back(obs->getPosition());
+            track.velocities.push_back(obs->getLinearVelocity());
+            Uint32 recorded = (Uint32)track.positions.size();
+            if (_listener && std::find(_milestones.begin(), _milestones.end(), recorded) != _milestones.end()) {
+                _listener(it->first, track.obstacle, track.positions);
+            }
+        }
+        track.age++;
+        ++it;
+    }
+}
+
+/**
+ * Confirms a predicted crate with the state the host has for it.
+ *
+ * The difference between the host's state and this peer's state at the
+ * same age is sampled as the prediction error. The crate itself is left
+ * alone: this peer owns it, so any write to it would be sent to every
+ * other peer. The copies of the other peers converge to ours through the
+ * regular state updates.
+ *
+ * @param key       The spawn key
+ * @param position  The host position at the last age of the trajectory
+ * @param velocity  The host velocity at the last age of the trajectory
+ * @param age       The number of ages the host has recorded
+ *
+ * @return true if the crate was predicted and is now confirmed
+ */
+bool SpawnPredictor::confirm(Uint32 key, const Vec2 position, const Vec2 velocity, Uint32 age) {
+    auto it = _tracks.find(key);
+    if (it == _tracks.end() || !it->second.predicted || age == 0 || age > it->second.positions.size()) {
+        return false;
+    }
+    Track& track = it->second;
+    track.predicted = false;
+    if (_stats) {
+        _stats->count("predict.confirmed");
+        _stats->sample("predict.error", position.distance(track.positions[age-1]));
+        _stats->sample("predict.error_vel", velocity.distance(track.velocities[age-1]));
+    }
+    return true;
+}
+
+/**
+ * Samples the divergence between a trajectory of another peer and ours.
+ *
+ * The maximum distance over the trajectory and the distance at its end
+ * are sampled as statistics.
+ *
+ * @param key           The spawn key
+ * @param trajectory    The positions of the other peer at every age
+ */
+void SpawnPredictor::compare(Uint32 key, const std::vector<Vec2>& trajectory) {
+    auto it = _tracks.find(key);
+    if (it == _tracks.end() || _stats == nullptr) {
+        return;
+    }
+    const std::vector<Vec2>& ours = it->second.positions;
+    size_t count = std::min(ours.size(), trajectory.size());
+    if (count == 0) {
+        return;
+    }
+    float worst = 0;
+    for(size_t ii = 0; ii < count; ii++) {
+        worst = std::max(worst, ours[ii].distance(trajectory[ii]));
+    }
+    _stats->sample("predict.divergence_max", worst);
+    _stats->sample("predict.divergence_end", ours[count-1].distance(trajectory[count-1]));
+}
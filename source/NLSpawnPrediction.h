@@ -0,0 +1,172 @@
+//
+//  NLSpawnPrediction.h
+//  Networked Physics Demo
+//
+//  This class tracks fired crates through their first ticks.
+//  A crate fired by this peer is simulated at once, before any other peer
+//  has seen it.  It stays predicted until the host acknowledges it with its
+//  own state for the crate.  The firing peer owns the crate, so its state is
+//  never corrected; the error is only measured.  The trajectory of every
+//  fired crate is recorded, so that peers can measure how far apart their
+//  copies drift.
+//
+//  Author: Networked Physics Lab contributors
+//  Version: 10/18/26
+//
+#ifndef __NL_SPAWN_PREDICTION_H__
+#define __NL_SPAWN_PREDICTION_H__
+#include <cugl/cugl.h>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+class NetLabStats;
+
+/**
+ * This class tracks fired crates from their spawn until they settle.
+ *
+ * Every crate has a track, indexed by spawn key, with its position and
+ * velocity at every age (in ticks since the spawn on this peer). Tracks of
+ * crates fired by this peer start out predicted. A track reports each
+ * milestone age to the milestone listener, so that the host can send its
+ * acknowledgement and trajectory.
+ */
+class SpawnPredictor {
+public:
+    /**
+     * The listener for milestone ages.
+     *
+     * The listener takes the spawn key, the obstacle and its trajectory
+     * (positions at ages 0 to age-1).
+     */
+    typedef std::function<void(Uint32 key, const std::shared_ptr<cugl::physics2::Obstacle>& obj,
+                               const std::vector<cugl::Vec2>& trajectory)> Listener;
+
+protected:
+    /** The early history of a fired crate */
+    struct Track {
+        /** The fired crate */
+        std::shared_ptr<cugl::physics2::Obstacle> obstacle;
+        /** The positions at every age */
+        std::vector<cugl::Vec2> positions;
+        /** The velocities at every age */
+        std::vector<cugl::Vec2> velocities;
+        /** The number of ticks since the spawn */
+        Uint32 age;
+        /** Whether the crate is still waiting for the host to confirm it */
+        bool predicted;
+    };
+
+    /** The tracked crates, indexed by spawn key */
+    std::unordered_map<Uint32, Track> _tracks;
+    /** The number of ages recorded per crate */
+    Uint32 _length;
+    /** The ages reported to the listener */
+    std::vector<Uint32> _milestones;
+    /** The listener for milestone ages */
+    Listener _listener;
+    /** The statistics log for errors and divergence (may be null) */
+    NetLabStats* _stats;
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates a predictor that records nothing.
+     */
+    SpawnPredictor() : _length(0), _stats(nullptr) {}
+
+    /**
+     * Initializes an empty predictor.
+     *
+     * @param length    The number of ages recorded per crate
+     */
+    void init(Uint32 length);
+
+    /**
+     * Removes all tracks.
+     */
+    void clear() { _tracks.clear(); }
+
+#pragma mark Attributes
+    /**
+     * Sets the listener for milestone ages.
+     *
+     * @param ages      The ages reported (at most the recorded length)
+     * @param listener  The listener for milestone ages
+     */
+    void setListener(const std::vector<Uint32>& ages, Listener listener) {
+        _milestones = ages;
+        _listener = listener;
+    }
+
+    /**
+     * Sets the statistics log for errors and divergence.
+     *
+     * @param stats The statistics log (or nullptr)
+     */
+    void setStats(NetLabStats* stats) { _stats = stats; }
+
+    /**
+     * Returns the number of tracked crates.
+     *
+     * @return the number of tracked crates.
+     */
+    size_t size() const { return _tracks.size(); }
+
+    /**
+     * Returns true if the crate is still waiting for confirmation.
+     *
+     * @param key   The spawn key
+     *
+     * @return true if the crate is still waiting for confirmation.
+     */
+    bool isPredicted(Uint32 key) const;
+
+#pragma mark Tracking
+    /**
+     * Starts tracking a newly spawned crate.
+     *
+     * @param key       The spawn key
+     * @param obj       The crate obstacle
+     * @param predicted Whether this peer fired the crate and waits for the host
+     */
+    void track(Uint32 key, const std::shared_ptr<cugl::physics2::Obstacle>& obj, bool predicted);
+
+    /**
+     * Records the state of every tracked crate.
+     *
+     * This should be called once per tick, after the physics step.
+     */
+    void update();
+
+    /**
+     * Confirms a predicted crate with the state the host has for it.
+     *
+     * The difference between the host's state and this peer's state at the
+     * same age is sampled as the prediction error. The crate itself is left
+     * alone: this peer owns it, so any write to it would be sent to every
+     * other peer. The copies of the other peers converge to ours through the
+     * regular state updates.
+     *
+     * @param key       The spawn key
+     * @param position  The host position at the last age of the trajectory
+     * @param velocity  The host velocity at the last age of the trajectory
+     * @param age       The number of ages the host has recorded
+     *
+     * @return true if the crate was predicted and is now confirmed
+     */
+    bool confirm(Uint32 key, const cugl::Vec2 position, const cugl::Vec2 velocity, Uint32 age);
+
+    /**
+     * Samples the divergence between a trajectory of another peer and ours.
+     *
+     * The maximum distance over the trajectory and the distance at its end
+     * are sampled as statistics.
+     *
+     * @param key           The spawn key
+     * @param trajectory    The positions of the other peer at every age
+     */
+    void compare(Uint32 key, const std::vector<cugl::Vec2>& trajectory);
+};
+
+#endif /* __NL_SPAWN_PREDICTION_H__ */
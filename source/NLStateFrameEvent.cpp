@@ -0,0 +1,82 @@
+//
+//  NLStateFrameEvent.cpp
+//  Networked Physics Lab
+//
+//  This class carries the state of the awake obstacles owned by a peer at
+//  one of its ticks.  The physics controller applies its own state updates
+//  without showing them to the game, so these frames are what the other
+//  peers interpolate remote obstacles from.
+//
+//  Created by the Networked Physics Lab contributors on 10/18/26.
+//
+
+#include "NLStateFrameEvent.h"
+
+/**
+ * This method is used by the NetEventController to create a new event of using a
+ * reference of the same type.
+ *
+ * Not that this method is not static, it differs from the static alloc() method
+ * and all methods must implement this method.
+ */
+std::shared_ptr<NetEvent> StateFrameEvent::newEvent(){
+    return std::make_shared<StateFrameEvent>();
+}
+
+std::shared_ptr<NetEvent> StateFrameEvent::allocStateFrameEvent(Uint32 peer, Uint64 tick, const std::vector<Record>& records){
+    auto event = std::make_shared<StateFrameEvent>();
+    event->_peer = peer;
+    event->_tick = tick;
+    event->_records = records;
+    return event;
+}
+
+/**
+ * Serialize any paramater that the event contains to a vector of bytes.
+ */
+std::vector<std::byte> StateFrameEvent::serialize(){
+    _serializer.reset();
+    _serializer.writeUint32(_peer);
+    _serializer.writeUint64(_tick);
+    _serializer.writeUint32((Uint32)_records.size());
+    for(auto& record : _records){
+        _serializer.writeUint64(record.id);
+        _serializer.writeFloat(record.pos.x);
+        _serializer.writeFloat(record.pos.y);
+        _serializer.writeFloat(record.vel.x);
+        _serializer.writeFloat(record.vel.y);
+        _serializer.writeFloat(record.angle);
+    }
+    return _serializer.serialize();
+}
+
+/**
+ * Deserialize a vector of bytes and set the corresponding parameters.
+ *
+ * @param data  a byte vector packed by serialize()
+ *
+ * This function should be the "reverse" of the serialize() function: it
+ * should be able to recreate a serialized event entirely, setting all the
+ * useful parameters of this class.
+ */
+void StateFrameEvent::deserialize(const std::vector<std::byte>& data){
+    _deserializer.reset();
+    _deserializer.receive(data);
+    _peer = _deserializer.readUint32();
+    _tick = _deserializer.readUint64();
+    Uint32 count = _deserializer.readUint32();
+    _records.clear();
+    _records.reserve(count);
+    for(Uint32 ii = 0; ii < count; ii++){
+        Record record;
+        record.id = _deserializer.readUint64();
+        float x = _deserializer.readFloat();
+        float y = _deserializer.readFloat();
+        record.pos = Vec2(x,y);
+        x = _deserializer.readFloat();
+        y = _deserializer.readFloat();
+        record.vel = Vec2(x,y);
+        record.angle = _deserializer.readFloat();
+        _records.push_back(record);
+    }
+}
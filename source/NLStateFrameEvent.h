@@ -0,0 +1,84 @@
+//
+//  NLStateFrameEvent.h
+//  Networked Physics Lab
+//
+//  This class carries the state of the awake obstacles owned by a peer at
+//  one of its ticks.  The physics controller applies its own state updates
+//  without showing them to the game, so these frames are what the other
+//  peers interpolate remote obstacles from.
+//
+//  Created by the Networked Physics Lab contributors on 10/18/26.
+//
+
+#ifndef NLStateFrameEvent_h
+#define NLStateFrameEvent_h
+
+#include <cugl/cugl.h>
+#include <vector>
+using namespace cugl::netphysics;
+using namespace cugl;
+
+class StateFrameEvent : public NetEvent {
+public:
+    /** The state of a single obstacle */
+    struct Record {
+        /** The obstacle id */
+        Uint64 id;
+        /** The obstacle position */
+        Vec2 pos;
+        /** The obstacle linear velocity */
+        Vec2 vel;
+        /** The obstacle angle */
+        float angle;
+    };
+    
+protected:
+    LWSerializer _serializer;
+    LWDeserializer _deserializer;
+    
+    /** The short UID of the peer that owns the obstacles */
+    Uint32 _peer;
+    /** The tick of the peer when it sent the frame */
+    Uint64 _tick;
+    /** The states of the obstacles */
+    std::vector<Record> _records;
+    
+public:
+    /**
+     * This method is used by the NetEventController to create a new event of using a
+     * reference of the same type.
+     *
+     * Not that this method is not static, it differs from the static alloc() method
+     * and all methods must implement this method.
+     */
+    std::shared_ptr<NetEvent> newEvent() override;
+    
+    static std::shared_ptr<NetEvent> allocStateFrameEvent(Uint32 peer, Uint64 tick, const std::vector<Record>& records);
+    
+    /**
+     * Serialize any paramater that the event contains to a vector of bytes.
+     */
+    std::vector<std::byte> serialize() override;
+    /**
+     * Deserialize a vector of bytes and set the corresponding parameters.
+     *
+     * @param data  a byte vector packed by serialize()
+     *
+     * This function should be the "reverse" of the serialize() function: it
+     * should be able to recreate a serialized event entirely, setting all the
+     * useful parameters of this class.
+     */
+    void deserialize(const std::vector<std::byte>& data) override;
+    
+    /** Gets the short UID of the peer that owns the obstacles. */
+    Uint32 getPeer() const { return _peer; }
+    
+    /** Gets the tick of the peer when it sent the frame. */
+    Uint64 getTick() const { return _tick; }
+    
+    /** Gets the states of the obstacles. */
+    const std::vector<Record>& getRecords() const { return _records; }
+};
+
+
+#endif /* NLStateFrameEvent_h */
@@ -0,0 +1,173 @@
+//
+//  NLStats.cpp
+//  Networked Physics Demo
+//
+//  This class collects performance counters and timing samples for the demo.
+//  Counters accumulate for the whole session, while samples are summarized
+//  (mean, median, 99th percentile and max) and discarded every time the
+//  statistics are reported.  Reports go to the log, so that they can be
+//  collected from a device after a test session.
+//
+//  Author: Networked Physics Lab contributors
+//  Version: 10/18/26
+//
+#include "NLStats.h"
+#include <algorithm>
+#include <cstdio>
+#if defined(__APPLE__)
+    #include <mach/mach.h>
+    #include <malloc/malloc.h>
+#elif defined(_WIN32)
+    #include <windows.h>
+    #include <psapi.h>
+    #pragma comment(lib, "psapi.lib")
+#elif defined(__linux__)
+    #include <malloc.h>
+    #include <unistd.h>
+#endif
+
+using namespace cugl;
+
+/**
+ * Returns the given percentile of a sorted, non-empty series.
+ *
+ * @param sorted    The sorted series
+ * @param percent   The percentile in [0,100]
+ *
+ * @return the given percentile of a sorted series.
+ */
+static float percentile(const std::vector<float>& sorted, float percent) {
+    size_t index = (size_t)(percent/100.0f*(sorted.size()-1)+0.5f);
+    return sorted[std::min(index,sorted.size()-1)];
+}
+
+#pragma mark Constructors
+/**
+ * Removes all counters and samples from this log.
+ */
+void NetLabStats::clear() {
+    _counters.clear();
+    _samples.clear();
+}
+
+#pragma mark Collection
+/**
+ * Returns the value of a session counter.
+ *
+ * @param key       The counter name
+ *
+ * @return the value of a session counter.
+ */
+Uint64 NetLabStats::getCount(const std::string& key) const {
+    auto it = _counters.find(key);
+    return it == _counters.end() ? 0 : it->second;
+}
+
+/**
+ * Returns the given percentile of a series since the last report.
+ *
+ * @param key       The series name
+ * @param percent   The percentile in [0,100]
+ *
+ * @return the given percentile of a series (0 if it is empty).
+ */
+float NetLabStats::getPercentile(const std::string& key, float percent) const {
+    auto it = _samples.find(key);
+    if (it == _samples.end() || it->second.empty()) {
+        return 0;
+    }
+    std::vector<float> sorted = it->second;
+    std::sort(sorted.begin(),sorted.end());
+    return percentile(sorted,percent);
+}
+
+/**
+ * Sets the memory gauges of this process.
+ *
+ * The gauge "<prefix>.rss_kb" is the resident set size, and the gauge
+ * "<prefix>.heap_kb" is the memory allocated by malloc (and so by new).
+ * A gauge is left unset where the platform does not report it: the heap
+ * is only read on glibc, Android and Apple platforms.
+ *
+ * @param prefix    The prefix of the gauges
+ *
+ * @return true if the resident set size was read
+ */
+bool NetLabStats::setMemory(const std::string& prefix) {
+    Uint64 rss = 0;
+#if defined(__APPLE__)
+    mach_task_basic_info_data_t info;
+    mach_msg_type_number_t size = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &size) == KERN_SUCCESS) {
+        rss = info.resident_size;
+    }
+    malloc_statistics_t heap;
+    malloc_zone_statistics(nullptr, &heap);
+    set(prefix + ".heap_kb", heap.size_in_use/1024);
+#elif defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS info;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &info, sizeof(info))) {
+        rss = info.WorkingSetSize;
+    }
+#elif defined(__linux__)
+    // The second field of statm is the resident size in pages
+    FILE* file = fopen("/proc/self/statm", "r");
+    if (file != nullptr) {
+        unsigned long total = 0;
+        unsigned long resident = 0;
+        if (fscanf(file, "%lu %lu", &total, &resident) == 2) {
+            rss = (Uint64)resident*(Uint64)sysconf(_SC_PAGESIZE);
+        }
+        fclose(file);
+    }
+    #if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+        set(prefix + ".heap_kb", mallinfo2().uordblks/1024);
+    #elif defined(__GLIBC__) || defined(__ANDROID__)
+        set(prefix + ".heap_kb", (Uint64)(unsigned int)mallinfo().uordblks/1024);
+    #endif
+#endif
+    if (rss == 0) {
+        return false;
+    }
+    set(prefix + ".rss_kb", rss/1024);
+    return true;
+}
+
+#pragma mark Reporting
+/**
+ * Writes the counters and sample summaries with the given prefix to the log.
+ *
+ * The reported samples are discarded afterwards, but the counters are
+ * kept. Series with another prefix are left alone, so a subsystem can
+ * report on its own without cutting short the periodic report.
+ *
+ * @param title     The title of this report
+ * @param prefix    The prefix of the reported keys (empty for all)
+ */
+void NetLabStats::report(const std::string& title, const std::string& prefix) {
+    CULog("==== %s ====", title.c_str());
+    for(auto it = _counters.lower_bound(prefix); it != _counters.end(); ++it) {
+        if (it->first.compare(0, prefix.size(), prefix) != 0) {
+            break;
+        }
+        CULog("%-28s %llu", it->first.c_str(), (unsigned long long)it->second);
+    }
+    for(auto it = _samples.lower_bound(prefix); it != _samples.end(); ++it) {
+        if (it->first.compare(0, prefix.size(), prefix) != 0) {
+            break;
+        }
+        std::vector<float>& series = it->second;
+        if (series.empty()) {
+            continue;
+        }
+        std::sort(series.begin(),series.end());
+        double total = 0;
+        for(float value : series) {
+            total += value;
+        }
+        CULog("%-28s n=%zu mean=%.3f p50=%.3f p99=%.3f max=%.3f", it->first.c_str(),
+              series.size(), total/series.size(), percentile(series,50),
+              percentile(series,99), series.back());
+        series.clear();
+    }
+}
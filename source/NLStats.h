@@ -0,0 +1,128 @@
+//
+//  NLStats.h
+//  Networked Physics Demo
+//
+//  This class collects performance counters and timing samples for the demo.
+//  Counters accumulate for the whole session, while samples are summarized
+//  (mean, median, 99th percentile and max) and discarded every time the
+//  statistics are reported.  Reports go to the log, so that they can be
+//  collected from a device after a test session.
+//
+//  Author: Networked Physics Lab contributors
+//  Version: 10/18/26
+//
+#ifndef __NL_STATS_H__
+#define __NL_STATS_H__
+#include <cugl/cugl.h>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * This class collects performance counters and timing samples.
+ *
+ * Like the input controller, this class is not a singleton.  It is a field
+ * of the game scene, which passes it to the subsystems it wants to measure.
+ * Keys are plain strings; the reports are sorted by key, so related
+ * statistics should share a prefix (e.g. "spawn.alloc", "spawn.latency").
+ */
+class NetLabStats {
+protected:
+    /** The session counters */
+    std::map<std::string, Uint64> _counters;
+    /** The samples collected since the last report */
+    std::map<std::string, std::vector<float>> _samples;
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates an empty statistics log.
+     */
+    NetLabStats() {}
+
+    /**
+     * Removes all counters and samples from this log.
+     */
+    void clear();
+
+#pragma mark Collection
+    /**
+     * Adds the given amount to a session counter.
+     *
+     * @param key       The counter name
+     * @param amount    The amount to add
+     */
+    void count(const std::string& key, Uint64 amount = 1) {
+        _counters[key] += amount;
+    }
+
+    /**
+     * Sets a session counter to the given value.
+     *
+     * This is useful for gauges, like the current population or memory use.
+     *
+     * @param key       The counter name
+     * @param value     The current value
+     */
+    void set(const std::string& key, Uint64 value) {
+        _counters[key] = value;
+    }
+
+    /**
+     * Adds a sample to the given series.
+     *
+     * @param key       The series name
+     * @param value     The sample value
+     */
+    void sample(const std::string& key, float value) {
+        _samples[key].push_back(value);
+    }
+
+    /**
+     * Returns the value of a session counter.
+     *
+     * @param key       The counter name
+     *
+     * @return the value of a session counter.
+     */
+    Uint64 getCount(const std::string& key) const;
+
+    /**
+     * Returns the given percentile of a series since the last report.
+     *
+     * @param key       The series name
+     * @param percent   The percentile in [0,100]
+     *
+     * @return the given percentile of a series (0 if it is empty).
+     */
+    float getPercentile(const std::string& key, float percent) const;
+
+    /**
+     * Sets the memory gauges of this process.
+     *
+     * The gauge "<prefix>.rss_kb" is the resident set size, and the gauge
+     * "<prefix>.heap_kb" is the memory allocated by malloc (and so by new).
+     * A gauge is left unset where the platform does not report it: the heap
+     * is only read on glibc, Android and Apple platforms.
+     *
+     * @param prefix    The prefix of the gauges
+     *
+     * @return true if the resident set size was read
+     */
+    bool setMemory(const std::string& prefix);
+
+#pragma mark Reporting
+    /**
+     * Writes the counters and sample summaries with the given prefix to the log.
+     *
+     * The reported samples are discarded afterwards, but the counters are
+     * kept. Series with another prefix are left alone, so a subsystem can
+     * report on its own without cutting short the periodic report.
+     *
+     * @param title     The title of this report
+     * @param prefix    The prefix of the reported keys (empty for all)
+     */
+    void report(const std::string& title, const std::string& prefix = "");
+};
+
+#endif /* __NL_STATS_H__ */
@@ -0,0 +1,76 @@
+//
+//  NLTickedEvent.cpp
+//  Networked Physics Lab
+//
+//  This class is the base of events that are applied at a fixed tick.
+//  Every ticked event carries the tick it was sent at and the tick it must
+//  execute at, so that all peers apply it at the same point in the
+//  simulation, no matter when it arrives.
+//
+//  Created by the Networked Physics Lab contributors on 10/18/26.
+//
+
+#include "NLTickedEvent.h"
+
+/**
+ * Writes the tick stamp of this event.
+ *
+ * Subclasses should call this first in serialize().
+ *
+ * @param out   The serializer to write to
+ */
+void TickedEvent::writeStamp(LWSerializer& out) const {
+    out.writeUint64(_sendTick);
+    out.writeUint64(_execTick);
+    out.writeUint32(_sender);
+    out.writeUint32(_seq);
+}
+
+/**
+ * Reads the tick stamp of this event.
+ *
+ * Subclasses should call this first in deserialize().
+ *
+ * @param in    The deserializer to read from
+ */
+void TickedEvent::readStamp(LWDeserializer& in) {
+    _sendTick = in.readUint64();
+    _execTick = in.readUint64();
+    _sender = in.readUint32();
+    _seq = in.readUint32();
+}
+
+/**
+ * Stamps this event with its ticks and sender.
+ *
+ * @param tick      The current tick of the sender
+ * @param delay     The number of ticks before the event is applied
+ * @param sender    The short UID of the sender
+ * @param seq       The sequence number of the event for the sender
+ */
+void TickedEvent::stamp(Uint64 tick, Uint32 delay, Uint32 sender, Uint32 seq) {
+    _sendTick = tick;
+    _execTick = tick+delay;
+    _sender = sender;
+    _seq = seq;
+}
+
+/**
+ * Returns true if this event must be applied before the other one.
+ *
+ * Events are ordered by execute tick, then sender, then sequence number,
+ * so that every peer applies the events of a tick in the same order.
+ *
+ * @param other The event to compare to
+ *
+ * @return true if this event must be applied before the other one.
+ */
+bool TickedEvent::precedes(const TickedEvent& other) const {
+    if (_execTick != other._execTick) {
+        return _execTick < other._execTick;
+    }
+    if (_sender != other._sender) {
+        return _sender < other._sender;
+    }
+    return _seq < other._seq;
+}
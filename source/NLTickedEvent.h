@@ -0,0 +1,92 @@
+//
+//  NLTickedEvent.h
+//  Networked Physics Lab
+//
+//  This class is the base of events that are applied at a fixed tick.
+//  Every ticked event carries the tick it was sent at and the tick it must
+//  execute at, so that all peers apply it at the same point in the
+//  simulation, no matter when it arrives.
+//
+//  Created by the Networked Physics Lab contributors on 10/18/26.
+//
+
+#ifndef NLTickedEvent_h
+#define NLTickedEvent_h
+
+#include <cugl/cugl.h>
+using namespace cugl::netphysics;
+using namespace cugl;
+
+class TickedEvent : public NetEvent {
+    
+protected:
+    /** The tick of the sender when this event was sent */
+    Uint64 _sendTick;
+    /** The tick at which this event is applied */
+    Uint64 _execTick;
+    /** The short UID of the sender */
+    Uint32 _sender;
+    /** The sequence number of this event among those of the sender */
+    Uint32 _seq;
+    
+    /**
+     * Writes the tick stamp of this event.
+     *
+     * Subclasses should call this first in serialize().
+     *
+     * @param out   The serializer to write to
+     */
+    void writeStamp(LWSerializer& out) const;
+    
+    /**
+     * Reads the tick stamp of this event.
+     *
+     * Subclasses should call this first in deserialize().
+     *
+     * @param in    The deserializer to read from
+     */
+    void readStamp(LWDeserializer& in);
+    
+public:
+    /**
+     * Creates an event to be applied at tick 0.
+     */
+    TickedEvent() : _sendTick(0), _execTick(0), _sender(0), _seq(0) {}
+    
+    /**
+     * Stamps this event with its ticks and sender.
+     *
+     * @param tick      The current tick of the sender
+     * @param delay     The number of ticks before the event is applied
+     * @param sender    The short UID of the sender
+     * @param seq       The sequence number of the event for the sender
+     */
+    void stamp(Uint64 tick, Uint32 delay, Uint32 sender, Uint32 seq);
+    
+    /** Gets the tick of the sender when this event was sent. */
+    Uint64 getSendTick() const { return _sendTick; }
+    
+    /** Gets the tick at which this event is applied. */
+    Uint64 getExecuteTick() const { return _execTick; }
+    
+    /** Gets the short UID of the sender. */
+    Uint32 getSender() const { return _sender; }
+    
+    /** Gets the sequence number of this event for the sender. */
+    Uint32 getSequence() const { return _seq; }
+    
+    /**
+     * Returns true if this event must be applied before the other one.
+     *
+     * Events are ordered by execute tick, then sender, then sequence number,
+     * so that every peer applies the events of a tick in the same order.
+     *
+     * @param other The event to compare to
+     *
+     * @return true if this event must be applied before the other one.
+     */
+    bool precedes(const TickedEvent& other) const;
+};
+
+
+#endif /* NLTickedEvent_h */
@@ -0,0 +1,184 @@
+//
+//  NLTopology.cpp
+//  Networked Physics Demo
+//
+//  This class chooses how state updates should be spread between peers.
+//  In a full mesh, every peer owns a share of the obstacles and sends their
+//  updates to every other peer, so the upload of every owner grows with the
+//  size of the room.  With a relay, one peer (normally the host) takes over
+//  every dynamic obstacle and sends every update once per receiver, while
+//  the other peers only send their inputs.  This moves the fan-out cost onto
+//  the peer with the best uplink.
+//
+//  The physics controller broadcasts the updates of the obstacles a peer
+//  owns, and has no hook to forward them through another peer.  So the
+//  relay is built from ownership: the relay owns what it would forward.
+//  The choice is made from the payload rates that peers report, against
+//  an uplink budget.
+//
+//  Author: Networked Physics Lab contributors
+//  Version: 10/18/26
+//
+#include "NLTopology.h"
+#include "NLStats.h"
+#include <algorithm>
+
+using namespace cugl;
+
+#pragma mark Constructors
+/**
+ * Initializes the topology selection.
+ *
+ * @param mode          The requested mode
+ * @param relay         The short UID of the relay peer
+ * @param header        The bytes of header added to every packet
+ * @param rate          The number of packets sent each second, per receiver
+ * @param budget        The upload each peer may use, in bytes per second
+ * @param relayBudget   The upload the relay may use, in bytes per second
+ */
+void Topology::init(Mode mode, Uint32 relay, Uint32 header, Uint32 rate, Uint32 budget, Uint32 relayBudget) {
+    _mode = mode;
+    _relay = relay;
+    _header = header;
+    _rate = rate;
+    _budget = budget;
+    _relayBudget = relayBudget;
+    clear();
+}
+
+/**
+ * Forgets all reported rates, and returns to the initial topology.
+ */
+void Topology::clear() {
+    _payloads.clear();
+    _active = _mode == Mode::RELAY ? Mode::RELAY : Mode::MESH;
+}
+
+#pragma mark Internal Helpers
+/**
+ * Returns the largest upload of a peer in the mesh.
+ *
+ * While relaying, the relay carries every payload, so the mesh estimate
+ * spreads the total evenly over the peers.
+ *
+ * @return the largest upload of a peer in the mesh, in bytes per second
+ */
+Uint32 Topology::getMeshPeak() const {
+    Uint32 peak = 0;
+    if (_active == Mode::MESH) {
+        auto mesh = estimate(Mode::MESH);
+        for(auto it = mesh.begin(); it != mesh.end(); ++it) {
+            peak = std::max(peak, it->second);
+        }
+        return peak;
+    }
+
+    std::map<Uint32, Uint32> payloads = _payloads;
+    payloads.insert({_relay, 0});
+    Uint64 total = 0;
+    for(auto it = payloads.begin(); it != payloads.end(); ++it) {
+        total += it->second;
+    }
+    if (total == 0) {
+        return 0;
+    }
+    Uint64 share = total/payloads.size();
+    Uint64 upload = (share+(Uint64)_header*_rate)*(payloads.size()-1);
+    return (Uint32)std::min<Uint64>(upload, UINT32_MAX);
+}
+
+#pragma mark Selection
+/**
+ * Forgets the payload rates of peers that have left.
+ *
+ * @param peers The short UIDs of the remaining peers
+ */
+void Topology::retain(const std::vector<Uint32>& peers) {
+    for(auto it = _payloads.begin(); it != _payloads.end(); ) {
+        if (std::find(peers.begin(), peers.end(), it->first) == peers.end()) {
+            it = _payloads.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+/**
+ * Returns the estimated upload of every peer in the given topology.
+ *
+ * @param mode  The topology (MESH or RELAY)
+ *
+ * @return the estimated upload of every peer, in bytes per second, by short UID
+ */
+std::map<Uint32, Uint32> Topology::estimate(Mode mode) const {
+    std::map<Uint32, Uint32> result;
+    std::map<Uint32, Uint32> payloads = _payloads;
+    payloads.insert({_relay, 0});
+
+    size_t receivers = payloads.size()-1;
+    Uint64 total = 0;
+    for(auto it = payloads.begin(); it != payloads.end(); ++it) {
+        total += it->second;
+    }
+
+    for(auto it = payloads.begin(); it != payloads.end(); ++it) {
+        Uint64 upload = 0;
+        if (mode != Mode::RELAY) {
+            if (it->second > 0) {
+                upload = ((Uint64)it->second+(Uint64)_header*_rate)*receivers;
+            }
+        } else if (it->first == _relay && total > 0) {
+            // The relay owns every obstacle, so every receiver gets every update from it
+            upload = (total+(Uint64)_header*_rate)*receivers;
+        }
+        result[it->first] = (Uint32)std::min<Uint64>(upload, UINT32_MAX);
+    }
+    return result;
+}
+
+/**
+ * Reevaluates the topology from the reported rates.
+ *
+ * This only changes anything in AUTO mode.
+ *
+ * @return true if the topology in use changed
+ */
+bool Topology::select() {
+    Mode previous = _active;
+    if (_mode != Mode::AUTO) {
+        _active = _mode;
+        return _active != previous;
+    }
+
+    Uint32 meshPeak = getMeshPeak();
+    Uint32 relayLoad = estimate(Mode::RELAY)[_relay];
+    if (_active == Mode::MESH) {
+        if (meshPeak > _budget && relayLoad <= _relayBudget) {
+            _active = Mode::RELAY;
+        }
+    } else if ((Uint64)meshPeak*5 < (Uint64)_budget*4 || relayLoad > _relayBudget) {
+        // Only return to the mesh with some headroom, so the choice does not flap
+        _active = Mode::MESH;
+    }
+
+    if (_active != previous && _stats) {
+        _stats->count("topology.switches");
+    }
+    return _active != previous;
+}
+
+/**
+ * Adopts the topology chosen by the relay peer.
+ *
+ * @param active    The topology in use by the relay (MESH or RELAY)
+ *
+ * @return true if the topology in use changed
+ */
+bool Topology::follow(Mode active) {
+    Mode previous = _active;
+    _active = active == Mode::RELAY ? Mode::RELAY : Mode::MESH;
+    if (_active != previous && _stats) {
+        _stats->count("topology.switches");
+    }
+    return _active != previous;
+}
@@ -0,0 +1,181 @@
+//
+//  NLTopology.h
+//  Networked Physics Demo
+//
+//  This class chooses how state updates should be spread between peers.
+//  In a full mesh, every peer owns a share of the obstacles and sends their
+//  updates to every other peer, so the upload of every owner grows with the
+//  size of the room.  With a relay, one peer (normally the host) takes over
+//  every dynamic obstacle and sends every update once per receiver, while
+//  the other peers only send their inputs.  This moves the fan-out cost onto
+//  the peer with the best uplink.
+//
+//  The physics controller broadcasts the updates of the obstacles a peer
+//  owns, and has no hook to forward them through another peer.  So the
+//  relay is built from ownership: the relay owns what it would forward.
+//  The choice is made from the payload rates that peers report, against
+//  an uplink budget.
+//
+//  Author: Networked Physics Lab contributors
+//  Version: 10/18/26
+//
+#ifndef __NL_TOPOLOGY_H__
+#define __NL_TOPOLOGY_H__
+#include <cugl/cugl.h>
+#include <map>
+#include <vector>
+
+class NetLabStats;
+
+/**
+ * This class selects the topology used to spread state updates.
+ *
+ * Peers report their payload rate, which is the bytes per second of state
+ * they send to a single receiver. From these, the class estimates the
+ * upload of every peer in each topology (packet headers included). In AUTO
+ * mode, the mesh is used until some peer exceeds the uplink budget, and the
+ * relay is used until every peer would fit comfortably in the mesh again.
+ *
+ * Only the relay peer selects. The other peers follow its choice, which
+ * it sends with its status reports.
+ */
+class Topology {
+public:
+    /** How state updates are spread between peers */
+    enum class Mode : int {
+        /** Every owner sends to every peer */
+        MESH = 0,
+        /** The relay owns every dynamic obstacle, and sends to every peer */
+        RELAY = 1,
+        /** Choose between the two from the measured rates */
+        AUTO = 2
+    };
+
+protected:
+    /** The requested mode */
+    Mode _mode;
+    /** The mode currently in use (never AUTO) */
+    Mode _active;
+    /** The short UID of the relay peer */
+    Uint32 _relay;
+    /** The bytes of header added to every packet */
+    Uint32 _header;
+    /** The number of packets a peer sends each second, per receiver */
+    Uint32 _rate;
+    /** The upload each peer may use, in bytes per second */
+    Uint32 _budget;
+    /** The upload the relay may use, in bytes per second */
+    Uint32 _relayBudget;
+    /** The reported payload rates, by short UID */
+    std::map<Uint32, Uint32> _payloads;
+    /** The statistics log for mode switches (may be null) */
+    NetLabStats* _stats;
+
+    /**
+     * Returns the largest upload of a peer in the mesh.
+     *
+     * While relaying, the relay carries every payload, so the mesh estimate
+     * spreads the total evenly over the peers.
+     *
+     * @return the largest upload of a peer in the mesh, in bytes per second
+     */
+    Uint32 getMeshPeak() const;
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates a full mesh topology.
+     */
+    Topology() : _mode(Mode::MESH), _active(Mode::MESH), _relay(0), _header(0),
+    _rate(0), _budget(0), _relayBudget(0), _stats(nullptr) {}
+
+    /**
+     * Initializes the topology selection.
+     *
+     * @param mode          The requested mode
+     * @param relay         The short UID of the relay peer
+     * @param header        The bytes of header added to every packet
+     * @param rate          The number of packets sent each second, per receiver
+     * @param budget        The upload each peer may use, in bytes per second
+     * @param relayBudget   The upload the relay may use, in bytes per second
+     */
+    void init(Mode mode, Uint32 relay, Uint32 header, Uint32 rate, Uint32 budget, Uint32 relayBudget);
+
+    /**
+     * Forgets all reported rates, and returns to the initial topology.
+     */
+    void clear();
+
+    /**
+     * Sets the statistics log for mode switches.
+     *
+     * @param stats The statistics log (or nullptr)
+     */
+    void setStats(NetLabStats* stats) { _stats = stats; }
+
+#pragma mark Selection
+    /**
+     * Records the payload rate of a peer.
+     *
+     * @param peer      The short UID of the peer
+     * @param payload   The bytes per second of state for a single receiver
+     */
+    void report(Uint32 peer, Uint32 payload) { _payloads[peer] = payload; }
+
+    /**
+     * Forgets the payload rates of peers that have left.
+     *
+     * @param peers The short UIDs of the remaining peers
+     */
+    void retain(const std::vector<Uint32>& peers);
+
+    /**
+     * Reevaluates the topology from the reported rates.
+     *
+     * This only changes anything in AUTO mode.
+     *
+     * @return true if the topology in use changed
+     */
+    bool select();
+
+    /**
+     * Adopts the topology chosen by the relay peer.
+     *
+     * @param active    The topology in use by the relay (MESH or RELAY)
+     *
+     * @return true if the topology in use changed
+     */
+    bool follow(Mode active);
+
+    /**
+     * Returns the topology in use (never AUTO).
+     *
+     * @return the topology in use (never AUTO).
+     */
+    Mode getActive() const { return _active; }
+
+    /**
+     * Returns true if the relay carries every state update.
+     *
+     * @return true if the relay carries every state update.
+     */
+    bool isRelaying() const { return _active == Mode::RELAY; }
+
+    /**
+     * Returns the short UID of the relay peer.
+     *
+     * @return the short UID of the relay peer.
+     */
+    Uint32 getRelay() const { return _relay; }
+
+    /**
+     * Returns the estimated upload of every peer in the given topology.
+     *
+     * @param mode  The topology (MESH or RELAY)
+     *
+     * @return the estimated upload of every peer, in bytes per second, by short UID
+     */
+    std::map<Uint32, Uint32> estimate(Mode mode) const;
+};
+
+#endif /* __NL_TOPOLOGY_H__ */
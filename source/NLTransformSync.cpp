@@ -0,0 +1,186 @@
+//
+//  NLTransformSync.cpp
+//  Networked Physics Demo
+//
+//  This class provides an alternative way of linking physics objects to the
+//  scene graph.  Instead of installing a listener on every obstacle (which
+//  is invoked one obstacle at a time, fetching the leftover time on every
+//  call), the obstacle/node pairs are kept in a dense table and all of the
+//  node transforms are updated in a single pass once per frame.
+//
+//  Author: Networked Physics Lab contributors
+//  Version: 10/18/26
+//
+#include "NLTransformSync.h"
+#include <box2d/b2_body.h>
+
+using namespace cugl;
+
+#pragma mark Constructors
+/**
+ * Removes all bindings from this table.
+ */
+void TransformSync::clear() {
+    _obstacles.clear();
+    _nodes.clear();
+    _lastPos.clear();
+    _lastAngle.clear();
+    _written = 0;
+}
+
+/**
+ * Reserves space for the given number of bindings.
+ *
+ * @param capacity  The expected number of bindings
+ */
+void TransformSync::reserve(size_t capacity) {
+    _obstacles.reserve(capacity);
+    _nodes.reserve(capacity);
+    _lastPos.reserve(capacity);
+    _lastAngle.reserve(capacity);
+}
+
+#pragma mark Bindings
+/**
+ * Binds the scene graph node to the obstacle.
+ *
+ * The node will follow the obstacle on every call to {@link #update}.
+ *
+ * @param obj   The physics object
+ * @param node  The scene graph node to move with it
+ */
+void TransformSync::add(const std::shared_ptr<physics2::Obstacle>& obj,
+                        const std::shared_ptr<scene2::SceneNode>& node) {
+    _obstacles.push_back(obj);
+    _nodes.push_back(node);
+    // NaN never compares equal, so the first update always writes the node
+    _lastPos.push_back(Vec2(NAN,NAN));
+    _lastAngle.push_back(NAN);
+}
+
+/**
+ * Unbinds the given obstacle, if it is bound.
+ *
+ * @param obj   The physics object
+ */
+void TransformSync::remove(const std::shared_ptr<physics2::Obstacle>& obj) {
+    for(size_t ii = 0; ii < _obstacles.size(); ii++) {
+        if (_obstacles[ii] == obj) {
+            removeAt(ii);
+            return;
+        }
+    }
+}
+
+/**
+ * Removes the binding at the given index by swapping in the last one.
+ *
+ * @param index The binding to remove
+ */
+void TransformSync::removeAt(size_t index) {
+    size_t last = _obstacles.size()-1;
+    if (index != last) {
+        _obstacles[index] = std::move(_obstacles[last]);
+        _nodes[index] = std::move(_nodes[last]);
+        _lastPos[index] = _lastPos[last];
+        _lastAngle[index] = _lastAngle[last];
+    }
+    _obstacles.pop_back();
+    _nodes.pop_back();
+    _lastPos.pop_back();
+    _lastAngle.pop_back();
+}
+
+#pragma mark Update
+/**
+ * Updates the transforms of all bound nodes.
+ *
+ * This method should be called once per frame, after the physics step.
+ * Positions are extrapolated by the given leftover time so that the
+ * animation is smooth between fixed steps.
+ *
+ * @param leftover  The time (in seconds) since the last physics step
+ * @param scale     The drawing scale of the physics world
+ */
+void TransformSync::update(float leftover, float scale) {
+    _written = 0;
+    _active.clear();
+    _px.clear(); _py.clear(); _pa.clear();
+    _vx.clear(); _vy.clear(); _va.clear();
+
+    // Gather pass: drop removed obstacles and skip sleeping ones that did not move
+    size_t ii = 0;
+    while (ii < _obstacles.size()) {
+        physics2::Obstacle* obs = _obstacles[ii].get();
+        if (obs->isRemoved()) {
+            removeAt(ii);
+            continue;
+        }
+        Vec2 pos;
+        float angle;
+        b2Body* body = obs->getBody();
+        if (_snapshots != nullptr && _snapshots->sample(obs, pos, angle)) {
+            // Interpolated poses are final, so extrapolate by zero
+            _active.push_back((Uint32)ii);
+            _px.push_back(pos.x);
+            _py.push_back(pos.y);
+            _pa.push_back(angle);
+            _vx.push_back(0);
+            _vy.push_back(0);
+            _va.push_back(0);
+        } else if (body == nullptr || body->IsAwake()) {
+            pos = obs->getPosition();
+            Vec2 vel = obs->getLinearVelocity();
+            _active.push_back((Uint32)ii);
+            _px.push_back(pos.x);
+            _py.push_back(pos.y);
+            _pa.push_back(obs->getAngle());
+            _vx.push_back(vel.x);
+            _vy.push_back(vel.y);
+            _va.push_back(obs->getAngularVelocity());
+        } else {
+            // A correction (SetTransform) can move a body without waking it
+            pos = obs->getPosition();
+            angle = obs->getAngle();
+            if (pos != _lastPos[ii] || angle != _lastAngle[ii]) {
+                _active.push_back((Uint32)ii);
+                _px.push_back(pos.x);
+                _py.push_back(pos.y);
+                _pa.push_back(angle);
+                _vx.push_back(0);
+                _vy.push_back(0);
+                _va.push_back(0);
+            }
+        }
+        ii++;
+    }
+
+    // Extrapolation pass: contiguous and branch free
+    size_t count = _active.size();
+    float* px = _px.data();
+    float* py = _py.data();
+    float* pa = _pa.data();
+    const float* vx = _vx.data();
+    const float* vy = _vy.data();
+    const float* va = _va.data();
+    for(size_t jj = 0; jj < count; jj++) {
+        px[jj] += leftover*vx[jj];
+        py[jj] += leftover*vy[jj];
+        pa[jj] += leftover*va[jj];
+    }
+
+    // Scatter pass: only touch the nodes that actually moved
+    for(size_t jj = 0; jj < count; jj++) {
+        Uint32 index = _active[jj];
+        Vec2& last = _lastPos[index];
+        if (last.x == px[jj] && last.y == py[jj] && _lastAngle[index] == pa[jj]) {
+            continue;
+        }
+        last.set(px[jj],py[jj]);
+        _lastAngle[index] = pa[jj];
+        scene2::SceneNode* node = _nodes[index].get();
+        node->setPosition(last*scale);
+        node->setAngle(pa[jj]);
+        _written++;
+    }
+}
@@ -0,0 +1,150 @@
+//
+//  NLTransformSync.h
+//  Networked Physics Demo
+//
+//  This class provides an alternative way of linking physics objects to the
+//  scene graph.  Instead of installing a listener on every obstacle (which
+//  is invoked one obstacle at a time, fetching the leftover time on every
+//  call), the obstacle/node pairs are kept in a dense table and all of the
+//  node transforms are updated in a single pass once per frame.
+//
+//  Author: Networked Physics Lab contributors
+//  Version: 10/18/26
+//
+#ifndef __NL_TRANSFORM_SYNC_H__
+#define __NL_TRANSFORM_SYNC_H__
+#include <cugl/cugl.h>
+#include <vector>
+#include "NLSnapshotBuffer.h"
+
+/**
+ * This class keeps scene graph nodes in sync with their physics obstacles.
+ *
+ * The bindings are stored as a structure of arrays. The update pass first
+ * gathers the physics state of every awake body into contiguous float arrays,
+ * then extrapolates all of them in one tight loop (which the compiler can
+ * vectorize), and finally writes back only the nodes whose transform actually
+ * changed.  Sleeping bodies are only gathered if their pose differs from
+ * the one last written, as a network correction moves a body without
+ * waking it.  Bodies that did not move are skipped.
+ *
+ * Obstacles that have been marked as removed are dropped from the table
+ * during the next update.
+ */
+class TransformSync {
+protected:
+    /** The bound obstacles (these keep the obstacles alive while bound) */
+    std::vector<std::shared_ptr<cugl::physics2::Obstacle>> _obstacles;
+    /** The scene graph nodes, parallel to _obstacles */
+    std::vector<std::shared_ptr<cugl::scene2::SceneNode>> _nodes;
+    /** The last position written to each node (in physics coordinates) */
+    std::vector<cugl::Vec2> _lastPos;
+    /** The last angle written to each node */
+    std::vector<float> _lastAngle;
+
+    // SCRATCH BUFFERS (reused every frame to avoid allocation)
+    /** Indices of the bindings gathered this frame */
+    std::vector<Uint32> _active;
+    /** Gathered x positions, later overwritten by the extrapolated values */
+    std::vector<float> _px;
+    /** Gathered y positions, later overwritten by the extrapolated values */
+    std::vector<float> _py;
+    /** Gathered angles, later overwritten by the extrapolated values */
+    std::vector<float> _pa;
+    /** Gathered x velocities */
+    std::vector<float> _vx;
+    /** Gathered y velocities */
+    std::vector<float> _vy;
+    /** Gathered angular velocities */
+    std::vector<float> _va;
+
+    /** The number of nodes written by the last update */
+    size_t _written;
+    /** The interpolated poses of remote obstacles (nullptr to use the physics pose) */
+    const SnapshotBuffer* _snapshots;
+
+    /**
+     * Removes the binding at the given index by swapping in the last one.
+     *
+     * @param index The binding to remove
+     */
+    void removeAt(size_t index);
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates an empty transform table.
+     */
+    TransformSync() : _written(0), _snapshots(nullptr) {}
+
+    /**
+     * Removes all bindings from this table.
+     */
+    void clear();
+
+    /**
+     * Reserves space for the given number of bindings.
+     *
+     * @param capacity  The expected number of bindings
+     */
+    void reserve(size_t capacity);
+
+#pragma mark Bindings
+    /**
+     * Binds the scene graph node to the obstacle.
+     *
+     * The node will follow the obstacle on every call to {@link #update}.
+     *
+     * @param obj   The physics object
+     * @param node  The scene graph node to move with it
+     */
+    void add(const std::shared_ptr<cugl::physics2::Obstacle>& obj,
+             const std::shared_ptr<cugl::scene2::SceneNode>& node);
+
+    /**
+     * Unbinds the given obstacle, if it is bound.
+     *
+     * @param obj   The physics object
+     */
+    void remove(const std::shared_ptr<cugl::physics2::Obstacle>& obj);
+
+    /**
+     * Returns the number of bindings in this table.
+     *
+     * @return the number of bindings in this table.
+     */
+    size_t size() const { return _obstacles.size(); }
+
+    /**
+     * Returns the number of nodes written by the last update.
+     *
+     * @return the number of nodes written by the last update.
+     */
+    size_t getWritten() const { return _written; }
+
+    /**
+     * Sets the snapshot buffer used to draw remote obstacles.
+     *
+     * Obstacles with buffered states are drawn at their interpolated pose
+     * instead of the extrapolated physics pose. Passing nullptr restores the
+     * default behavior.
+     *
+     * @param snapshots The snapshot buffer (or nullptr)
+     */
+    void setSnapshots(const SnapshotBuffer* snapshots) { _snapshots = snapshots; }
+
+#pragma mark Update
+    /**
+     * Updates the transforms of all bound nodes.
+     *
+     * This method should be called once per frame, after the physics step.
+     * Positions are extrapolated by the given leftover time so that the
+     * animation is smooth between fixed steps.
+     *
+     * @param leftover  The time (in seconds) since the last physics step
+     * @param scale     The drawing scale of the physics world
+     */
+    void update(float leftover, float scale);
+};
+
+#endif /* __NL_TRANSFORM_SYNC_H__ */
@@ -0,0 +1,289 @@
+//
+//  NLWorldHash.cpp
+//  Networked Physics Demo
+//
+//  This class hashes the state of every body in the world, so that peers
+//  can notice early that their simulations have diverged.  Each body is
+//  quantized (transform and velocities) and hashed on its own, and the
+//  world hash is the sum of the body hashes, so the order of the bodies
+//  does not matter.  Sleeping bodies that have not moved keep their hash
+//  from the last pass.  The hashes of the other peers are compared tick
+//  by tick, and the first mismatch is reported with the local snapshot.
+//
+//  Author: Networked Physics Lab contributors
+//  Version: 10/18/26
+//
+#include "NLWorldHash.h"
+#include "NLStats.h"
+#include <box2d/b2_body.h>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+using namespace cugl;
+
+/** The largest quantized value, so that rounding never overflows */
+#define QUANTUM_LIMIT   1073741824.0f
+
+#pragma mark Internal Helpers
+/**
+ * Returns a 64 bit value with its bits mixed (the MurmurHash3 finalizer).
+ *
+ * @param value The value to mix
+ *
+ * @return a 64 bit value with its bits mixed.
+ */
+static Uint64 mix64(Uint64 value) {
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdULL;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ULL;
+    value ^= value >> 33;
+    return value;
+}
+
+/**
+ * Returns the quantized value.
+ *
+ * @param value     The value to quantize
+ * @param inverse   The number of steps per unit
+ *
+ * @return the quantized value.
+ */
+static Sint32 quantize(float value, float inverse) {
+    float steps = value*inverse;
+    steps = std::max(-QUANTUM_LIMIT, std::min(QUANTUM_LIMIT, steps));
+    return (Sint32)std::lround(steps);
+}
+
+/**
+ * Returns the hash of a single body.
+ *
+ * @param body  The quantized body
+ *
+ * @return the hash of a single body.
+ */
+static Uint64 hashBody(const WorldHash::Body& body) {
+    Uint64 hash = mix64(body.id);
+    hash = mix64(hash ^ (((Uint64)(Uint32)body.x << 32) | (Uint32)body.y));
+    hash = mix64(hash ^ (((Uint64)(Uint32)body.angle << 32) | (Uint32)body.spin));
+    hash = mix64(hash ^ (((Uint64)(Uint32)body.vx << 32) | (Uint32)body.vy));
+    return hash;
+}
+
+#pragma mark Constructors
+/**
+ * Initializes the hasher.
+ *
+ * @param capacity  The number of snapshots kept for diagnosis
+ * @param quantum   The size of a quantization step (meters, radians, per second)
+ */
+void WorldHash::init(size_t capacity, float quantum) {
+    _capacity = capacity;
+    _quantum = quantum;
+    clear();
+}
+
+/**
+ * Discards the cache, the snapshots and any mismatch.
+ */
+void WorldHash::clear() {
+    _cache.clear();
+    _history.clear();
+    _pending.clear();
+    _diverged = false;
+    _firstMismatch = 0;
+}
+
+#pragma mark Hashing
+/**
+ * Returns the hash of the world, recording it as the given tick.
+ *
+ * Unless full is true, bodies that are asleep (or static) and have not
+ * moved reuse their hash from the last pass.
+ *
+ * @param world The obstacle world
+ * @param tick  The current tick
+ * @param full  Whether to rehash every body
+ *
+ * @return the hash of the world
+ */
+Uint64 WorldHash::compute(const std::shared_ptr<physics2::ObstacleWorld>& world, Uint64 tick, bool full) {
+    Timestamp start;
+    _pass++;
+    float inverse = 1.0f/_quantum;
+
+    Snapshot snapshot;
+    snapshot.tick = tick;
+    snapshot.hash = 0;
+    auto& ids = world->getObjToId();
+    if (_capacity > 0) {
+        snapshot.bodies.reserve(ids.size());
+    }
+    size_t rehashed = 0;
+    for(auto it = ids.begin(); it != ids.end(); ++it) {
+        physics2::Obstacle* obj = it->first.get();
+        if (obj->isRemoved()) {
+            continue;
+        }
+        Vec2 pos = obj->getPosition();
+        float angle = obj->getAngle();
+        auto entry = _cache.find(obj);
+        bool stale = full || entry == _cache.end() || entry->second.body.id != it->second ||
+                     (obj->getBodyType() != b2_staticBody && obj->isAwake()) ||
+                     entry->second.position != pos || entry->second.angle != angle;
+        if (stale) {
+            Entry& cached = _cache[obj];
+            Vec2 vel = obj->getLinearVelocity();
+            cached.body.id = it->second;
+            cached.body.x = quantize(pos.x, inverse);
+            cached.body.y = quantize(pos.y, inverse);
+            cached.body.angle = quantize(angle, inverse);
+            cached.body.vx = quantize(vel.x, inverse);
+            cached.body.vy = quantize(vel.y, inverse);
+            cached.body.spin = quantize(obj->getAngularVelocity(), inverse);
+            cached.hash = hashBody(cached.body);
+            cached.position = pos;
+            cached.angle = angle;
+            entry = _cache.find(obj);
+            rehashed++;
+        }
+        entry->second.pass = _pass;
+        // A sum does not depend on the order the world keeps its bodies in
+        snapshot.hash += entry->second.hash;
+        if (_capacity > 0) {
+            snapshot.bodies.push_back(entry->second.body);
+        }
+    }
+
+    // Forget the bodies that left the world
+    for(auto it = _cache.begin(); it != _cache.end(); ) {
+        if (it->second.pass != _pass) {
+            it = _cache.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    Uint64 result = snapshot.hash;
+    if (_capacity > 0) {
+        _history.push_back(std::move(snapshot));
+        while (_history.size() > _capacity) {
+            _history.pop_front();
+        }
+    }
+
+    // Peers ahead of us sent their hash already
+    auto pending = _pending.find(tick);
+    if (pending != _pending.end()) {
+        for(auto& remote : pending->second) {
+            compare(tick, remote.first, result, remote.second);
+        }
+    }
+    size_t unmatched = 0;
+    for(auto it = _pending.begin(); it != _pending.end() && it->first <= tick; ) {
+        if (it->first < tick) {
+            unmatched += it->second.size();
+        }
+        it = _pending.erase(it);
+    }
+
+    if (_stats) {
+        Timestamp end;
+        _stats->sample(full ? "hash.full_us" : "hash.compute_us", (float)end.ellapsedMicros(start));
+        _stats->count("hash.rehashed", rehashed);
+        if (unmatched > 0) {
+            _stats->count("hash.unmatched", unmatched);
+        }
+    }
+    return result;
+}
+
+/**
+ * Compares the hash of another peer, now or once we hash that tick.
+ *
+ * @param peer  The other peer
+ * @param tick  The tick hashed
+ * @param hash  The hash of the other peer
+ */
+void WorldHash::receive(Uint32 peer, Uint64 tick, Uint64 hash) {
+    for(auto it = _history.rbegin(); it != _history.rend(); ++it) {
+        if (it->tick == tick) {
+            compare(tick, peer, it->hash, hash);
+            return;
+        }
+    }
+    if (_history.empty() || tick > _history.back().tick) {
+        _pending[tick].push_back(std::make_pair(peer, hash));
+    } else if (_stats) {
+        _stats->count("hash.unmatched");
+    }
+}
+
+/**
+ * Compares the hash of another peer with ours.
+ *
+ * @param tick      The tick hashed
+ * @param peer      The other peer
+ * @param local     Our hash
+ * @param remote    The hash of the other peer
+ */
+void WorldHash::compare(Uint64 tick, Uint32 peer, Uint64 local, Uint64 remote) {
+    if (local == remote) {
+        if (_stats) {
+            _stats->count("hash.matched");
+        }
+        return;
+    }
+    if (_stats) {
+        _stats->count("hash.mismatched");
+    }
+    if (_diverged) {
+        return;
+    }
+    _diverged = true;
+    _firstMismatch = tick;
+    if (_handler) {
+        _handler(tick, peer, local, remote);
+    }
+}
+
+#pragma mark Diagnosis
+/**
+ * Writes the snapshot of the given tick to a file.
+ *
+ * The file uses the log format read by data.py: a "timestep" line,
+ * then one line per body with its position, angle, velocities and id.
+ *
+ * @param tick  The tick hashed
+ * @param path  The file to write
+ *
+ * @return true if the snapshot was kept and written
+ */
+bool WorldHash::dump(Uint64 tick, const std::string& path) const {
+    const Snapshot* snapshot = nullptr;
+    for(auto it = _history.begin(); it != _history.end(); ++it) {
+        if (it->tick == tick) {
+            snapshot = &(*it);
+        }
+    }
+    if (snapshot == nullptr) {
+        return false;
+    }
+
+    // Sorted by id, so that the dumps of two peers line up
+    std::vector<Body> bodies = snapshot->bodies;
+    std::sort(bodies.begin(), bodies.end(), [](const Body& a, const Body& b) { return a.id < b.id; });
+
+    std::ofstream out(path);
+    if (!out) {
+        return false;
+    }
+    out << "timestep " << tick << "\n";
+    for(auto it = bodies.begin(); it != bodies.end(); ++it) {
+        out << it->x*_quantum << "," << it->y*_quantum << "," << it->angle*_quantum << ","
+            << it->vx*_quantum << "," << it->vy*_quantum << "," << it->spin*_quantum << ","
+            << it->id << "\n";
+    }
+    return (bool)out;
+}
@@ -0,0 +1,202 @@
+//
+//  NLWorldHash.h
+//  Networked Physics Demo
+//
+//  This class hashes the state of every body in the world, so that peers
+//  can notice early that their simulations have diverged.  Each body is
+//  quantized (transform and velocities) and hashed on its own, and the
+//  world hash is the sum of the body hashes, so the order of the bodies
+//  does not matter.  Sleeping bodies that have not moved keep their hash
+//  from the last pass.  The hashes of the other peers are compared tick
+//  by tick, and the first mismatch is reported with the local snapshot.
+//
+//  Author: Networked Physics Lab contributors
+//  Version: 10/18/26
+//
+#ifndef __NL_WORLD_HASH_H__
+#define __NL_WORLD_HASH_H__
+#include <cugl/cugl.h>
+#include <deque>
+#include <functional>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class NetLabStats;
+
+/**
+ * This class computes world hashes and compares them with other peers.
+ *
+ * The last few hashed ticks are kept as snapshots of quantized bodies,
+ * so that a mismatch can be dumped for diagnosis. Hashes from peers that
+ * are ahead wait until this peer hashes the same tick.
+ */
+class WorldHash {
+public:
+    /** The quantized state of a single body */
+    struct Body {
+        /** The obstacle id */
+        Uint64 id;
+        /** The quantized position */
+        Sint32 x, y;
+        /** The quantized angle */
+        Sint32 angle;
+        /** The quantized linear velocity */
+        Sint32 vx, vy;
+        /** The quantized angular velocity */
+        Sint32 spin;
+    };
+
+    /**
+     * The handler of a mismatch.
+     *
+     * The handler takes the tick, the peer that disagrees, and both hashes.
+     * It is only called for the first mismatch.
+     */
+    typedef std::function<void(Uint64 tick, Uint32 peer, Uint64 local, Uint64 remote)> MismatchHandler;
+
+protected:
+    /** The cached hash of a single body */
+    struct Entry {
+        /** The quantized state of the body */
+        Body body;
+        /** The hash of the body */
+        Uint64 hash;
+        /** The position when hashed, to notice moved sleeping bodies */
+        cugl::Vec2 position;
+        /** The angle when hashed, to notice moved sleeping bodies */
+        float angle;
+        /** The pass that last saw the body */
+        Uint64 pass;
+    };
+
+    /** The hash and bodies of a hashed tick */
+    struct Snapshot {
+        /** The tick hashed */
+        Uint64 tick;
+        /** The world hash */
+        Uint64 hash;
+        /** The quantized bodies, ordered by id */
+        std::vector<Body> bodies;
+    };
+
+    /** The cached body hashes */
+    std::unordered_map<cugl::physics2::Obstacle*, Entry> _cache;
+    /** The most recent snapshots, oldest first */
+    std::deque<Snapshot> _history;
+    /** The hashes of other peers for ticks not hashed yet, by tick */
+    std::map<Uint64, std::vector<std::pair<Uint32, Uint64>>> _pending;
+    /** The maximum number of snapshots kept */
+    size_t _capacity;
+    /** The size of a quantization step */
+    float _quantum;
+    /** The number of hashing passes so far */
+    Uint64 _pass;
+    /** Whether a mismatch was found */
+    bool _diverged;
+    /** The tick of the first mismatch */
+    Uint64 _firstMismatch;
+    /** The handler of the first mismatch (may be empty) */
+    MismatchHandler _handler;
+    /** The statistics log for hash times and results (may be null) */
+    NetLabStats* _stats;
+
+    /**
+     * Compares the hash of another peer with ours.
+     *
+     * @param tick      The tick hashed
+     * @param peer      The other peer
+     * @param local     Our hash
+     * @param remote    The hash of the other peer
+     */
+    void compare(Uint64 tick, Uint32 peer, Uint64 local, Uint64 remote);
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates a hasher with no history.
+     */
+    WorldHash() : _capacity(0), _quantum(1), _pass(0), _diverged(false), _firstMismatch(0), _stats(nullptr) {}
+
+    /**
+     * Initializes the hasher.
+     *
+     * @param capacity  The number of snapshots kept for diagnosis
+     * @param quantum   The size of a quantization step (meters, radians, per second)
+     */
+    void init(size_t capacity, float quantum);
+
+    /**
+     * Discards the cache, the snapshots and any mismatch.
+     */
+    void clear();
+
+    /**
+     * Sets the handler of the first mismatch.
+     *
+     * @param handler   The handler of the first mismatch
+     */
+    void setMismatchHandler(MismatchHandler handler) { _handler = handler; }
+
+    /**
+     * Sets the statistics log for hash times and results.
+     *
+     * @param stats The statistics log (or nullptr)
+     */
+    void setStats(NetLabStats* stats) { _stats = stats; }
+
+#pragma mark Hashing
+    /**
+     * Returns the hash of the world, recording it as the given tick.
+     *
+     * Unless full is true, bodies that are asleep (or static) and have not
+     * moved reuse their hash from the last pass.
+     *
+     * @param world The obstacle world
+     * @param tick  The current tick
+     * @param full  Whether to rehash every body
+     *
+     * @return the hash of the world
+     */
+    Uint64 compute(const std::shared_ptr<cugl::physics2::ObstacleWorld>& world, Uint64 tick, bool full = false);
+
+    /**
+     * Compares the hash of another peer, now or once we hash that tick.
+     *
+     * @param peer  The other peer
+     * @param tick  The tick hashed
+     * @param hash  The hash of the other peer
+     */
+    void receive(Uint32 peer, Uint64 tick, Uint64 hash);
+
+    /**
+     * Returns true if a mismatch was found.
+     *
+     * @return true if a mismatch was found.
+     */
+    bool isDiverged() const { return _diverged; }
+
+    /**
+     * Returns the tick of the first mismatch.
+     *
+     * @return the tick of the first mismatch.
+     */
+    Uint64 getFirstMismatch() const { return _firstMismatch; }
+
+#pragma mark Diagnosis
+    /**
+     * Writes the snapshot of the given tick to a file.
+     *
+     * The file uses the log format read by data.py: a "timestep" line,
+     * then one line per body with its position, angle, velocities and id.
+     *
+     * @param tick  The tick hashed
+     * @param path  The file to write
+     *
+     * @return true if the snapshot was kept and written
+     */
+    bool dump(Uint64 tick, const std::string& path) const;
+};
+
+#endif /* __NL_WORLD_HASH_H__ */
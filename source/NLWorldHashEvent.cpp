@@ -0,0 +1,59 @@
+//
+//  NLWorldHashEvent.cpp
+//  Networked Physics Lab
+//
+//  This class carries the world hash of a peer at a given tick.  Peers
+//  that simulate the same inputs should have the same hash at the same
+//  tick, so a mismatch means that their worlds have diverged.
+//
+//  Created by the Networked Physics Lab contributors on 10/18/26.
+//
+
+#include "NLWorldHashEvent.h"
+
+/**
+ * This method is used by the NetEventController to create a new event of using a
+ * reference of the same type.
+ *
+ * Not that this method is not static, it differs from the static alloc() method
+ * and all methods must implement this method.
+ */
+std::shared_ptr<NetEvent> WorldHashEvent::newEvent(){
+    return std::make_shared<WorldHashEvent>();
+}
+
+std::shared_ptr<NetEvent> WorldHashEvent::allocWorldHashEvent(Uint32 peer, Uint64 tick, Uint64 hash){
+    auto event = std::make_shared<WorldHashEvent>();
+    event->_peer = peer;
+    event->_tick = tick;
+    event->_hash = hash;
+    return event;
+}
+
+/**
+ * Serialize any paramater that the event contains to a vector of bytes.
+ */
+std::vector<std::byte> WorldHashEvent::serialize(){
+    _serializer.reset();
+    _serializer.writeUint32(_peer);
+    _serializer.writeUint64(_tick);
+    _serializer.writeUint64(_hash);
+    return _serializer.serialize();
+}
+
+/**
+ * Deserialize a vector of bytes and set the corresponding parameters.
+ *
+ * @param data  a byte vector packed by serialize()
+ *
+ * This function should be the "reverse" of the serialize() function: it
+ * should be able to recreate a serialized event entirely, setting all the
+ * useful parameters of this class.
+ */
+void WorldHashEvent::deserialize(const std::vector<std::byte>& data){
+    _deserializer.reset();
+    _deserializer.receive(data);
+    _peer = _deserializer.readUint32();
+    _tick = _deserializer.readUint64();
+    _hash = _deserializer.readUint64();
+}
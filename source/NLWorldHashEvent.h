@@ -0,0 +1,70 @@
+//
+//  NLWorldHashEvent.h
+//  Networked Physics Lab
+//
+//  This class carries the world hash of a peer at a given tick.  Peers
+//  that simulate the same inputs should have the same hash at the same
+//  tick, so a mismatch means that their worlds have diverged.
+//
+//  Created by the Networked Physics Lab contributors on 10/18/26.
+//
+
+#ifndef NLWorldHashEvent_h
+#define NLWorldHashEvent_h
+
+#include <cugl/cugl.h>
+using namespace cugl::netphysics;
+using namespace cugl;
+
+class WorldHashEvent : public NetEvent {
+    
+protected:
+    LWSerializer _serializer;
+    LWDeserializer _deserializer;
+    
+    /** The short UID of the peer that hashed its world */
+    Uint32 _peer;
+    /** The tick hashed */
+    Uint64 _tick;
+    /** The world hash */
+    Uint64 _hash;
+    
+public:
+    /**
+     * This method is used by the NetEventController to create a new event of using a
+     * reference of the same type.
+     *
+     * Not that this method is not static, it differs from the static alloc() method
+     * and all methods must implement this method.
+     */
+    std::shared_ptr<NetEvent> newEvent() override;
+    
+    static std::shared_ptr<NetEvent> allocWorldHashEvent(Uint32 peer, Uint64 tick, Uint64 hash);
+    
+    /**
+     * Serialize any paramater that the event contains to a vector of bytes.
+     */
+    std::vector<std::byte> serialize() override;
+    /**
+     * Deserialize a vector of bytes and set the corresponding parameters.
+     *
+     * @param data  a byte vector packed by serialize()
+     *
+     * This function should be the "reverse" of the serialize() function: it
+     * should be able to recreate a serialized event entirely, setting all the
+     * useful parameters of this class.
+     */
+    void deserialize(const std::vector<std::byte>& data) override;
+    
+    /** Gets the short UID of the peer that hashed its world. */
+    Uint32 getPeer() const { return _peer; }
+    
+    /** Gets the tick hashed. */
+    Uint64 getTick() const { return _tick; }
+    
+    /** Gets the world hash. */
+    Uint64 getHash() const { return _hash; }
+};
+
+
+#endif /* NLWorldHashEvent_h */
@@ -0,0 +1,110 @@
+//
+//  RDRandom.cpp
+//  General Purpose Random Generator
+//
+//  This class is a small deterministic random generator (PCG32, XSH-RR
+//  variant).  Its whole state is two 64 bit words, so it is cheap to copy
+//  into a snapshot or send to another peer, unlike the 2.5 to 5 KB state of a
+//  std::mt19937.  Every seed has 2^63 independent streams, so that each
+//  peer or factory can draw from its own sequence without disturbing the
+//  others.  The generator can also jump ahead any number of draws in
+//  logarithmic time.
+//
+//  The helpers for bounded integers and floats are part of the class on
+//  purpose.  The standard distributions are implemented differently by
+//  each C++ library, so they do not give the same values on every peer.
+//
+//  Author: Networked Physics Lab contributors (from a stub by Barry Lyu)
+//  Version: 10/18/26
+//
+#include "RDRandom.h"
+
+using namespace cugl;
+
+#pragma mark Constructors
+/**
+ * Reseeds this generator with the given seed and stream.
+ *
+ * Generators with the same seed but different streams produce unrelated
+ * sequences.
+ *
+ * @param value     The seed
+ * @param stream    The stream (only the lower 63 bits are used)
+ */
+void Random::seed(Uint64 value, Uint64 stream) {
+    _state = 0;
+    _inc = (stream << 1) | 1;
+    (*this)();
+    _state += value;
+    (*this)();
+}
+
+#pragma mark Generation
+/**
+ * Returns a uniform integer in [0, bound).
+ *
+ * This rejects the draws that would bias the result, so it may consume
+ * more than one draw (rarely, for small bounds).
+ *
+ * @param bound The exclusive upper bound (must be positive)
+ *
+ * @return a uniform integer in [0, bound).
+ */
+Uint32 Random::below(Uint32 bound) {
+    // The draws below this are the remainder of 2^32 mod bound
+    Uint32 threshold = (0u-bound) % bound;
+    for(;;) {
+        Uint32 value = (*this)();
+        if (value >= threshold) {
+            return value % bound;
+        }
+    }
+}
+
+/**
+ * Advances this generator as if it had made the given number of draws.
+ *
+ * This takes time logarithmic in the number of draws.
+ *
+ * @param draws The number of draws to skip
+ */
+void Random::advance(Uint64 draws) {
+    // Compose the step x -> mult*x+plus with itself by repeated squaring
+    Uint64 mult = MULTIPLIER;
+    Uint64 plus = _inc;
+    Uint64 accMult = 1;
+    Uint64 accPlus = 0;
+    while (draws > 0) {
+        if (draws & 1) {
+            accMult *= mult;
+            accPlus = accPlus*mult+plus;
+        }
+        plus = (mult+1)*plus;
+        mult *= mult;
+        draws >>= 1;
+    }
+    _state = accMult*_state+accPlus;
+}
+
+#pragma mark Serialization
+/**
+ * Writes the state of this generator to the serializer (16 bytes).
+ *
+ * @param out   The serializer to write to
+ */
+void Random::serialize(net::LWSerializer& out) const {
+    out.writeUint64(_state);
+    out.writeUint64(_inc);
+}
+
+/**
+ * Restores the state of this generator from the deserializer.
+ *
+ * @param in    The deserializer to read from
+ */
+void Random::deserialize(net::LWDeserializer& in) {
+    Uint64 state = in.readUint64();
+    Uint64 inc = in.readUint64();
+    _state = state;
+    _inc = inc | 1;
+}
@@ -1,26 +1,180 @@
 //
 //  RDRandom.h
-//  Rocket
+//  General Purpose Random Generator
 //
-//  Created by Barry Lyu on 6/25/23.
+//  This class is a small deterministic random generator (PCG32, XSH-RR
+//  variant).  Its whole state is two 64 bit words, so it is cheap to copy
+//  into a snapshot or send to another peer, unlike the 2.5 to 5 KB state of a
+//  std::mt19937.  Every seed has 2^63 independent streams, so that each
+//  peer or factory can draw from its own sequence without disturbing the
+//  others.  The generator can also jump ahead any number of draws in
+//  logarithmic time.
 //
+//  The helpers for bounded integers and floats are part of the class on
+//  purpose.  The standard distributions are implemented differently by
+//  each C++ library, so they do not give the same values on every peer.
+//
+//  Author: Networked Physics Lab contributors (from a stub by Barry Lyu)
+//  Version: 10/18/26
+//
+#ifndef __RD_RANDOM_H__
+#define __RD_RANDOM_H__
+#include <cugl/cugl.h>
 
-#ifndef RDRandom_h
-#define RDRandom_h
-
-#include <random>
-#include <format>
-
+/**
+ * This class is a deterministic random generator with independent streams.
+ *
+ * This class satisfies the UniformRandomBitGenerator requirements, so it
+ * can be passed to standard algorithms. However, draws that must agree
+ * between peers should use the methods below instead of std distributions.
+ */
 class Random {
-    
+public:
+    /** The type of a single draw */
+    typedef Uint32 result_type;
+
 protected:
-    std::mt19937 random_32;
-    
-    void seed(Uint32){
-        random_32 = (
+    /** The multiplier of the linear congruential generator */
+    static const Uint64 MULTIPLIER = 6364136223846793005ULL;
+
+    /** The state of the underlying linear congruential generator */
+    Uint64 _state;
+    /** The increment of the generator, which selects the stream (always odd) */
+    Uint64 _inc;
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates a generator with seed 0 on stream 0.
+     */
+    Random() { seed(0); }
+
+    /**
+     * Creates a generator with the given seed and stream.
+     *
+     * @param value     The seed
+     * @param stream    The stream (only the lower 63 bits are used)
+     */
+    Random(Uint64 value, Uint64 stream = 0) { seed(value, stream); }
+
+    /**
+     * Reseeds this generator with the given seed and stream.
+     *
+     * Generators with the same seed but different streams produce unrelated
+     * sequences.
+     *
+     * @param value     The seed
+     * @param stream    The stream (only the lower 63 bits are used)
+     */
+    void seed(Uint64 value, Uint64 stream = 0);
+
+#pragma mark Generation
+    /**
+     * Returns the smallest possible draw.
+     *
+     * @return the smallest possible draw.
+     */
+    static constexpr result_type min() { return 0; }
+
+    /**
+     * Returns the largest possible draw.
+     *
+     * @return the largest possible draw.
+     */
+    static constexpr result_type max() { return 0xffffffff; }
+
+    /**
+     * Returns the next 32 bit draw.
+     *
+     * @return the next 32 bit draw.
+     */
+    Uint32 operator()() {
+        Uint64 old = _state;
+        _state = old*MULTIPLIER+_inc;
+        Uint32 shifted = (Uint32)(((old >> 18) ^ old) >> 27);
+        Uint32 rotate = (Uint32)(old >> 59);
+        return (shifted >> rotate) | (shifted << ((-rotate) & 31));
+    }
+
+    /**
+     * Returns a uniform integer in [0, bound).
+     *
+     * This rejects the draws that would bias the result, so it may consume
+     * more than one draw (rarely, for small bounds).
+     *
+     * @param bound The exclusive upper bound (must be positive)
+     *
+     * @return a uniform integer in [0, bound).
+     */
+    Uint32 below(Uint32 bound);
+
+    /**
+     * Returns a uniform float in [0, 1).
+     *
+     * @return a uniform float in [0, 1).
+     */
+    float nextFloat() {
+        // The top 24 bits fill the mantissa exactly
+        return (float)((*this)() >> 8)*(1.0f/16777216.0f);
+    }
+
+    /**
+     * Returns a uniform float in [low, high).
+     *
+     * @param low   The inclusive lower bound
+     * @param high  The exclusive upper bound
+     *
+     * @return a uniform float in [low, high).
+     */
+    float range(float low, float high) {
+        return low+(high-low)*nextFloat();
     }
 
-}
+    /**
+     * Advances this generator as if it had made the given number of draws.
+     *
+     * This takes time logarithmic in the number of draws.
+     *
+     * @param draws The number of draws to skip
+     */
+    void advance(Uint64 draws);
 
+#pragma mark Serialization
+    /**
+     * Writes the state of this generator to the serializer (16 bytes).
+     *
+     * @param out   The serializer to write to
+     */
+    void serialize(cugl::net::LWSerializer& out) const;
+
+    /**
+     * Restores the state of this generator from the deserializer.
+     *
+     * @param in    The deserializer to read from
+     */
+    void deserialize(cugl::net::LWDeserializer& in);
+
+    /**
+     * Returns true if both generators will produce the same sequence.
+     *
+     * @param other The generator to compare
+     *
+     * @return true if both generators will produce the same sequence.
+     */
+    bool operator==(const Random& other) const {
+        return _state == other._state && _inc == other._inc;
+    }
+
+    /**
+     * Returns true if the generators will produce different sequences.
+     *
+     * @param other The generator to compare
+     *
+     * @return true if the generators will produce different sequences.
+     */
+    bool operator!=(const Random& other) const {
+        return !(*this == other);
+    }
+};
 
-#endif /* RDRandom_h */
+#endif /* __RD_RANDOM_H__ */
@@ -0,0 +1,71 @@
+//
+//  NLAuthorityTest.cpp
+//  Networked Physics Demo
+//
+//  Tests for the lease arbiter on the host.  An obstacle must never be
+//  granted to two peers at once, the lowest peer must win a tie, and a
+//  lease must be free again once it runs out.
+//
+//  Author: Networked Physics Lab contributors
+//  Version: 10/18/26
+//
+#include "NLTest.h"
+#include "NLAuthority.h"
+
+/** The lease length used by every test */
+#define TEST_LEASE  10
+
+NL_TEST(Authority, LowestPeerWinsTie) {
+    AuthorityArbiter arbiter;
+    arbiter.init(TEST_LEASE);
+    arbiter.request(3, {7});
+    arbiter.request(2, {7});
+    auto verdicts = arbiter.resolve(0);
+    NL_CHECK_EQ(verdicts.size(), (size_t)2);
+    NL_CHECK_EQ(verdicts[0].peer, 2u);
+    NL_CHECK_EQ(verdicts[0].granted.size(), (size_t)1);
+    NL_CHECK_EQ(verdicts[1].peer, 3u);
+    NL_CHECK_EQ(verdicts[1].granted.size(), (size_t)0);
+    NL_CHECK_EQ(verdicts[1].denied.size(), (size_t)1);
+}
+
+NL_TEST(Authority, HolderKeepsLease) {
+    AuthorityArbiter arbiter;
+    arbiter.init(TEST_LEASE);
+    arbiter.request(3, {7});
+    arbiter.resolve(0);
+
+    // A lower peer may not take a leased obstacle, but the holder may renew
+    arbiter.request(1, {7});
+    arbiter.request(3, {7});
+    auto verdicts = arbiter.resolve(5);
+    NL_CHECK_EQ(verdicts[0].peer, 1u);
+    NL_CHECK_EQ(verdicts[0].denied.size(), (size_t)1);
+    NL_CHECK_EQ(verdicts[1].peer, 3u);
+    NL_CHECK_EQ(verdicts[1].granted.size(), (size_t)1);
+    NL_CHECK_EQ(arbiter.size(), (size_t)1);
+}
+
+NL_TEST(Authority, ExpiredLeaseIsFree) {
+    AuthorityArbiter arbiter;
+    arbiter.init(TEST_LEASE);
+    arbiter.request(1, {7, 8});
+    arbiter.resolve(0);
+    NL_CHECK_EQ(arbiter.size(), (size_t)2);
+
+    arbiter.request(2, {7});
+    auto verdicts = arbiter.resolve(TEST_LEASE);
+    NL_CHECK_EQ(verdicts.size(), (size_t)1);
+    NL_CHECK_EQ(verdicts[0].granted.size(), (size_t)1);
+    NL_CHECK_EQ(arbiter.size(), (size_t)1);
+}
+
+NL_TEST(Authority, DuplicateRequestsGrantOnce) {
+    AuthorityArbiter arbiter;
+    arbiter.init(TEST_LEASE);
+    arbiter.request(2, {7});
+    arbiter.request(2, {7});
+    auto verdicts = arbiter.resolve(0);
+    NL_CHECK_EQ(verdicts.size(), (size_t)1);
+    NL_CHECK_EQ(verdicts[0].granted.size(), (size_t)1);
+}
@@ -0,0 +1,241 @@
+//
+//  NLChannel.cpp
+//  Networked Physics Demo
+//
+//  These classes are a model of a datagram protocol, not part of the game's
+//  transport.  They are only built into the tests, which run them over a
+//  simulated lossy link to show what splitting delivery classes would buy.
+//
+//  The model has two classes of delivery.  Events (like crate spawns and
+//  ownership changes) must all arrive, in order, so they go on a reliable
+//  channel that retransmits until acknowledged.  Obstacle state only
+//  matters until a newer state exists, so it goes on a channel that is
+//  never retransmitted and drops anything older than what it has already
+//  delivered.  Sending both on one reliable stream makes fresh state wait
+//  behind the retransmission of stale state.
+//
+//  The game does not send through these channels.  Its events go through
+//  the network controller, which is already reliable and ordered, and
+//  which only broadcasts.  A second reliability layer on top of it would
+//  never see a loss, and a channel per peer would multiply every event by
+//  the size of the room.  The state updates are sent by the physics
+//  controller itself.  The only unreliable class the game has is its
+//  optional events, which are dropped when over budget.
+//
+//  Author: Networked Physics Lab contributors
+//  Version: 10/18/26
+//
+#include "NLChannel.h"
+#include <algorithm>
+
+using namespace cugl;
+
+#pragma mark -
+#pragma mark Reliable Channel
+/**
+ * Initializes an empty channel.
+ *
+ * @param timeout       The time before an unacknowledged message is resent
+ * @param redundancy    The number of recent small messages repeated in every frame
+ * @param small         The largest payload that is repeated
+ */
+void ReliableChannel::init(Uint64 timeout, Uint32 redundancy, size_t small) {
+    _timeout = timeout;
+    _redundancy = redundancy;
+    _small = small;
+    clear();
+}
+
+/**
+ * Forgets all messages, sent and received.
+ */
+void ReliableChannel::clear() {
+    _nextSeq = 1;
+    _unacked.clear();
+    _resent = 0;
+    _repeated = 0;
+    _expected = 1;
+    _early.clear();
+}
+
+/**
+ * Queues a message for the next frame, returning its sequence number.
+ *
+ * @param key       The stream of the message
+ * @param payload   The message contents
+ * @param now       The current time
+ *
+ * @return the sequence number of the message
+ */
+Uint32 ReliableChannel::send(Uint32 key, const std::vector<std::byte>& payload, Uint64 now) {
+    Pending pending;
+    pending.message.seq = _nextSeq++;
+    pending.message.key = key;
+    pending.message.sent = now;
+    pending.message.payload = payload;
+    pending.sent = false;
+    pending.lastSent = 0;
+    pending.nextSend = now;
+    pending.missing = false;
+    _unacked[pending.message.seq] = pending;
+    return pending.message.seq;
+}
+
+/**
+ * Returns the frame to send now.
+ *
+ * The frame has the messages never sent, those missing or past their
+ * timeout, and copies of the most recent small unacknowledged messages.
+ * It also acknowledges everything this end has received.
+ *
+ * @param now   The current time
+ *
+ * @return the frame to send now
+ */
+ChannelFrame ReliableChannel::frame(Uint64 now) {
+    ChannelFrame result;
+    result.ack = getAck();
+    result.ackBits = getAckBits();
+    for(auto it = _unacked.begin(); it != _unacked.end(); ++it) {
+        Pending& pending = it->second;
+        if (!pending.sent || pending.missing || pending.nextSend <= now) {
+            if (pending.sent) {
+                _resent++;
+            }
+            pending.sent = true;
+            pending.lastSent = now;
+            pending.nextSend = now+_timeout;
+            pending.missing = false;
+            result.messages.push_back(pending.message);
+        }
+    }
+    
+    // Repeat the newest small messages that did not go out above
+    Uint32 repeats = 0;
+    for(auto it = _unacked.rbegin(); it != _unacked.rend() && repeats < _redundancy; ++it) {
+        Pending& pending = it->second;
+        if (pending.sent && pending.lastSent != now && pending.message.payload.size() <= _small) {
+            pending.lastSent = now;
+            result.messages.push_back(pending.message);
+            repeats++;
+        }
+    }
+    _repeated += repeats;
+    return result;
+}
+
+/**
+ * Drops every message acknowledged by the receiver.
+ *
+ * Any message sent before the latest one acknowledged is marked missing,
+ * and resent in the next frame.
+ *
+ * @param ack       The cumulative acknowledgement of the receiver
+ * @param ackBits   Bit i is set if message ack+1+i was received
+ */
+void ReliableChannel::acknowledge(Uint32 ack, Uint32 ackBits) {
+    Uint64 latest = 0;
+    for(auto it = _unacked.begin(); it != _unacked.end(); ) {
+        Uint32 offset = it->first-ack-1;
+        bool acked = it->first <= ack || (offset < 32 && (ackBits & (1u << offset)));
+        if (acked) {
+            latest = std::max(latest, it->second.lastSent);
+            it = _unacked.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    
+    // A message sent before one that arrived was most likely lost
+    for(auto it = _unacked.begin(); it != _unacked.end(); ++it) {
+        if (it->second.sent && it->second.lastSent < latest) {
+            it->second.missing = true;
+        }
+    }
+}
+
+/**
+ * Receives a frame, returning the messages now ready in order.
+ *
+ * The acknowledgement of the frame is applied first. Duplicates and
+ * messages already delivered are ignored.
+ *
+ * @param frame The received frame
+ *
+ * @return the messages ready for delivery, in order
+ */
+std::vector<ChannelMessage> ReliableChannel::receive(const ChannelFrame& frame) {
+    acknowledge(frame.ack, frame.ackBits);
+    std::vector<ChannelMessage> result;
+    for(auto& message : frame.messages) {
+        if (message.seq >= _expected) {
+            _early.emplace(message.seq, message);
+        }
+    }
+    for(auto it = _early.begin(); it != _early.end() && it->first == _expected; it = _early.erase(it)) {
+        result.push_back(it->second);
+        _expected++;
+    }
+    return result;
+}
+
+/**
+ * Returns the selective acknowledgement for the sender.
+ *
+ * @return bit i is set if message getAck()+1+i was received
+ */
+Uint32 ReliableChannel::getAckBits() const {
+    Uint32 bits = 0;
+    for(auto it = _early.begin(); it != _early.end() && it->first-_expected < 32; ++it) {
+        bits |= 1u << (it->first-_expected);
+    }
+    return bits;
+}
+
+#pragma mark -
+#pragma mark Latest Channel
+/**
+ * Forgets all messages, sent and received.
+ */
+void LatestChannel::clear() {
+    _nextSeq = 1;
+    _latest.clear();
+    _stale = 0;
+}
+
+/**
+ * Stamps a message with its sequence number.
+ *
+ * @param key       The stream of the message
+ * @param payload   The message contents
+ * @param now       The current time
+ *
+ * @return the message to send now
+ */
+ChannelMessage LatestChannel::send(Uint32 key, const std::vector<std::byte>& payload, Uint64 now) {
+    ChannelMessage message;
+    message.seq = _nextSeq++;
+    message.key = key;
+    message.sent = now;
+    message.payload = payload;
+    return message;
+}
+
+/**
+ * Returns true if the message is newer than anything in its stream.
+ *
+ * Stale messages are counted and should be dropped.
+ *
+ * @param message   The received message
+ *
+ * @return true if the message is newer than anything in its stream.
+ */
+bool LatestChannel::receive(const ChannelMessage& message) {
+    Uint32& latest = _latest[message.key];
+    if (message.seq <= latest) {
+        _stale++;
+        return false;
+    }
+    latest = message.seq;
+    return true;
+}
@@ -0,0 +1,279 @@
+//
+//  NLChannel.h
+//  Networked Physics Demo
+//
+//  These classes are a model of a datagram protocol, not part of the game's
+//  transport.  They are only built into the tests, which run them over a
+//  simulated lossy link to show what splitting delivery classes would buy.
+//
+//  The model has two classes of delivery.  Events (like crate spawns and
+//  ownership changes) must all arrive, in order, so they go on a reliable
+//  channel that retransmits until acknowledged.  Obstacle state only
+//  matters until a newer state exists, so it goes on a channel that is
+//  never retransmitted and drops anything older than what it has already
+//  delivered.  Sending both on one reliable stream makes fresh state wait
+//  behind the retransmission of stale state.
+//
+//  The game does not send through these channels.  Its events go through
+//  the network controller, which is already reliable and ordered, and
+//  which only broadcasts.  A second reliability layer on top of it would
+//  never see a loss, and a channel per peer would multiply every event by
+//  the size of the room.  The state updates are sent by the physics
+//  controller itself.  The only unreliable class the game has is its
+//  optional events, which are dropped when over budget.
+//
+//  The reliable channel models selective acks.  It sends one frame per
+//  tick, which carries the acknowledgement of what it received (with a
+//  bitfield of the 32 messages after the cumulative ack).  A message is
+//  resent as soon as a later message is acknowledged, without waiting for
+//  a timeout.  The last few small unacknowledged messages may also be
+//  repeated in every frame, so that a single loss costs no round trip at
+//  all.  The network controller does not expose its framing, so none of
+//  this runs beneath the game's events; the latencies the tests report
+//  are those of the model on the simulated link.
+//
+//  Author: Networked Physics Lab contributors
+//  Version: 10/18/26
+//
+#ifndef __NL_CHANNEL_H__
+#define __NL_CHANNEL_H__
+#include <cugl/cugl.h>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+/** A message on a channel */
+struct ChannelMessage {
+    /** The sequence number of the message in its channel */
+    Uint32 seq;
+    /** The stream of the message (e.g. the obstacle of a state update) */
+    Uint32 key;
+    /** The time the message was first sent, in microseconds */
+    Uint64 sent;
+    /** The message contents */
+    std::vector<std::byte> payload;
+};
+
+/** A frame of the reliable channel, sent once per tick */
+struct ChannelFrame {
+    /** The last message received with no gaps before it */
+    Uint32 ack;
+    /** Bit i is set if message ack+1+i was received */
+    Uint32 ackBits;
+    /** The messages (new, resent or repeated) */
+    std::vector<ChannelMessage> messages;
+};
+
+/**
+ * This class is one end of a reliable, ordered channel.
+ *
+ * Each end both sends and receives. Messages are queued with {@link #send}
+ * and go out in the next {@link #frame}, which also acknowledges what this
+ * end received. The sender keeps every message until it is acknowledged.
+ * A message is resent when a message sent after it is acknowledged (it was
+ * most likely lost), or when the retransmission timeout passes. The
+ * receiver holds messages that arrive early, and only delivers them in order.
+ */
+class ReliableChannel {
+protected:
+    /** A sent message waiting for an ack */
+    struct Pending {
+        /** The message */
+        ChannelMessage message;
+        /** Whether the message was sent at least once */
+        bool sent;
+        /** The last time the message was sent */
+        Uint64 lastSent;
+        /** The time the message is resent if still unacknowledged */
+        Uint64 nextSend;
+        /** Whether a later message was acknowledged since the last send */
+        bool missing;
+    };
+
+    /** The sequence number of the next message sent */
+    Uint32 _nextSeq;
+    /** The sent messages waiting for an ack */
+    std::map<Uint32, Pending> _unacked;
+    /** The time before an unacknowledged message is resent */
+    Uint64 _timeout;
+    /** The number of recent small messages repeated in every frame */
+    Uint32 _redundancy;
+    /** The largest payload that is repeated */
+    size_t _small;
+    /** The number of messages resent */
+    Uint64 _resent;
+    /** The number of repeated copies sent */
+    Uint64 _repeated;
+    /** The sequence number of the next message to deliver */
+    Uint32 _expected;
+    /** The received messages waiting for the gaps before them */
+    std::map<Uint32, ChannelMessage> _early;
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates an empty channel.
+     */
+    ReliableChannel() : _nextSeq(1), _timeout(0), _redundancy(0), _small(0),
+    _resent(0), _repeated(0), _expected(1) {}
+
+    /**
+     * Initializes an empty channel.
+     *
+     * @param timeout       The time before an unacknowledged message is resent
+     * @param redundancy    The number of recent small messages repeated in every frame
+     * @param small         The largest payload that is repeated
+     */
+    void init(Uint64 timeout, Uint32 redundancy = 0, size_t small = 64);
+
+    /**
+     * Forgets all messages, sent and received.
+     */
+    void clear();
+
+#pragma mark Sending
+    /**
+     * Queues a message for the next frame, returning its sequence number.
+     *
+     * @param key       The stream of the message
+     * @param payload   The message contents
+     * @param now       The current time
+     *
+     * @return the sequence number of the message
+     */
+    Uint32 send(Uint32 key, const std::vector<std::byte>& payload, Uint64 now);
+
+    /**
+     * Returns the frame to send now.
+     *
+     * The frame has the messages never sent, those missing or past their
+     * timeout, and copies of the most recent small unacknowledged messages.
+     * It also acknowledges everything this end has received.
+     *
+     * @param now   The current time
+     *
+     * @return the frame to send now
+     */
+    ChannelFrame frame(Uint64 now);
+
+    /**
+     * Drops every message acknowledged by the receiver.
+     *
+     * Any message sent before the latest one acknowledged is marked missing,
+     * and resent in the next frame.
+     *
+     * @param ack       The cumulative acknowledgement of the receiver
+     * @param ackBits   Bit i is set if message ack+1+i was received
+     */
+    void acknowledge(Uint32 ack, Uint32 ackBits);
+
+    /**
+     * Returns the number of messages waiting for an ack.
+     *
+     * @return the number of messages waiting for an ack.
+     */
+    size_t getUnacked() const { return _unacked.size(); }
+
+    /**
+     * Returns the number of messages resent.
+     *
+     * @return the number of messages resent.
+     */
+    Uint64 getResent() const { return _resent; }
+
+    /**
+     * Returns the number of repeated copies sent.
+     *
+     * @return the number of repeated copies sent.
+     */
+    Uint64 getRepeated() const { return _repeated; }
+
+#pragma mark Receiving
+    /**
+     * Receives a frame, returning the messages now ready in order.
+     *
+     * The acknowledgement of the frame is applied first. Duplicates and
+     * messages already delivered are ignored.
+     *
+     * @param frame The received frame
+     *
+     * @return the messages ready for delivery, in order
+     */
+    std::vector<ChannelMessage> receive(const ChannelFrame& frame);
+
+    /**
+     * Returns the cumulative acknowledgement for the sender.
+     *
+     * @return the cumulative acknowledgement for the sender.
+     */
+    Uint32 getAck() const { return _expected-1; }
+
+    /**
+     * Returns the selective acknowledgement for the sender.
+     *
+     * @return bit i is set if message getAck()+1+i was received
+     */
+    Uint32 getAckBits() const;
+};
+
+/**
+ * This class is an unreliable channel where the latest message wins.
+ *
+ * Messages are never resent. Each stream (e.g. each obstacle) only
+ * delivers a message newer than the last one it delivered, so reordered
+ * and superseded state is dropped instead of applied out of order.
+ */
+class LatestChannel {
+protected:
+    /** The sequence number of the next message sent */
+    Uint32 _nextSeq;
+    /** The sequence number of the last message delivered, by stream */
+    std::unordered_map<Uint32, Uint32> _latest;
+    /** The number of stale messages dropped */
+    Uint64 _stale;
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates an empty channel.
+     */
+    LatestChannel() : _nextSeq(1), _stale(0) {}
+
+    /**
+     * Forgets all messages, sent and received.
+     */
+    void clear();
+
+#pragma mark Sending
+    /**
+     * Stamps a message with its sequence number.
+     *
+     * @param key       The stream of the message
+     * @param payload   The message contents
+     * @param now       The current time
+     *
+     * @return the message to send now
+     */
+    ChannelMessage send(Uint32 key, const std::vector<std::byte>& payload, Uint64 now);
+
+#pragma mark Receiving
+    /**
+     * Returns true if the message is newer than anything in its stream.
+     *
+     * Stale messages are counted and should be dropped.
+     *
+     * @param message   The received message
+     *
+     * @return true if the message is newer than anything in its stream.
+     */
+    bool receive(const ChannelMessage& message);
+
+    /**
+     * Returns the number of stale messages dropped.
+     *
+     * @return the number of stale messages dropped.
+     */
+    Uint64 getStale() const { return _stale; }
+};
+
+#endif /* __NL_CHANNEL_H__ */
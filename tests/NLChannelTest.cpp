@@ -0,0 +1,268 @@
+//
+//  NLChannelTest.cpp
+//  Networked Physics Demo
+//
+//  Tests for the model of reliable and latest-wins channels (the game does
+//  not send through them).  Events must arrive in order, stale state must
+//  be dropped, and state on its own channel must stay fresher over a lossy
+//  link than state queued with the events.
+//  In the model, a selective ack must resend a lost event before its
+//  timeout, and repeating small events must recover most losses with no
+//  resend.
+//
+//  Author: Networked Physics Lab contributors
+//  Version: 10/18/26
+//
+#include "NLTest.h"
+#include "NLChannel.h"
+#include <algorithm>
+#include <random>
+
+/** The length of a simulated tick, in microseconds */
+#define TEST_STEP       16667
+/** The one way delay of the simulated link, in microseconds */
+#define TEST_DELAY      50000
+/** The stream of events in the simulation (state streams are numbered from 0) */
+#define EVENT_STREAM    0xFFFFFFFF
+/** The number of ticks between events in the simulation */
+#define EVENT_TICKS     6
+
+/** A packet in flight on the simulated link */
+struct TestPacket {
+    /** The time the packet arrives */
+    Uint64 arrival;
+    /** The reliable frame */
+    ChannelFrame frame;
+    /** The latest-wins messages */
+    std::vector<ChannelMessage> latest;
+};
+
+/**
+ * Returns the packets that have arrived by now, removing them from the wire.
+ */
+static std::vector<TestPacket> arrive(std::vector<TestPacket>& wire, Uint64 now) {
+    std::vector<TestPacket> result;
+    for(auto it = wire.begin(); it != wire.end(); ) {
+        if (it->arrival <= now) {
+            result.push_back(*it);
+            it = wire.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    return result;
+}
+
+/**
+ * Returns a payload of the given size.
+ */
+static std::vector<std::byte> makePayload(size_t size) {
+    return std::vector<std::byte>(size, std::byte{0});
+}
+
+NL_TEST(Channel, LatestDropsStaleState) {
+    LatestChannel sender, receiver;
+    ChannelMessage first = sender.send(1, makePayload(8), 0);
+    ChannelMessage second = sender.send(1, makePayload(8), 1);
+    ChannelMessage other = sender.send(2, makePayload(8), 2);
+
+    // Reordered state is dropped, but only within its own stream
+    NL_CHECK(receiver.receive(second));
+    NL_CHECK(!receiver.receive(first));
+    NL_CHECK(receiver.receive(other));
+    NL_CHECK(!receiver.receive(second));
+    NL_CHECK_EQ(receiver.getStale(), (Uint64)2);
+}
+
+NL_TEST(Channel, ReliableDeliversInOrder) {
+    ReliableChannel sender, receiver;
+    sender.init(TEST_DELAY);
+    receiver.init(TEST_DELAY);
+    sender.send(0, makePayload(8), 0);
+    ChannelFrame lost = sender.frame(0);
+    sender.send(0, makePayload(8), TEST_STEP);
+    ChannelFrame later = sender.frame(TEST_STEP);
+
+    // The second message waits for the first
+    NL_CHECK_EQ(receiver.receive(later).size(), (size_t)0);
+    NL_CHECK_EQ(receiver.getAck(), 0u);
+    NL_CHECK_EQ(receiver.getAckBits(), 2u);
+    auto delivered = receiver.receive(lost);
+    NL_CHECK_EQ(delivered.size(), (size_t)2);
+    NL_CHECK_EQ(delivered[0].seq, 1u);
+    NL_CHECK_EQ(delivered[1].seq, 2u);
+
+    // Duplicates are ignored
+    NL_CHECK_EQ(receiver.receive(later).size(), (size_t)0);
+}
+
+/**
+ * Returns the average age of the newest state at the receiver.
+ *
+ * The sender sends a state update for every stream each tick, and an event
+ * every few ticks, in one packet per tick over a lossy link. Unless split,
+ * state goes on the reliable channel with the events.
+ */
+static double simulateStateAge(bool split, float loss, Uint32 streams) {
+    ReliableChannel sender, receiver;
+    sender.init(2*TEST_DELAY+2*TEST_STEP);
+    receiver.init(2*TEST_DELAY+2*TEST_STEP);
+    LatestChannel latestSender, latestReceiver;
+    std::vector<TestPacket> forward, backward;
+    std::vector<Uint64> newest(streams, 0);
+    std::minstd_rand random(1);
+    std::uniform_real_distribution<float> dice(0.0f, 1.0f);
+    auto payload = makePayload(32);
+
+    double total = 0;
+    Uint64 samples = 0;
+    for(Uint64 tick = 0; tick < 60*60; tick++) {
+        Uint64 now = tick*TEST_STEP;
+        for(auto& packet : arrive(backward, now)) {
+            sender.receive(packet.frame);
+        }
+        for(auto& packet : arrive(forward, now)) {
+            for(auto& message : receiver.receive(packet.frame)) {
+                if (message.key != EVENT_STREAM) {
+                    newest[message.key] = std::max(newest[message.key], message.sent);
+                }
+            }
+            for(auto& message : packet.latest) {
+                if (latestReceiver.receive(message)) {
+                    newest[message.key] = std::max(newest[message.key], message.sent);
+                }
+            }
+        }
+        for(Uint32 key = 0; key < streams; key++) {
+            if (newest[key] > 0) {
+                total += now-newest[key];
+                samples++;
+            }
+        }
+
+        std::vector<ChannelMessage> latest;
+        for(Uint32 key = 0; key < streams; key++) {
+            if (split) {
+                latest.push_back(latestSender.send(key, payload, now));
+            } else {
+                sender.send(key, payload, now);
+            }
+        }
+        if (tick % EVENT_TICKS == 0) {
+            sender.send(EVENT_STREAM, payload, now);
+        }
+
+        // One packet each way per tick, lost as a whole
+        TestPacket there = { now+TEST_DELAY, sender.frame(now), latest };
+        TestPacket back  = { now+TEST_DELAY, receiver.frame(now), {} };
+        if (dice(random) >= loss) {
+            forward.push_back(there);
+        }
+        if (dice(random) >= loss) {
+            backward.push_back(back);
+        }
+    }
+    return samples > 0 ? total/samples : 0;
+}
+
+NL_TEST(Channel, SplitStateStaysFresh) {
+    double single = simulateStateAge(false, 0.05f, 8);
+    double split = simulateStateAge(true, 0.05f, 8);
+
+    // Split state is at most a lost packet behind the link delay
+    NL_CHECK(split < single);
+    NL_CHECK(split < TEST_DELAY+2*TEST_STEP);
+}
+
+NL_TEST(Channel, SelectiveAckResendsEarly) {
+    ReliableChannel sender, receiver;
+    sender.init(10*TEST_DELAY);
+    receiver.init(10*TEST_DELAY);
+    sender.send(0, makePayload(8), 1);
+    sender.frame(1);
+    sender.send(0, makePayload(8), 1+TEST_STEP);
+    receiver.receive(sender.frame(1+TEST_STEP));
+
+    // The second message was acked but not the first, so it goes again at once
+    ChannelFrame ack = receiver.frame(1+2*TEST_STEP);
+    NL_CHECK_EQ(ack.ack, 0u);
+    NL_CHECK_EQ(ack.ackBits, 2u);
+    sender.receive(ack);
+    ChannelFrame resend = sender.frame(1+3*TEST_STEP);
+    NL_CHECK_EQ(resend.messages.size(), (size_t)1);
+    NL_CHECK_EQ(resend.messages[0].seq, 1u);
+    NL_CHECK_EQ(sender.getResent(), (Uint64)1);
+    NL_CHECK_EQ(sender.getUnacked(), (size_t)1);
+}
+
+NL_TEST(Channel, RedundancyRecoversLoss) {
+    ReliableChannel sender, receiver;
+    sender.init(10*TEST_DELAY, 2);
+    receiver.init(10*TEST_DELAY, 2);
+    sender.send(0, makePayload(8), 1);
+    sender.frame(1);
+    sender.send(0, makePayload(8), 1+TEST_STEP);
+
+    // The first frame is lost, but the next one repeats its message
+    auto delivered = receiver.receive(sender.frame(1+TEST_STEP));
+    NL_CHECK_EQ(delivered.size(), (size_t)2);
+    NL_CHECK_EQ(sender.getRepeated(), (Uint64)1);
+    NL_CHECK_EQ(sender.getResent(), (Uint64)0);
+
+    // Large messages are never repeated
+    sender.send(0, makePayload(256), 1+2*TEST_STEP);
+    sender.frame(1+2*TEST_STEP);
+    NL_CHECK_EQ(sender.frame(1+3*TEST_STEP).messages.size(), (size_t)2);
+}
+
+/**
+ * Returns the worst event latency over a lossy link.
+ *
+ * Both ends send a frame every tick, and one sends a small event every few
+ * ticks. Only the second half of the run counts.
+ */
+static Uint64 simulateEventLatency(Uint32 redundancy, float loss) {
+    ReliableChannel sender, receiver;
+    sender.init(2*TEST_DELAY+2*TEST_STEP, redundancy);
+    receiver.init(2*TEST_DELAY+2*TEST_STEP, redundancy);
+    std::vector<TestPacket> forward, backward;
+    std::minstd_rand random(1);
+    std::uniform_real_distribution<float> dice(0.0f, 1.0f);
+    auto payload = makePayload(32);
+
+    Uint64 worst = 0;
+    for(Uint64 tick = 1; tick <= 60*60; tick++) {
+        Uint64 now = tick*TEST_STEP;
+        for(auto& packet : arrive(backward, now)) {
+            sender.receive(packet.frame);
+        }
+        for(auto& packet : arrive(forward, now)) {
+            for(auto& message : receiver.receive(packet.frame)) {
+                if (tick > 30*60) {
+                    worst = std::max(worst, now-message.sent);
+                }
+            }
+        }
+        if (tick % EVENT_TICKS == 0) {
+            sender.send(EVENT_STREAM, payload, now);
+        }
+        TestPacket there = { now+TEST_DELAY, sender.frame(now), {} };
+        TestPacket back  = { now+TEST_DELAY, receiver.frame(now), {} };
+        if (dice(random) >= loss) {
+            forward.push_back(there);
+        }
+        if (dice(random) >= loss) {
+            backward.push_back(back);
+        }
+    }
+    return worst;
+}
+
+NL_TEST(Channel, RedundancyBoundsLatency) {
+    Uint64 plain = simulateEventLatency(0, 0.05f);
+    Uint64 repeated = simulateEventLatency(3, 0.05f);
+
+    // Without repeats a loss costs a round trip; with them, a tick or two
+    NL_CHECK(plain >= 3*TEST_DELAY);
+    NL_CHECK(repeated < plain);
+}
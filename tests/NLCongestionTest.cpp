@@ -0,0 +1,141 @@
+//
+//  NLCongestionTest.cpp
+//  Networked Physics Demo
+//
+//  Tests for the congestion controller.  The budget must be cut on loss
+//  and on a growing queue, must only grow while it is used, and must keep
+//  the queue of a throttled link short when the sender follows it.
+//
+//  Author: Networked Physics Lab contributors
+//  Version: 10/18/26
+//
+#include "NLTest.h"
+#include "NLCongestion.h"
+#include <algorithm>
+#include <vector>
+
+/** One second, in microseconds */
+#define SECOND  1000000
+
+/**
+ * Returns a controller between 1000 and 10000 bytes per second.
+ */
+static CongestionController makeController(float budget) {
+    CongestionController controller;
+    controller.init(budget, 1000, 10000, 500, 0.5f, 50000);
+    return controller;
+}
+
+/**
+ * Sends ten probes at the given time, answered after the given round trip.
+ */
+static void answerProbes(CongestionController& controller, Uint32& seq, Uint64 now, Uint64 rtt) {
+    for(int ii = 0; ii < 10; ii++) {
+        controller.probe(++seq, now);
+        controller.acknowledge(seq, now+rtt);
+    }
+}
+
+NL_TEST(Congestion, CutsBudgetOnLoss) {
+    CongestionController controller = makeController(8000);
+    controller.update(SECOND, 0);
+    for(Uint32 seq = 1; seq <= 10; seq++) {
+        controller.probe(seq, SECOND);
+    }
+    controller.update(3*SECOND, 8000);
+    NL_CHECK_NEAR(controller.getLoss(), 1.0f, 1e-6);
+    NL_CHECK_NEAR(controller.getBudget(), 4000.0f, 1e-3);
+}
+
+NL_TEST(Congestion, GrowsOnlyWhenUsed) {
+    CongestionController controller = makeController(4000);
+    Uint32 seq = 0;
+    controller.update(SECOND, 0);
+    answerProbes(controller, seq, SECOND, 20000);
+    controller.update(2*SECOND, 0);
+    NL_CHECK_NEAR(controller.getBudget(), 4000.0f, 1e-3);
+
+    answerProbes(controller, seq, 2*SECOND, 20000);
+    controller.update(3*SECOND, 4000);
+    NL_CHECK_NEAR(controller.getBudget(), 4500.0f, 1e-3);
+}
+
+NL_TEST(Congestion, CutsBudgetOnQueueDelay) {
+    CongestionController controller = makeController(8000);
+    Uint32 seq = 0;
+    controller.update(SECOND, 0);
+    answerProbes(controller, seq, SECOND, 20000);
+    controller.update(2*SECOND, 8000);
+    NL_CHECK_EQ(controller.getQueueDelay(), (Uint64)0);
+
+    // The round trip grows well past its minimum, so a queue is forming
+    for(Uint64 ii = 2; ii < 6; ii++) {
+        answerProbes(controller, seq, ii*SECOND, 200000);
+    }
+    controller.update(6*SECOND, 8000);
+    NL_CHECK(controller.getQueueDelay() > 50000);
+    NL_CHECK(controller.getBudget() < 8000);
+}
+
+/**
+ * Returns the worst queue delay of state updates over a throttled link.
+ *
+ * The sender offers one update per tick. With control, an update is
+ * skipped when it would exceed the budget (the next one supersedes it).
+ * The link drains at its bandwidth and answers probes after its delay.
+ */
+static Uint64 simulateLink(bool control, Uint32 bandwidth, Uint32 update) {
+    const Uint32 rate = 60;
+    const Uint64 step = SECOND/rate;
+    const Uint64 delay = 60000;
+    CongestionController controller;
+    controller.init((float)update*rate, 2.0f*update, (float)update*rate, update*rate/20.0f, 0.7f, 50000);
+
+    Uint64 linkFree = 0;
+    Uint64 used = 0;
+    Uint64 worst = 0;
+    float tokens = 0;
+    Uint32 seq = 0;
+    std::vector<std::pair<Uint64,Uint32>> answers;
+    for(Uint64 tick = 0; tick < 60*rate; tick++) {
+        Uint64 now = tick*step;
+        for(auto it = answers.begin(); it != answers.end(); ) {
+            if (it->first <= now) {
+                controller.acknowledge(it->second, it->first);
+                it = answers.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        float budget = controller.getBudget();
+        tokens = std::min(tokens+budget/rate, std::max((float)update, 4*budget/rate));
+        if (!control || tokens >= update) {
+            tokens -= control ? update : 0;
+            Uint64 start = std::max(now, linkFree);
+            linkFree = start+(Uint64)update*SECOND/bandwidth;
+            used += update;
+            // Only the second half counts, once the controller has settled
+            if (tick >= 30*rate) {
+                worst = std::max(worst, start-now);
+            }
+        }
+        if (tick % (rate/4) == 0) {
+            controller.probe(++seq, now);
+            answers.push_back({std::max(now, linkFree)+2*delay, seq});
+        }
+        if (tick % rate == 0) {
+            controller.update(now, used);
+            used = 0;
+        }
+    }
+    return worst;
+}
+
+NL_TEST(Congestion, KeepsThrottledQueueShort) {
+    // Ten crates a tick over a cellular uplink that carries half of them
+    Uint64 uncontrolled = simulateLink(false, 12000, 400);
+    Uint64 controlled = simulateLink(true, 12000, 400);
+    NL_CHECK(uncontrolled > SECOND);
+    NL_CHECK(controlled < SECOND/2);
+}
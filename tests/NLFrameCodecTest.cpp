@@ -0,0 +1,134 @@
+//
+//  NLFrameCodecTest.cpp
+//  Networked Physics Demo
+//
+//  Tests for the frame codec.  Every frame must decode to its contents,
+//  frames that do not shrink must be sent raw, the dictionary must help
+//  small frames, and malformed frames must be rejected.
+//
+//  Author: Networked Physics Lab contributors
+//  Version: 10/18/26
+//
+#include "NLTest.h"
+#include "NLFrameCodec.h"
+#include <cstring>
+#include <vector>
+
+/**
+ * Appends the bytes of a value to a frame.
+ */
+template <typename T>
+static void append(std::vector<std::byte>& frame, T value) {
+    std::byte bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    frame.insert(frame.end(), bytes, bytes+sizeof(T));
+}
+
+/**
+ * Returns a frame of state records, like the ones the game writes.
+ *
+ * Obstacle ii rests at (ii,1), except that the obstacles from moved on
+ * are shifted right and falling.
+ */
+static std::vector<std::byte> makeFrame(Uint64 first, Uint64 count, Uint64 moved) {
+    std::vector<std::byte> frame;
+    for(Uint64 ii = first; ii < first+count; ii++) {
+        float shift = ii >= moved ? 0.25f*(ii-moved+1) : 0.0f;
+        append(frame, ii);
+        append(frame, (float)ii+shift);
+        append(frame, 1.0f);
+        append(frame, 0.0f);
+        append(frame, shift > 0 ? 0.5f : 0.0f);
+        append(frame, shift > 0 ? -9.8f : 0.0f);
+        append(frame, 0.0f);
+    }
+    return frame;
+}
+
+/**
+ * Returns the contents of an encoded frame, or an empty frame if it is malformed.
+ */
+static std::vector<std::byte> roundTrip(const FrameCodec& codec, const std::vector<std::byte>& data) {
+    std::vector<std::byte> frame;
+    if (!codec.decode(data, frame)) {
+        frame.clear();
+    }
+    return frame;
+}
+
+NL_TEST(FrameCodec, RoundTripsFrames) {
+    FrameCodec codec;
+    codec.init(std::vector<std::byte>());
+
+    // Too small to be worth compressing
+    auto small = makeFrame(0, 1, 1);
+    small.resize(16);
+    auto encoded = codec.encode(small);
+    NL_CHECK_EQ((Uint32)encoded[0], (Uint32)FrameCodec::RAW);
+    NL_CHECK_EQ(encoded.size(), small.size()+1);
+    NL_CHECK(roundTrip(codec, encoded) == small);
+
+    auto large = makeFrame(0, 100, 80);
+    encoded = codec.encode(large);
+    NL_CHECK_EQ((Uint32)encoded[0], (Uint32)FrameCodec::LZ);
+    NL_CHECK(encoded.size() < large.size());
+    NL_CHECK(roundTrip(codec, encoded) == large);
+
+    auto empty = std::vector<std::byte>();
+    NL_CHECK(roundTrip(codec, codec.encode(empty)).empty());
+}
+
+NL_TEST(FrameCodec, SendsIncompressibleFramesRaw) {
+    FrameCodec codec;
+    codec.init(std::vector<std::byte>());
+
+    std::vector<std::byte> noise;
+    Uint32 state = 12345;
+    for(int ii = 0; ii < 256; ii++) {
+        state = state*1664525u+1013904223u;
+        noise.push_back(std::byte(state >> 24));
+    }
+    auto encoded = codec.encode(noise);
+    NL_CHECK_EQ((Uint32)encoded[0], (Uint32)FrameCodec::RAW);
+    NL_CHECK_EQ(encoded.size(), noise.size()+1);
+    NL_CHECK(roundTrip(codec, encoded) == noise);
+}
+
+NL_TEST(FrameCodec, DictionaryShrinksSmallFrames) {
+    // The level layout, as every peer sees it before play
+    auto layout = makeFrame(0, 100, 100);
+    FrameCodec plain;
+    plain.init(std::vector<std::byte>());
+    FrameCodec preset;
+    preset.init(layout);
+
+    // A few crates of the layout, one of them moving
+    auto frame = makeFrame(40, 4, 43);
+    auto withoutDict = plain.encode(frame);
+    auto withDict = preset.encode(frame);
+    NL_CHECK(roundTrip(plain, withoutDict) == frame);
+    NL_CHECK(roundTrip(preset, withDict) == frame);
+    NL_CHECK(withDict.size() < withoutDict.size());
+
+    // A codec with another dictionary cannot read the frame
+    NL_CHECK(roundTrip(plain, withDict) != frame);
+}
+
+NL_TEST(FrameCodec, RejectsMalformedFrames) {
+    FrameCodec codec;
+    codec.init(std::vector<std::byte>());
+    std::vector<std::byte> frame;
+    NL_CHECK(!codec.decode(std::vector<std::byte>(), frame));
+
+    auto encoded = codec.encode(makeFrame(0, 100, 80));
+    NL_CHECK_EQ((Uint32)encoded[0], (Uint32)FrameCodec::LZ);
+    auto truncated = std::vector<std::byte>(encoded.begin(), encoded.end()-8);
+    NL_CHECK(!codec.decode(truncated, frame));
+
+    // Ten literals and then a match before the start of the frame
+    std::vector<std::byte> reach = { std::byte(FrameCodec::LZ), std::byte(20), std::byte(0xa0) };
+    reach.insert(reach.end(), 10, std::byte(7));
+    reach.push_back(std::byte(11));
+    reach.push_back(std::byte(0));
+    NL_CHECK(!codec.decode(reach, frame));
+}
@@ -0,0 +1,87 @@
+//
+//  NLObstacleIdsTest.cpp
+//  Networked Physics Demo
+//
+//  Tests for the spawn keys and id digests.  Keys must never collide across
+//  peers, obstacles must be numbered by the world in the order they are
+//  bound, and the digests must agree exactly when the bindings do.
+//
+//  Author: Networked Physics Lab contributors
+//  Version: 10/18/26
+//
+#include "NLTest.h"
+#include "NLObstacleIds.h"
+#include "NLStats.h"
+
+using namespace cugl;
+
+NL_TEST(ObstacleIds, KeysAreDisjointPerPeer) {
+    ObstacleIds one;
+    ObstacleIds two;
+    one.init(1, 4);
+    two.init(2, 4);
+    Uint32 first = one.reserve(10);
+    NL_CHECK_EQ(ObstacleIds::getPeer(first), 1u);
+    NL_CHECK_EQ(one.reserve(), first+10);
+    NL_CHECK_EQ(ObstacleIds::getPeer(two.reserve()), 2u);
+}
+
+NL_TEST(ObstacleIds, BindsWorldIdsInOrder) {
+    auto world = nlMakeWorld();
+    ObstacleIds ids;
+    ids.init(1, 4);
+    auto a = nlMakeBox();
+    auto b = nlMakeBox();
+    Uint64 ida = ids.bind(world, a, 7);
+    Uint64 idb = ids.bind(world, b, 3);
+    NL_CHECK(ida != idb);
+    NL_CHECK_EQ(world->getObjToId().at(a), ida);
+
+    // An obstacle already in the world keeps its id
+    NL_CHECK_EQ(ids.bind(world, a, 9), ida);
+    NL_CHECK_EQ(ids.size(), 3);
+}
+
+NL_TEST(ObstacleIds, DigestsAgreeOnTheSameBindings) {
+    auto world1 = nlMakeWorld();
+    auto world2 = nlMakeWorld();
+    ObstacleIds peer1;
+    ObstacleIds peer2;
+    peer1.init(1, 4);
+    peer2.init(2, 4);
+    for(Uint32 key = 1; key <= 5; key++) {
+        peer1.bind(world1, nlMakeBox(), key);
+        peer2.bind(world2, nlMakeBox(), key);
+    }
+    NL_CHECK_EQ(peer1.digest(), peer2.digest());
+
+    // Unbinding a key changes the digest until the other peer does the same
+    peer1.unbind(3);
+    NL_CHECK(peer1.digest() != peer2.digest());
+    peer2.unbind(3);
+    NL_CHECK_EQ(peer1.digest(), peer2.digest());
+}
+
+NL_TEST(ObstacleIds, ReportsMismatchedOrder) {
+    auto world1 = nlMakeWorld();
+    auto world2 = nlMakeWorld();
+    NetLabStats stats;
+    ObstacleIds peer1;
+    ObstacleIds peer2;
+    peer1.init(1, 4);
+    peer2.init(2, 4);
+    peer1.setStats(&stats);
+
+    // The same spawns applied in a different order get different ids
+    peer1.bind(world1, nlMakeBox(), 10);
+    peer1.bind(world1, nlMakeBox(), 20);
+    peer2.bind(world2, nlMakeBox(), 20);
+    peer2.bind(world2, nlMakeBox(), 10);
+
+    // A digest from a peer that is ahead waits for our tick
+    peer1.receive(2, 30, peer2.record(30));
+    NL_CHECK_EQ(stats.getCount("ids.mismatch"), 0u);
+    peer1.record(30);
+    NL_CHECK_EQ(stats.getCount("ids.mismatch"), 1u);
+    NL_CHECK_EQ(stats.getCount("ids.agreed"), 0u);
+}
@@ -0,0 +1,81 @@
+//
+//  NLRecorderTest.cpp
+//  Networked Physics Demo
+//
+//  Tests for the session recorder.  A replay must give back every frame
+//  with its own time (even inside a run of identical inputs), the spawns
+//  in the order they were recorded, and the ticks in between.
+//
+//  Author: Networked Physics Lab contributors
+//  Version: 10/18/26
+//
+#include "NLTest.h"
+#include "NLRecorder.h"
+#include <cstdio>
+
+/** The file written by the tests, in the working directory */
+#define TEST_SESSION    "nl_recorder_test.nlrs"
+
+NL_TEST(Recorder, ReplaysFrameTimesAndSpawns) {
+    SessionInput idle;
+    SessionInput turn;
+    turn.flags = SessionInput::TURN;
+    turn.vertical = 0.5f;
+    std::vector<std::byte> params = { std::byte(1), std::byte(2), std::byte(3) };
+
+    SessionRecorder recorder;
+    NL_CHECK(recorder.open(TEST_SESSION, 2, 3, false));
+    recorder.recordFrame(idle, 0.016f);
+    recorder.recordFrame(idle, 0.018f);
+    recorder.recordTick();
+    recorder.recordSpawn(params);
+    recorder.recordFrame(turn, 0.015f);
+    recorder.close();
+
+    SessionReplay replay;
+    NL_CHECK(replay.open(TEST_SESSION));
+    NL_CHECK_EQ(replay.getShortUID(), 2u);
+    NL_CHECK_EQ(replay.getNumPlayers(), 3u);
+    NL_CHECK(!replay.isHost());
+
+    NL_CHECK_EQ(replay.next(), SessionReplay::FRAME);
+    NL_CHECK_EQ(replay.getFrameTime(), 0.016f);
+    NL_CHECK_EQ(replay.next(), SessionReplay::FRAME);
+    NL_CHECK_EQ(replay.getFrameTime(), 0.018f);
+    NL_CHECK_EQ(replay.next(), SessionReplay::TICK);
+    NL_CHECK_EQ(replay.next(), SessionReplay::SPAWN);
+    NL_CHECK(replay.getSpawn() == params);
+    NL_CHECK_EQ(replay.next(), SessionReplay::FRAME);
+    NL_CHECK_EQ(replay.getFrameTime(), 0.015f);
+    NL_CHECK(replay.getInput() == turn);
+    NL_CHECK_EQ(replay.next(), SessionReplay::DONE);
+    NL_CHECK(replay.isComplete());
+    NL_CHECK_EQ(replay.getTicks(), (Uint64)1);
+    std::remove(TEST_SESSION);
+}
+
+NL_TEST(Recorder, StopsAtTruncatedRecords) {
+    SessionRecorder recorder;
+    NL_CHECK(recorder.open(TEST_SESSION, 1, 2, true));
+    recorder.recordSpawn(std::vector<std::byte>(8, std::byte(5)));
+    recorder.close();
+
+    // Cut the file in the middle of the spawn parameters
+    std::FILE* file = std::fopen(TEST_SESSION, "rb");
+    std::vector<char> data(64);
+    size_t size = file ? std::fread(data.data(), 1, data.size(), file) : 0;
+    if (file) {
+        std::fclose(file);
+    }
+    file = std::fopen(TEST_SESSION, "wb");
+    if (file) {
+        std::fwrite(data.data(), 1, size/2, file);
+        std::fclose(file);
+    }
+
+    SessionReplay replay;
+    NL_CHECK(replay.open(TEST_SESSION));
+    NL_CHECK_EQ(replay.next(), SessionReplay::DONE);
+    NL_CHECK(!replay.isComplete());
+    std::remove(TEST_SESSION);
+}
@@ -0,0 +1,155 @@
+//
+//  NLSnapshotBufferTest.cpp
+//  Networked Physics Demo
+//
+//  Tests for the snapshot buffer.  Remote obstacles must be drawn the
+//  measured delay in the past, the delay must grow with the jitter of the
+//  sender, late and reordered states must not move the track backwards,
+//  and owned obstacles must never be buffered.
+//
+//  Author: Networked Physics Lab contributors
+//  Version: 10/18/26
+//
+#include "NLTest.h"
+#include "NLSnapshotBuffer.h"
+
+using namespace cugl;
+
+/** The length of a test tick */
+#define TEST_STEP   (1.0f/60.0f)
+/** The short UID of the sending peer */
+#define TEST_PEER   2
+
+/**
+ * Returns a state at the given tick, moving one unit per tick.
+ */
+static SnapshotBuffer::Snapshot makeState(Uint64 tick, float x) {
+    SnapshotBuffer::Snapshot state;
+    state.tick = tick;
+    state.pos = Vec2(x,4);
+    state.vel = Vec2(1/TEST_STEP,0);
+    state.angle = 0;
+    return state;
+}
+
+NL_TEST(SnapshotBuffer, RejectsSmallCapacity) {
+    SnapshotBuffer buffer;
+    NL_CHECK(!buffer.init(2));
+    NL_CHECK(buffer.init(3));
+    NL_CHECK_NEAR(buffer.getDelay(TEST_PEER), 1, 1e-6);
+}
+
+NL_TEST(SnapshotBuffer, SizesDelayFromJitter) {
+    SnapshotBuffer steady;
+    SnapshotBuffer jittery;
+    steady.init(16);
+    jittery.init(16);
+
+    // Frames every 2 ticks, with a transit of 3 ticks (give or take 2)
+    for(Uint64 ii = 0; ii < 64; ii++) {
+        Uint64 sent = 100+2*ii;
+        steady.arrive(TEST_PEER, sent, sent+3);
+        jittery.arrive(TEST_PEER, sent, sent+(ii % 2 == 0 ? 1 : 5));
+    }
+    NL_CHECK_NEAR(steady.getJitter(TEST_PEER), 0, 1e-6);
+    NL_CHECK_NEAR(steady.getDelay(TEST_PEER), 5, 1e-3);
+    NL_CHECK(jittery.getJitter(TEST_PEER) > 3);
+    NL_CHECK(jittery.getDelay(TEST_PEER) > steady.getDelay(TEST_PEER)+6);
+
+    // The delay never outgrows the states the buffer can hold
+    SnapshotBuffer small;
+    small.init(4);
+    for(Uint64 ii = 0; ii < 64; ii++) {
+        small.arrive(TEST_PEER, 100+2*ii, 100+2*ii+(ii % 2 == 0 ? 1 : 9));
+    }
+    NL_CHECK(small.getDelay(TEST_PEER) <= 4+1e-3);
+}
+
+NL_TEST(SnapshotBuffer, DrawsTheDelayInThePast) {
+    auto world = nlMakeWorld();
+    auto box = nlMakeBox(world, Vec2(0,4));
+    SnapshotBuffer buffer;
+    buffer.init(8);
+
+    // One unit per tick, sent at ticks 1 to 4 and received on the same tick
+    for(Uint64 ii = 1; ii <= 4; ii++) {
+        buffer.arrive(TEST_PEER, ii, ii);
+        NL_CHECK(buffer.receive(box.get(), TEST_PEER, makeState(ii, (float)ii)));
+    }
+    NL_CHECK_NEAR(buffer.getDelay(TEST_PEER), 1, 1e-6);
+    buffer.prune(world, 4);
+
+    Vec2 pos;
+    float angle = 0;
+    buffer.setRenderTime(0, TEST_STEP);
+    NL_CHECK(buffer.sample(box.get(), pos, angle));
+    NL_CHECK_NEAR(pos.x, 3, 1e-4);
+
+    // Halfway through the next tick is halfway between two states
+    buffer.setRenderTime(TEST_STEP/2, TEST_STEP);
+    NL_CHECK(buffer.sample(box.get(), pos, angle));
+    NL_CHECK_NEAR(pos.x, 3.5f, 1e-4);
+}
+
+NL_TEST(SnapshotBuffer, DropsReorderedStates) {
+    auto world = nlMakeWorld();
+    auto box = nlMakeBox(world, Vec2(0,4));
+    SnapshotBuffer buffer;
+    buffer.init(8);
+
+    NL_CHECK(buffer.receive(box.get(), TEST_PEER, makeState(5, 5)));
+    NL_CHECK(!buffer.receive(box.get(), TEST_PEER, makeState(4, 4)));
+    NL_CHECK(!buffer.receive(box.get(), TEST_PEER, makeState(5, 9)));
+
+    // A new owner starts a new track, whatever its clock says
+    NL_CHECK(buffer.receive(box.get(), TEST_PEER+1, makeState(2, 2)));
+}
+
+NL_TEST(SnapshotBuffer, ExtrapolatesUntilStale) {
+    auto world = nlMakeWorld();
+    auto box = nlMakeBox(world, Vec2(0,4));
+    SnapshotBuffer buffer;
+    buffer.init(8);
+    buffer.arrive(TEST_PEER, 10, 10);
+    buffer.receive(box.get(), TEST_PEER, makeState(10, 10));
+
+    // Starved by two ticks: keep moving along the velocity
+    Vec2 pos;
+    float angle = 0;
+    buffer.prune(world, 13);
+    buffer.setRenderTime(0, TEST_STEP);
+    NL_CHECK(buffer.sample(box.get(), pos, angle));
+    NL_CHECK_NEAR(pos.x, 12, 1e-3);
+
+    // Far past the newest state, fall back to the physics pose
+    buffer.prune(world, 100);
+    buffer.setRenderTime(0, TEST_STEP);
+    NL_CHECK(!buffer.sample(box.get(), pos, angle));
+}
+
+NL_TEST(SnapshotBuffer, PrunesOwnedAndRemovedObstacles) {
+    auto world = nlMakeWorld();
+    auto mine = nlMakeBox(world, Vec2(4,4));
+    auto gone = nlMakeBox(world, Vec2(8,4));
+
+    SnapshotBuffer buffer;
+    buffer.init(8);
+    buffer.receive(mine.get(), TEST_PEER, makeState(1, 4));
+    buffer.receive(gone.get(), TEST_PEER, makeState(1, 8));
+    NL_CHECK_EQ(buffer.size(), 2);
+
+    // Taking ownership drops the track
+    world->getOwned().insert({mine,0});
+    buffer.prune(world, 1);
+    NL_CHECK_EQ(buffer.size(), 1);
+    Vec2 pos;
+    float angle = 0;
+    buffer.setRenderTime(0, TEST_STEP);
+    NL_CHECK(!buffer.sample(mine.get(), pos, angle));
+
+    // Removed obstacles leave the world on its next update
+    gone->markRemoved(true);
+    world->update(TEST_STEP);
+    buffer.prune(world, 2);
+    NL_CHECK_EQ(buffer.size(), 0);
+}
@@ -0,0 +1,92 @@
+//
+//  NLTest.h
+//  Networked Physics Demo
+//
+//  This is a minimal test harness for the helper classes of the demo.  Tests
+//  are plain functions registered under a suite name, and each check records
+//  a failure with its file and line instead of aborting, so that one run
+//  reports every broken check of a suite.  The simulations that used to run
+//  as startup benchmarks in the game scene are suites here, with checks on
+//  the behavior they were written to show.
+//
+//  Author: Networked Physics Lab contributors
+//  Version: 10/18/26
+//
+#ifndef __NL_TEST_H__
+#define __NL_TEST_H__
+#include <cugl/cugl.h>
+#include <cmath>
+#include <functional>
+#include <string>
+
+/**
+ * Registers a test function under the given suite.
+ *
+ * Registration happens during static initialization, so every test file
+ * only needs to be linked in.
+ *
+ * @param suite The suite name (selected on the command line)
+ * @param name  The test name
+ * @param test  The test function
+ *
+ * @return true (so that it can initialize a static)
+ */
+bool nlRegisterTest(const char* suite, const char* name, std::function<void()> test);
+
+/**
+ * Records a failed check of the running test.
+ *
+ * @param file  The source file of the check
+ * @param line  The source line of the check
+ * @param what  The text of the check
+ */
+void nlFailCheck(const char* file, int line, const std::string& what);
+
+/** Defines a test function and registers it under a suite */
+#define NL_TEST(suite, name) \
+    static void suite##_##name(); \
+    static bool suite##_##name##_registered = nlRegisterTest(#suite, #name, suite##_##name); \
+    static void suite##_##name()
+
+/** Checks that the condition holds */
+#define NL_CHECK(cond) \
+    do { if (!(cond)) { nlFailCheck(__FILE__, __LINE__, #cond); } } while (0)
+
+/** Checks that two values are equal */
+#define NL_CHECK_EQ(a, b) \
+    do { if (!((a) == (b))) { nlFailCheck(__FILE__, __LINE__, #a " == " #b); } } while (0)
+
+/** Checks that two floating point values are within eps of each other */
+#define NL_CHECK_NEAR(a, b, eps) \
+    do { if (!(std::fabs((double)(a)-(double)(b)) <= (eps))) { \
+        nlFailCheck(__FILE__, __LINE__, #a " ~= " #b); } } while (0)
+
+#pragma mark -
+#pragma mark Fixtures
+/**
+ * Returns a world with no gravity, so that bodies only move when told to.
+ */
+inline std::shared_ptr<cugl::physics2::ObstacleWorld> nlMakeWorld() {
+    return cugl::physics2::ObstacleWorld::alloc(cugl::Rect(0,0,32,18), cugl::Vec2::ZERO);
+}
+
+/**
+ * Returns a unit box at the given position, not in any world.
+ */
+inline std::shared_ptr<cugl::physics2::BoxObstacle> nlMakeBox(cugl::Vec2 pos = cugl::Vec2::ZERO) {
+    auto box = cugl::physics2::BoxObstacle::alloc(pos, cugl::Size(1,1));
+    box->setDensity(1.0f);
+    return box;
+}
+
+/**
+ * Returns a unit box at the given position, added to the world.
+ */
+inline std::shared_ptr<cugl::physics2::BoxObstacle> nlMakeBox(const std::shared_ptr<cugl::physics2::ObstacleWorld>& world,
+                                                             cugl::Vec2 pos) {
+    auto box = nlMakeBox(pos);
+    world->addObstacle(box);
+    return box;
+}
+
+#endif /* __NL_TEST_H__ */
@@ -0,0 +1,93 @@
+//
+//  NLTestMain.cpp
+//  Networked Physics Demo
+//
+//  This is the entry point of the test runner.  With no arguments it runs
+//  every registered test; otherwise it runs the suites named on the command
+//  line.  The exit status is the number of failed tests (capped at 255), so
+//  that ctest can run one suite per test.
+//
+//  Author: Networked Physics Lab contributors
+//  Version: 10/18/26
+//
+#define SDL_MAIN_HANDLED
+#include "NLTest.h"
+#include <cstdio>
+#include <set>
+#include <vector>
+
+/** A registered test */
+struct NLTestCase {
+    /** The suite name */
+    std::string suite;
+    /** The test name */
+    std::string name;
+    /** The test function */
+    std::function<void()> test;
+};
+
+/**
+ * Returns the registered tests, in registration order.
+ *
+ * This is a function static so that it exists before any registration.
+ */
+static std::vector<NLTestCase>& registry() {
+    static std::vector<NLTestCase> tests;
+    return tests;
+}
+
+/** The number of failed checks in the running test */
+static int failures = 0;
+
+/**
+ * Registers a test function under the given suite.
+ *
+ * @param suite The suite name (selected on the command line)
+ * @param name  The test name
+ * @param test  The test function
+ *
+ * @return true (so that it can initialize a static)
+ */
+bool nlRegisterTest(const char* suite, const char* name, std::function<void()> test) {
+    registry().push_back({suite, name, test});
+    return true;
+}
+
+/**
+ * Records a failed check of the running test.
+ *
+ * @param file  The source file of the check
+ * @param line  The source line of the check
+ * @param what  The text of the check
+ */
+void nlFailCheck(const char* file, int line, const std::string& what) {
+    std::fprintf(stderr, "  %s:%d: check failed: %s\n", file, line, what.c_str());
+    failures++;
+}
+
+/**
+ * Runs the selected suites, and returns the number of failed tests.
+ */
+int main(int argc, char* argv[]) {
+    std::set<std::string> suites(argv+1, argv+argc);
+    int failed = 0;
+    int run = 0;
+    for(auto& test : registry()) {
+        if (!suites.empty() && suites.find(test.suite) == suites.end()) {
+            continue;
+        }
+        failures = 0;
+        test.test();
+        run++;
+        std::printf("%s %s.%s\n", failures == 0 ? "PASS" : "FAIL", test.suite.c_str(), test.name.c_str());
+        if (failures > 0) {
+            failed++;
+        }
+    }
+    if (run == 0) {
+        std::fprintf(stderr, "No tests matched\n");
+        return 1;
+    }
+    std::printf("%d of %d tests passed\n", run-failed, run);
+    return failed > 255 ? 255 : failed;
+}
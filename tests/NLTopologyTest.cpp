@@ -0,0 +1,122 @@
+//
+//  NLTopologyTest.cpp
+//  Networked Physics Demo
+//
+//  Tests for the topology selection.  In the mesh, the upload of every
+//  owner must grow with the size of the room; with the relay, only the
+//  relay uploads state.  In AUTO mode the relay must be chosen once a peer
+//  is over budget, and the mesh must only come back with some headroom.
+//
+//  Author: Networked Physics Lab contributors
+//  Version: 10/18/26
+//
+#include "NLTest.h"
+#include "NLTopology.h"
+
+/** The short UID of the relay peer */
+#define TEST_RELAY  1
+/** The bytes of header per packet */
+#define TEST_HEADER 28
+/** The packets per second, per receiver */
+#define TEST_RATE   60
+
+/**
+ * Returns a topology where every peer reports the same payload rate.
+ */
+static Topology makeRoom(Topology::Mode mode, Uint32 peers, Uint32 payload, Uint32 budget) {
+    Topology topology;
+    topology.init(mode, TEST_RELAY, TEST_HEADER, TEST_RATE, budget, 10*budget);
+    for(Uint32 peer = TEST_RELAY; peer < TEST_RELAY+peers; peer++) {
+        topology.report(peer, payload);
+    }
+    return topology;
+}
+
+NL_TEST(Topology, MeshGrowsWithRoom) {
+    const Uint32 payload = 2000;
+    const Uint32 sizes[] = { 4, 8, 16 };
+    for(Uint32 peers : sizes) {
+        Topology topology = makeRoom(Topology::Mode::MESH, peers, payload, 1000000);
+        auto mesh = topology.estimate(Topology::Mode::MESH);
+        NL_CHECK_EQ(mesh.size(), peers);
+        for(auto it = mesh.begin(); it != mesh.end(); ++it) {
+            NL_CHECK_EQ(it->second, (payload+TEST_HEADER*TEST_RATE)*(peers-1));
+        }
+    }
+}
+
+NL_TEST(Topology, OnlyRelayUploadsState) {
+    const Uint32 payload = 2000;
+    const Uint32 sizes[] = { 4, 8, 16 };
+    for(Uint32 peers : sizes) {
+        Topology topology = makeRoom(Topology::Mode::RELAY, peers, payload, 1000000);
+        auto relay = topology.estimate(Topology::Mode::RELAY);
+        NL_CHECK_EQ(relay[TEST_RELAY], (payload*peers+TEST_HEADER*TEST_RATE)*(peers-1));
+        for(auto it = relay.begin(); it != relay.end(); ++it) {
+            if (it->first != TEST_RELAY) {
+                NL_CHECK_EQ(it->second, 0);
+            }
+        }
+    }
+}
+
+NL_TEST(Topology, FixedModesDoNotSwitch) {
+    Topology mesh = makeRoom(Topology::Mode::MESH, 8, 100000, 1000);
+    NL_CHECK(!mesh.select());
+    NL_CHECK(!mesh.isRelaying());
+
+    Topology relay = makeRoom(Topology::Mode::RELAY, 2, 0, 1000000);
+    NL_CHECK(!relay.select());
+    NL_CHECK(relay.isRelaying());
+}
+
+NL_TEST(Topology, AutoSwitchesWithHeadroom) {
+    // Each peer needs (2000+1680)*3 = 11040 bytes per second in the mesh
+    Topology topology = makeRoom(Topology::Mode::AUTO, 4, 2000, 12000);
+    NL_CHECK(!topology.select());
+    NL_CHECK_EQ(topology.getActive(), Topology::Mode::MESH);
+
+    // Over budget: relay
+    for(Uint32 peer = TEST_RELAY; peer < TEST_RELAY+4; peer++) {
+        topology.report(peer, 3000);
+    }
+    NL_CHECK(topology.select());
+    NL_CHECK(topology.isRelaying());
+
+    // While relaying, only the relay reports state; the mesh is judged by
+    // the total spread over the room. Just under budget is not enough.
+    topology.report(TEST_RELAY, 8400);
+    for(Uint32 peer = TEST_RELAY+1; peer < TEST_RELAY+4; peer++) {
+        topology.report(peer, 0);
+    }
+    NL_CHECK(!topology.select());
+    NL_CHECK(topology.isRelaying());
+
+    // With 20% headroom, back to the mesh
+    topology.report(TEST_RELAY, 4000);
+    NL_CHECK(topology.select());
+    NL_CHECK_EQ(topology.getActive(), Topology::Mode::MESH);
+}
+
+NL_TEST(Topology, RelayMustFitItsBudget) {
+    Topology topology;
+    topology.init(Topology::Mode::AUTO, TEST_RELAY, TEST_HEADER, TEST_RATE, 12000, 20000);
+    for(Uint32 peer = TEST_RELAY; peer < TEST_RELAY+4; peer++) {
+        topology.report(peer, 3000);
+    }
+    NL_CHECK(!topology.select());
+    NL_CHECK(!topology.isRelaying());
+}
+
+NL_TEST(Topology, FollowsAndForgetsPeers) {
+    Topology topology = makeRoom(Topology::Mode::AUTO, 4, 2000, 12000);
+    NL_CHECK(topology.follow(Topology::Mode::RELAY));
+    NL_CHECK(!topology.follow(Topology::Mode::RELAY));
+    NL_CHECK(topology.isRelaying());
+
+    topology.retain({ TEST_RELAY, TEST_RELAY+1 });
+    NL_CHECK_EQ(topology.estimate(Topology::Mode::MESH).size(), 2);
+    topology.clear();
+    NL_CHECK(!topology.isRelaying());
+    NL_CHECK_EQ(topology.estimate(Topology::Mode::MESH).size(), 1);
+}
@@ -0,0 +1,87 @@
+//
+//  NLTransformSyncTest.cpp
+//  Networked Physics Demo
+//
+//  Tests for the batched transform sync.  The nodes must follow awake
+//  bodies, skip bodies that did not move, and still follow a sleeping body
+//  that a network correction moved without waking it.
+//
+//  Author: Networked Physics Lab contributors
+//  Version: 10/18/26
+//
+#include "NLTest.h"
+#include "NLTransformSync.h"
+#include <box2d/b2_body.h>
+
+using namespace cugl;
+
+/** The drawing scale used by every test */
+#define TEST_SCALE  32.0f
+
+NL_TEST(TransformSync, FollowsAwakeBodies) {
+    auto world = nlMakeWorld();
+    auto box = nlMakeBox(world, Vec2(4,4));
+    auto node = scene2::SceneNode::alloc();
+    TransformSync sync;
+    sync.add(box, node);
+
+    sync.update(0, TEST_SCALE);
+    NL_CHECK_EQ(sync.getWritten(), 1);
+    NL_CHECK_NEAR(node->getPosition().x, 4*TEST_SCALE, 1e-3);
+    NL_CHECK_NEAR(node->getPosition().y, 4*TEST_SCALE, 1e-3);
+
+    // The leftover time extrapolates along the velocity
+    box->setLinearVelocity(Vec2(2,0));
+    sync.update(0.5f, TEST_SCALE);
+    NL_CHECK_NEAR(node->getPosition().x, 5*TEST_SCALE, 1e-3);
+}
+
+NL_TEST(TransformSync, SkipsBodiesThatDidNotMove) {
+    auto world = nlMakeWorld();
+    auto box = nlMakeBox(world, Vec2(4,4));
+    auto node = scene2::SceneNode::alloc();
+    TransformSync sync;
+    sync.add(box, node);
+
+    sync.update(0, TEST_SCALE);
+    sync.update(0, TEST_SCALE);
+    NL_CHECK_EQ(sync.getWritten(), 0);
+}
+
+NL_TEST(TransformSync, RedrawsSleepingBodyMovedByCorrection) {
+    auto world = nlMakeWorld();
+    auto box = nlMakeBox(world, Vec2(4,4));
+    auto node = scene2::SceneNode::alloc();
+    TransformSync sync;
+    sync.add(box, node);
+    sync.update(0, TEST_SCALE);
+
+    // SetTransform (which the network correction uses) does not wake a body
+    box->getBody()->SetAwake(false);
+    box->setPosition(Vec2(6,4));
+    NL_CHECK(!box->getBody()->IsAwake());
+
+    sync.update(0, TEST_SCALE);
+    NL_CHECK_EQ(sync.getWritten(), 1);
+    NL_CHECK_NEAR(node->getPosition().x, 6*TEST_SCALE, 1e-3);
+
+    // Once drawn, the sleeping body is skipped again
+    sync.update(0, TEST_SCALE);
+    NL_CHECK_EQ(sync.getWritten(), 0);
+}
+
+NL_TEST(TransformSync, DropsRemovedObstacles) {
+    auto world = nlMakeWorld();
+    auto keep = nlMakeBox(world, Vec2(4,4));
+    auto drop = nlMakeBox(world, Vec2(8,4));
+    auto keepNode = scene2::SceneNode::alloc();
+    auto dropNode = scene2::SceneNode::alloc();
+    TransformSync sync;
+    sync.add(drop, dropNode);
+    sync.add(keep, keepNode);
+
+    drop->markRemoved(true);
+    sync.update(0, TEST_SCALE);
+    NL_CHECK_EQ(sync.size(), 1);
+    NL_CHECK_NEAR(keepNode->getPosition().x, 4*TEST_SCALE, 1e-3);
+}
@@ -0,0 +1,133 @@
+//
+//  NLWorldHashTest.cpp
+//  Networked Physics Demo
+//
+//  Tests for the world hash.  The cached hash of a settling world must
+//  always equal a full rehash, identical worlds must agree, a sleeping
+//  body moved by a correction must change the hash, and only the first
+//  mismatch with another peer is reported.
+//
+//  Author: Networked Physics Lab contributors
+//  Version: 10/18/26
+//
+#include "NLTest.h"
+#include "NLWorldHash.h"
+#include <box2d/b2_body.h>
+#include <cmath>
+
+using namespace cugl;
+
+/** The quantization step used by every test */
+#define TEST_QUANTUM    (1.0f/1024)
+
+/**
+ * Returns a world of boxes stacked in columns on a floor.
+ *
+ * Some of the boxes settle and fall asleep, and some keep moving, so
+ * that the hasher both reuses and recomputes body hashes.
+ */
+static std::shared_ptr<physics2::ObstacleWorld> makeStacks(size_t bodies) {
+    size_t columns = (size_t)std::ceil(std::sqrt((double)bodies));
+    float width = columns*1.5f+2.0f;
+    auto world = physics2::ObstacleWorld::alloc(Rect(0,0,width,width*2),Vec2(0,-9.8f));
+    auto floor = physics2::BoxObstacle::alloc(Vec2(width/2,0.5f), Size(width,1.0f));
+    floor->setBodyType(b2_staticBody);
+    world->addInitObstacle(floor);
+    for(size_t ii = 0; ii < bodies; ii++) {
+        Vec2 pos(1.5f+(ii % columns)*1.5f, 1.5f+(ii / columns)*1.1f);
+        auto box = physics2::BoxObstacle::alloc(pos, Size(1.0f,1.0f));
+        box->setDensity(1.0f);
+        box->setFriction(0.5f);
+        world->addInitObstacle(box);
+    }
+    return world;
+}
+
+NL_TEST(WorldHash, CachedHashMatchesFullHash) {
+    auto world = makeStacks(36);
+    WorldHash cached;
+    WorldHash full;
+    cached.init(0, TEST_QUANTUM);
+    full.init(0, TEST_QUANTUM);
+
+    int differences = 0;
+    for(Uint64 tick = 0; tick < 240; tick++) {
+        world->update(1.0f/60);
+        if (cached.compute(world, tick) != full.compute(world, tick, true)) {
+            differences++;
+        }
+    }
+    NL_CHECK_EQ(differences, 0);
+}
+
+NL_TEST(WorldHash, IdenticalWorldsAgree) {
+    auto world1 = makeStacks(16);
+    auto world2 = makeStacks(16);
+    WorldHash hash1;
+    WorldHash hash2;
+    hash1.init(0, TEST_QUANTUM);
+    hash2.init(0, TEST_QUANTUM);
+
+    int differences = 0;
+    for(Uint64 tick = 0; tick < 60; tick++) {
+        world1->update(1.0f/60);
+        world2->update(1.0f/60);
+        if (hash1.compute(world1, tick) != hash2.compute(world2, tick)) {
+            differences++;
+        }
+    }
+    NL_CHECK_EQ(differences, 0);
+
+    // One body off by a few quanta is enough to disagree
+    auto obj = world2->getObstacles().back();
+    obj->setPosition(obj->getPosition()+Vec2(4*TEST_QUANTUM,0));
+    NL_CHECK(hash1.compute(world1, 60) != hash2.compute(world2, 60));
+}
+
+NL_TEST(WorldHash, RehashesSleepingBodyMovedByCorrection) {
+    auto world = physics2::ObstacleWorld::alloc(Rect(0,0,32,18), Vec2::ZERO);
+    auto box = physics2::BoxObstacle::alloc(Vec2(4,4), Size(1,1));
+    box->setDensity(1.0f);
+    world->addInitObstacle(box);
+    WorldHash hasher;
+    hasher.init(0, TEST_QUANTUM);
+
+    box->getBody()->SetAwake(false);
+    Uint64 before = hasher.compute(world, 0);
+    NL_CHECK_EQ(hasher.compute(world, 1), before);
+
+    // SetTransform (which the network correction uses) does not wake a body
+    box->setPosition(Vec2(6,4));
+    NL_CHECK(!box->getBody()->IsAwake());
+    Uint64 after = hasher.compute(world, 2);
+    NL_CHECK(after != before);
+    NL_CHECK_EQ(after, hasher.compute(world, 3, true));
+}
+
+NL_TEST(WorldHash, ReportsFirstMismatchOnly) {
+    auto world = physics2::ObstacleWorld::alloc(Rect(0,0,32,18), Vec2::ZERO);
+    auto box = physics2::BoxObstacle::alloc(Vec2(4,4), Size(1,1));
+    world->addInitObstacle(box);
+    WorldHash hasher;
+    hasher.init(4, TEST_QUANTUM);
+    int reports = 0;
+    Uint64 reported = 0;
+    hasher.setMismatchHandler([&](Uint64 tick, Uint32 peer, Uint64 local, Uint64 remote) {
+        reports++;
+        reported = tick;
+    });
+
+    // A peer ahead of us waits until we hash the same tick
+    Uint64 hash = hasher.compute(world, 0);
+    hasher.receive(2, 1, hash);
+    NL_CHECK_EQ(reports, 0);
+    hasher.compute(world, 1);
+    NL_CHECK(!hasher.isDiverged());
+
+    hasher.receive(2, 0, hash+1);
+    hasher.receive(3, 1, hash+1);
+    NL_CHECK(hasher.isDiverged());
+    NL_CHECK_EQ(hasher.getFirstMismatch(), (Uint64)0);
+    NL_CHECK_EQ(reports, 1);
+    NL_CHECK_EQ(reported, (Uint64)0);
+}